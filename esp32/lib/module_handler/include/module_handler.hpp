@@ -115,6 +115,9 @@ class ModuleHandler {
   /** Store reference to last module */
   Module *last_module;
 
+  /** Last received command, stored here instead of on the stack */
+  Esp32Command cmd = Esp32Command_init_zero;
+
   typedef struct {
     /** Size of receive/request buffer */
     const size_t size = Esp32Command_size;
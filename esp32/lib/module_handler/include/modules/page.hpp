@@ -0,0 +1,117 @@
+/**
+ * @file page.hpp
+ * @brief Module for storing pages of measurements on the sd card
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef LIB_MODULE_HANDLER_INCLUDE_MODULES_PAGE_HPP_
+#define LIB_MODULE_HANDLER_INCLUDE_MODULES_PAGE_HPP_
+
+#include <Arduino.h>
+#include <SD.h>
+
+#include "soil_power_sensor.pb.h"
+#include "template_module.hpp"
+#include "transcoder.h"
+
+/**
+ * @ingroup moduleHandler
+ * @brief Page module for the esp32
+ *
+ * Stores pages spilled from the FRAM buffer of the stm32 as files on the sd
+ * card. Each file descriptor maps to the file `/page_<fd>.bin`. The module
+ * supports OPEN, CLOSE, WRITE, READ and DELETE commands through OnReceive.
+ * Writes are appended to the end of the file and reads start at the offset in
+ * the command, so the file position is not shared between the two.
+ *
+ * The response echoes the request type and file descriptor with a return code
+ * of 0 on success. For WRITE and READ the number of bytes written or read is
+ * returned in num_bytes, and READ returns the bytes in data.
+ *
+ * @{
+ */
+
+class ModulePage : public ModuleHandler::Module {
+ public:
+  /**
+   * @brief Construct a new Module Page object
+   *
+   * @param cs_pin Chip select pin of the sd card
+   */
+  explicit ModulePage(uint8_t cs_pin = 7);
+
+  ~ModulePage(void);
+
+  /**
+   * @see ModuleHandler::Module.OnReceive
+   */
+  void OnReceive(const Esp32Command &cmd);
+
+  /**
+   * @see ModuleHandler::Module.OnRequest
+   */
+  size_t OnRequest(uint8_t *buffer);
+
+ private:
+  /** Return codes */
+  typedef enum {
+    /** Success */
+    PAGE_OK = 0,
+    /** Sd card could not be initialized */
+    PAGE_NO_CARD = 1,
+    /** File could not be opened or does not exist */
+    PAGE_FILE_ERROR = 2,
+    /** File could not be written in full */
+    PAGE_WRITE_ERROR = 3,
+  } ReturnCode;
+
+  /**
+   * @brief Initializes the sd card on first use
+   *
+   * @return true if the sd card is ready, false otherwise
+   */
+  bool Begin(void);
+
+  /**
+   * @brief Get the path of the file for a file descriptor
+   *
+   * @param fd File descriptor
+   * @return Path of the file
+   */
+  String Path(uint32_t fd);
+
+  void Open(const PageCommand &cmd, PageCommand *resp);
+
+  void Close(const PageCommand &cmd, PageCommand *resp);
+
+  void Write(const PageCommand &cmd, PageCommand *resp);
+
+  void Read(const PageCommand &cmd, PageCommand *resp);
+
+  void Delete(const PageCommand &cmd, PageCommand *resp);
+
+  /** Chip select pin of the sd card */
+  uint8_t cs_pin;
+
+  /** Flag for sd card initialized */
+  bool sd_ready = false;
+
+  /** File open for appending */
+  File file;
+
+  /** File descriptor of the open file */
+  uint32_t file_fd = 0;
+
+  /** Buffer for i2c requests */
+  uint8_t request_buffer[Esp32Command_size] = {};
+  size_t request_buffer_len = 0;
+};
+
+/**
+ * @}
+ */
+
+#endif  // LIB_MODULE_HANDLER_INCLUDE_MODULES_PAGE_HPP_
@@ -83,17 +83,20 @@ void ModuleHandler::ModuleHandler::OnReceive(size_t num_bytes) {
     }
 
     // decode measurement
-    Esp32Command cmd =
-        DecodeEsp32Command(receive_buffer.data, receive_buffer.len);
-
-    Log.verboseln("Forwarding message to: cmd.which_command: %d",
-                  cmd.which_command);
+    int status =
+        DecodeEsp32Command(receive_buffer.data, receive_buffer.len, &cmd);
+    if (status != 0) {
+      Log.errorln("Failed to decode Esp32Command");
+    } else {
+      Log.verboseln("Forwarding message to: cmd.which_command: %d",
+                    cmd.which_command);
 
-    // store reference to module for future OnRequest calls
-    last_module = req_map.at(cmd.which_command);
+      // store reference to module for future OnRequest calls
+      last_module = req_map.at(cmd.which_command);
 
-    // forward command to module
-    last_module->OnReceive(cmd);
+      // forward command to module
+      last_module->OnReceive(cmd);
+    }
 
     // reset buffer
     receive_buffer.len = 0;
@@ -155,8 +158,8 @@ void ModuleHandler::ModuleHandler::OnRequest(void) {
 
       // write finished flag
       Wire.write(1);
-      // write directly to i2c
-      Wire.write(request_buffer.data, request_buffer.len);
+      // write remaining bytes directly to i2c
+      Wire.write(request_buffer.data + request_buffer.idx, bytes_remaining);
 
       // reset to indicate flushed buffer
       request_buffer.len = 0;
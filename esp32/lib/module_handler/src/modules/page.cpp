@@ -0,0 +1,168 @@
+#include "modules/page.hpp"
+
+#include <ArduinoLog.h>
+
+ModulePage::ModulePage(uint8_t cs_pin) : cs_pin(cs_pin) {
+  // set module type
+  type = Esp32Command_page_command_tag;
+}
+
+ModulePage::~ModulePage(void) {
+  if (file) {
+    file.close();
+  }
+}
+
+void ModulePage::OnReceive(const Esp32Command &cmd) {
+  Log.traceln("ModulePage::OnReceive");
+
+  // check if page command
+  if (cmd.which_command != Esp32Command_page_command_tag) {
+    return;
+  }
+
+  const PageCommand &page_cmd = cmd.command.page_command;
+
+  Log.traceln("PageCommand file_request: %d, fd: %d", page_cmd.file_request,
+              page_cmd.file_descriptor);
+
+  // init return command
+  PageCommand resp = PageCommand_init_zero;
+  resp.file_request = page_cmd.file_request;
+  resp.file_descriptor = page_cmd.file_descriptor;
+
+  if (!Begin()) {
+    resp.rc = PAGE_NO_CARD;
+  } else {
+    // switch for command types
+    switch (page_cmd.file_request) {
+      case PageCommand_RequestType_OPEN:
+        Log.traceln("Calling OPEN");
+        Open(page_cmd, &resp);
+        break;
+
+      case PageCommand_RequestType_CLOSE:
+        Log.traceln("Calling CLOSE");
+        Close(page_cmd, &resp);
+        break;
+
+      case PageCommand_RequestType_WRITE:
+        Log.traceln("Calling WRITE");
+        Write(page_cmd, &resp);
+        break;
+
+      case PageCommand_RequestType_READ:
+        Log.traceln("Calling READ");
+        Read(page_cmd, &resp);
+        break;
+
+      case PageCommand_RequestType_DELETE:
+        Log.traceln("Calling DELETE");
+        Delete(page_cmd, &resp);
+        break;
+
+      default:
+        Log.warningln("page command type not found!");
+        break;
+    }
+  }
+
+  request_buffer_len =
+      EncodePageCommandMsg(&resp, request_buffer, sizeof(request_buffer));
+}
+
+size_t ModulePage::OnRequest(uint8_t *buffer) {
+  Log.traceln("ModulePage::OnRequest");
+  memcpy(buffer, request_buffer, request_buffer_len);
+  return request_buffer_len;
+}
+
+bool ModulePage::Begin(void) {
+  if (!sd_ready) {
+    sd_ready = SD.begin(cs_pin);
+    if (!sd_ready) {
+      Log.errorln("Failed to begin sd card!");
+    }
+  }
+
+  return sd_ready;
+}
+
+String ModulePage::Path(uint32_t fd) { return "/page_" + String(fd) + ".bin"; }
+
+void ModulePage::Open(const PageCommand &cmd, PageCommand *resp) {
+  // only a single file is kept open
+  if (file) {
+    if (file_fd == cmd.file_descriptor) {
+      return;
+    }
+    file.close();
+  }
+
+  file = SD.open(Path(cmd.file_descriptor), FILE_APPEND);
+  if (!file) {
+    Log.errorln("Error opening %s", Path(cmd.file_descriptor).c_str());
+    resp->rc = PAGE_FILE_ERROR;
+    return;
+  }
+
+  file_fd = cmd.file_descriptor;
+}
+
+void ModulePage::Close(const PageCommand &cmd, PageCommand *resp) {
+  if (file && file_fd == cmd.file_descriptor) {
+    file.close();
+  }
+}
+
+void ModulePage::Write(const PageCommand &cmd, PageCommand *resp) {
+  // open implicitly so writes do not depend on state lost in a reset
+  if (!file || file_fd != cmd.file_descriptor) {
+    Open(cmd, resp);
+    if (resp->rc != PAGE_OK) {
+      return;
+    }
+  }
+
+  size_t written = file.write(cmd.data.bytes, cmd.data.size);
+  // make bytes visible to reads of the same file
+  file.flush();
+
+  resp->num_bytes = written;
+  if (written != cmd.data.size) {
+    Log.errorln("Wrote %d of %d bytes", written, cmd.data.size);
+    resp->rc = PAGE_WRITE_ERROR;
+  }
+}
+
+void ModulePage::Read(const PageCommand &cmd, PageCommand *resp) {
+  File read_file = SD.open(Path(cmd.file_descriptor), FILE_READ);
+  if (!read_file) {
+    resp->rc = PAGE_FILE_ERROR;
+    return;
+  }
+
+  // limit to size of data field
+  size_t len = cmd.num_bytes;
+  if (len > sizeof(resp->data.bytes)) {
+    len = sizeof(resp->data.bytes);
+  }
+
+  // end of file returns no bytes
+  size_t n = 0;
+  if (read_file.seek(cmd.offset)) {
+    n = read_file.read(resp->data.bytes, len);
+  }
+  read_file.close();
+
+  resp->data.size = n;
+  resp->num_bytes = n;
+}
+
+void ModulePage::Delete(const PageCommand &cmd, PageCommand *resp) {
+  Close(cmd, resp);
+
+  if (!SD.remove(Path(cmd.file_descriptor))) {
+    resp->rc = PAGE_FILE_ERROR;
+  }
+}
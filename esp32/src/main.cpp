@@ -10,6 +10,7 @@
 #include <Wire.h>
 
 #include "module_handler.hpp"
+#include "modules/page.hpp"
 #include "modules/wifi.hpp"
 
 /** Target device address */
@@ -68,6 +69,10 @@ RESET!
   static ModuleWiFi wifi;
   mh.RegisterModule(&wifi);
 
+  // create and register the page module for the sd card
+  static ModulePage page;
+  mh.RegisterModule(&page);
+
   // start i2c interface
   Wire.onReceive(onReceive);
   Wire.onRequest(onRequest);
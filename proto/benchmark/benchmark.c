@@ -0,0 +1,419 @@
+/**
+ * @file benchmark.c
+ * @brief Native benchmark of the transcoder encode and decode functions
+ *
+ * Times the transcoder on the host across representative inputs and reports
+ * the time per operation, the serialized bytes per operation and the peak
+ * stack usage as JSON. Run with `make benchmark` from proto/.
+ *
+ * The stack usage is measured by running each operation once on a thread with
+ * a stack filled with a known pattern, then finding the deepest byte that was
+ * overwritten. The usage of an empty operation is subtracted to remove the
+ * overhead of the thread itself. Numbers are for the host compiler and
+ * architecture, so they are only comparable between runs on the same machine.
+ *
+ * @see transcoder.h
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "soil_power_sensor.pb.h"
+#include "transcoder.h"
+
+#ifndef BENCHMARK_COMMIT
+/** Commit the benchmark was built from, set by the Makefile */
+#define BENCHMARK_COMMIT "unknown"
+#endif /* BENCHMARK_COMMIT */
+
+#ifndef BENCHMARK_MIN_NS
+/** Minimum duration of a single timed run */
+#define BENCHMARK_MIN_NS 50000000ULL
+#endif /* BENCHMARK_MIN_NS */
+
+#ifndef BENCHMARK_RUNS
+/** Number of timed runs, the fastest is reported */
+#define BENCHMARK_RUNS 5
+#endif /* BENCHMARK_RUNS */
+
+/** Size of the painted stack used to measure stack usage */
+#define STACK_SIZE (64 * 1024)
+
+/** Pattern the stack is filled with */
+#define STACK_PATTERN 0xA5
+
+/** Size of the output buffers */
+#define BUFFER_SIZE 512
+
+/**
+ * @brief Operation under test
+ *
+ * @param arg Benchmark case
+ * @return Number of serialized bytes produced or consumed
+ */
+typedef size_t (*BenchmarkOp)(const void *arg);
+
+/** Single benchmark case */
+typedef struct {
+  /** Name of the benchmarked function */
+  const char *name;
+  /** Description of the input */
+  const char *input;
+  /** Operation to run */
+  BenchmarkOp op;
+  /** Argument passed to the operation */
+  const void *arg;
+} Benchmark;
+
+/** Result of a benchmark case */
+typedef struct {
+  /** Number of operations in the fastest run */
+  uint64_t iterations;
+  /** Nanoseconds per operation */
+  double ns_per_op;
+  /** Serialized bytes per operation */
+  size_t bytes_per_op;
+  /** Peak stack usage in bytes */
+  size_t peak_stack;
+} BenchmarkResult;
+
+/** Arguments for EncodePowerMeasurement */
+typedef struct {
+  uint32_t ts;
+  uint32_t logger_id;
+  uint32_t cell_id;
+  double voltage;
+  double current;
+} PowerArgs;
+
+/** Arguments for EncodeTeros12Measurement */
+typedef struct {
+  uint32_t ts;
+  uint32_t logger_id;
+  uint32_t cell_id;
+  double vwc_raw;
+  double vwc_adj;
+  double temp;
+  uint32_t ec;
+} Teros12Args;
+
+/** Serialized message passed to the decode functions */
+typedef struct {
+  uint8_t data[BUFFER_SIZE];
+  size_t len;
+} Encoded;
+
+/** Sink for results so the operations are not optimized out */
+static volatile size_t sink;
+
+/** Output of the encode functions, kept off the stack of the operations */
+static uint8_t output[BUFFER_SIZE];
+
+/**
+ * @brief Current time of the monotonic clock
+ *
+ * @return Time in nanoseconds
+ */
+static uint64_t NowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t OpNone(const void *arg) {
+  (void)arg;
+  return 0;
+}
+
+static size_t OpEncodePower(const void *arg) {
+  const PowerArgs *a = arg;
+  size_t len = EncodePowerMeasurement(a->ts, a->logger_id, a->cell_id,
+                                      a->voltage, a->current, output);
+  sink = output[0];
+  return len;
+}
+
+static size_t OpEncodeTeros12(const void *arg) {
+  const Teros12Args *a = arg;
+  size_t len =
+      EncodeTeros12Measurement(a->ts, a->logger_id, a->cell_id, a->vwc_raw,
+                               a->vwc_adj, a->temp, a->ec, output);
+  sink = output[0];
+  return len;
+}
+
+static size_t OpDecodeEsp32Command(const void *arg) {
+  const Encoded *e = arg;
+  Esp32Command cmd;
+  if (DecodeEsp32Command(e->data, e->len, &cmd) != 0) {
+    return 0;
+  }
+  sink = cmd.which_command;
+  return e->len;
+}
+
+static size_t OpEncodeWiFiCommand(const void *arg) {
+  const WiFiCommand *cmd = arg;
+  size_t len = EncodeWiFiCommand(cmd, output, sizeof(output));
+  sink = output[0];
+  return len;
+}
+
+static size_t OpDecodeUserConfiguration(const void *arg) {
+  const Encoded *e = arg;
+  UserConfiguration config;
+  if (DecodeUserConfiguration(e->data, e->len, &config) != 0) {
+    return 0;
+  }
+  sink = config.logger_id;
+  return e->len;
+}
+
+/** Power measurement with small values */
+static const PowerArgs power_small = {
+    .ts = 1701055519, .logger_id = 1, .cell_id = 1, .voltage = 1.2,
+    .current = 0.5};
+
+/** Power measurement with large values and ids */
+static const PowerArgs power_large = {.ts = 1701055519,
+                                      .logger_id = 0xFFFFFFFF,
+                                      .cell_id = 0xFFFFFFFF,
+                                      .voltage = 3300.123,
+                                      .current = -120000.5};
+
+/** Teros12 measurement with typical values */
+static const Teros12Args teros12_typical = {
+    .ts = 1701055519, .logger_id = 1, .cell_id = 1, .vwc_raw = 2070.0,
+    .vwc_adj = 0.34, .temp = 21.3, .ec = 12};
+
+/** Teros12 measurement with large ids and conductivity */
+static const Teros12Args teros12_large = {.ts = 1701055519,
+                                          .logger_id = 0xFFFFFFFF,
+                                          .cell_id = 0xFFFFFFFF,
+                                          .vwc_raw = 3500.5,
+                                          .vwc_adj = 0.99,
+                                          .temp = -40.0,
+                                          .ec = 0xFFFFFFFF};
+
+/** WiFi connect command */
+static WiFiCommand wifi_connect;
+/** WiFi POST command with a full response */
+static WiFiCommand wifi_post;
+
+/** Serialized Esp32Command messages */
+static Encoded esp32_test, esp32_connect, esp32_post;
+/** Serialized UserConfiguration messages */
+static Encoded config_minimal, config_full;
+
+/**
+ * @brief Fills the inputs of the benchmarks
+ */
+static void SetupInputs(void) {
+  wifi_connect = (WiFiCommand)WiFiCommand_init_zero;
+  wifi_connect.type = WiFiCommand_Type_CONNECT;
+  strcpy(wifi_connect.ssid, "HelloWorld");
+  strcpy(wifi_connect.passwd, "correct horse battery staple");
+
+  wifi_post = (WiFiCommand)WiFiCommand_init_zero;
+  wifi_post.type = WiFiCommand_Type_POST;
+  strcpy(wifi_post.url, "https://dirtviz.jlab.ucsc.edu/api/sensor/");
+  wifi_post.port = 443;
+  wifi_post.rc = 200;
+  wifi_post.ts = 1701055519;
+  wifi_post.resp.size = sizeof(wifi_post.resp.bytes);
+  for (size_t i = 0; i < wifi_post.resp.size; i++) {
+    wifi_post.resp.bytes[i] = (uint8_t)i;
+  }
+
+  esp32_test.len = EncodeTestCommand(TestCommand_ChangeState_RECEIVE, 42,
+                                     esp32_test.data, sizeof(esp32_test.data));
+  esp32_connect.len = EncodeWiFiCommand(&wifi_connect, esp32_connect.data,
+                                        sizeof(esp32_connect.data));
+  esp32_post.len =
+      EncodeWiFiCommand(&wifi_post, esp32_post.data, sizeof(esp32_post.data));
+
+  UserConfiguration config = UserConfiguration_init_zero;
+  config.logger_id = 1;
+  config.cell_id = 1;
+  config_minimal.len = EncodeUserConfiguration(&config, config_minimal.data);
+
+  config.logger_id = 200;
+  config.cell_id = 300;
+  config.Upload_method = Uploadmethod_WiFi;
+  config.Upload_interval = 3600;
+  config.enabled_sensors_count = 5;
+  for (size_t i = 0; i < config.enabled_sensors_count; i++) {
+    config.enabled_sensors[i] = (EnabledSensor)i;
+  }
+  config.Voltage_Slope = 1.05;
+  config.Voltage_Offset = -0.02;
+  config.Current_Slope = 0.98;
+  config.Current_Offset = 0.01;
+  strcpy(config.WiFi_SSID, "HelloWorld");
+  strcpy(config.WiFi_Password, "correct horse battery staple");
+  strcpy(config.API_Endpoint_URL, "https://dirtviz.jlab.ucsc.edu/api/");
+  config.API_Endpoint_Port = 443;
+  config_full.len = EncodeUserConfiguration(&config, config_full.data);
+}
+
+/** Benchmarks to run */
+static const Benchmark benchmarks[] = {
+    {"EncodePowerMeasurement", "small", OpEncodePower, &power_small},
+    {"EncodePowerMeasurement", "large", OpEncodePower, &power_large},
+    {"EncodeTeros12Measurement", "typical", OpEncodeTeros12,
+     &teros12_typical},
+    {"EncodeTeros12Measurement", "large", OpEncodeTeros12, &teros12_large},
+    {"DecodeEsp32Command", "test_command", OpDecodeEsp32Command, &esp32_test},
+    {"DecodeEsp32Command", "wifi_connect", OpDecodeEsp32Command,
+     &esp32_connect},
+    {"DecodeEsp32Command", "wifi_post", OpDecodeEsp32Command, &esp32_post},
+    {"EncodeWiFiCommand", "connect", OpEncodeWiFiCommand, &wifi_connect},
+    {"EncodeWiFiCommand", "post", OpEncodeWiFiCommand, &wifi_post},
+    {"DecodeUserConfiguration", "minimal", OpDecodeUserConfiguration,
+     &config_minimal},
+    {"DecodeUserConfiguration", "full", OpDecodeUserConfiguration,
+     &config_full},
+};
+
+/**
+ * @brief Runs an operation once on the painted stack
+ *
+ * @param arg Benchmark to run
+ * @return NULL
+ */
+static void *StackThread(void *arg) {
+  const Benchmark *bench = arg;
+  sink = bench->op(bench->arg);
+  return NULL;
+}
+
+/**
+ * @brief Measures the stack used by an operation
+ *
+ * @param bench Benchmark to measure
+ * @return Bytes of stack used, 0 on error
+ */
+static size_t MeasureStack(const Benchmark *bench) {
+  void *stack = NULL;
+  if (posix_memalign(&stack, (size_t)sysconf(_SC_PAGESIZE), STACK_SIZE) != 0) {
+    return 0;
+  }
+  memset(stack, STACK_PATTERN, STACK_SIZE);
+
+  pthread_attr_t attr;
+  pthread_t thread;
+  size_t used = 0;
+  pthread_attr_init(&attr);
+  if (pthread_attr_setstack(&attr, stack, STACK_SIZE) == 0 &&
+      pthread_create(&thread, &attr, StackThread, (void *)bench) == 0) {
+    pthread_join(thread, NULL);
+
+    // the stack grows down, find the lowest overwritten byte
+    const uint8_t *bytes = stack;
+    size_t i = 0;
+    while (i < STACK_SIZE && bytes[i] == STACK_PATTERN) {
+      i++;
+    }
+    used = STACK_SIZE - i;
+  }
+  pthread_attr_destroy(&attr);
+  free(stack);
+
+  return used;
+}
+
+/**
+ * @brief Runs a benchmark
+ *
+ * The number of iterations is doubled until a run takes at least
+ * BENCHMARK_MIN_NS, then BENCHMARK_RUNS runs are timed and the fastest is
+ * kept.
+ *
+ * @param bench Benchmark to run
+ * @param stack_overhead Stack used by an empty operation
+ * @return Result of the benchmark
+ */
+static BenchmarkResult RunBenchmark(const Benchmark *bench,
+                                    size_t stack_overhead) {
+  BenchmarkResult result = {0};
+
+  result.bytes_per_op = bench->op(bench->arg);
+
+  uint64_t iterations = 1;
+  uint64_t elapsed = 0;
+  do {
+    iterations *= 2;
+    uint64_t start = NowNs();
+    for (uint64_t i = 0; i < iterations; i++) {
+      sink = bench->op(bench->arg);
+    }
+    elapsed = NowNs() - start;
+  } while (elapsed < BENCHMARK_MIN_NS);
+
+  result.iterations = iterations;
+  result.ns_per_op = (double)elapsed / (double)iterations;
+  for (int run = 1; run < BENCHMARK_RUNS; run++) {
+    uint64_t start = NowNs();
+    for (uint64_t i = 0; i < iterations; i++) {
+      sink = bench->op(bench->arg);
+    }
+    double ns_per_op = (double)(NowNs() - start) / (double)iterations;
+    if (ns_per_op < result.ns_per_op) {
+      result.ns_per_op = ns_per_op;
+    }
+  }
+
+  size_t stack = MeasureStack(bench);
+  result.peak_stack = stack > stack_overhead ? stack - stack_overhead : 0;
+
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  FILE *out = stdout;
+  if (argc > 1) {
+    out = fopen(argv[1], "w");
+    if (out == NULL) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  SetupInputs();
+
+  const Benchmark none = {"None", "", OpNone, NULL};
+  size_t stack_overhead = MeasureStack(&none);
+
+  const size_t num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+  fprintf(out, "{\n");
+  fprintf(out, "  \"commit\": \"%s\",\n", BENCHMARK_COMMIT);
+  fprintf(out, "  \"compiler\": \"%s\",\n", __VERSION__);
+  fprintf(out, "  \"benchmarks\": [\n");
+  for (size_t i = 0; i < num_benchmarks; i++) {
+    const Benchmark *bench = &benchmarks[i];
+    BenchmarkResult result = RunBenchmark(bench, stack_overhead);
+
+    fprintf(out,
+            "    {\"name\": \"%s\", \"input\": \"%s\", \"iterations\": %llu, "
+            "\"ns_per_op\": %.2f, \"bytes_per_op\": %zu, "
+            "\"peak_stack_bytes\": %zu}%s\n",
+            bench->name, bench->input, (unsigned long long)result.iterations,
+            result.ns_per_op, result.bytes_per_op, result.peak_stack,
+            i + 1 < num_benchmarks ? "," : "");
+  }
+  fprintf(out, "  ]\n");
+  fprintf(out, "}\n");
+
+  if (out != stdout) {
+    fclose(out);
+  }
+
+  return 0;
+}
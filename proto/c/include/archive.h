@@ -0,0 +1,203 @@
+/**
+ * @file archive.h
+ *
+ * @brief Reader for indexed archives of measurements
+ *
+ * @see archive.c
+ * @see test_archive.c
+ *
+ * @author John Madden <jmadden173@pm.me>
+ * @date 2026-10-16
+ */
+
+#ifndef PROTO_C_INCLUDE_ARCHIVE_H_
+#define PROTO_C_INCLUDE_ARCHIVE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "soil_power_sensor.pb.h"
+
+/**
+ * @ingroup proto
+ * @defgroup protoArchive Archive
+ * @brief Reader for indexed archives of measurements
+ *
+ * Archives store measurements in blocks followed by an index of the blocks,
+ * and are written by ents.proto.ArchiveWriter in the python package. Each
+ * block holds length-delimited Measurement messages of a single logger and
+ * cell. The index stores the logger, cell, timestamp range and location of
+ * each block, so a query only reads the blocks that can match.
+ *
+ * All integers are little-endian.
+ *
+ * @verbatim
+ * header:  | magic "ENTSARC" | version (u8) |
+ * blocks:  | varint length | Measurement | ... |
+ * index:   | logger_id (u32) | cell_id (u32) | ts_min (u32) | ts_max (u32) |
+ *          | offset (u64) | length (u32) | count (u32) | ...
+ * trailer: | index offset (u64) | number of blocks (u32) | magic "EIDX" |
+ * @endverbatim
+ *
+ * The archive is read through a callback, so it can be stored in a file, on
+ * an sd card or in memory.
+ *
+ * @{
+ */
+
+/** Magic number and version at the start of an archive */
+#define ARCHIVE_MAGIC "ENTSARC\x01"
+
+/** Number of bytes of the header */
+#define ARCHIVE_HEADER_SIZE 8
+
+/** Magic number at the end of the trailer */
+#define ARCHIVE_INDEX_MAGIC "EIDX"
+
+/** Number of bytes of an index entry */
+#define ARCHIVE_ENTRY_SIZE 32
+
+/** Number of bytes of the trailer */
+#define ARCHIVE_TRAILER_SIZE 16
+
+/**
+ * @brief Reads bytes of an archive
+ *
+ * @param ctx Context passed to ArchiveOpen()
+ * @param offset Offset in the archive
+ * @param data Buffer for the bytes
+ * @param len Number of bytes to read
+ * @return true on success, false on error
+ */
+typedef bool (*ArchiveReadFunc)(void *ctx, uint64_t offset, uint8_t *data,
+                                size_t len);
+
+/**
+ * @brief Open archive
+ */
+typedef struct {
+  /** Reads bytes of the archive */
+  ArchiveReadFunc read;
+  /** Context of read */
+  void *ctx;
+  /** Offset of the index */
+  uint64_t index_offset;
+  /** Number of blocks */
+  uint32_t num_blocks;
+} Archive;
+
+/**
+ * @brief Index entry of a block
+ */
+typedef struct {
+  /** Logger of the measurements */
+  uint32_t logger_id;
+  /** Cell of the measurements */
+  uint32_t cell_id;
+  /** Earliest timestamp */
+  uint32_t ts_min;
+  /** Latest timestamp */
+  uint32_t ts_max;
+  /** Offset of the block in the archive */
+  uint64_t offset;
+  /** Number of bytes of the block */
+  uint32_t len;
+  /** Number of measurements of the block */
+  uint32_t count;
+} ArchiveBlock;
+
+/**
+ * @brief Measurements to match
+ *
+ * Timestamps are matched from start to end, inclusive. Use 0 and UINT32_MAX to
+ * match all.
+ */
+typedef struct {
+  /** Only match logger_id */
+  bool has_logger_id;
+  /** Logger to match */
+  uint32_t logger_id;
+  /** Only match cell_id */
+  bool has_cell_id;
+  /** Cell to match */
+  uint32_t cell_id;
+  /** Earliest timestamp to match */
+  uint32_t start;
+  /** Latest timestamp to match */
+  uint32_t end;
+} ArchiveQuery;
+
+/**
+ * @brief Called for each matching measurement
+ *
+ * @param meas Decoded measurement, values as with DecodeMeasurement()
+ * @param arg Argument passed to ArchiveRead()
+ * @return true to continue, false to stop the query
+ */
+typedef bool (*ArchiveCallback)(const Measurement *meas, void *arg);
+
+/**
+ * @brief Opens an archive by reading its header and trailer
+ *
+ * @param archive Archive to open
+ * @param read Reads bytes of the archive
+ * @param ctx Context of read
+ * @param size Number of bytes of the archive
+ * @return 0 on success, -1 if the archive can not be read or is missing its
+ * index
+ */
+int ArchiveOpen(Archive *archive, ArchiveReadFunc read, void *ctx,
+                uint64_t size);
+
+/**
+ * @brief Reads the index entry of a block
+ *
+ * @param archive Open archive
+ * @param i Index of the block
+ * @param block Index entry
+ * @return 0 on success, -1 if out of range or the archive can not be read
+ */
+int ArchiveGetBlock(const Archive *archive, uint32_t i, ArchiveBlock *block);
+
+/**
+ * @brief Checks if a block may hold matching measurements
+ *
+ * @param block Index entry of the block
+ * @param query Measurements to match
+ * @return true if the block may match, false if it does not
+ */
+bool ArchiveBlockMatches(const ArchiveBlock *block, const ArchiveQuery *query);
+
+/**
+ * @brief Reads matching measurements
+ *
+ * Only blocks with a matching index entry are read. Measurements are passed
+ * to @p cb in the order they were written for each logger and cell.
+ *
+ * @param archive Open archive
+ * @param query Measurements to match
+ * @param buffer Buffer for a block, blocks are around the block size of the
+ * writer
+ * @param size Size of buffer
+ * @param cb Called for each matching measurement
+ * @param arg Argument passed to cb
+ * @return Number of matching measurements, -1 if a block can not be read or
+ * decoded, or does not fit in @p buffer
+ */
+int ArchiveRead(const Archive *archive, const ArchiveQuery *query,
+                uint8_t *buffer, size_t size, ArchiveCallback cb, void *arg);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PROTO_C_INCLUDE_ARCHIVE_H_
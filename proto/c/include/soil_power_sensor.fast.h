@@ -0,0 +1,33 @@
+/* Automatically generated by generate_fast_encoders.py */
+
+#ifndef PB_SOIL_POWER_SENSOR_FAST_H_INCLUDED
+#define PB_SOIL_POWER_SENSOR_FAST_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pb_encode.h"
+#include "soil_power_sensor.pb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of bytes of the encoded message, same as pb_get_encoded_size() */
+size_t Measurement_fast_encoded_size(const Measurement *msg);
+
+/* Encodes a message with the same output as pb_encode(). Returns false if the
+ * message does not fit in size bytes. */
+bool Measurement_fast_encode(const Measurement *msg, uint8_t *buffer,
+                             size_t size, size_t *len);
+
+/* Encodes a message to a stream with the same output as pb_encode(), without
+ * an intermediate buffer. Returns false if the stream fails. */
+bool Measurement_fast_encode_stream(const Measurement *msg, pb_ostream_t *stream);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
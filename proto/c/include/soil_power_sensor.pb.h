@@ -36,7 +36,8 @@ typedef enum _PageCommand_RequestType {
     PageCommand_RequestType_OPEN = 0,
     PageCommand_RequestType_CLOSE = 1,
     PageCommand_RequestType_READ = 2,
-    PageCommand_RequestType_WRITE = 3
+    PageCommand_RequestType_WRITE = 3,
+    PageCommand_RequestType_DELETE = 4
 } PageCommand_RequestType;
 
 typedef enum _TestCommand_ChangeState {
@@ -79,39 +80,60 @@ typedef struct _MeasurementMetadata {
 } MeasurementMetadata;
 
 /* Power measurement message. Voltage and current can be digitially combined to
- obtain power. */
+ obtain power.
+
+ Values were sent as double before they were sent as float. The double fields
+ are kept to decode old measurements. */
 typedef struct _PowerMeasurement {
+    /* voltage, deprecated */
+    double voltage_double;
+    /* current, deprecated */
+    double current_double;
     /* voltage */
-    double voltage;
+    float voltage;
     /* current */
-    double current;
+    float current;
 } PowerMeasurement;
 
 /* Teros12 measurement message */
 typedef struct _Teros12Measurement {
+    /* raw volumetric water content, deprecated */
+    double vwc_raw_double;
+    /* calibrated volumetric water content, deprecated */
+    double vwc_adj_double;
+    /* temperature in celcious, deprecated */
+    double temp_double;
+    /* electrical conductivity */
+    uint32_t ec;
     /* raw volumetric water content */
-    double vwc_raw;
+    float vwc_raw;
     /* calibrated volumetric water content */
-    double vwc_adj;
+    float vwc_adj;
     /* temperature in celcious */
-    double temp;
-    /* electrical conductivity */
-    uint32_t ec;
+    float temp;
 } Teros12Measurement;
 
 typedef struct _Teros21Measurement {
+    /* Matric potential of soil in kPa, deprecated */
+    double matric_pot_double;
+    /* temperature in celcius, deprecated */
+    double temp_double;
     /* Matric potential of soil in kPa */
-    double matric_pot;
+    float matric_pot;
     /* temperature in celcius */
-    double temp;
+    float temp;
 } Teros21Measurement;
 
 /* Phytos measurement */
 typedef struct _Phytos31Measurement {
+    /* raw adc voltage, deprecated */
+    double voltage_double;
+    /* calibrated leaf wetness, deprecated */
+    double leaf_wetness_double;
     /* raw adc voltage */
-    double voltage;
+    float voltage;
     /* calibrated leaf wetness */
-    double leaf_wetness;
+    float leaf_wetness;
 } Phytos31Measurement;
 
 typedef struct _BME280Measurement {
@@ -123,6 +145,53 @@ typedef struct _BME280Measurement {
     uint32_t humidity;
 } BME280Measurement;
 
+/* Summary of the power samples of one measurement window. Oversampled power
+ is sent as statistics of the calibrated samples instead of the samples
+ themselves. */
+typedef struct _PowerSummary {
+    /* number of samples of each channel */
+    uint32_t count;
+    /* mean voltage */
+    float voltage_mean;
+    /* minimum voltage */
+    float voltage_min;
+    /* maximum voltage */
+    float voltage_max;
+    /* sample standard deviation of voltage */
+    float voltage_stddev;
+    /* mean current */
+    float current_mean;
+    /* minimum current */
+    float current_min;
+    /* maximum current */
+    float current_max;
+    /* sample standard deviation of current */
+    float current_stddev;
+} PowerSummary;
+
+typedef PB_BYTES_ARRAY_T(64) PowerBurst_samples_t;
+/* Block of raw samples of a power burst. Bursts capture a single channel at a
+ high data rate and are split into blocks that fit an uplink. Samples are the
+ raw codes of the adc, the first sample of a block as a zigzag varint and the
+ following ones as zigzag varints of the difference to the previous sample,
+ so every block decodes on its own. */
+typedef struct _PowerBurst {
+    /* number of the burst, increments with every capture */
+    uint32_t burst_id;
+    /* samples are current if set, otherwise voltage */
+    bool current;
+    /* data rate in samples per second */
+    uint32_t rate;
+    /* index of the first sample of the block within the burst */
+    uint32_t offset;
+    /* number of samples of the burst */
+    uint32_t total;
+    /* number of conversions missed during the burst */
+    uint32_t dropped;
+    /* compressed samples */
+    PowerBurst_samples_t samples;
+} PowerBurst;
+
 /* Top level measurement message */
 typedef struct _Measurement {
     /* Metadata */
@@ -135,15 +204,102 @@ typedef struct _Measurement {
         Phytos31Measurement phytos31;
         BME280Measurement bme280;
         Teros21Measurement teros21;
+        PowerSummary power_summary;
+        PowerBurst power_burst;
     } measurement;
 } Measurement;
 
+/* Batch of power measurements, one entry per sample */
+typedef struct _PowerBatch {
+    /* voltage */
+    pb_size_t voltage_count;
+    float voltage[32];
+    /* current */
+    pb_size_t current_count;
+    float current[32];
+} PowerBatch;
+
+/* Batch of Teros12 measurements, one entry per sample */
+typedef struct _Teros12Batch {
+    /* raw volumetric water content */
+    pb_size_t vwc_raw_count;
+    float vwc_raw[32];
+    /* calibrated volumetric water content */
+    pb_size_t vwc_adj_count;
+    float vwc_adj[32];
+    /* temperature in celcius */
+    pb_size_t temp_count;
+    float temp[32];
+    /* electrical conductivity */
+    pb_size_t ec_count;
+    uint32_t ec[32];
+} Teros12Batch;
+
+/* Batch of Teros21 measurements, one entry per sample */
+typedef struct _Teros21Batch {
+    /* Matric potential of soil in kPa */
+    pb_size_t matric_pot_count;
+    float matric_pot[32];
+    /* temperature in celcius */
+    pb_size_t temp_count;
+    float temp[32];
+} Teros21Batch;
+
+/* Batch of Phytos31 measurements, one entry per sample */
+typedef struct _Phytos31Batch {
+    /* raw adc voltage */
+    pb_size_t voltage_count;
+    float voltage[32];
+    /* calibrated leaf wetness */
+    pb_size_t leaf_wetness_count;
+    float leaf_wetness[32];
+} Phytos31Batch;
+
+/* Batch of BME280 measurements, one entry per sample */
+typedef struct _BME280Batch {
+    /* pressure */
+    pb_size_t pressure_count;
+    uint32_t pressure[32];
+    /* temperature */
+    pb_size_t temperature_count;
+    int32_t temperature[32];
+    /* humidity */
+    pb_size_t humidity_count;
+    uint32_t humidity[32];
+} BME280Batch;
+
+/* Compact batch of measurements of one type from one cell and logger.
+
+ The metadata is sent once for the whole batch, with ts being the timestamp
+ of the first sample. Samples are stored column wise in packed repeated
+ fields, so the i-th entry of every field belongs to the i-th sample. Values
+ are sent as float rather than double, which is enough for the precision of
+ the sensors. */
+typedef struct _MeasurementBatch {
+    /* Metadata shared by all samples */
+    bool has_meta;
+    MeasurementMetadata meta;
+    /* Timestamp of each sample minus the timestamp of the previous sample, the
+ first entry is relative to meta.ts */
+    pb_size_t ts_delta_count;
+    int32_t ts_delta[32];
+    pb_size_t which_batch;
+    union {
+        PowerBatch power;
+        Teros12Batch teros12;
+        Phytos31Batch phytos31;
+        BME280Batch bme280;
+        Teros21Batch teros21;
+    } batch;
+} MeasurementBatch;
+
 /* Acknowledge Packet */
 typedef struct _Response {
     /* Response from server */
     Response_ResponseType resp;
 } Response;
 
+typedef PB_BYTES_ARRAY_T(256) PageCommand_data_t;
 typedef struct _PageCommand {
     /* File request type */
     PageCommand_RequestType file_request;
@@ -153,6 +309,12 @@ typedef struct _PageCommand {
     uint32_t block_size;
     /* Number of bytes */
     uint32_t num_bytes;
+    /* Bytes written to or read from the file */
+    PageCommand_data_t data;
+    /* Offset into the file to read from */
+    uint32_t offset;
+    /* Return code, 0 on success */
+    uint32_t rc;
 } PageCommand;
 
 typedef struct _TestCommand {
@@ -230,8 +392,8 @@ extern "C" {
 #define _Response_ResponseType_ARRAYSIZE ((Response_ResponseType)(Response_ResponseType_ERROR+1))
 
 #define _PageCommand_RequestType_MIN PageCommand_RequestType_OPEN
-#define _PageCommand_RequestType_MAX PageCommand_RequestType_WRITE
-#define _PageCommand_RequestType_ARRAYSIZE ((PageCommand_RequestType)(PageCommand_RequestType_WRITE+1))
+#define _PageCommand_RequestType_MAX PageCommand_RequestType_DELETE
+#define _PageCommand_RequestType_ARRAYSIZE ((PageCommand_RequestType)(PageCommand_RequestType_DELETE+1))
 
 #define _TestCommand_ChangeState_MIN TestCommand_ChangeState_RECEIVE
 #define _TestCommand_ChangeState_MAX TestCommand_ChangeState_REQUEST
@@ -248,6 +410,14 @@ extern "C" {
 
 
 
+
+
+
+
+
+
+
+
 #define Response_resp_ENUMTYPE Response_ResponseType
 
 
@@ -263,28 +433,44 @@ extern "C" {
 
 /* Initializer values for message structs */
 #define MeasurementMetadata_init_default         {0, 0, 0}
-#define PowerMeasurement_init_default            {0, 0}
-#define Teros12Measurement_init_default          {0, 0, 0, 0}
-#define Teros21Measurement_init_default          {0, 0}
-#define Phytos31Measurement_init_default         {0, 0}
+#define PowerMeasurement_init_default            {0, 0, 0, 0}
+#define Teros12Measurement_init_default          {0, 0, 0, 0, 0, 0, 0}
+#define Teros21Measurement_init_default          {0, 0, 0, 0}
+#define Phytos31Measurement_init_default         {0, 0, 0, 0}
 #define BME280Measurement_init_default           {0, 0, 0}
+#define PowerSummary_init_default                {0, 0, 0, 0, 0, 0, 0, 0, 0}
+#define PowerBurst_init_default                  {0, 0, 0, 0, 0, 0, {0, {0}}}
 #define Measurement_init_default                 {false, MeasurementMetadata_init_default, 0, {PowerMeasurement_init_default}}
+#define PowerBatch_init_default                  {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define Teros12Batch_init_default                {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define Teros21Batch_init_default                {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define Phytos31Batch_init_default               {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define BME280Batch_init_default                 {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define MeasurementBatch_init_default            {false, MeasurementMetadata_init_default, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {PowerBatch_init_default}}
 #define Response_init_default                    {_Response_ResponseType_MIN}
 #define Esp32Command_init_default                {0, {PageCommand_init_default}}
-#define PageCommand_init_default                 {_PageCommand_RequestType_MIN, 0, 0, 0}
+#define PageCommand_init_default                 {_PageCommand_RequestType_MIN, 0, 0, 0, {0, {0}}, 0, 0}
 #define TestCommand_init_default                 {_TestCommand_ChangeState_MIN, 0}
 #define WiFiCommand_init_default                 {_WiFiCommand_Type_MIN, "", "", "", 0, 0, {0, {0}}, 0}
 #define UserConfiguration_init_default           {0, 0, _Uploadmethod_MIN, 0, 0, {_EnabledSensor_MIN, _EnabledSensor_MIN, _EnabledSensor_MIN, _EnabledSensor_MIN, _EnabledSensor_MIN}, 0, 0, 0, 0, "", "", "", 0}
 #define MeasurementMetadata_init_zero            {0, 0, 0}
-#define PowerMeasurement_init_zero               {0, 0}
-#define Teros12Measurement_init_zero             {0, 0, 0, 0}
-#define Teros21Measurement_init_zero             {0, 0}
-#define Phytos31Measurement_init_zero            {0, 0}
+#define PowerMeasurement_init_zero               {0, 0, 0, 0}
+#define Teros12Measurement_init_zero             {0, 0, 0, 0, 0, 0, 0}
+#define Teros21Measurement_init_zero             {0, 0, 0, 0}
+#define Phytos31Measurement_init_zero            {0, 0, 0, 0}
 #define BME280Measurement_init_zero              {0, 0, 0}
+#define PowerSummary_init_zero                   {0, 0, 0, 0, 0, 0, 0, 0, 0}
+#define PowerBurst_init_zero                     {0, 0, 0, 0, 0, 0, {0, {0}}}
 #define Measurement_init_zero                    {false, MeasurementMetadata_init_zero, 0, {PowerMeasurement_init_zero}}
+#define PowerBatch_init_zero                     {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define Teros12Batch_init_zero                   {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define Teros21Batch_init_zero                   {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define Phytos31Batch_init_zero                  {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define BME280Batch_init_zero                    {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}}
+#define MeasurementBatch_init_zero               {false, MeasurementMetadata_init_zero, 0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0, {PowerBatch_init_zero}}
 #define Response_init_zero                       {_Response_ResponseType_MIN}
 #define Esp32Command_init_zero                   {0, {PageCommand_init_zero}}
-#define PageCommand_init_zero                    {_PageCommand_RequestType_MIN, 0, 0, 0}
+#define PageCommand_init_zero                    {_PageCommand_RequestType_MIN, 0, 0, 0, {0, {0}}, 0, 0}
 #define TestCommand_init_zero                    {_TestCommand_ChangeState_MIN, 0}
 #define WiFiCommand_init_zero                    {_WiFiCommand_Type_MIN, "", "", "", 0, 0, {0, {0}}, 0}
 #define UserConfiguration_init_zero              {0, 0, _Uploadmethod_MIN, 0, 0, {_EnabledSensor_MIN, _EnabledSensor_MIN, _EnabledSensor_MIN, _EnabledSensor_MIN, _EnabledSensor_MIN}, 0, 0, 0, 0, "", "", "", 0}
@@ -293,30 +479,80 @@ extern "C" {
 #define MeasurementMetadata_cell_id_tag          1
 #define MeasurementMetadata_logger_id_tag        2
 #define MeasurementMetadata_ts_tag               3
-#define PowerMeasurement_voltage_tag             2
-#define PowerMeasurement_current_tag             3
-#define Teros12Measurement_vwc_raw_tag           2
-#define Teros12Measurement_vwc_adj_tag           3
-#define Teros12Measurement_temp_tag              4
+#define PowerMeasurement_voltage_double_tag      2
+#define PowerMeasurement_current_double_tag      3
+#define PowerMeasurement_voltage_tag             4
+#define PowerMeasurement_current_tag             5
+#define Teros12Measurement_vwc_raw_double_tag    2
+#define Teros12Measurement_vwc_adj_double_tag    3
+#define Teros12Measurement_temp_double_tag       4
 #define Teros12Measurement_ec_tag                5
-#define Teros21Measurement_matric_pot_tag        1
-#define Teros21Measurement_temp_tag              2
-#define Phytos31Measurement_voltage_tag          1
-#define Phytos31Measurement_leaf_wetness_tag     2
+#define Teros12Measurement_vwc_raw_tag           6
+#define Teros12Measurement_vwc_adj_tag           7
+#define Teros12Measurement_temp_tag              8
+#define Teros21Measurement_matric_pot_double_tag 1
+#define Teros21Measurement_temp_double_tag       2
+#define Teros21Measurement_matric_pot_tag        3
+#define Teros21Measurement_temp_tag              4
+#define Phytos31Measurement_voltage_double_tag   1
+#define Phytos31Measurement_leaf_wetness_double_tag 2
+#define Phytos31Measurement_voltage_tag          3
+#define Phytos31Measurement_leaf_wetness_tag     4
 #define BME280Measurement_pressure_tag           1
 #define BME280Measurement_temperature_tag        2
 #define BME280Measurement_humidity_tag           3
+#define PowerSummary_count_tag                   1
+#define PowerSummary_voltage_mean_tag            2
+#define PowerSummary_voltage_min_tag             3
+#define PowerSummary_voltage_max_tag             4
+#define PowerSummary_voltage_stddev_tag          5
+#define PowerSummary_current_mean_tag            6
+#define PowerSummary_current_min_tag             7
+#define PowerSummary_current_max_tag             8
+#define PowerSummary_current_stddev_tag          9
+#define PowerBurst_burst_id_tag                  1
+#define PowerBurst_current_tag                   2
+#define PowerBurst_rate_tag                      3
+#define PowerBurst_offset_tag                    4
+#define PowerBurst_total_tag                     5
+#define PowerBurst_dropped_tag                   6
+#define PowerBurst_samples_tag                   7
 #define Measurement_meta_tag                     1
 #define Measurement_power_tag                    2
 #define Measurement_teros12_tag                  3
 #define Measurement_phytos31_tag                 4
 #define Measurement_bme280_tag                   5
 #define Measurement_teros21_tag                  6
+#define Measurement_power_summary_tag            7
+#define Measurement_power_burst_tag              8
+#define PowerBatch_voltage_tag                   1
+#define PowerBatch_current_tag                   2
+#define Teros12Batch_vwc_raw_tag                 1
+#define Teros12Batch_vwc_adj_tag                 2
+#define Teros12Batch_temp_tag                    3
+#define Teros12Batch_ec_tag                      4
+#define Teros21Batch_matric_pot_tag              1
+#define Teros21Batch_temp_tag                    2
+#define Phytos31Batch_voltage_tag                1
+#define Phytos31Batch_leaf_wetness_tag           2
+#define BME280Batch_pressure_tag                 1
+#define BME280Batch_temperature_tag              2
+#define BME280Batch_humidity_tag                 3
+#define MeasurementBatch_meta_tag                1
+#define MeasurementBatch_ts_delta_tag            2
+#define MeasurementBatch_power_tag               3
+#define MeasurementBatch_teros12_tag             4
+#define MeasurementBatch_phytos31_tag            5
+#define MeasurementBatch_bme280_tag              6
+#define MeasurementBatch_teros21_tag             7
 #define Response_resp_tag                        1
 #define PageCommand_file_request_tag             1
 #define PageCommand_file_descriptor_tag          2
 #define PageCommand_block_size_tag               3
 #define PageCommand_num_bytes_tag                4
+#define PageCommand_data_tag                     5
+#define PageCommand_offset_tag                   6
+#define PageCommand_rc_tag                       7
 #define TestCommand_state_tag                    1
 #define TestCommand_data_tag                     2
 #define WiFiCommand_type_tag                     1
@@ -353,28 +589,37 @@ X(a, STATIC,   SINGULAR, UINT32,   ts,                3)
 #define MeasurementMetadata_DEFAULT NULL
 
 #define PowerMeasurement_FIELDLIST(X, a) \
-X(a, STATIC,   SINGULAR, DOUBLE,   voltage,           2) \
-X(a, STATIC,   SINGULAR, DOUBLE,   current,           3)
+X(a, STATIC,   SINGULAR, DOUBLE,   voltage_double,    2) \
+X(a, STATIC,   SINGULAR, DOUBLE,   current_double,    3) \
+X(a, STATIC,   SINGULAR, FLOAT,    voltage,           4) \
+X(a, STATIC,   SINGULAR, FLOAT,    current,           5)
 #define PowerMeasurement_CALLBACK NULL
 #define PowerMeasurement_DEFAULT NULL
 
 #define Teros12Measurement_FIELDLIST(X, a) \
-X(a, STATIC,   SINGULAR, DOUBLE,   vwc_raw,           2) \
-X(a, STATIC,   SINGULAR, DOUBLE,   vwc_adj,           3) \
-X(a, STATIC,   SINGULAR, DOUBLE,   temp,              4) \
-X(a, STATIC,   SINGULAR, UINT32,   ec,                5)
+X(a, STATIC,   SINGULAR, DOUBLE,   vwc_raw_double,    2) \
+X(a, STATIC,   SINGULAR, DOUBLE,   vwc_adj_double,    3) \
+X(a, STATIC,   SINGULAR, DOUBLE,   temp_double,       4) \
+X(a, STATIC,   SINGULAR, UINT32,   ec,                5) \
+X(a, STATIC,   SINGULAR, FLOAT,    vwc_raw,           6) \
+X(a, STATIC,   SINGULAR, FLOAT,    vwc_adj,           7) \
+X(a, STATIC,   SINGULAR, FLOAT,    temp,              8)
 #define Teros12Measurement_CALLBACK NULL
 #define Teros12Measurement_DEFAULT NULL
 
 #define Teros21Measurement_FIELDLIST(X, a) \
-X(a, STATIC,   SINGULAR, DOUBLE,   matric_pot,        1) \
-X(a, STATIC,   SINGULAR, DOUBLE,   temp,              2)
+X(a, STATIC,   SINGULAR, DOUBLE,   matric_pot_double,   1) \
+X(a, STATIC,   SINGULAR, DOUBLE,   temp_double,       2) \
+X(a, STATIC,   SINGULAR, FLOAT,    matric_pot,        3) \
+X(a, STATIC,   SINGULAR, FLOAT,    temp,              4)
 #define Teros21Measurement_CALLBACK NULL
 #define Teros21Measurement_DEFAULT NULL
 
 #define Phytos31Measurement_FIELDLIST(X, a) \
-X(a, STATIC,   SINGULAR, DOUBLE,   voltage,           1) \
-X(a, STATIC,   SINGULAR, DOUBLE,   leaf_wetness,      2)
+X(a, STATIC,   SINGULAR, DOUBLE,   voltage_double,    1) \
+X(a, STATIC,   SINGULAR, DOUBLE,   leaf_wetness_double,   2) \
+X(a, STATIC,   SINGULAR, FLOAT,    voltage,           3) \
+X(a, STATIC,   SINGULAR, FLOAT,    leaf_wetness,      4)
 #define Phytos31Measurement_CALLBACK NULL
 #define Phytos31Measurement_DEFAULT NULL
 
@@ -385,13 +630,39 @@ X(a, STATIC,   SINGULAR, UINT32,   humidity,          3)
 #define BME280Measurement_CALLBACK NULL
 #define BME280Measurement_DEFAULT NULL
 
+#define PowerSummary_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   count,             1) \
+X(a, STATIC,   SINGULAR, FLOAT,    voltage_mean,      2) \
+X(a, STATIC,   SINGULAR, FLOAT,    voltage_min,       3) \
+X(a, STATIC,   SINGULAR, FLOAT,    voltage_max,       4) \
+X(a, STATIC,   SINGULAR, FLOAT,    voltage_stddev,    5) \
+X(a, STATIC,   SINGULAR, FLOAT,    current_mean,      6) \
+X(a, STATIC,   SINGULAR, FLOAT,    current_min,       7) \
+X(a, STATIC,   SINGULAR, FLOAT,    current_max,       8) \
+X(a, STATIC,   SINGULAR, FLOAT,    current_stddev,    9)
+#define PowerSummary_CALLBACK NULL
+#define PowerSummary_DEFAULT NULL
+
+#define PowerBurst_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   burst_id,          1) \
+X(a, STATIC,   SINGULAR, BOOL,     current,           2) \
+X(a, STATIC,   SINGULAR, UINT32,   rate,              3) \
+X(a, STATIC,   SINGULAR, UINT32,   offset,            4) \
+X(a, STATIC,   SINGULAR, UINT32,   total,             5) \
+X(a, STATIC,   SINGULAR, UINT32,   dropped,           6) \
+X(a, STATIC,   SINGULAR, BYTES,    samples,           7)
+#define PowerBurst_CALLBACK NULL
+#define PowerBurst_DEFAULT NULL
+
 #define Measurement_FIELDLIST(X, a) \
 X(a, STATIC,   OPTIONAL, MESSAGE,  meta,              1) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,power,measurement.power),   2) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,teros12,measurement.teros12),   3) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,phytos31,measurement.phytos31),   4) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,bme280,measurement.bme280),   5) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,teros21,measurement.teros21),   6)
+X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,teros21,measurement.teros21),   6) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,power_summary,measurement.power_summary),   7) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,power_burst,measurement.power_burst),   8)
 #define Measurement_CALLBACK NULL
 #define Measurement_DEFAULT NULL
 #define Measurement_meta_MSGTYPE MeasurementMetadata
@@ -400,6 +671,58 @@ X(a, STATIC,   ONEOF,    MESSAGE,  (measurement,teros21,measurement.teros21),
 #define Measurement_measurement_phytos31_MSGTYPE Phytos31Measurement
 #define Measurement_measurement_bme280_MSGTYPE BME280Measurement
 #define Measurement_measurement_teros21_MSGTYPE Teros21Measurement
+#define Measurement_measurement_power_summary_MSGTYPE PowerSummary
+#define Measurement_measurement_power_burst_MSGTYPE PowerBurst
+
+#define PowerBatch_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, FLOAT,    voltage,           1) \
+X(a, STATIC,   REPEATED, FLOAT,    current,           2)
+#define PowerBatch_CALLBACK NULL
+#define PowerBatch_DEFAULT NULL
+
+#define Teros12Batch_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, FLOAT,    vwc_raw,           1) \
+X(a, STATIC,   REPEATED, FLOAT,    vwc_adj,           2) \
+X(a, STATIC,   REPEATED, FLOAT,    temp,              3) \
+X(a, STATIC,   REPEATED, UINT32,   ec,                4)
+#define Teros12Batch_CALLBACK NULL
+#define Teros12Batch_DEFAULT NULL
+
+#define Teros21Batch_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, FLOAT,    matric_pot,        1) \
+X(a, STATIC,   REPEATED, FLOAT,    temp,              2)
+#define Teros21Batch_CALLBACK NULL
+#define Teros21Batch_DEFAULT NULL
+
+#define Phytos31Batch_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, FLOAT,    voltage,           1) \
+X(a, STATIC,   REPEATED, FLOAT,    leaf_wetness,      2)
+#define Phytos31Batch_CALLBACK NULL
+#define Phytos31Batch_DEFAULT NULL
+
+#define BME280Batch_FIELDLIST(X, a) \
+X(a, STATIC,   REPEATED, UINT32,   pressure,          1) \
+X(a, STATIC,   REPEATED, SINT32,   temperature,       2) \
+X(a, STATIC,   REPEATED, UINT32,   humidity,          3)
+#define BME280Batch_CALLBACK NULL
+#define BME280Batch_DEFAULT NULL
+
+#define MeasurementBatch_FIELDLIST(X, a) \
+X(a, STATIC,   OPTIONAL, MESSAGE,  meta,              1) \
+X(a, STATIC,   REPEATED, SINT32,   ts_delta,          2) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (batch,power,batch.power),   3) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (batch,teros12,batch.teros12),   4) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (batch,phytos31,batch.phytos31),   5) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (batch,bme280,batch.bme280),   6) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (batch,teros21,batch.teros21),   7)
+#define MeasurementBatch_CALLBACK NULL
+#define MeasurementBatch_DEFAULT NULL
+#define MeasurementBatch_meta_MSGTYPE MeasurementMetadata
+#define MeasurementBatch_batch_power_MSGTYPE PowerBatch
+#define MeasurementBatch_batch_teros12_MSGTYPE Teros12Batch
+#define MeasurementBatch_batch_phytos31_MSGTYPE Phytos31Batch
+#define MeasurementBatch_batch_bme280_MSGTYPE BME280Batch
+#define MeasurementBatch_batch_teros21_MSGTYPE Teros21Batch
 
 #define Response_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UENUM,    resp,              1)
@@ -420,7 +743,10 @@ X(a, STATIC,   ONEOF,    MESSAGE,  (command,wifi_command,command.wifi_command),
 X(a, STATIC,   SINGULAR, UENUM,    file_request,      1) \
 X(a, STATIC,   SINGULAR, UINT32,   file_descriptor,   2) \
 X(a, STATIC,   SINGULAR, UINT32,   block_size,        3) \
-X(a, STATIC,   SINGULAR, UINT32,   num_bytes,         4)
+X(a, STATIC,   SINGULAR, UINT32,   num_bytes,         4) \
+X(a, STATIC,   SINGULAR, BYTES,    data,              5) \
+X(a, STATIC,   SINGULAR, UINT32,   offset,            6) \
+X(a, STATIC,   SINGULAR, UINT32,   rc,                7)
 #define PageCommand_CALLBACK NULL
 #define PageCommand_DEFAULT NULL
 
@@ -465,7 +791,15 @@ extern const pb_msgdesc_t Teros12Measurement_msg;
 extern const pb_msgdesc_t Teros21Measurement_msg;
 extern const pb_msgdesc_t Phytos31Measurement_msg;
 extern const pb_msgdesc_t BME280Measurement_msg;
+extern const pb_msgdesc_t PowerSummary_msg;
+extern const pb_msgdesc_t PowerBurst_msg;
 extern const pb_msgdesc_t Measurement_msg;
+extern const pb_msgdesc_t PowerBatch_msg;
+extern const pb_msgdesc_t Teros12Batch_msg;
+extern const pb_msgdesc_t Teros21Batch_msg;
+extern const pb_msgdesc_t Phytos31Batch_msg;
+extern const pb_msgdesc_t BME280Batch_msg;
+extern const pb_msgdesc_t MeasurementBatch_msg;
 extern const pb_msgdesc_t Response_msg;
 extern const pb_msgdesc_t Esp32Command_msg;
 extern const pb_msgdesc_t PageCommand_msg;
@@ -480,7 +814,15 @@ extern const pb_msgdesc_t UserConfiguration_msg;
 #define Teros21Measurement_fields &Teros21Measurement_msg
 #define Phytos31Measurement_fields &Phytos31Measurement_msg
 #define BME280Measurement_fields &BME280Measurement_msg
+#define PowerSummary_fields &PowerSummary_msg
+#define PowerBurst_fields &PowerBurst_msg
 #define Measurement_fields &Measurement_msg
+#define PowerBatch_fields &PowerBatch_msg
+#define Teros12Batch_fields &Teros12Batch_msg
+#define Teros21Batch_fields &Teros21Batch_msg
+#define Phytos31Batch_fields &Phytos31Batch_msg
+#define BME280Batch_fields &BME280Batch_msg
+#define MeasurementBatch_fields &MeasurementBatch_msg
 #define Response_fields &Response_msg
 #define Esp32Command_fields &Esp32Command_msg
 #define PageCommand_fields &PageCommand_msg
@@ -489,17 +831,25 @@ extern const pb_msgdesc_t UserConfiguration_msg;
 #define UserConfiguration_fields &UserConfiguration_msg
 
 /* Maximum encoded size of messages (where known) */
+#define BME280Batch_size                         576
 #define BME280Measurement_size                   23
 #define Esp32Command_size                        607
+#define MeasurementBatch_size                    887
 #define MeasurementMetadata_size                 18
-#define Measurement_size                         55
-#define PageCommand_size                         20
-#define Phytos31Measurement_size                 18
-#define PowerMeasurement_size                    18
+#define Measurement_size                         120
+#define PageCommand_size                         291
+#define Phytos31Batch_size                       320
+#define Phytos31Measurement_size                 28
+#define PowerBatch_size                          320
+#define PowerBurst_size                          98
+#define PowerMeasurement_size                    28
+#define PowerSummary_size                        46
 #define Response_size                            2
-#define SOIL_POWER_SENSOR_PB_H_MAX_SIZE          Esp32Command_size
-#define Teros12Measurement_size                  33
-#define Teros21Measurement_size                  18
+#define SOIL_POWER_SENSOR_PB_H_MAX_SIZE          MeasurementBatch_size
+#define Teros12Batch_size                        672
+#define Teros12Measurement_size                  48
+#define Teros21Batch_size                        320
+#define Teros21Measurement_size                  28
 #define TestCommand_size                         13
 #define UserConfiguration_size                   238
 #define WiFiCommand_size                         604
@@ -24,6 +24,7 @@ extern "C" {
 #include <stddef.h>
 #include <string.h>
 
+#include "pb_encode.h"
 #include "soil_power_sensor.pb.h"
 
 /**
@@ -31,6 +32,22 @@ extern "C" {
  * @defgroup protoTranscoder Transcoder
  * @brief Library for encoding/decoding protobuf messages
  *
+ * Sensor values are encoded as float, which takes 5 bytes on the wire instead
+ * of 9 bytes for double. Define TRANSCODER_ENCODE_DOUBLE to encode the
+ * deprecated double fields instead, for backends that do not decode the float
+ * fields yet.
+ *
+ * Measurements are encoded into a buffer of at least Measurement_size bytes,
+ * or into a nanopb output stream with the Stream variants. Streams allow
+ * serializing directly into the destination, such as the FRAM buffer.
+ *
+ * Measurements are serialized with the encoders generated by
+ * generate_fast_encoders.py rather than pb_encode(). They compute the message
+ * size up front and write the fields directly, without walking the nanopb
+ * field descriptors. The output is identical to pb_encode(). The Stream
+ * variants encode into a Measurement_size buffer on the stack and pass it to
+ * the stream with a single write.
+ *
  * @{
  */
 
@@ -47,7 +64,8 @@ extern "C" {
  * @param cell_id Cell Id
  * @param voltage Voltage measured in mV
  * @param current Current measured in uA
- * @param buffer Buffer to store serialized measurement
+ * @param buffer Buffer to store serialized measurement, at least
+ * Measurement_size bytes
  * @return Number of bytes in @p buffer
  */
 size_t EncodePowerMeasurement(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
@@ -68,7 +86,8 @@ size_t EncodePowerMeasurement(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
  * @param vwc_adj Volumetric water content converted to percentage
  * @param temp Temperature in celsius
  * @param ec Electrical conductivity
- * @param buffer Buffer to store serialized measurement
+ * @param buffer Buffer to store serialized measurement, at least
+ * Measurement_size bytes
  * @return Number of bytes in @p buffer
  */
 size_t EncodeTeros12Measurement(uint32_t ts, uint32_t logger_id,
@@ -92,7 +111,8 @@ size_t EncodeTeros12Measurement(uint32_t ts, uint32_t logger_id,
  * @param cell_id Cell Id
  * @param voltage Raw voltage reading
  * @param leaf_wetness Calibrated leaf wetness
- * @param buffer Buffer to store serialized measurement
+ * @param buffer Buffer to store serialized measurement, at least
+ * Measurement_size bytes
  * @return Number of bytes in @p buffer
  */
 size_t EncodePhytos31Measurement(uint32_t ts, uint32_t logger_id,
@@ -128,7 +148,8 @@ size_t EncodePhytos31Measurement(uint32_t ts, uint32_t logger_id,
  * @param pressure Air pressure in hPa
  * @param temperature Air temperature in celsius (C)
  * @param humidity Relative humidity in percent (%)
- * @param buffer Buffer to store serialized measurement
+ * @param buffer Buffer to store serialized measurement, at least
+ * Measurement_size bytes
  * @return Number of bytes in @p buffer
  */
 size_t EncodeBME280Measurement(uint32_t ts, uint32_t logger_id,
@@ -136,6 +157,375 @@ size_t EncodeBME280Measurement(uint32_t ts, uint32_t logger_id,
                                int32_t temperature, uint32_t humidity,
                                uint8_t *buffer);
 
+/**
+ * @brief Encodes a Teros21 measurement
+ *
+ * The timestamp is not able to encode timezones and is references from UTC+0.
+ * The serialized data is stored in @p buffer with the number of bytes written
+ * being returned by the function. A return value of -1 indicates an error in
+ * encoding.
+ *
+ * @param ts Timestamp
+ * @param logger_id Logger Id
+ * @param cell_id Cell Id
+ * @param matric_pot Matric potential in kPa
+ * @param temp Temperature in celsius
+ * @param buffer Buffer to store serialized measurement, at least
+ * Measurement_size bytes
+ * @return Number of bytes in @p buffer
+ */
+size_t EncodeTeros21Measurement(uint32_t ts, uint32_t logger_id,
+                                uint32_t cell_id, double matric_pot,
+                                double temp, uint8_t *buffer);
+
+/**
+ * @brief Encodes a summary of oversampled power measurements
+ *
+ * The timestamp is not able to encode timezones and is references from UTC+0.
+ * The serialized data is stored in @p buffer with the number of bytes written
+ * being returned by the function. A return value of -1 indicates an error in
+ * encoding.
+ *
+ * Statistics are always encoded as float.
+ *
+ * @param ts Timestamp of the start of the window
+ * @param logger_id Logger Id
+ * @param cell_id Cell Id
+ * @param summary Statistics of voltage in mV and current in uA
+ * @param buffer Buffer to store serialized measurement, at least
+ * Measurement_size bytes
+ * @return Number of bytes in @p buffer
+ */
+size_t EncodePowerSummary(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
+                          const PowerSummary *summary, uint8_t *buffer);
+
+/**
+ * @brief Encodes a block of a power burst
+ *
+ * The timestamp is not able to encode timezones and is references from UTC+0.
+ * The serialized data is stored in @p buffer with the number of bytes written
+ * being returned by the function. A return value of -1 indicates an error in
+ * encoding.
+ *
+ * @param ts Timestamp of the start of the burst
+ * @param logger_id Logger Id
+ * @param cell_id Cell Id
+ * @param burst Block of the burst with samples from EncodeBurstSamples()
+ * @param buffer Buffer to store serialized measurement, at least
+ * Measurement_size bytes
+ * @return Number of bytes in @p buffer
+ */
+size_t EncodePowerBurst(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
+                        const PowerBurst *burst, uint8_t *buffer);
+
+/**
+ * @brief Compresses raw samples of a power burst
+ *
+ * The first sample is stored as a zig-zag varint and the following samples as
+ * zig-zag varints of the difference to the previous sample, so slowly
+ * changing signals take one or two bytes per sample instead of three. Samples
+ * are added until the next one does not fit in @p size bytes.
+ *
+ * @param samples Raw samples
+ * @param count Number of samples
+ * @param buffer Buffer to store compressed samples
+ * @param size Size of buffer
+ * @param len Number of bytes in @p buffer
+ * @return Number of samples compressed
+ */
+size_t EncodeBurstSamples(const int32_t *samples, size_t count,
+                          uint8_t *buffer, size_t size, size_t *len);
+
+/**
+ * @brief Decompresses raw samples of a power burst
+ *
+ * @see EncodeBurstSamples
+ *
+ * @param data Compressed samples
+ * @param len Number of bytes in @p data
+ * @param samples Raw samples
+ * @param max Maximum number of samples
+ * @return Number of samples, -1 on error or if there are more than @p max
+ * samples
+ */
+int DecodeBurstSamples(const uint8_t *data, size_t len, int32_t *samples,
+                       size_t max);
+
+/**
+ * @brief Encodes a power measurement into a stream
+ *
+ * @see EncodePowerMeasurement
+ *
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodePowerMeasurementStream(uint32_t ts, uint32_t logger_id,
+                                  uint32_t cell_id, double voltage,
+                                  double current, pb_ostream_t *ostream);
+
+/**
+ * @brief Encodes a Teros12 measurement into a stream
+ *
+ * @see EncodeTeros12Measurement
+ *
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodeTeros12MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                    uint32_t cell_id, double vwc_raw,
+                                    double vwc_adj, double temp, uint32_t ec,
+                                    pb_ostream_t *ostream);
+
+/**
+ * @brief Encodes a Phytos31 measurement into a stream
+ *
+ * @see EncodePhytos31Measurement
+ *
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodePhytos31MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                     uint32_t cell_id, double voltage,
+                                     double leaf_wetness,
+                                     pb_ostream_t *ostream);
+
+/**
+ * @brief Encodes a BME280 measurement into a stream
+ *
+ * @see EncodeBME280Measurement
+ *
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodeBME280MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                   uint32_t cell_id, uint32_t pressure,
+                                   int32_t temperature, uint32_t humidity,
+                                   pb_ostream_t *ostream);
+
+/**
+ * @brief Encodes a Teros21 measurement into a stream
+ *
+ * @see EncodeTeros21Measurement
+ *
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodeTeros21MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                    uint32_t cell_id, double matric_pot,
+                                    double temp, pb_ostream_t *ostream);
+
+/**
+ * @brief Encodes a summary of oversampled power measurements into a stream
+ *
+ * @see EncodePowerSummary
+ *
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodePowerSummaryStream(uint32_t ts, uint32_t logger_id,
+                              uint32_t cell_id, const PowerSummary *summary,
+                              pb_ostream_t *ostream);
+
+/**
+ * @brief Encodes a block of a power burst into a stream
+ *
+ * @see EncodePowerBurst
+ *
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodePowerBurstStream(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
+                            const PowerBurst *burst, pb_ostream_t *ostream);
+
+/**
+ * @brief Decodes a measurement message
+ *
+ * Values of measurements encoded with the deprecated double fields are copied
+ * to the float fields, so only the float fields need to be read.
+ *
+ * @param data Protobuf serialized data
+ * @param len Number of bytes in @p data
+ * @param meas Decoded measurement
+ * @return 0 on success, -1 on error
+ */
+int DecodeMeasurement(const uint8_t *data, const size_t len,
+                      Measurement *meas);
+
+/**
+ * @brief Adds a measurement to a batch
+ *
+ * The batch must be initialized with MeasurementBatch_init_zero. The first
+ * measurement sets the metadata and type of the batch. Following measurements
+ * must have the same type, cell id and logger id. Values are read from the
+ * float fields, see DecodeMeasurement(), and the timestamp is stored as the
+ * difference to the previous measurement.
+ *
+ * The batch is left unchanged if the measurement can not be added.
+ *
+ * @param batch Batch of measurements
+ * @param meas Measurement to add
+ * @param max_size Maximum number of bytes of the serialized batch
+ * @return 0 if added, -1 if the measurement does not match the batch, the
+ * batch is full or the serialized batch would exceed @p max_size bytes
+ */
+int MeasurementBatchAdd(MeasurementBatch *batch, const Measurement *meas,
+                        size_t max_size);
+
+/**
+ * @brief Gets a measurement from a batch
+ *
+ * @param batch Batch of measurements
+ * @param idx Index of the measurement in the batch
+ * @param meas Measurement with the metadata and values of the sample
+ * @return 0 on success, -1 if @p idx is out of range or the batch is malformed
+ */
+int MeasurementBatchGet(const MeasurementBatch *batch, size_t idx,
+                        Measurement *meas);
+
+/**
+ * @brief Encodes a batch of measurements
+ *
+ * @param batch Batch of measurements
+ * @param buffer Buffer to store serialized batch
+ * @param size Size of buffer
+ * @return Number of bytes in @p buffer, -1 indicates an error
+ */
+size_t EncodeMeasurementBatch(const MeasurementBatch *batch, uint8_t *buffer,
+                              size_t size);
+
+/**
+ * @brief Decodes a batch of measurements
+ *
+ * @param data Protobuf serialized data
+ * @param len Number of bytes in @p data
+ * @param batch Decoded batch
+ * @return 0 on success, -1 on error
+ */
+int DecodeMeasurementBatch(const uint8_t *data, const size_t len,
+                           MeasurementBatch *batch);
+
+#ifndef TRANSCODER_DELTA_KEYFRAME_INTERVAL
+/** Maximum number of measurements of a stream between keyframes */
+#define TRANSCODER_DELTA_KEYFRAME_INTERVAL 16
+#endif /* TRANSCODER_DELTA_KEYFRAME_INTERVAL */
+
+/** Number of streams, one per measurement type indexed by which_measurement */
+#define TRANSCODER_DELTA_STREAMS (Measurement_power_burst_tag + 1)
+
+/** Maximum number of bytes of a compressed measurement */
+#define TRANSCODER_DELTA_MAX_SIZE (Measurement_size + 2)
+
+/**
+ * @brief Reference of a stream of compressed measurements
+ */
+typedef struct {
+  /** Last measurement of the stream */
+  Measurement ref;
+  /** Difference of the timestamps of the last two measurements */
+  uint32_t period;
+  /** Sequence number of the last measurement */
+  uint8_t seq;
+  /** Number of measurements since the last keyframe */
+  uint8_t since_keyframe;
+  /** Set once the stream has a reference */
+  bool valid;
+} MeasurementDeltaStream;
+
+/**
+ * @brief State of the compression of measurements
+ *
+ * Consecutive measurements of the same type change very little, so a
+ * measurement is stored as the difference to the previous measurement of the
+ * same type, the reference. Each type is a separate stream. The first
+ * measurement of a stream and every TRANSCODER_DELTA_KEYFRAME_INTERVAL-th
+ * measurement after are stored in full as a keyframe, bounding the number of
+ * measurements lost with a missing reference.
+ *
+ * A compressed measurement starts with the measurement type, with the top bit
+ * set for keyframes, and a sequence number that increments for every
+ * measurement of the stream. Keyframes are followed by the serialized
+ * Measurement message. Deltas are followed by a bitmap of the values that
+ * changed, the change in the interval between timestamps as a zig-zag
+ * varint, and the changed values in the order of the message fields. Float
+ * and double values are stored as the XOR of their bits with the reference as
+ * a varint, which is small when the sign, exponent and leading digits match.
+ * Integer values are stored as the zig-zag varint of the difference.
+ * Measurements of types with more values than fit the bitmap, such as power
+ * summaries, or without numeric values, such as power bursts, are always
+ * stored as keyframes.
+ *
+ * @verbatim
+ * keyframe: | 0x80 + type | seq | Measurement                               |
+ * delta:    | type        | seq | bitmap | ts (zig-zag) | changed values... |
+ * @endverbatim
+ *
+ * Deltas must be decoded in the order they were encoded. The sequence number
+ * detects a missing reference, in which case the delta is refused until the
+ * next keyframe. The metadata of a delta is the same as its reference.
+ *
+ * Encoding and decoding do not modify the state, it is advanced with
+ * MeasurementDeltaAdvance() once the measurement is stored or consumed. This
+ * allows retrying the same measurement, such as an uplink that failed.
+ */
+typedef struct {
+  /** Streams indexed by which_measurement */
+  MeasurementDeltaStream streams[TRANSCODER_DELTA_STREAMS];
+} MeasurementDelta;
+
+/**
+ * @brief Initializes the state of the compression
+ *
+ * All streams start without a reference, so the next measurement of each
+ * type is a keyframe.
+ *
+ * @param delta State of the compression
+ */
+void MeasurementDeltaInit(MeasurementDelta *delta);
+
+/**
+ * @brief Compresses a measurement against the previous one of its type
+ *
+ * A keyframe is encoded if the stream has no reference, the keyframe interval
+ * is reached or the metadata differs from the reference.
+ *
+ * @param delta State of the compression
+ * @param meas Measurement to compress
+ * @param buffer Buffer to store the compressed measurement
+ * @param size Size of buffer, TRANSCODER_DELTA_MAX_SIZE bytes always suffice
+ * @return Number of bytes in @p buffer, -1 indicates an error
+ */
+size_t EncodeMeasurementDelta(const MeasurementDelta *delta,
+                              const Measurement *meas, uint8_t *buffer,
+                              size_t size);
+
+/**
+ * @brief Decompresses a measurement
+ *
+ * Values are returned as with DecodeMeasurement().
+ *
+ * @param delta State of the compression
+ * @param data Compressed measurement
+ * @param len Number of bytes in @p data
+ * @param meas Decompressed measurement
+ * @return 0 on success, -1 if @p data is malformed or the reference of a
+ * delta is missing
+ */
+int DecodeMeasurementDelta(const MeasurementDelta *delta, const uint8_t *data,
+                           const size_t len, Measurement *meas);
+
+/**
+ * @brief Advances the state past a compressed measurement
+ *
+ * Called once a measurement from EncodeMeasurementDelta() is stored, or a
+ * measurement from DecodeMeasurementDelta() is consumed.
+ *
+ * @param delta State of the compression
+ * @param data Compressed measurement
+ * @param meas Measurement that was compressed or decompressed
+ */
+void MeasurementDeltaAdvance(MeasurementDelta *delta, const uint8_t *data,
+                             const Measurement *meas);
+
 /**
  * @brief Decodes a response message
  *
@@ -154,11 +544,48 @@ Response_ResponseType DecodeResponse(const uint8_t *data, const size_t len);
  * @brief Decodes an Esp32Command message
  *
  * The type of command and the data from the command will need to be manually
- * extracted, @see soil_power_sensor.ph.h.
+ * extracted, @see soil_power_sensor.ph.h. Use DecodePageCommand or
+ * DecodeWiFiCommand when the type of command is known, which decode into the
+ * smaller command struct.
+ *
+ * @param data Serialized data buffer
+ * @param len Length of data buffer
+ * @param cmd Decoded command
  *
- * @returns Esp32Command data
+ * @return 0 on success, -1 on error
  */
-Esp32Command DecodeEsp32Command(const uint8_t *data, const size_t len);
+int DecodeEsp32Command(const uint8_t *data, const size_t len,
+                       Esp32Command *cmd);
+
+/**
+ * @brief Decodes the PageCommand of an Esp32Command message
+ *
+ * The command is decoded directly into @p page_cmd without an intermediate
+ * Esp32Command.
+ *
+ * @param data Serialized data buffer
+ * @param len Length of data buffer
+ * @param page_cmd Decoded page command
+ *
+ * @return 0 on success, -1 on error or if the message is not a page command
+ */
+int DecodePageCommand(const uint8_t *data, const size_t len,
+                      PageCommand *page_cmd);
+
+/**
+ * @brief Decodes the WiFiCommand of an Esp32Command message
+ *
+ * The command is decoded directly into @p wifi_cmd without an intermediate
+ * Esp32Command.
+ *
+ * @param data Serialized data buffer
+ * @param len Length of data buffer
+ * @param wifi_cmd Decoded WiFi command
+ *
+ * @return 0 on success, -1 on error or if the message is not a WiFi command
+ */
+int DecodeWiFiCommand(const uint8_t *data, const size_t len,
+                      WiFiCommand *wifi_cmd);
 
 /**
  * @brief Encodes a page command
@@ -175,6 +602,21 @@ Esp32Command DecodeEsp32Command(const uint8_t *data, const size_t len);
 size_t EncodePageCommand(PageCommand_RequestType req, int fd, size_t bs,
                          size_t n, uint8_t *buffer, size_t size);
 
+/**
+ * @brief Encodes a page command from a message
+ *
+ * Used for commands with data, such as writes and responses to reads. The
+ * command is encoded as an Esp32Command without being copied into one.
+ *
+ * @param page_cmd Page command
+ * @param buffer Buffer to store serialized command
+ * @param size Size of buffer
+ *
+ * @returns Number of bytes in @p buffer
+ */
+size_t EncodePageCommandMsg(const PageCommand *page_cmd, uint8_t *buffer,
+                            size_t size);
+
 /**
  * @brief Encodes a test command
  *
@@ -191,6 +633,8 @@ size_t EncodeTestCommand(TestCommand_ChangeState state, int32_t data,
 /**
  * @brief Encodes a WiFiCommand
  *
+ * The command is encoded as an Esp32Command without being copied into one.
+ *
  * @param wifi_cmd Command containing the data
  * @param buffer Buffer to store serialized measurement
  * @param size Size of buffer
@@ -0,0 +1,154 @@
+/**
+ * @file archive.c
+ *
+ * @see archive.h
+ *
+ * @author John Madden <jmadden173@pm.me>
+ * @date 2026-10-16
+ */
+
+#include "archive.h"
+
+#include <string.h>
+
+#include "pb_decode.h"
+#include "transcoder.h"
+
+/**
+ * @brief Reads a little-endian 32-bit integer
+ *
+ * @param data Bytes of the integer
+ * @return Integer
+ */
+static uint32_t ReadU32(const uint8_t *data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+         ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+/**
+ * @brief Reads a little-endian 64-bit integer
+ *
+ * @param data Bytes of the integer
+ * @return Integer
+ */
+static uint64_t ReadU64(const uint8_t *data) {
+  return (uint64_t)ReadU32(data) | ((uint64_t)ReadU32(data + 4) << 32);
+}
+
+int ArchiveOpen(Archive *archive, ArchiveReadFunc read, void *ctx,
+                uint64_t size) {
+  if (size < ARCHIVE_HEADER_SIZE + ARCHIVE_TRAILER_SIZE) {
+    return -1;
+  }
+
+  uint8_t header[ARCHIVE_HEADER_SIZE];
+  if (!read(ctx, 0, header, sizeof(header)) ||
+      memcmp(header, ARCHIVE_MAGIC, ARCHIVE_HEADER_SIZE) != 0) {
+    return -1;
+  }
+
+  uint8_t trailer[ARCHIVE_TRAILER_SIZE];
+  const uint64_t trailer_offset = size - ARCHIVE_TRAILER_SIZE;
+  if (!read(ctx, trailer_offset, trailer, sizeof(trailer)) ||
+      memcmp(trailer + 12, ARCHIVE_INDEX_MAGIC, 4) != 0) {
+    return -1;
+  }
+
+  const uint64_t index_offset = ReadU64(trailer);
+  const uint32_t num_blocks = ReadU32(trailer + 8);
+
+  // index ends at the trailer
+  if (index_offset > trailer_offset ||
+      (trailer_offset - index_offset) / ARCHIVE_ENTRY_SIZE != num_blocks ||
+      (trailer_offset - index_offset) % ARCHIVE_ENTRY_SIZE != 0) {
+    return -1;
+  }
+
+  archive->read = read;
+  archive->ctx = ctx;
+  archive->index_offset = index_offset;
+  archive->num_blocks = num_blocks;
+
+  return 0;
+}
+
+int ArchiveGetBlock(const Archive *archive, uint32_t i, ArchiveBlock *block) {
+  if (i >= archive->num_blocks) {
+    return -1;
+  }
+
+  uint8_t entry[ARCHIVE_ENTRY_SIZE];
+  const uint64_t offset =
+      archive->index_offset + (uint64_t)i * ARCHIVE_ENTRY_SIZE;
+  if (!archive->read(archive->ctx, offset, entry, sizeof(entry))) {
+    return -1;
+  }
+
+  block->logger_id = ReadU32(entry);
+  block->cell_id = ReadU32(entry + 4);
+  block->ts_min = ReadU32(entry + 8);
+  block->ts_max = ReadU32(entry + 12);
+  block->offset = ReadU64(entry + 16);
+  block->len = ReadU32(entry + 24);
+  block->count = ReadU32(entry + 28);
+
+  return 0;
+}
+
+bool ArchiveBlockMatches(const ArchiveBlock *block,
+                         const ArchiveQuery *query) {
+  if (query->has_logger_id && block->logger_id != query->logger_id) {
+    return false;
+  }
+  if (query->has_cell_id && block->cell_id != query->cell_id) {
+    return false;
+  }
+  return block->ts_max >= query->start && block->ts_min <= query->end;
+}
+
+int ArchiveRead(const Archive *archive, const ArchiveQuery *query,
+                uint8_t *buffer, size_t size, ArchiveCallback cb, void *arg) {
+  int matches = 0;
+
+  for (uint32_t i = 0; i < archive->num_blocks; i++) {
+    ArchiveBlock block;
+    if (ArchiveGetBlock(archive, i, &block) != 0) {
+      return -1;
+    }
+    if (!ArchiveBlockMatches(&block, query)) {
+      continue;
+    }
+
+    if (block.len > size ||
+        !archive->read(archive->ctx, block.offset, buffer, block.len)) {
+      return -1;
+    }
+
+    pb_istream_t istream = pb_istream_from_buffer(buffer, block.len);
+    while (istream.bytes_left > 0) {
+      uint32_t len;
+      if (!pb_decode_varint32(&istream, &len) || len > istream.bytes_left) {
+        return -1;
+      }
+
+      const uint8_t *data = buffer + (block.len - istream.bytes_left);
+      Measurement meas = Measurement_init_zero;
+      if (DecodeMeasurement(data, len, &meas) != 0 ||
+          !pb_read(&istream, NULL, len)) {
+        return -1;
+      }
+
+      // blocks only hold one logger and cell
+      if (meas.meta.ts < query->start || meas.meta.ts > query->end) {
+        continue;
+      }
+
+      ++matches;
+      if (!cb(&meas, arg)) {
+        return matches;
+      }
+    }
+  }
+
+  return matches;
+}
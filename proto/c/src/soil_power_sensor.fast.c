@@ -0,0 +1,922 @@
+/* Automatically generated by generate_fast_encoders.py */
+
+#include "soil_power_sensor.fast.h"
+
+#include <string.h>
+
+static inline size_t varint32_size(uint32_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+static inline size_t varint64_size(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+static inline uint8_t *write_varint32(uint8_t *p, uint32_t value) {
+  while (value >= 0x80) {
+    *p++ = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+  return p;
+}
+
+static inline uint8_t *write_varint64(uint8_t *p, uint64_t value) {
+  while (value >= 0x80) {
+    *p++ = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+  return p;
+}
+
+static inline uint8_t *write_fixed32(uint8_t *p, uint32_t value) {
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+  p[2] = (uint8_t)(value >> 16);
+  p[3] = (uint8_t)(value >> 24);
+  return p + 4;
+}
+
+static inline uint8_t *write_fixed64(uint8_t *p, uint64_t value) {
+  p = write_fixed32(p, (uint32_t)value);
+  return write_fixed32(p, (uint32_t)(value >> 32));
+}
+
+/* Fixed values are written to the stream in one call, independent of the byte
+ * order of the target */
+static inline bool stream_fixed32(pb_ostream_t *stream, uint32_t value) {
+  uint8_t bytes[4];
+  write_fixed32(bytes, value);
+  return pb_write(stream, bytes, sizeof(bytes));
+}
+
+static inline bool stream_fixed64(pb_ostream_t *stream, uint64_t value) {
+  uint8_t bytes[8];
+  write_fixed64(bytes, value);
+  return pb_write(stream, bytes, sizeof(bytes));
+}
+
+static inline uint32_t zigzag32(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline uint64_t zigzag64(int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/* Zero checks compare the bits, so -0.0 is encoded like in pb_encode() */
+static inline uint32_t float_bits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static inline uint64_t double_bits(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static size_t MeasurementMetadata_fast_size(const MeasurementMetadata *msg) {
+  size_t size = 0;
+  if (msg->cell_id != 0) {
+    size += 1 + varint32_size(msg->cell_id);
+  }
+  if (msg->logger_id != 0) {
+    size += 1 + varint32_size(msg->logger_id);
+  }
+  if (msg->ts != 0) {
+    size += 1 + varint32_size(msg->ts);
+  }
+  return size;
+}
+
+static uint8_t *MeasurementMetadata_fast_write(const MeasurementMetadata *msg, uint8_t *p) {
+  if (msg->cell_id != 0) {
+    *p++ = 0x08;
+    p = write_varint32(p, msg->cell_id);
+  }
+  if (msg->logger_id != 0) {
+    *p++ = 0x10;
+    p = write_varint32(p, msg->logger_id);
+  }
+  if (msg->ts != 0) {
+    *p++ = 0x18;
+    p = write_varint32(p, msg->ts);
+  }
+  return p;
+}
+
+static bool MeasurementMetadata_fast_stream(const MeasurementMetadata *msg, pb_ostream_t *stream) {
+  if (msg->cell_id != 0) {
+    if (!pb_encode_varint(stream, 0x08) ||
+        !pb_encode_varint(stream, msg->cell_id)) {
+      return false;
+    }
+  }
+  if (msg->logger_id != 0) {
+    if (!pb_encode_varint(stream, 0x10) ||
+        !pb_encode_varint(stream, msg->logger_id)) {
+      return false;
+    }
+  }
+  if (msg->ts != 0) {
+    if (!pb_encode_varint(stream, 0x18) ||
+        !pb_encode_varint(stream, msg->ts)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t PowerMeasurement_fast_size(const PowerMeasurement *msg) {
+  size_t size = 0;
+  if (double_bits(msg->voltage_double) != 0) {
+    size += 1 + 8;
+  }
+  if (double_bits(msg->current_double) != 0) {
+    size += 1 + 8;
+  }
+  if (float_bits(msg->voltage) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->current) != 0) {
+    size += 1 + 4;
+  }
+  return size;
+}
+
+static uint8_t *PowerMeasurement_fast_write(const PowerMeasurement *msg, uint8_t *p) {
+  if (double_bits(msg->voltage_double) != 0) {
+    *p++ = 0x11;
+    p = write_fixed64(p, double_bits(msg->voltage_double));
+  }
+  if (double_bits(msg->current_double) != 0) {
+    *p++ = 0x19;
+    p = write_fixed64(p, double_bits(msg->current_double));
+  }
+  if (float_bits(msg->voltage) != 0) {
+    *p++ = 0x25;
+    p = write_fixed32(p, float_bits(msg->voltage));
+  }
+  if (float_bits(msg->current) != 0) {
+    *p++ = 0x2d;
+    p = write_fixed32(p, float_bits(msg->current));
+  }
+  return p;
+}
+
+static bool PowerMeasurement_fast_stream(const PowerMeasurement *msg, pb_ostream_t *stream) {
+  if (double_bits(msg->voltage_double) != 0) {
+    if (!pb_encode_varint(stream, 0x11) ||
+        !stream_fixed64(stream, double_bits(msg->voltage_double))) {
+      return false;
+    }
+  }
+  if (double_bits(msg->current_double) != 0) {
+    if (!pb_encode_varint(stream, 0x19) ||
+        !stream_fixed64(stream, double_bits(msg->current_double))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->voltage) != 0) {
+    if (!pb_encode_varint(stream, 0x25) ||
+        !stream_fixed32(stream, float_bits(msg->voltage))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->current) != 0) {
+    if (!pb_encode_varint(stream, 0x2d) ||
+        !stream_fixed32(stream, float_bits(msg->current))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t Teros12Measurement_fast_size(const Teros12Measurement *msg) {
+  size_t size = 0;
+  if (double_bits(msg->vwc_raw_double) != 0) {
+    size += 1 + 8;
+  }
+  if (double_bits(msg->vwc_adj_double) != 0) {
+    size += 1 + 8;
+  }
+  if (double_bits(msg->temp_double) != 0) {
+    size += 1 + 8;
+  }
+  if (msg->ec != 0) {
+    size += 1 + varint32_size(msg->ec);
+  }
+  if (float_bits(msg->vwc_raw) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->vwc_adj) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->temp) != 0) {
+    size += 1 + 4;
+  }
+  return size;
+}
+
+static uint8_t *Teros12Measurement_fast_write(const Teros12Measurement *msg, uint8_t *p) {
+  if (double_bits(msg->vwc_raw_double) != 0) {
+    *p++ = 0x11;
+    p = write_fixed64(p, double_bits(msg->vwc_raw_double));
+  }
+  if (double_bits(msg->vwc_adj_double) != 0) {
+    *p++ = 0x19;
+    p = write_fixed64(p, double_bits(msg->vwc_adj_double));
+  }
+  if (double_bits(msg->temp_double) != 0) {
+    *p++ = 0x21;
+    p = write_fixed64(p, double_bits(msg->temp_double));
+  }
+  if (msg->ec != 0) {
+    *p++ = 0x28;
+    p = write_varint32(p, msg->ec);
+  }
+  if (float_bits(msg->vwc_raw) != 0) {
+    *p++ = 0x35;
+    p = write_fixed32(p, float_bits(msg->vwc_raw));
+  }
+  if (float_bits(msg->vwc_adj) != 0) {
+    *p++ = 0x3d;
+    p = write_fixed32(p, float_bits(msg->vwc_adj));
+  }
+  if (float_bits(msg->temp) != 0) {
+    *p++ = 0x45;
+    p = write_fixed32(p, float_bits(msg->temp));
+  }
+  return p;
+}
+
+static bool Teros12Measurement_fast_stream(const Teros12Measurement *msg, pb_ostream_t *stream) {
+  if (double_bits(msg->vwc_raw_double) != 0) {
+    if (!pb_encode_varint(stream, 0x11) ||
+        !stream_fixed64(stream, double_bits(msg->vwc_raw_double))) {
+      return false;
+    }
+  }
+  if (double_bits(msg->vwc_adj_double) != 0) {
+    if (!pb_encode_varint(stream, 0x19) ||
+        !stream_fixed64(stream, double_bits(msg->vwc_adj_double))) {
+      return false;
+    }
+  }
+  if (double_bits(msg->temp_double) != 0) {
+    if (!pb_encode_varint(stream, 0x21) ||
+        !stream_fixed64(stream, double_bits(msg->temp_double))) {
+      return false;
+    }
+  }
+  if (msg->ec != 0) {
+    if (!pb_encode_varint(stream, 0x28) ||
+        !pb_encode_varint(stream, msg->ec)) {
+      return false;
+    }
+  }
+  if (float_bits(msg->vwc_raw) != 0) {
+    if (!pb_encode_varint(stream, 0x35) ||
+        !stream_fixed32(stream, float_bits(msg->vwc_raw))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->vwc_adj) != 0) {
+    if (!pb_encode_varint(stream, 0x3d) ||
+        !stream_fixed32(stream, float_bits(msg->vwc_adj))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->temp) != 0) {
+    if (!pb_encode_varint(stream, 0x45) ||
+        !stream_fixed32(stream, float_bits(msg->temp))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t Phytos31Measurement_fast_size(const Phytos31Measurement *msg) {
+  size_t size = 0;
+  if (double_bits(msg->voltage_double) != 0) {
+    size += 1 + 8;
+  }
+  if (double_bits(msg->leaf_wetness_double) != 0) {
+    size += 1 + 8;
+  }
+  if (float_bits(msg->voltage) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->leaf_wetness) != 0) {
+    size += 1 + 4;
+  }
+  return size;
+}
+
+static uint8_t *Phytos31Measurement_fast_write(const Phytos31Measurement *msg, uint8_t *p) {
+  if (double_bits(msg->voltage_double) != 0) {
+    *p++ = 0x09;
+    p = write_fixed64(p, double_bits(msg->voltage_double));
+  }
+  if (double_bits(msg->leaf_wetness_double) != 0) {
+    *p++ = 0x11;
+    p = write_fixed64(p, double_bits(msg->leaf_wetness_double));
+  }
+  if (float_bits(msg->voltage) != 0) {
+    *p++ = 0x1d;
+    p = write_fixed32(p, float_bits(msg->voltage));
+  }
+  if (float_bits(msg->leaf_wetness) != 0) {
+    *p++ = 0x25;
+    p = write_fixed32(p, float_bits(msg->leaf_wetness));
+  }
+  return p;
+}
+
+static bool Phytos31Measurement_fast_stream(const Phytos31Measurement *msg, pb_ostream_t *stream) {
+  if (double_bits(msg->voltage_double) != 0) {
+    if (!pb_encode_varint(stream, 0x09) ||
+        !stream_fixed64(stream, double_bits(msg->voltage_double))) {
+      return false;
+    }
+  }
+  if (double_bits(msg->leaf_wetness_double) != 0) {
+    if (!pb_encode_varint(stream, 0x11) ||
+        !stream_fixed64(stream, double_bits(msg->leaf_wetness_double))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->voltage) != 0) {
+    if (!pb_encode_varint(stream, 0x1d) ||
+        !stream_fixed32(stream, float_bits(msg->voltage))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->leaf_wetness) != 0) {
+    if (!pb_encode_varint(stream, 0x25) ||
+        !stream_fixed32(stream, float_bits(msg->leaf_wetness))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t BME280Measurement_fast_size(const BME280Measurement *msg) {
+  size_t size = 0;
+  if (msg->pressure != 0) {
+    size += 1 + varint32_size(msg->pressure);
+  }
+  if (msg->temperature != 0) {
+    size += 1 + varint64_size((uint64_t)(int64_t)msg->temperature);
+  }
+  if (msg->humidity != 0) {
+    size += 1 + varint32_size(msg->humidity);
+  }
+  return size;
+}
+
+static uint8_t *BME280Measurement_fast_write(const BME280Measurement *msg, uint8_t *p) {
+  if (msg->pressure != 0) {
+    *p++ = 0x08;
+    p = write_varint32(p, msg->pressure);
+  }
+  if (msg->temperature != 0) {
+    *p++ = 0x10;
+    p = write_varint64(p, (uint64_t)(int64_t)msg->temperature);
+  }
+  if (msg->humidity != 0) {
+    *p++ = 0x18;
+    p = write_varint32(p, msg->humidity);
+  }
+  return p;
+}
+
+static bool BME280Measurement_fast_stream(const BME280Measurement *msg, pb_ostream_t *stream) {
+  if (msg->pressure != 0) {
+    if (!pb_encode_varint(stream, 0x08) ||
+        !pb_encode_varint(stream, msg->pressure)) {
+      return false;
+    }
+  }
+  if (msg->temperature != 0) {
+    if (!pb_encode_varint(stream, 0x10) ||
+        !pb_encode_varint(stream, (uint64_t)(int64_t)msg->temperature)) {
+      return false;
+    }
+  }
+  if (msg->humidity != 0) {
+    if (!pb_encode_varint(stream, 0x18) ||
+        !pb_encode_varint(stream, msg->humidity)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t Teros21Measurement_fast_size(const Teros21Measurement *msg) {
+  size_t size = 0;
+  if (double_bits(msg->matric_pot_double) != 0) {
+    size += 1 + 8;
+  }
+  if (double_bits(msg->temp_double) != 0) {
+    size += 1 + 8;
+  }
+  if (float_bits(msg->matric_pot) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->temp) != 0) {
+    size += 1 + 4;
+  }
+  return size;
+}
+
+static uint8_t *Teros21Measurement_fast_write(const Teros21Measurement *msg, uint8_t *p) {
+  if (double_bits(msg->matric_pot_double) != 0) {
+    *p++ = 0x09;
+    p = write_fixed64(p, double_bits(msg->matric_pot_double));
+  }
+  if (double_bits(msg->temp_double) != 0) {
+    *p++ = 0x11;
+    p = write_fixed64(p, double_bits(msg->temp_double));
+  }
+  if (float_bits(msg->matric_pot) != 0) {
+    *p++ = 0x1d;
+    p = write_fixed32(p, float_bits(msg->matric_pot));
+  }
+  if (float_bits(msg->temp) != 0) {
+    *p++ = 0x25;
+    p = write_fixed32(p, float_bits(msg->temp));
+  }
+  return p;
+}
+
+static bool Teros21Measurement_fast_stream(const Teros21Measurement *msg, pb_ostream_t *stream) {
+  if (double_bits(msg->matric_pot_double) != 0) {
+    if (!pb_encode_varint(stream, 0x09) ||
+        !stream_fixed64(stream, double_bits(msg->matric_pot_double))) {
+      return false;
+    }
+  }
+  if (double_bits(msg->temp_double) != 0) {
+    if (!pb_encode_varint(stream, 0x11) ||
+        !stream_fixed64(stream, double_bits(msg->temp_double))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->matric_pot) != 0) {
+    if (!pb_encode_varint(stream, 0x1d) ||
+        !stream_fixed32(stream, float_bits(msg->matric_pot))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->temp) != 0) {
+    if (!pb_encode_varint(stream, 0x25) ||
+        !stream_fixed32(stream, float_bits(msg->temp))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t PowerSummary_fast_size(const PowerSummary *msg) {
+  size_t size = 0;
+  if (msg->count != 0) {
+    size += 1 + varint32_size(msg->count);
+  }
+  if (float_bits(msg->voltage_mean) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->voltage_min) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->voltage_max) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->voltage_stddev) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->current_mean) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->current_min) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->current_max) != 0) {
+    size += 1 + 4;
+  }
+  if (float_bits(msg->current_stddev) != 0) {
+    size += 1 + 4;
+  }
+  return size;
+}
+
+static uint8_t *PowerSummary_fast_write(const PowerSummary *msg, uint8_t *p) {
+  if (msg->count != 0) {
+    *p++ = 0x08;
+    p = write_varint32(p, msg->count);
+  }
+  if (float_bits(msg->voltage_mean) != 0) {
+    *p++ = 0x15;
+    p = write_fixed32(p, float_bits(msg->voltage_mean));
+  }
+  if (float_bits(msg->voltage_min) != 0) {
+    *p++ = 0x1d;
+    p = write_fixed32(p, float_bits(msg->voltage_min));
+  }
+  if (float_bits(msg->voltage_max) != 0) {
+    *p++ = 0x25;
+    p = write_fixed32(p, float_bits(msg->voltage_max));
+  }
+  if (float_bits(msg->voltage_stddev) != 0) {
+    *p++ = 0x2d;
+    p = write_fixed32(p, float_bits(msg->voltage_stddev));
+  }
+  if (float_bits(msg->current_mean) != 0) {
+    *p++ = 0x35;
+    p = write_fixed32(p, float_bits(msg->current_mean));
+  }
+  if (float_bits(msg->current_min) != 0) {
+    *p++ = 0x3d;
+    p = write_fixed32(p, float_bits(msg->current_min));
+  }
+  if (float_bits(msg->current_max) != 0) {
+    *p++ = 0x45;
+    p = write_fixed32(p, float_bits(msg->current_max));
+  }
+  if (float_bits(msg->current_stddev) != 0) {
+    *p++ = 0x4d;
+    p = write_fixed32(p, float_bits(msg->current_stddev));
+  }
+  return p;
+}
+
+static bool PowerSummary_fast_stream(const PowerSummary *msg, pb_ostream_t *stream) {
+  if (msg->count != 0) {
+    if (!pb_encode_varint(stream, 0x08) ||
+        !pb_encode_varint(stream, msg->count)) {
+      return false;
+    }
+  }
+  if (float_bits(msg->voltage_mean) != 0) {
+    if (!pb_encode_varint(stream, 0x15) ||
+        !stream_fixed32(stream, float_bits(msg->voltage_mean))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->voltage_min) != 0) {
+    if (!pb_encode_varint(stream, 0x1d) ||
+        !stream_fixed32(stream, float_bits(msg->voltage_min))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->voltage_max) != 0) {
+    if (!pb_encode_varint(stream, 0x25) ||
+        !stream_fixed32(stream, float_bits(msg->voltage_max))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->voltage_stddev) != 0) {
+    if (!pb_encode_varint(stream, 0x2d) ||
+        !stream_fixed32(stream, float_bits(msg->voltage_stddev))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->current_mean) != 0) {
+    if (!pb_encode_varint(stream, 0x35) ||
+        !stream_fixed32(stream, float_bits(msg->current_mean))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->current_min) != 0) {
+    if (!pb_encode_varint(stream, 0x3d) ||
+        !stream_fixed32(stream, float_bits(msg->current_min))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->current_max) != 0) {
+    if (!pb_encode_varint(stream, 0x45) ||
+        !stream_fixed32(stream, float_bits(msg->current_max))) {
+      return false;
+    }
+  }
+  if (float_bits(msg->current_stddev) != 0) {
+    if (!pb_encode_varint(stream, 0x4d) ||
+        !stream_fixed32(stream, float_bits(msg->current_stddev))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t PowerBurst_fast_size(const PowerBurst *msg) {
+  size_t size = 0;
+  if (msg->burst_id != 0) {
+    size += 1 + varint32_size(msg->burst_id);
+  }
+  if (msg->current != 0) {
+    size += 1 + 1;
+  }
+  if (msg->rate != 0) {
+    size += 1 + varint32_size(msg->rate);
+  }
+  if (msg->offset != 0) {
+    size += 1 + varint32_size(msg->offset);
+  }
+  if (msg->total != 0) {
+    size += 1 + varint32_size(msg->total);
+  }
+  if (msg->dropped != 0) {
+    size += 1 + varint32_size(msg->dropped);
+  }
+  if (msg->samples.size != 0) {
+    size += 1 + varint32_size(msg->samples.size) + msg->samples.size;
+  }
+  return size;
+}
+
+static uint8_t *PowerBurst_fast_write(const PowerBurst *msg, uint8_t *p) {
+  if (msg->burst_id != 0) {
+    *p++ = 0x08;
+    p = write_varint32(p, msg->burst_id);
+  }
+  if (msg->current != 0) {
+    *p++ = 0x10;
+    p = write_varint32(p, msg->current);
+  }
+  if (msg->rate != 0) {
+    *p++ = 0x18;
+    p = write_varint32(p, msg->rate);
+  }
+  if (msg->offset != 0) {
+    *p++ = 0x20;
+    p = write_varint32(p, msg->offset);
+  }
+  if (msg->total != 0) {
+    *p++ = 0x28;
+    p = write_varint32(p, msg->total);
+  }
+  if (msg->dropped != 0) {
+    *p++ = 0x30;
+    p = write_varint32(p, msg->dropped);
+  }
+  if (msg->samples.size != 0) {
+    *p++ = 0x3a;
+    p = write_varint32(p, msg->samples.size);
+    memcpy(p, msg->samples.bytes, msg->samples.size);
+    p += msg->samples.size;
+  }
+  return p;
+}
+
+static bool PowerBurst_fast_stream(const PowerBurst *msg, pb_ostream_t *stream) {
+  if (msg->burst_id != 0) {
+    if (!pb_encode_varint(stream, 0x08) ||
+        !pb_encode_varint(stream, msg->burst_id)) {
+      return false;
+    }
+  }
+  if (msg->current != 0) {
+    if (!pb_encode_varint(stream, 0x10) ||
+        !pb_encode_varint(stream, msg->current)) {
+      return false;
+    }
+  }
+  if (msg->rate != 0) {
+    if (!pb_encode_varint(stream, 0x18) ||
+        !pb_encode_varint(stream, msg->rate)) {
+      return false;
+    }
+  }
+  if (msg->offset != 0) {
+    if (!pb_encode_varint(stream, 0x20) ||
+        !pb_encode_varint(stream, msg->offset)) {
+      return false;
+    }
+  }
+  if (msg->total != 0) {
+    if (!pb_encode_varint(stream, 0x28) ||
+        !pb_encode_varint(stream, msg->total)) {
+      return false;
+    }
+  }
+  if (msg->dropped != 0) {
+    if (!pb_encode_varint(stream, 0x30) ||
+        !pb_encode_varint(stream, msg->dropped)) {
+      return false;
+    }
+  }
+  if (msg->samples.size != 0) {
+    if (!pb_encode_varint(stream, 0x3a) ||
+        !pb_encode_string(stream, msg->samples.bytes, msg->samples.size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static size_t Measurement_fast_size(const Measurement *msg) {
+  size_t size = 0;
+  if (msg->has_meta) {
+    const size_t sub = MeasurementMetadata_fast_size(&msg->meta);
+    size += 1 + varint32_size(sub) + sub;
+  }
+  switch (msg->which_measurement) {
+    case Measurement_power_tag: {
+      const size_t sub = PowerMeasurement_fast_size(&msg->measurement.power);
+      size += 1 + varint32_size(sub) + sub;
+      break;
+    }
+    case Measurement_teros12_tag: {
+      const size_t sub = Teros12Measurement_fast_size(&msg->measurement.teros12);
+      size += 1 + varint32_size(sub) + sub;
+      break;
+    }
+    case Measurement_phytos31_tag: {
+      const size_t sub = Phytos31Measurement_fast_size(&msg->measurement.phytos31);
+      size += 1 + varint32_size(sub) + sub;
+      break;
+    }
+    case Measurement_bme280_tag: {
+      const size_t sub = BME280Measurement_fast_size(&msg->measurement.bme280);
+      size += 1 + varint32_size(sub) + sub;
+      break;
+    }
+    case Measurement_teros21_tag: {
+      const size_t sub = Teros21Measurement_fast_size(&msg->measurement.teros21);
+      size += 1 + varint32_size(sub) + sub;
+      break;
+    }
+    case Measurement_power_summary_tag: {
+      const size_t sub = PowerSummary_fast_size(&msg->measurement.power_summary);
+      size += 1 + varint32_size(sub) + sub;
+      break;
+    }
+    case Measurement_power_burst_tag: {
+      const size_t sub = PowerBurst_fast_size(&msg->measurement.power_burst);
+      size += 1 + varint32_size(sub) + sub;
+      break;
+    }
+    default:
+      break;
+  }
+  return size;
+}
+
+static uint8_t *Measurement_fast_write(const Measurement *msg, uint8_t *p) {
+  if (msg->has_meta) {
+    *p++ = 0x0a;
+    p = write_varint32(p, MeasurementMetadata_fast_size(&msg->meta));
+    p = MeasurementMetadata_fast_write(&msg->meta, p);
+  }
+  switch (msg->which_measurement) {
+    case Measurement_power_tag: {
+      *p++ = 0x12;
+      p = write_varint32(p, PowerMeasurement_fast_size(&msg->measurement.power));
+      p = PowerMeasurement_fast_write(&msg->measurement.power, p);
+      break;
+    }
+    case Measurement_teros12_tag: {
+      *p++ = 0x1a;
+      p = write_varint32(p, Teros12Measurement_fast_size(&msg->measurement.teros12));
+      p = Teros12Measurement_fast_write(&msg->measurement.teros12, p);
+      break;
+    }
+    case Measurement_phytos31_tag: {
+      *p++ = 0x22;
+      p = write_varint32(p, Phytos31Measurement_fast_size(&msg->measurement.phytos31));
+      p = Phytos31Measurement_fast_write(&msg->measurement.phytos31, p);
+      break;
+    }
+    case Measurement_bme280_tag: {
+      *p++ = 0x2a;
+      p = write_varint32(p, BME280Measurement_fast_size(&msg->measurement.bme280));
+      p = BME280Measurement_fast_write(&msg->measurement.bme280, p);
+      break;
+    }
+    case Measurement_teros21_tag: {
+      *p++ = 0x32;
+      p = write_varint32(p, Teros21Measurement_fast_size(&msg->measurement.teros21));
+      p = Teros21Measurement_fast_write(&msg->measurement.teros21, p);
+      break;
+    }
+    case Measurement_power_summary_tag: {
+      *p++ = 0x3a;
+      p = write_varint32(p, PowerSummary_fast_size(&msg->measurement.power_summary));
+      p = PowerSummary_fast_write(&msg->measurement.power_summary, p);
+      break;
+    }
+    case Measurement_power_burst_tag: {
+      *p++ = 0x42;
+      p = write_varint32(p, PowerBurst_fast_size(&msg->measurement.power_burst));
+      p = PowerBurst_fast_write(&msg->measurement.power_burst, p);
+      break;
+    }
+    default:
+      break;
+  }
+  return p;
+}
+
+static bool Measurement_fast_stream(const Measurement *msg, pb_ostream_t *stream) {
+  if (msg->has_meta) {
+    if (!pb_encode_varint(stream, 0x0a) ||
+        !pb_encode_varint(stream, MeasurementMetadata_fast_size(&msg->meta)) ||
+        !MeasurementMetadata_fast_stream(&msg->meta, stream)) {
+      return false;
+    }
+  }
+  switch (msg->which_measurement) {
+    case Measurement_power_tag: {
+      if (!pb_encode_varint(stream, 0x12) ||
+          !pb_encode_varint(stream, PowerMeasurement_fast_size(&msg->measurement.power)) ||
+          !PowerMeasurement_fast_stream(&msg->measurement.power, stream)) {
+        return false;
+      }
+      break;
+    }
+    case Measurement_teros12_tag: {
+      if (!pb_encode_varint(stream, 0x1a) ||
+          !pb_encode_varint(stream, Teros12Measurement_fast_size(&msg->measurement.teros12)) ||
+          !Teros12Measurement_fast_stream(&msg->measurement.teros12, stream)) {
+        return false;
+      }
+      break;
+    }
+    case Measurement_phytos31_tag: {
+      if (!pb_encode_varint(stream, 0x22) ||
+          !pb_encode_varint(stream, Phytos31Measurement_fast_size(&msg->measurement.phytos31)) ||
+          !Phytos31Measurement_fast_stream(&msg->measurement.phytos31, stream)) {
+        return false;
+      }
+      break;
+    }
+    case Measurement_bme280_tag: {
+      if (!pb_encode_varint(stream, 0x2a) ||
+          !pb_encode_varint(stream, BME280Measurement_fast_size(&msg->measurement.bme280)) ||
+          !BME280Measurement_fast_stream(&msg->measurement.bme280, stream)) {
+        return false;
+      }
+      break;
+    }
+    case Measurement_teros21_tag: {
+      if (!pb_encode_varint(stream, 0x32) ||
+          !pb_encode_varint(stream, Teros21Measurement_fast_size(&msg->measurement.teros21)) ||
+          !Teros21Measurement_fast_stream(&msg->measurement.teros21, stream)) {
+        return false;
+      }
+      break;
+    }
+    case Measurement_power_summary_tag: {
+      if (!pb_encode_varint(stream, 0x3a) ||
+          !pb_encode_varint(stream, PowerSummary_fast_size(&msg->measurement.power_summary)) ||
+          !PowerSummary_fast_stream(&msg->measurement.power_summary, stream)) {
+        return false;
+      }
+      break;
+    }
+    case Measurement_power_burst_tag: {
+      if (!pb_encode_varint(stream, 0x42) ||
+          !pb_encode_varint(stream, PowerBurst_fast_size(&msg->measurement.power_burst)) ||
+          !PowerBurst_fast_stream(&msg->measurement.power_burst, stream)) {
+        return false;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
+
+size_t Measurement_fast_encoded_size(const Measurement *msg) {
+  return Measurement_fast_size(msg);
+}
+
+bool Measurement_fast_encode(const Measurement *msg, uint8_t *buffer,
+                             size_t size, size_t *len) {
+  const size_t msg_size = Measurement_fast_size(msg);
+  if (msg_size > size) {
+    return false;
+  }
+
+  Measurement_fast_write(msg, buffer);
+  *len = msg_size;
+  return true;
+}
+
+bool Measurement_fast_encode_stream(const Measurement *msg, pb_ostream_t *stream) {
+  return Measurement_fast_stream(msg, stream);
+}
@@ -24,16 +24,40 @@ PB_BIND(Phytos31Measurement, Phytos31Measurement, AUTO)
 PB_BIND(BME280Measurement, BME280Measurement, AUTO)
 
 
+PB_BIND(PowerSummary, PowerSummary, AUTO)
+
+
+PB_BIND(PowerBurst, PowerBurst, AUTO)
+
+
 PB_BIND(Measurement, Measurement, AUTO)
 
 
+PB_BIND(PowerBatch, PowerBatch, 2)
+
+
+PB_BIND(Teros12Batch, Teros12Batch, 2)
+
+
+PB_BIND(Teros21Batch, Teros21Batch, 2)
+
+
+PB_BIND(Phytos31Batch, Phytos31Batch, 2)
+
+
+PB_BIND(BME280Batch, BME280Batch, 2)
+
+
+PB_BIND(MeasurementBatch, MeasurementBatch, 2)
+
+
 PB_BIND(Response, Response, AUTO)
 
 
 PB_BIND(Esp32Command, Esp32Command, 2)
 
 
-PB_BIND(PageCommand, PageCommand, AUTO)
+PB_BIND(PageCommand, PageCommand, 2)
 
 
 PB_BIND(TestCommand, TestCommand, AUTO)
@@ -9,8 +9,11 @@
 
 #include "transcoder.h"
 
+#include <stddef.h>
+
 #include "pb_decode.h"
 #include "pb_encode.h"
+#include "soil_power_sensor.fast.h"
 
 /**
  * @brief Encodes a measurement
@@ -20,120 +23,407 @@
  * error.
  *
  * @param meas Measurement
- * @param buffer Buffer to store serialized measurement
+ * @param buffer Buffer to store serialized measurement of at least
+ * Measurement_size bytes
  * @return Length of buffer, -1 indicates there was an error
  */
 size_t EncodeMeasurement(Measurement *meas, uint8_t *buffer);
 
 /**
- * @brief Encodes a esp32command
+ * @brief Encodes a measurement into a stream
+ *
+ * The measurement is serialized with the generated fast encoder directly into
+ * the stream, without a buffer on the stack.
+ *
+ * @param meas Measurement
+ * @param ostream Output stream
+ * @return true on success, false if the stream failed
+ */
+bool EncodeMeasurementStream(const Measurement *meas, pb_ostream_t *ostream);
+
+/**
+ * @brief Encodes a command as the only field of an esp32command
  *
- * Serializes a esp32command object and stores result in buffer. The resulting
- * number of bytes is returned with -1 indicating there was an error.
+ * The output is the same as encoding an Esp32Command with the command set, but
+ * the command is encoded from @p msg without copying it into an Esp32Command.
  *
- * @param cmd Reference to command
+ * @param tag Field number of the command in Esp32Command
+ * @param fields Fields of the command
+ * @param msg Command to encode
  * @param buffer Buffer to store serialized esp32command
  * @param size Size of buffer
  *
  * @return Length of buffer, -1 indicates there was an error
  */
-size_t EncodeEsp32Command(const Esp32Command *cmd, uint8_t *buffer,
-                          size_t size);
+static size_t EncodeEsp32Submessage(pb_size_t tag, const pb_msgdesc_t *fields,
+                                    const void *msg, uint8_t *buffer,
+                                    size_t size);
+
+/**
+ * @brief Decodes a command from an esp32command
+ *
+ * The command is decoded directly into @p msg without an intermediate
+ * Esp32Command. Other fields of the esp32command are skipped.
+ *
+ * @param data Serialized esp32command
+ * @param len Length of @p data
+ * @param tag Field number of the command in Esp32Command
+ * @param fields Fields of the command
+ * @param msg Decoded command
+ *
+ * @return 0 on success, -1 if decoding failed or the esp32command does not
+ * contain the command
+ */
+static int DecodeEsp32Submessage(const uint8_t *data, const size_t len,
+                                 pb_size_t tag, const pb_msgdesc_t *fields,
+                                 void *msg);
+
+/**
+ * @brief Fills a power measurement
+ *
+ * @param meas Measurement to fill
+ *
+ * @see EncodePowerMeasurement
+ */
+static void BuildPowerMeasurement(Measurement *meas, uint32_t ts,
+                                  uint32_t logger_id, uint32_t cell_id,
+                                  double voltage, double current) {
+  *meas = (Measurement)Measurement_init_zero;
+
+  meas->has_meta = true;
+
+  meas->meta.ts = ts;
+  meas->meta.logger_id = logger_id;
+  meas->meta.cell_id = cell_id;
+
+  meas->which_measurement = Measurement_power_tag;
+#ifdef TRANSCODER_ENCODE_DOUBLE
+  meas->measurement.power.voltage_double = voltage;
+  meas->measurement.power.current_double = current;
+#else
+  meas->measurement.power.voltage = (float)voltage;
+  meas->measurement.power.current = (float)current;
+#endif /* TRANSCODER_ENCODE_DOUBLE */
+}
 
 size_t EncodePowerMeasurement(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
                               double voltage, double current, uint8_t *buffer) {
-  Measurement meas = Measurement_init_zero;
+  Measurement meas;
+  BuildPowerMeasurement(&meas, ts, logger_id, cell_id, voltage, current);
+  return EncodeMeasurement(&meas, buffer);
+}
 
-  meas.has_meta = true;
+bool EncodePowerMeasurementStream(uint32_t ts, uint32_t logger_id,
+                                  uint32_t cell_id, double voltage,
+                                  double current, pb_ostream_t *ostream) {
+  Measurement meas;
+  BuildPowerMeasurement(&meas, ts, logger_id, cell_id, voltage, current);
+  return EncodeMeasurementStream(&meas, ostream);
+}
 
-  meas.meta.ts = ts;
-  meas.meta.logger_id = logger_id;
-  meas.meta.cell_id = cell_id;
+/**
+ * @brief Fills a Teros12 measurement
+ *
+ * @param meas Measurement to fill
+ *
+ * @see EncodeTeros12Measurement
+ */
+static void BuildTeros12Measurement(Measurement *meas, uint32_t ts,
+                                    uint32_t logger_id, uint32_t cell_id,
+                                    double vwc_raw, double vwc_adj,
+                                    double temp, uint32_t ec) {
+  *meas = (Measurement)Measurement_init_zero;
 
-  meas.which_measurement = Measurement_power_tag;
-  meas.measurement.power.voltage = voltage;
-  meas.measurement.power.current = current;
+  meas->has_meta = true;
 
-  return EncodeMeasurement(&meas, buffer);
+  meas->meta.ts = ts;
+  meas->meta.logger_id = logger_id;
+  meas->meta.cell_id = cell_id;
+
+  meas->which_measurement = Measurement_teros12_tag;
+#ifdef TRANSCODER_ENCODE_DOUBLE
+  meas->measurement.teros12.vwc_raw_double = vwc_raw;
+  meas->measurement.teros12.vwc_adj_double = vwc_adj;
+  meas->measurement.teros12.temp_double = temp;
+#else
+  meas->measurement.teros12.vwc_raw = (float)vwc_raw;
+  meas->measurement.teros12.vwc_adj = (float)vwc_adj;
+  meas->measurement.teros12.temp = (float)temp;
+#endif /* TRANSCODER_ENCODE_DOUBLE */
+  meas->measurement.teros12.ec = ec;
 }
 
 size_t EncodeTeros12Measurement(uint32_t ts, uint32_t logger_id,
                                 uint32_t cell_id, double vwc_raw,
                                 double vwc_adj, double temp, uint32_t ec,
                                 uint8_t *buffer) {
-  Measurement meas = Measurement_init_zero;
+  Measurement meas;
+  BuildTeros12Measurement(&meas, ts, logger_id, cell_id, vwc_raw, vwc_adj,
+                          temp, ec);
+  return EncodeMeasurement(&meas, buffer);
+}
 
-  meas.has_meta = true;
+bool EncodeTeros12MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                    uint32_t cell_id, double vwc_raw,
+                                    double vwc_adj, double temp, uint32_t ec,
+                                    pb_ostream_t *ostream) {
+  Measurement meas;
+  BuildTeros12Measurement(&meas, ts, logger_id, cell_id, vwc_raw, vwc_adj,
+                          temp, ec);
+  return EncodeMeasurementStream(&meas, ostream);
+}
 
-  meas.meta.ts = ts;
-  meas.meta.logger_id = logger_id;
-  meas.meta.cell_id = cell_id;
+/**
+ * @brief Fills a Phytos31 measurement
+ *
+ * @param meas Measurement to fill
+ *
+ * @see EncodePhytos31Measurement
+ */
+static void BuildPhytos31Measurement(Measurement *meas, uint32_t ts,
+                                     uint32_t logger_id, uint32_t cell_id,
+                                     double voltage, double leaf_wetness) {
+  *meas = (Measurement)Measurement_init_zero;
 
-  meas.which_measurement = Measurement_teros12_tag;
-  meas.measurement.teros12.vwc_raw = vwc_raw;
-  meas.measurement.teros12.vwc_adj = vwc_adj;
-  meas.measurement.teros12.temp = temp;
-  meas.measurement.teros12.ec = ec;
+  meas->has_meta = true;
 
-  return EncodeMeasurement(&meas, buffer);
+  meas->meta.ts = ts;
+  meas->meta.logger_id = logger_id;
+  meas->meta.cell_id = cell_id;
+
+  meas->which_measurement = Measurement_phytos31_tag;
+#ifdef TRANSCODER_ENCODE_DOUBLE
+  meas->measurement.phytos31.voltage_double = voltage;
+  meas->measurement.phytos31.leaf_wetness_double = leaf_wetness;
+#else
+  meas->measurement.phytos31.voltage = (float)voltage;
+  meas->measurement.phytos31.leaf_wetness = (float)leaf_wetness;
+#endif /* TRANSCODER_ENCODE_DOUBLE */
 }
 
 size_t EncodePhytos31Measurement(uint32_t ts, uint32_t logger_id,
                                  uint32_t cell_id, double voltage,
                                  double leaf_wetness, uint8_t *buffer) {
-  Measurement meas = Measurement_init_zero;
+  Measurement meas;
+  BuildPhytos31Measurement(&meas, ts, logger_id, cell_id, voltage,
+                           leaf_wetness);
+  return EncodeMeasurement(&meas, buffer);
+}
 
-  meas.has_meta = true;
+bool EncodePhytos31MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                     uint32_t cell_id, double voltage,
+                                     double leaf_wetness,
+                                     pb_ostream_t *ostream) {
+  Measurement meas;
+  BuildPhytos31Measurement(&meas, ts, logger_id, cell_id, voltage,
+                           leaf_wetness);
+  return EncodeMeasurementStream(&meas, ostream);
+}
 
-  meas.meta.ts = ts;
-  meas.meta.logger_id = logger_id;
-  meas.meta.cell_id = cell_id;
+/**
+ * @brief Fills a BME280 measurement
+ *
+ * @param meas Measurement to fill
+ *
+ * @see EncodeBME280Measurement
+ */
+static void BuildBME280Measurement(Measurement *meas, uint32_t ts,
+                                   uint32_t logger_id, uint32_t cell_id,
+                                   uint32_t pressure, int32_t temperature,
+                                   uint32_t humidity) {
+  *meas = (Measurement)Measurement_init_zero;
 
-  meas.which_measurement = Measurement_phytos31_tag;
-  meas.measurement.phytos31.voltage = voltage;
-  meas.measurement.phytos31.leaf_wetness = leaf_wetness;
+  meas->has_meta = true;
 
-  return EncodeMeasurement(&meas, buffer);
+  meas->meta.ts = ts;
+  meas->meta.logger_id = logger_id;
+  meas->meta.cell_id = cell_id;
+
+  meas->which_measurement = Measurement_bme280_tag;
+  meas->measurement.bme280.pressure = pressure;
+  meas->measurement.bme280.temperature = temperature;
+  meas->measurement.bme280.humidity = humidity;
 }
 
 size_t EncodeBME280Measurement(uint32_t ts, uint32_t logger_id,
                                uint32_t cell_id, uint32_t pressure,
                                int32_t temperature, uint32_t humidity,
                                uint8_t *buffer) {
-  Measurement meas = Measurement_init_zero;
+  Measurement meas;
+  BuildBME280Measurement(&meas, ts, logger_id, cell_id, pressure, temperature,
+                         humidity);
+  return EncodeMeasurement(&meas, buffer);
+}
 
-  meas.has_meta = true;
+bool EncodeBME280MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                   uint32_t cell_id, uint32_t pressure,
+                                   int32_t temperature, uint32_t humidity,
+                                   pb_ostream_t *ostream) {
+  Measurement meas;
+  BuildBME280Measurement(&meas, ts, logger_id, cell_id, pressure, temperature,
+                         humidity);
+  return EncodeMeasurementStream(&meas, ostream);
+}
 
-  meas.meta.ts = ts;
-  meas.meta.logger_id = logger_id;
-  meas.meta.cell_id = cell_id;
+/**
+ * @brief Fills a Teros21 measurement
+ *
+ * @param meas Measurement to fill
+ *
+ * @see EncodeTeros21Measurement
+ */
+static void BuildTeros21Measurement(Measurement *meas, uint32_t ts,
+                                    uint32_t logger_id, uint32_t cell_id,
+                                    double matric_pot, double temp) {
+  *meas = (Measurement)Measurement_init_zero;
 
-  meas.which_measurement = Measurement_bme280_tag;
-  meas.measurement.bme280.pressure = pressure;
-  meas.measurement.bme280.temperature = temperature;
-  meas.measurement.bme280.humidity = humidity;
+  meas->has_meta = true;
 
-  return EncodeMeasurement(&meas, buffer);
+  meas->meta.ts = ts;
+  meas->meta.logger_id = logger_id;
+  meas->meta.cell_id = cell_id;
+
+  meas->which_measurement = Measurement_teros21_tag;
+#ifdef TRANSCODER_ENCODE_DOUBLE
+  meas->measurement.teros21.matric_pot_double = matric_pot;
+  meas->measurement.teros21.temp_double = temp;
+#else
+  meas->measurement.teros21.matric_pot = (float)matric_pot;
+  meas->measurement.teros21.temp = (float)temp;
+#endif /* TRANSCODER_ENCODE_DOUBLE */
 }
 
 size_t EncodeTeros21Measurement(uint32_t ts, uint32_t logger_id,
                                 uint32_t cell_id, double matric_pot,
                                 double temp, uint8_t *buffer) {
-  Measurement meas = Measurement_init_zero;
+  Measurement meas;
+  BuildTeros21Measurement(&meas, ts, logger_id, cell_id, matric_pot, temp);
+  return EncodeMeasurement(&meas, buffer);
+}
+
+bool EncodeTeros21MeasurementStream(uint32_t ts, uint32_t logger_id,
+                                    uint32_t cell_id, double matric_pot,
+                                    double temp, pb_ostream_t *ostream) {
+  Measurement meas;
+  BuildTeros21Measurement(&meas, ts, logger_id, cell_id, matric_pot, temp);
+  return EncodeMeasurementStream(&meas, ostream);
+}
+
+/**
+ * @brief Fills a power summary
+ *
+ * @param meas Measurement to fill
+ *
+ * @see EncodePowerSummary
+ */
+static void BuildPowerSummary(Measurement *meas, uint32_t ts,
+                              uint32_t logger_id, uint32_t cell_id,
+                              const PowerSummary *summary) {
+  *meas = (Measurement)Measurement_init_zero;
+
+  meas->has_meta = true;
+
+  meas->meta.ts = ts;
+  meas->meta.logger_id = logger_id;
+  meas->meta.cell_id = cell_id;
+
+  meas->which_measurement = Measurement_power_summary_tag;
+  meas->measurement.power_summary = *summary;
+}
+
+size_t EncodePowerSummary(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
+                          const PowerSummary *summary, uint8_t *buffer) {
+  Measurement meas;
+  BuildPowerSummary(&meas, ts, logger_id, cell_id, summary);
+  return EncodeMeasurement(&meas, buffer);
+}
+
+bool EncodePowerSummaryStream(uint32_t ts, uint32_t logger_id,
+                              uint32_t cell_id, const PowerSummary *summary,
+                              pb_ostream_t *ostream) {
+  Measurement meas;
+  BuildPowerSummary(&meas, ts, logger_id, cell_id, summary);
+  return EncodeMeasurementStream(&meas, ostream);
+}
+
+/**
+ * @brief Fills a block of a power burst
+ *
+ * @param meas Measurement to fill
+ *
+ * @see EncodePowerBurst
+ */
+static void BuildPowerBurst(Measurement *meas, uint32_t ts, uint32_t logger_id,
+                            uint32_t cell_id, const PowerBurst *burst) {
+  *meas = (Measurement)Measurement_init_zero;
 
-  meas.has_meta = true;
+  meas->has_meta = true;
 
-  meas.meta.ts = ts;
-  meas.meta.logger_id = logger_id;
-  meas.meta.cell_id = cell_id;
+  meas->meta.ts = ts;
+  meas->meta.logger_id = logger_id;
+  meas->meta.cell_id = cell_id;
 
-  meas.which_measurement = Measurement_teros21_tag;
-  meas.measurement.teros21.matric_pot = matric_pot;
-  meas.measurement.teros21.temp = temp;
+  meas->which_measurement = Measurement_power_burst_tag;
+  meas->measurement.power_burst = *burst;
+}
 
+size_t EncodePowerBurst(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
+                        const PowerBurst *burst, uint8_t *buffer) {
+  Measurement meas;
+  BuildPowerBurst(&meas, ts, logger_id, cell_id, burst);
   return EncodeMeasurement(&meas, buffer);
 }
 
+bool EncodePowerBurstStream(uint32_t ts, uint32_t logger_id, uint32_t cell_id,
+                            const PowerBurst *burst, pb_ostream_t *ostream) {
+  Measurement meas;
+  BuildPowerBurst(&meas, ts, logger_id, cell_id, burst);
+  return EncodeMeasurementStream(&meas, ostream);
+}
+
+size_t EncodeBurstSamples(const int32_t *samples, size_t count,
+                          uint8_t *buffer, size_t size, size_t *len) {
+  size_t written = 0;
+  int32_t prev = 0;
+
+  size_t i;
+  for (i = 0; i < count; i++) {
+    // encoded separately to check the sample fits
+    uint8_t varint[10];
+    pb_ostream_t ostream = pb_ostream_from_buffer(varint, sizeof(varint));
+    pb_encode_svarint(&ostream, (int64_t)samples[i] - prev);
+    if (written + ostream.bytes_written > size) {
+      break;
+    }
+
+    memcpy(buffer + written, varint, ostream.bytes_written);
+    written += ostream.bytes_written;
+    prev = samples[i];
+  }
+
+  *len = written;
+  return i;
+}
+
+int DecodeBurstSamples(const uint8_t *data, size_t len, int32_t *samples,
+                       size_t max) {
+  pb_istream_t istream = pb_istream_from_buffer(data, len);
+  int64_t sample = 0;
+
+  size_t count = 0;
+  while (istream.bytes_left > 0) {
+    int64_t diff;
+    if (count >= max || !pb_decode_svarint(&istream, &diff)) {
+      return -1;
+    }
+
+    sample += diff;
+    samples[count++] = (int32_t)sample;
+  }
+
+  return (int)count;
+}
+
 Response_ResponseType DecodeResponse(const uint8_t *data, const size_t len) {
   Response resp;
 
@@ -150,69 +440,745 @@ Response_ResponseType DecodeResponse(const uint8_t *data, const size_t len) {
 }
 
 size_t EncodeMeasurement(Measurement *meas, uint8_t *buffer) {
-  // create output stream
-  pb_ostream_t ostream = pb_ostream_from_buffer(buffer, 256);
+  size_t len = 0;
   // encode message and check rc
-  bool status = pb_encode(&ostream, Measurement_fields, meas);
+  bool status = Measurement_fast_encode(meas, buffer, Measurement_size, &len);
   if (!status) {
     return -1;
   }
 
   // return number of bytes written
+  return len;
+}
+
+bool EncodeMeasurementStream(const Measurement *meas, pb_ostream_t *ostream) {
+  return Measurement_fast_encode_stream(meas, ostream);
+}
+
+/**
+ * @brief Copies values of deprecated double fields to the float fields
+ *
+ * Measurements only set one of the fields, so a float field that is zero
+ * takes the value of the double field.
+ *
+ * @param meas Decoded measurement
+ */
+static void UpgradeDoubleValues(Measurement *meas) {
+  switch (meas->which_measurement) {
+    case Measurement_power_tag: {
+      PowerMeasurement *m = &meas->measurement.power;
+      if (m->voltage == 0) {
+        m->voltage = (float)m->voltage_double;
+      }
+      if (m->current == 0) {
+        m->current = (float)m->current_double;
+      }
+      break;
+    }
+    case Measurement_teros12_tag: {
+      Teros12Measurement *m = &meas->measurement.teros12;
+      if (m->vwc_raw == 0) {
+        m->vwc_raw = (float)m->vwc_raw_double;
+      }
+      if (m->vwc_adj == 0) {
+        m->vwc_adj = (float)m->vwc_adj_double;
+      }
+      if (m->temp == 0) {
+        m->temp = (float)m->temp_double;
+      }
+      break;
+    }
+    case Measurement_phytos31_tag: {
+      Phytos31Measurement *m = &meas->measurement.phytos31;
+      if (m->voltage == 0) {
+        m->voltage = (float)m->voltage_double;
+      }
+      if (m->leaf_wetness == 0) {
+        m->leaf_wetness = (float)m->leaf_wetness_double;
+      }
+      break;
+    }
+    case Measurement_teros21_tag: {
+      Teros21Measurement *m = &meas->measurement.teros21;
+      if (m->matric_pot == 0) {
+        m->matric_pot = (float)m->matric_pot_double;
+      }
+      if (m->temp == 0) {
+        m->temp = (float)m->temp_double;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+int DecodeMeasurement(const uint8_t *data, const size_t len,
+                      Measurement *meas) {
+  pb_istream_t istream = pb_istream_from_buffer(data, len);
+  bool status = pb_decode(&istream, Measurement_fields, meas);
+  if (!status) {
+    return -1;
+  }
+
+  UpgradeDoubleValues(meas);
+
+  return 0;
+}
+
+/**
+ * @brief Gets the batch type of a measurement type
+ *
+ * @param which_measurement Measurement tag
+ * @return Batch tag, 0 if the type can not be batched
+ */
+static pb_size_t BatchTag(pb_size_t which_measurement) {
+  switch (which_measurement) {
+    case Measurement_power_tag:
+      return MeasurementBatch_power_tag;
+    case Measurement_teros12_tag:
+      return MeasurementBatch_teros12_tag;
+    case Measurement_phytos31_tag:
+      return MeasurementBatch_phytos31_tag;
+    case Measurement_bme280_tag:
+      return MeasurementBatch_bme280_tag;
+    case Measurement_teros21_tag:
+      return MeasurementBatch_teros21_tag;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Appends the values of a measurement to the columns of a batch
+ *
+ * The type of the measurement must match the batch and the batch must not be
+ * full.
+ *
+ * @param batch Batch of measurements
+ * @param meas Measurement
+ */
+static void BatchPush(MeasurementBatch *batch, const Measurement *meas) {
+  switch (batch->which_batch) {
+    case MeasurementBatch_power_tag: {
+      PowerBatch *b = &batch->batch.power;
+      const PowerMeasurement *m = &meas->measurement.power;
+      b->voltage[b->voltage_count++] = m->voltage;
+      b->current[b->current_count++] = m->current;
+      break;
+    }
+    case MeasurementBatch_teros12_tag: {
+      Teros12Batch *b = &batch->batch.teros12;
+      const Teros12Measurement *m = &meas->measurement.teros12;
+      b->vwc_raw[b->vwc_raw_count++] = m->vwc_raw;
+      b->vwc_adj[b->vwc_adj_count++] = m->vwc_adj;
+      b->temp[b->temp_count++] = m->temp;
+      b->ec[b->ec_count++] = m->ec;
+      break;
+    }
+    case MeasurementBatch_phytos31_tag: {
+      Phytos31Batch *b = &batch->batch.phytos31;
+      const Phytos31Measurement *m = &meas->measurement.phytos31;
+      b->voltage[b->voltage_count++] = m->voltage;
+      b->leaf_wetness[b->leaf_wetness_count++] = m->leaf_wetness;
+      break;
+    }
+    case MeasurementBatch_bme280_tag: {
+      BME280Batch *b = &batch->batch.bme280;
+      const BME280Measurement *m = &meas->measurement.bme280;
+      b->pressure[b->pressure_count++] = m->pressure;
+      b->temperature[b->temperature_count++] = m->temperature;
+      b->humidity[b->humidity_count++] = m->humidity;
+      break;
+    }
+    case MeasurementBatch_teros21_tag: {
+      Teros21Batch *b = &batch->batch.teros21;
+      const Teros21Measurement *m = &meas->measurement.teros21;
+      b->matric_pot[b->matric_pot_count++] = m->matric_pot;
+      b->temp[b->temp_count++] = m->temp;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Removes the last values from the columns of a batch
+ *
+ * @param batch Batch of measurements
+ */
+static void BatchPop(MeasurementBatch *batch) {
+  switch (batch->which_batch) {
+    case MeasurementBatch_power_tag:
+      batch->batch.power.voltage_count--;
+      batch->batch.power.current_count--;
+      break;
+    case MeasurementBatch_teros12_tag:
+      batch->batch.teros12.vwc_raw_count--;
+      batch->batch.teros12.vwc_adj_count--;
+      batch->batch.teros12.temp_count--;
+      batch->batch.teros12.ec_count--;
+      break;
+    case MeasurementBatch_phytos31_tag:
+      batch->batch.phytos31.voltage_count--;
+      batch->batch.phytos31.leaf_wetness_count--;
+      break;
+    case MeasurementBatch_bme280_tag:
+      batch->batch.bme280.pressure_count--;
+      batch->batch.bme280.temperature_count--;
+      batch->batch.bme280.humidity_count--;
+      break;
+    case MeasurementBatch_teros21_tag:
+      batch->batch.teros21.matric_pot_count--;
+      batch->batch.teros21.temp_count--;
+      break;
+    default:
+      break;
+  }
+}
+
+int MeasurementBatchAdd(MeasurementBatch *batch, const Measurement *meas,
+                        size_t max_size) {
+  pb_size_t tag = BatchTag(meas->which_measurement);
+  if (tag == 0) {
+    return -1;
+  }
+
+  const size_t max_count =
+      sizeof(batch->ts_delta) / sizeof(batch->ts_delta[0]);
+  if (batch->ts_delta_count >= max_count) {
+    return -1;
+  }
+
+  // the first measurement sets the metadata and type of the batch
+  bool first = (batch->ts_delta_count == 0);
+  if (first) {
+    batch->has_meta = true;
+    batch->meta = meas->meta;
+    batch->which_batch = tag;
+  } else if (tag != batch->which_batch ||
+             meas->meta.cell_id != batch->meta.cell_id ||
+             meas->meta.logger_id != batch->meta.logger_id) {
+    return -1;
+  }
+
+  // timestamp of the previous measurement
+  uint32_t prev_ts = batch->meta.ts;
+  for (pb_size_t i = 0; i < batch->ts_delta_count; i++) {
+    prev_ts += (uint32_t)batch->ts_delta[i];
+  }
+
+  batch->ts_delta[batch->ts_delta_count++] = (int32_t)(meas->meta.ts - prev_ts);
+  BatchPush(batch, meas);
+
+  // undo if the batch no longer fits
+  size_t size = 0;
+  if (!pb_get_encoded_size(&size, MeasurementBatch_fields, batch) ||
+      size > max_size) {
+    BatchPop(batch);
+    batch->ts_delta_count--;
+    if (first) {
+      batch->has_meta = false;
+      batch->which_batch = 0;
+    }
+    return -1;
+  }
+
+  return 0;
+}
+
+int MeasurementBatchGet(const MeasurementBatch *batch, size_t idx,
+                        Measurement *meas) {
+  if (idx >= batch->ts_delta_count) {
+    return -1;
+  }
+
+  Measurement out = Measurement_init_zero;
+
+  out.has_meta = true;
+  out.meta = batch->meta;
+  for (size_t i = 0; i <= idx; i++) {
+    out.meta.ts += (uint32_t)batch->ts_delta[i];
+  }
+
+  switch (batch->which_batch) {
+    case MeasurementBatch_power_tag: {
+      const PowerBatch *b = &batch->batch.power;
+      if (idx >= b->voltage_count || idx >= b->current_count) {
+        return -1;
+      }
+      out.which_measurement = Measurement_power_tag;
+      out.measurement.power.voltage = b->voltage[idx];
+      out.measurement.power.current = b->current[idx];
+      break;
+    }
+    case MeasurementBatch_teros12_tag: {
+      const Teros12Batch *b = &batch->batch.teros12;
+      if (idx >= b->vwc_raw_count || idx >= b->vwc_adj_count ||
+          idx >= b->temp_count || idx >= b->ec_count) {
+        return -1;
+      }
+      out.which_measurement = Measurement_teros12_tag;
+      out.measurement.teros12.vwc_raw = b->vwc_raw[idx];
+      out.measurement.teros12.vwc_adj = b->vwc_adj[idx];
+      out.measurement.teros12.temp = b->temp[idx];
+      out.measurement.teros12.ec = b->ec[idx];
+      break;
+    }
+    case MeasurementBatch_phytos31_tag: {
+      const Phytos31Batch *b = &batch->batch.phytos31;
+      if (idx >= b->voltage_count || idx >= b->leaf_wetness_count) {
+        return -1;
+      }
+      out.which_measurement = Measurement_phytos31_tag;
+      out.measurement.phytos31.voltage = b->voltage[idx];
+      out.measurement.phytos31.leaf_wetness = b->leaf_wetness[idx];
+      break;
+    }
+    case MeasurementBatch_bme280_tag: {
+      const BME280Batch *b = &batch->batch.bme280;
+      if (idx >= b->pressure_count || idx >= b->temperature_count ||
+          idx >= b->humidity_count) {
+        return -1;
+      }
+      out.which_measurement = Measurement_bme280_tag;
+      out.measurement.bme280.pressure = b->pressure[idx];
+      out.measurement.bme280.temperature = b->temperature[idx];
+      out.measurement.bme280.humidity = b->humidity[idx];
+      break;
+    }
+    case MeasurementBatch_teros21_tag: {
+      const Teros21Batch *b = &batch->batch.teros21;
+      if (idx >= b->matric_pot_count || idx >= b->temp_count) {
+        return -1;
+      }
+      out.which_measurement = Measurement_teros21_tag;
+      out.measurement.teros21.matric_pot = b->matric_pot[idx];
+      out.measurement.teros21.temp = b->temp[idx];
+      break;
+    }
+    default:
+      return -1;
+  }
+
+  *meas = out;
+  return 0;
+}
+
+size_t EncodeMeasurementBatch(const MeasurementBatch *batch, uint8_t *buffer,
+                              size_t size) {
+  pb_ostream_t ostream = pb_ostream_from_buffer(buffer, size);
+  bool status = pb_encode(&ostream, MeasurementBatch_fields, batch);
+  if (!status) {
+    return -1;
+  }
+
   return ostream.bytes_written;
 }
 
-Esp32Command DecodeEsp32Command(const uint8_t *data, const size_t len) {
-  Esp32Command cmd;
+int DecodeMeasurementBatch(const uint8_t *data, const size_t len,
+                           MeasurementBatch *batch) {
+  pb_istream_t istream = pb_istream_from_buffer(data, len);
+  bool status = pb_decode(&istream, MeasurementBatch_fields, batch);
+  if (!status) {
+    return -1;
+  }
+
+  return 0;
+}
+
+/** Flag of the first byte of a compressed measurement marking keyframes */
+#define DELTA_KEYFRAME 0x80
+
+/**
+ * @brief Encoding of a value of a compressed measurement
+ */
+typedef enum {
+  /** XOR of the bits of a float */
+  DELTA_XOR32,
+  /** XOR of the bits of a double */
+  DELTA_XOR64,
+  /** Difference of a 32-bit integer */
+  DELTA_DIFF32,
+} DeltaEncoding;
+
+/**
+ * @brief Value of a compressed measurement
+ */
+typedef struct {
+  /** Offset of the value in Measurement */
+  size_t offset;
+  /** Encoding of the value */
+  DeltaEncoding encoding;
+} DeltaValue;
+
+/** Defines a value of a measurement type */
+#define DELTA_VALUE(type, field, encoding) \
+  {offsetof(Measurement, measurement.type.field), encoding}
+
+/** Values of power measurements in the order of the message fields */
+static const DeltaValue kPowerValues[] = {
+    DELTA_VALUE(power, voltage_double, DELTA_XOR64),
+    DELTA_VALUE(power, current_double, DELTA_XOR64),
+    DELTA_VALUE(power, voltage, DELTA_XOR32),
+    DELTA_VALUE(power, current, DELTA_XOR32),
+};
+
+/** Values of Teros12 measurements in the order of the message fields */
+static const DeltaValue kTeros12Values[] = {
+    DELTA_VALUE(teros12, vwc_raw_double, DELTA_XOR64),
+    DELTA_VALUE(teros12, vwc_adj_double, DELTA_XOR64),
+    DELTA_VALUE(teros12, temp_double, DELTA_XOR64),
+    DELTA_VALUE(teros12, ec, DELTA_DIFF32),
+    DELTA_VALUE(teros12, vwc_raw, DELTA_XOR32),
+    DELTA_VALUE(teros12, vwc_adj, DELTA_XOR32),
+    DELTA_VALUE(teros12, temp, DELTA_XOR32),
+};
+
+/** Values of Phytos31 measurements in the order of the message fields */
+static const DeltaValue kPhytos31Values[] = {
+    DELTA_VALUE(phytos31, voltage_double, DELTA_XOR64),
+    DELTA_VALUE(phytos31, leaf_wetness_double, DELTA_XOR64),
+    DELTA_VALUE(phytos31, voltage, DELTA_XOR32),
+    DELTA_VALUE(phytos31, leaf_wetness, DELTA_XOR32),
+};
+
+/** Values of BME280 measurements in the order of the message fields */
+static const DeltaValue kBME280Values[] = {
+    DELTA_VALUE(bme280, pressure, DELTA_DIFF32),
+    DELTA_VALUE(bme280, temperature, DELTA_DIFF32),
+    DELTA_VALUE(bme280, humidity, DELTA_DIFF32),
+};
+
+/** Values of Teros21 measurements in the order of the message fields */
+static const DeltaValue kTeros21Values[] = {
+    DELTA_VALUE(teros21, matric_pot_double, DELTA_XOR64),
+    DELTA_VALUE(teros21, temp_double, DELTA_XOR64),
+    DELTA_VALUE(teros21, matric_pot, DELTA_XOR32),
+    DELTA_VALUE(teros21, temp, DELTA_XOR32),
+};
 
+/**
+ * @brief Gets the values of a measurement type
+ *
+ * @param which Type of measurement
+ * @param count Number of values
+ * @return Values in the order of the message fields, NULL if the type is only
+ * stored as keyframes
+ */
+static const DeltaValue *GetDeltaValues(pb_size_t which, size_t *count) {
+  switch (which) {
+    case Measurement_power_tag:
+      *count = sizeof(kPowerValues) / sizeof(kPowerValues[0]);
+      return kPowerValues;
+    case Measurement_teros12_tag:
+      *count = sizeof(kTeros12Values) / sizeof(kTeros12Values[0]);
+      return kTeros12Values;
+    case Measurement_phytos31_tag:
+      *count = sizeof(kPhytos31Values) / sizeof(kPhytos31Values[0]);
+      return kPhytos31Values;
+    case Measurement_bme280_tag:
+      *count = sizeof(kBME280Values) / sizeof(kBME280Values[0]);
+      return kBME280Values;
+    case Measurement_teros21_tag:
+      *count = sizeof(kTeros21Values) / sizeof(kTeros21Values[0]);
+      return kTeros21Values;
+    default:
+      return NULL;
+  }
+}
+
+/**
+ * @brief Reads the bits of a value
+ *
+ * @param meas Measurement
+ * @param value Value to read
+ * @return Bits of the value
+ */
+static uint64_t DeltaLoad(const Measurement *meas, const DeltaValue *value) {
+  const uint8_t *ptr = (const uint8_t *)meas + value->offset;
+  if (value->encoding == DELTA_XOR64) {
+    uint64_t bits;
+    memcpy(&bits, ptr, sizeof(bits));
+    return bits;
+  }
+
+  uint32_t bits;
+  memcpy(&bits, ptr, sizeof(bits));
+  return bits;
+}
+
+/**
+ * @brief Writes the bits of a value
+ *
+ * @param meas Measurement
+ * @param value Value to write
+ * @param bits Bits of the value
+ */
+static void DeltaStore(Measurement *meas, const DeltaValue *value,
+                       uint64_t bits) {
+  uint8_t *ptr = (uint8_t *)meas + value->offset;
+  if (value->encoding == DELTA_XOR64) {
+    memcpy(ptr, &bits, sizeof(bits));
+  } else {
+    uint32_t bits32 = (uint32_t)bits;
+    memcpy(ptr, &bits32, sizeof(bits32));
+  }
+}
+
+/**
+ * @brief Checks if a measurement is stored as a keyframe
+ *
+ * @param stream Stream of the measurement
+ * @param meas Measurement
+ * @return true for a keyframe, false for a delta
+ */
+static bool DeltaIsKeyframe(const MeasurementDeltaStream *stream,
+                            const Measurement *meas) {
+  if (!stream->valid ||
+      stream->since_keyframe + 1 >= TRANSCODER_DELTA_KEYFRAME_INTERVAL) {
+    return true;
+  }
+
+  // deltas keep the metadata of the reference
+  const Measurement *ref = &stream->ref;
+  return meas->has_meta != ref->has_meta ||
+         meas->meta.cell_id != ref->meta.cell_id ||
+         meas->meta.logger_id != ref->meta.logger_id;
+}
+
+void MeasurementDeltaInit(MeasurementDelta *delta) {
+  memset(delta, 0, sizeof(MeasurementDelta));
+}
+
+size_t EncodeMeasurementDelta(const MeasurementDelta *delta,
+                              const Measurement *meas, uint8_t *buffer,
+                              size_t size) {
+  const pb_size_t which = meas->which_measurement;
+  if (which == 0 || which >= TRANSCODER_DELTA_STREAMS || size < 3) {
+    return -1;
+  }
+
+  size_t count = 0;
+  const DeltaValue *values = GetDeltaValues(which, &count);
+
+  const MeasurementDeltaStream *stream = &delta->streams[which];
+  buffer[1] = stream->seq + 1;
+
+  if (values == NULL || DeltaIsKeyframe(stream, meas)) {
+    buffer[0] = DELTA_KEYFRAME | which;
+    size_t len = 0;
+    if (!Measurement_fast_encode(meas, buffer + 2, size - 2, &len)) {
+      return -1;
+    }
+    return len + 2;
+  }
+
+  // compared as decoded, so float fields of double values are not stored
+  Measurement upgraded = *meas;
+  UpgradeDoubleValues(&upgraded);
+
+  buffer[0] = which;
+  uint8_t bitmap = 0;
+  pb_ostream_t ostream = pb_ostream_from_buffer(buffer + 3, size - 3);
+
+  // change of the interval between timestamps, usually zero
+  const uint32_t interval = meas->meta.ts - stream->ref.meta.ts;
+  if (!pb_encode_svarint(&ostream, (int32_t)(interval - stream->period))) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const uint64_t ref_bits = DeltaLoad(&stream->ref, &values[i]);
+    const uint64_t bits = DeltaLoad(&upgraded, &values[i]);
+    if (bits == ref_bits) {
+      continue;
+    }
+
+    bitmap |= 1 << i;
+    bool status;
+    if (values[i].encoding == DELTA_DIFF32) {
+      const uint32_t diff = (uint32_t)bits - (uint32_t)ref_bits;
+      status = pb_encode_svarint(&ostream, (int32_t)diff);
+    } else {
+      status = pb_encode_varint(&ostream, bits ^ ref_bits);
+    }
+    if (!status) {
+      return -1;
+    }
+  }
+  buffer[2] = bitmap;
+
+  return ostream.bytes_written + 3;
+}
+
+int DecodeMeasurementDelta(const MeasurementDelta *delta, const uint8_t *data,
+                           const size_t len, Measurement *meas) {
+  if (len < 2) {
+    return -1;
+  }
+
+  const pb_size_t which = data[0] & ~DELTA_KEYFRAME;
+  if (which == 0 || which >= TRANSCODER_DELTA_STREAMS) {
+    return -1;
+  }
+
+  if (data[0] & DELTA_KEYFRAME) {
+    if (DecodeMeasurement(data + 2, len - 2, meas) != 0 ||
+        meas->which_measurement != which) {
+      return -1;
+    }
+    return 0;
+  }
+
+  size_t count = 0;
+  const DeltaValue *values = GetDeltaValues(which, &count);
+  if (values == NULL) {
+    return -1;
+  }
+
+  // deltas need the preceding measurement of the stream
+  const MeasurementDeltaStream *stream = &delta->streams[which];
+  if (!stream->valid || data[1] != (uint8_t)(stream->seq + 1) || len < 3) {
+    return -1;
+  }
+
+  const uint8_t bitmap = data[2];
+  if (bitmap >> count) {
+    return -1;
+  }
+
+  *meas = stream->ref;
+  pb_istream_t istream = pb_istream_from_buffer(data + 3, len - 3);
+
+  int64_t change;
+  if (!pb_decode_svarint(&istream, &change)) {
+    return -1;
+  }
+  meas->meta.ts = stream->ref.meta.ts + stream->period + (uint32_t)change;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!(bitmap & (1 << i))) {
+      continue;
+    }
+
+    const uint64_t ref_bits = DeltaLoad(&stream->ref, &values[i]);
+    if (values[i].encoding == DELTA_DIFF32) {
+      int64_t diff;
+      if (!pb_decode_svarint(&istream, &diff)) {
+        return -1;
+      }
+      DeltaStore(meas, &values[i], (uint32_t)ref_bits + (uint32_t)diff);
+    } else {
+      uint64_t bits;
+      if (!pb_decode_varint(&istream, &bits)) {
+        return -1;
+      }
+      DeltaStore(meas, &values[i], ref_bits ^ bits);
+    }
+  }
+
+  if (istream.bytes_left != 0) {
+    return -1;
+  }
+
+  UpgradeDoubleValues(meas);
+
+  return 0;
+}
+
+void MeasurementDeltaAdvance(MeasurementDelta *delta, const uint8_t *data,
+                             const Measurement *meas) {
+  const pb_size_t which = data[0] & ~DELTA_KEYFRAME;
+  if (which >= TRANSCODER_DELTA_STREAMS) {
+    return;
+  }
+
+  MeasurementDeltaStream *stream = &delta->streams[which];
+  if (data[0] & DELTA_KEYFRAME) {
+    stream->period = 0;
+    stream->since_keyframe = 0;
+  } else {
+    stream->period = meas->meta.ts - stream->ref.meta.ts;
+    ++stream->since_keyframe;
+  }
+
+  // references hold the float values, see DecodeMeasurement()
+  stream->ref = *meas;
+  UpgradeDoubleValues(&stream->ref);
+
+  stream->seq = data[1];
+  stream->valid = true;
+}
+
+int DecodeEsp32Command(const uint8_t *data, const size_t len,
+                       Esp32Command *cmd) {
   pb_istream_t istream = pb_istream_from_buffer(data, len);
-  pb_decode(&istream, Esp32Command_fields, &cmd);
+  bool status = pb_decode(&istream, Esp32Command_fields, cmd);
+  if (!status) {
+    return -1;
+  }
 
-  return cmd;
+  return 0;
+}
+
+int DecodePageCommand(const uint8_t *data, const size_t len,
+                      PageCommand *page_cmd) {
+  return DecodeEsp32Submessage(data, len, Esp32Command_page_command_tag,
+                               PageCommand_fields, page_cmd);
+}
+
+int DecodeWiFiCommand(const uint8_t *data, const size_t len,
+                      WiFiCommand *wifi_cmd) {
+  return DecodeEsp32Submessage(data, len, Esp32Command_wifi_command_tag,
+                               WiFiCommand_fields, wifi_cmd);
 }
 
 size_t EncodePageCommand(PageCommand_RequestType req, int fd, size_t bs,
                          size_t n, uint8_t *buffer, size_t size) {
   // create command object
-  Esp32Command cmd = Esp32Command_init_default;
-  cmd.which_command = Esp32Command_page_command_tag;
-  cmd.command.page_command.file_request = req;
-  cmd.command.page_command.file_descriptor = fd;
-  cmd.command.page_command.block_size = bs;
-  cmd.command.page_command.num_bytes = n;
+  PageCommand page_cmd = PageCommand_init_default;
+  page_cmd.file_request = req;
+  page_cmd.file_descriptor = fd;
+  page_cmd.block_size = bs;
+  page_cmd.num_bytes = n;
 
-  return EncodeEsp32Command(&cmd, buffer, size);
+  return EncodePageCommandMsg(&page_cmd, buffer, size);
+}
+
+size_t EncodePageCommandMsg(const PageCommand *page_cmd, uint8_t *buffer,
+                            size_t size) {
+  return EncodeEsp32Submessage(Esp32Command_page_command_tag,
+                               PageCommand_fields, page_cmd, buffer, size);
 }
 
 size_t EncodeTestCommand(TestCommand_ChangeState state, int32_t data,
                          uint8_t *buffer, size_t size) {
-  Esp32Command cmd = Esp32Command_init_default;
-  cmd.which_command = Esp32Command_test_command_tag;
-  cmd.command.test_command.state = state;
-  cmd.command.test_command.data = data;
+  TestCommand test_cmd = TestCommand_init_default;
+  test_cmd.state = state;
+  test_cmd.data = data;
 
-  return EncodeEsp32Command(&cmd, buffer, size);
+  return EncodeEsp32Submessage(Esp32Command_test_command_tag,
+                               TestCommand_fields, &test_cmd, buffer, size);
 }
 
 size_t EncodeWiFiCommand(const WiFiCommand *wifi_cmd, uint8_t *buffer,
                          size_t size) {
-  Esp32Command cmd = Esp32Command_init_default;
-
-  cmd.which_command = Esp32Command_wifi_command_tag;
-
-  // copy data from wifi_cmd to cmd
-  memcpy(&cmd.command.wifi_command, wifi_cmd, sizeof(WiFiCommand));
-
-  return EncodeEsp32Command(&cmd, buffer, size);
+  return EncodeEsp32Submessage(Esp32Command_wifi_command_tag,
+                               WiFiCommand_fields, wifi_cmd, buffer, size);
 }
 
-size_t EncodeEsp32Command(const Esp32Command *cmd, uint8_t *buffer,
-                          size_t size) {
+static size_t EncodeEsp32Submessage(pb_size_t tag, const pb_msgdesc_t *fields,
+                                    const void *msg, uint8_t *buffer,
+                                    size_t size) {
   // create output stream
   pb_ostream_t ostream = pb_ostream_from_buffer(buffer, size);
-  // encode message and check rc
-  bool status = pb_encode(&ostream, Esp32Command_fields, cmd);
-  if (!status) {
+  // encode the oneof field of esp32command
+  if (!pb_encode_tag(&ostream, PB_WT_STRING, tag)) {
+    return -1;
+  }
+  if (!pb_encode_submessage(&ostream, fields, msg)) {
     return -1;
   }
 
@@ -220,6 +1186,43 @@ size_t EncodeEsp32Command(const Esp32Command *cmd, uint8_t *buffer,
   return ostream.bytes_written;
 }
 
+static int DecodeEsp32Submessage(const uint8_t *data, const size_t len,
+                                 pb_size_t tag, const pb_msgdesc_t *fields,
+                                 void *msg) {
+  pb_istream_t istream = pb_istream_from_buffer(data, len);
+
+  bool found = false;
+  pb_wire_type_t wire_type;
+  uint32_t field_tag;
+  bool eof;
+  while (pb_decode_tag(&istream, &wire_type, &field_tag, &eof)) {
+    if (field_tag != tag || wire_type != PB_WT_STRING) {
+      if (!pb_skip_field(&istream, wire_type)) {
+        return -1;
+      }
+      continue;
+    }
+
+    pb_istream_t substream;
+    if (!pb_make_string_substream(&istream, &substream)) {
+      return -1;
+    }
+    // repeated occurrences of a submessage are merged
+    bool status = found ? pb_decode_noinit(&substream, fields, msg)
+                        : pb_decode(&substream, fields, msg);
+    if (!pb_close_string_substream(&istream, &substream) || !status) {
+      return -1;
+    }
+    found = true;
+  }
+
+  if (!eof || !found) {
+    return -1;
+  }
+
+  return 0;
+}
+
 size_t EncodeUserConfiguration(UserConfiguration *config, uint8_t *buffer) {
   // create output stream
   pb_ostream_t ostream = pb_ostream_from_buffer(buffer, UserConfiguration_size);
@@ -0,0 +1,594 @@
+"""Generates fast encoders for nanopb messages
+
+Encoders are generated from a compiled descriptor set and write tags and
+varints directly, without the field descriptors used by pb_encode(). Sizes of
+submessages are calculated up front, so the output is written in a single pass.
+The output is identical to pb_encode() for the supported field types.
+
+Each message gets a writer to a buffer and a writer to a pb_ostream_t. The
+stream writer passes tags and values to pb_encode_varint() and pb_write() as
+they are encoded, so streams such as the FRAM staging ring are written without
+an intermediate buffer.
+
+Only singular scalar fields, bytes fields, submessages and oneofs of
+submessages are supported, which covers the measurement messages. Bytes fields
+must have a max_size in the options file so nanopb stores them in a fixed size
+array. Encoders are generated for
+the root messages given on the command line and all messages they contain.
+
+Usage:
+    python generate_fast_encoders.py build/soil_power_sensor.desc Measurement
+
+The descriptor set is generated with
+    protoc --descriptor_set_out=build/soil_power_sensor.desc soil_power_sensor.proto
+"""
+
+import argparse
+import os
+
+from google.protobuf import descriptor_pb2
+
+FieldProto = descriptor_pb2.FieldDescriptorProto
+
+# field type -> (wire type, value expression format, size expression format,
+# write statement format, stream write expression format)
+SCALARS = {
+    FieldProto.TYPE_UINT32: (
+        0,
+        "{v}",
+        "varint32_size({v})",
+        "write_varint32(p, {v})",
+        "pb_encode_varint(stream, {v})",
+    ),
+    FieldProto.TYPE_UINT64: (
+        0,
+        "{v}",
+        "varint64_size({v})",
+        "write_varint64(p, {v})",
+        "pb_encode_varint(stream, {v})",
+    ),
+    FieldProto.TYPE_INT32: (
+        0,
+        "{v}",
+        "varint64_size((uint64_t)(int64_t){v})",
+        "write_varint64(p, (uint64_t)(int64_t){v})",
+        "pb_encode_varint(stream, (uint64_t)(int64_t){v})",
+    ),
+    FieldProto.TYPE_INT64: (
+        0,
+        "{v}",
+        "varint64_size((uint64_t){v})",
+        "write_varint64(p, (uint64_t){v})",
+        "pb_encode_varint(stream, (uint64_t){v})",
+    ),
+    FieldProto.TYPE_ENUM: (
+        0,
+        "{v}",
+        "varint64_size((uint64_t)(int64_t){v})",
+        "write_varint64(p, (uint64_t)(int64_t){v})",
+        "pb_encode_varint(stream, (uint64_t)(int64_t){v})",
+    ),
+    FieldProto.TYPE_SINT32: (
+        0,
+        "{v}",
+        "varint32_size(zigzag32({v}))",
+        "write_varint32(p, zigzag32({v}))",
+        "pb_encode_varint(stream, zigzag32({v}))",
+    ),
+    FieldProto.TYPE_SINT64: (
+        0,
+        "{v}",
+        "varint64_size(zigzag64({v}))",
+        "write_varint64(p, zigzag64({v}))",
+        "pb_encode_varint(stream, zigzag64({v}))",
+    ),
+    FieldProto.TYPE_BOOL: (
+        0,
+        "{v}",
+        "1",
+        "write_varint32(p, {v})",
+        "pb_encode_varint(stream, {v})",
+    ),
+    FieldProto.TYPE_FIXED32: (
+        5,
+        "{v}",
+        "4",
+        "write_fixed32(p, {v})",
+        "stream_fixed32(stream, {v})",
+    ),
+    FieldProto.TYPE_SFIXED32: (
+        5,
+        "{v}",
+        "4",
+        "write_fixed32(p, (uint32_t){v})",
+        "stream_fixed32(stream, (uint32_t){v})",
+    ),
+    FieldProto.TYPE_FLOAT: (
+        5,
+        "float_bits({v})",
+        "4",
+        "write_fixed32(p, float_bits({v}))",
+        "stream_fixed32(stream, float_bits({v}))",
+    ),
+    FieldProto.TYPE_FIXED64: (
+        1,
+        "{v}",
+        "8",
+        "write_fixed64(p, {v})",
+        "stream_fixed64(stream, {v})",
+    ),
+    FieldProto.TYPE_SFIXED64: (
+        1,
+        "{v}",
+        "8",
+        "write_fixed64(p, (uint64_t){v})",
+        "stream_fixed64(stream, (uint64_t){v})",
+    ),
+    FieldProto.TYPE_DOUBLE: (
+        1,
+        "double_bits({v})",
+        "8",
+        "write_fixed64(p, double_bits({v}))",
+        "stream_fixed64(stream, double_bits({v}))",
+    ),
+}
+
+# helpers shared by all encoders
+HELPERS = """\
+static inline size_t varint32_size(uint32_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+static inline size_t varint64_size(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+static inline uint8_t *write_varint32(uint8_t *p, uint32_t value) {
+  while (value >= 0x80) {
+    *p++ = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+  return p;
+}
+
+static inline uint8_t *write_varint64(uint8_t *p, uint64_t value) {
+  while (value >= 0x80) {
+    *p++ = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+  return p;
+}
+
+static inline uint8_t *write_fixed32(uint8_t *p, uint32_t value) {
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+  p[2] = (uint8_t)(value >> 16);
+  p[3] = (uint8_t)(value >> 24);
+  return p + 4;
+}
+
+static inline uint8_t *write_fixed64(uint8_t *p, uint64_t value) {
+  p = write_fixed32(p, (uint32_t)value);
+  return write_fixed32(p, (uint32_t)(value >> 32));
+}
+
+/* Fixed values are written to the stream in one call, independent of the byte
+ * order of the target */
+static inline bool stream_fixed32(pb_ostream_t *stream, uint32_t value) {
+  uint8_t bytes[4];
+  write_fixed32(bytes, value);
+  return pb_write(stream, bytes, sizeof(bytes));
+}
+
+static inline bool stream_fixed64(pb_ostream_t *stream, uint64_t value) {
+  uint8_t bytes[8];
+  write_fixed64(bytes, value);
+  return pb_write(stream, bytes, sizeof(bytes));
+}
+
+static inline uint32_t zigzag32(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline uint64_t zigzag64(int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/* Zero checks compare the bits, so -0.0 is encoded like in pb_encode() */
+static inline uint32_t float_bits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static inline uint64_t double_bits(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+"""
+
+
+def tag_bytes(number: int, wire_type: int) -> list[int]:
+    """Encodes the key of a field as a varint
+
+    Args:
+        number: Field number.
+        wire_type: Wire type of the field.
+
+    Returns:
+        Bytes of the key.
+    """
+
+    key = (number << 3) | wire_type
+    out = []
+    while key >= 0x80:
+        out.append((key & 0x7F) | 0x80)
+        key >>= 7
+    out.append(key)
+    return out
+
+
+def write_tag(number: int, wire_type: int, indent: str) -> list[str]:
+    """Generates the statements writing the key of a field"""
+
+    key = tag_bytes(number, wire_type)
+    return [f"{indent}*p++ = 0x{b:02x};" for b in key]
+
+
+def stream_tag(number: int, wire_type: int) -> str:
+    """Generates the expression writing the key of a field to a stream"""
+
+    return f"pb_encode_varint(stream, 0x{(number << 3) | wire_type:02x})"
+
+
+def stream_block(writes: list[str], indent: str) -> list[str]:
+    """Generates the statements writing values to a stream
+
+    Args:
+        writes: Expressions that return false if the stream fails.
+        indent: Indentation of the generated lines.
+
+    Returns:
+        Lines of code returning false on the first failed write.
+    """
+
+    lines = [f"{indent}if (!{writes[0]}" + (" ||" if len(writes) > 1 else ") {")]
+    for i, write in enumerate(writes[1:], 2):
+        end = " ||" if i < len(writes) else ") {"
+        lines.append(f"{indent}    !{write}{end}")
+    lines.append(f"{indent}  return false;")
+    lines.append(f"{indent}}}")
+    return lines
+
+
+class Generator:
+    """Generates encoders for messages of a file descriptor"""
+
+    def __init__(self, fd: descriptor_pb2.FileDescriptorProto):
+        self.fd = fd
+        self.messages = {m.name: m for m in fd.message_type}
+        self.order = []
+
+    def add(self, name: str):
+        """Adds a message and all messages it contains, dependencies first"""
+
+        if name in self.order:
+            return
+
+        msg = self.messages[name]
+        for field in msg.field:
+            if field.label == FieldProto.LABEL_REPEATED:
+                raise ValueError(f"{name}.{field.name}: repeated fields not supported")
+            if field.proto3_optional:
+                raise ValueError(f"{name}.{field.name}: optional fields not supported")
+            if field.type == FieldProto.TYPE_MESSAGE:
+                self.add(field.type_name.split(".")[-1])
+            elif field.type != FieldProto.TYPE_BYTES and field.type not in SCALARS:
+                raise ValueError(f"{name}.{field.name}: type not supported")
+
+        self.order.append(name)
+
+    def oneof_name(self, msg, field) -> str | None:
+        """Gets the name of the oneof of a field, None if not in a oneof"""
+
+        if field.HasField("oneof_index"):
+            return msg.oneof_decl[field.oneof_index].name
+        return None
+
+    def field_blocks(self, msg, mode: str) -> list[str]:
+        """Generates the size calculation or writes of all fields
+
+        Fields are handled in order of declaration like pb_encode(). Fields of a
+        oneof are grouped into a switch on the which_ member.
+
+        Args:
+            msg: Message descriptor.
+            mode: "size" for the size calculation, "write" for writes to a
+                buffer or "stream" for writes to a stream.
+
+        Returns:
+            Lines of code.
+        """
+
+        lines = []
+        done_oneofs = set()
+        for field in msg.field:
+            oneof = self.oneof_name(msg, field)
+            if oneof is None:
+                lines += self.field_block(msg, field, f"msg->{field.name}", mode, "  ")
+                continue
+
+            if oneof in done_oneofs:
+                continue
+            done_oneofs.add(oneof)
+
+            lines.append(f"  switch (msg->which_{oneof}) {{")
+            for member in msg.field:
+                if self.oneof_name(msg, member) != oneof:
+                    continue
+                lines.append(f"    case {msg.name}_{member.name}_tag: {{")
+                lines += self.field_block(
+                    msg, member, f"msg->{oneof}.{member.name}", mode, "      ", True
+                )
+                lines.append("      break;")
+                lines.append("    }")
+            lines.append("    default:")
+            lines.append("      break;")
+            lines.append("  }")
+        return lines
+
+    def field_block(
+        self, msg, field, value: str, mode: str, indent: str, present: bool = False
+    ) -> list[str]:
+        """Generates the size calculation or write of a single field
+
+        Args:
+            msg: Message descriptor.
+            field: Field descriptor.
+            value: Expression of the field value.
+            mode: "size", "write" or "stream", see field_blocks().
+            indent: Indentation of the generated lines.
+            present: Field is always encoded, such as a member of a oneof.
+
+        Returns:
+            Lines of code.
+        """
+
+        lines = []
+        if field.type == FieldProto.TYPE_MESSAGE:
+            sub = field.type_name.split(".")[-1]
+            key_len = len(tag_bytes(field.number, 2))
+            inner = indent
+            if not present:
+                lines.append(f"{indent}if (msg->has_{field.name}) {{")
+                inner = indent + "  "
+            if mode == "size":
+                lines.append(f"{inner}const size_t sub = {sub}_fast_size(&{value});")
+                lines.append(f"{inner}size += {key_len} + varint32_size(sub) + sub;")
+            elif mode == "stream":
+                lines += stream_block(
+                    [
+                        stream_tag(field.number, 2),
+                        f"pb_encode_varint(stream, {sub}_fast_size(&{value}))",
+                        f"{sub}_fast_stream(&{value}, stream)",
+                    ],
+                    inner,
+                )
+            else:
+                lines += write_tag(field.number, 2, inner)
+                lines.append(
+                    f"{inner}p = write_varint32(p, {sub}_fast_size(&{value}));"
+                )
+                lines.append(f"{inner}p = {sub}_fast_write(&{value}, p);")
+            if not present:
+                lines.append(f"{indent}}}")
+            return lines
+
+        if field.type == FieldProto.TYPE_BYTES:
+            key_len = len(tag_bytes(field.number, 2))
+            inner = indent
+            if not present:
+                lines.append(f"{indent}if ({value}.size != 0) {{")
+                inner = indent + "  "
+            if mode == "size":
+                lines.append(
+                    f"{inner}size += {key_len} + varint32_size({value}.size) + "
+                    f"{value}.size;"
+                )
+            elif mode == "stream":
+                lines += stream_block(
+                    [
+                        stream_tag(field.number, 2),
+                        f"pb_encode_string(stream, {value}.bytes, {value}.size)",
+                    ],
+                    inner,
+                )
+            else:
+                lines += write_tag(field.number, 2, inner)
+                lines.append(f"{inner}p = write_varint32(p, {value}.size);")
+                lines.append(f"{inner}memcpy(p, {value}.bytes, {value}.size);")
+                lines.append(f"{inner}p += {value}.size;")
+            if not present:
+                lines.append(f"{indent}}}")
+            return lines
+
+        wire_type, check, size_expr, write_expr, stream_expr = SCALARS[field.type]
+        key_len = len(tag_bytes(field.number, wire_type))
+        lines.append(f"{indent}if ({check.format(v=value)} != 0) {{")
+        if mode == "size":
+            lines.append(f"{indent}  size += {key_len} + {size_expr.format(v=value)};")
+        elif mode == "stream":
+            lines += stream_block(
+                [stream_tag(field.number, wire_type), stream_expr.format(v=value)],
+                indent + "  ",
+            )
+        else:
+            lines += write_tag(field.number, wire_type, indent + "  ")
+            lines.append(f"{indent}  p = {write_expr.format(v=value)};")
+        lines.append(f"{indent}}}")
+        return lines
+
+    def message_functions(self, name: str) -> str:
+        """Generates the size and write functions of a message"""
+
+        msg = self.messages[name]
+        size_lines = self.field_blocks(msg, "size")
+        write_lines = self.field_blocks(msg, "write")
+        stream_lines = self.field_blocks(msg, "stream")
+
+        out = []
+        out.append(f"static size_t {name}_fast_size(const {name} *msg) {{")
+        out.append("  size_t size = 0;")
+        out += size_lines
+        out.append("  return size;")
+        out.append("}")
+        out.append("")
+        out.append(
+            f"static uint8_t *{name}_fast_write(const {name} *msg, uint8_t *p) {{"
+        )
+        out += write_lines
+        out.append("  return p;")
+        out.append("}")
+        out.append("")
+        out.append(
+            f"static bool {name}_fast_stream(const {name} *msg, "
+            "pb_ostream_t *stream) {"
+        )
+        out += stream_lines
+        out.append("  return true;")
+        out.append("}")
+        out.append("")
+        return "\n".join(out)
+
+    def source(self, header: str, roots: list[str]) -> str:
+        """Generates the source file"""
+
+        out = [
+            "/* Automatically generated by generate_fast_encoders.py */",
+            "",
+            f'#include "{header}"',
+            "",
+            "#include <string.h>",
+            "",
+            HELPERS,
+        ]
+        for name in self.order:
+            out.append(self.message_functions(name))
+
+        for name in roots:
+            out.append(
+                f"""\
+size_t {name}_fast_encoded_size(const {name} *msg) {{
+  return {name}_fast_size(msg);
+}}
+
+bool {name}_fast_encode(const {name} *msg, uint8_t *buffer,
+{" " * len(f"bool {name}_fast_encode(")}size_t size, size_t *len) {{
+  const size_t msg_size = {name}_fast_size(msg);
+  if (msg_size > size) {{
+    return false;
+  }}
+
+  {name}_fast_write(msg, buffer);
+  *len = msg_size;
+  return true;
+}}
+
+bool {name}_fast_encode_stream(const {name} *msg, pb_ostream_t *stream) {{
+  return {name}_fast_stream(msg, stream);
+}}
+"""
+            )
+        return "\n".join(out)
+
+    def header(self, pb_header: str, guard: str, roots: list[str]) -> str:
+        """Generates the header file"""
+
+        out = [
+            "/* Automatically generated by generate_fast_encoders.py */",
+            "",
+            f"#ifndef {guard}",
+            f"#define {guard}",
+            "",
+            "#include <stdbool.h>",
+            "#include <stddef.h>",
+            "#include <stdint.h>",
+            "",
+            '#include "pb_encode.h"',
+            f'#include "{pb_header}"',
+            "",
+            "#ifdef __cplusplus",
+            'extern "C" {',
+            "#endif",
+            "",
+        ]
+        for name in roots:
+            pad = " " * len(f"bool {name}_fast_encode(")
+            out.append(
+                f"""\
+/* Number of bytes of the encoded message, same as pb_get_encoded_size() */
+size_t {name}_fast_encoded_size(const {name} *msg);
+
+/* Encodes a message with the same output as pb_encode(). Returns false if the
+ * message does not fit in size bytes. */
+bool {name}_fast_encode(const {name} *msg, uint8_t *buffer,
+{pad}size_t size, size_t *len);
+
+/* Encodes a message to a stream with the same output as pb_encode(), without
+ * an intermediate buffer. Returns false if the stream fails. */
+bool {name}_fast_encode_stream(const {name} *msg, pb_ostream_t *stream);
+"""
+            )
+        out += [
+            "#ifdef __cplusplus",
+            "} /* extern \"C\" */",
+            "#endif",
+            "",
+            "#endif",
+            "",
+        ]
+        return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generates fast encoders")
+    parser.add_argument("descriptor", help="Descriptor set from protoc")
+    parser.add_argument("messages", nargs="+", help="Messages to encode")
+    parser.add_argument("--output-dir", default=".", help="Output directory")
+    args = parser.parse_args()
+
+    fds = descriptor_pb2.FileDescriptorSet()
+    with open(args.descriptor, "rb") as f:
+        fds.ParseFromString(f.read())
+    fd = fds.file[-1]
+
+    gen = Generator(fd)
+    for name in args.messages:
+        gen.add(name)
+
+    base = os.path.splitext(os.path.basename(fd.name))[0]
+    pb_header = f"{base}.pb.h"
+    header = f"{base}.fast.h"
+    guard = f"PB_{base.upper()}_FAST_H_INCLUDED"
+
+    with open(os.path.join(args.output_dir, header), "w") as f:
+        f.write(gen.header(pb_header, guard, args.messages))
+    with open(os.path.join(args.output_dir, f"{base}.fast.c"), "w") as f:
+        f.write(gen.source(header, args.messages))
+
+
+if __name__ == "__main__":
+    main()
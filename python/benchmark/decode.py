@@ -0,0 +1,84 @@
+"""Benchmark of decoding archives of length-delimited measurements
+
+Compares decode_measurements(), which builds a dictionary per measurement,
+with decode_measurement_frames(), which builds a DataFrame per measurement
+type. Prints the throughput of each in records/s along with the protobuf
+backend, which is selected with PROTOCOL_BUFFERS_PYTHON_IMPLEMENTATION.
+
+Run from python/ with:
+
+    python benchmark/decode.py --records 100000
+"""
+
+import argparse
+import time
+
+from google.protobuf.internal import api_implementation
+
+from ents.proto import (
+    decode_measurement_frames,
+    decode_measurements,
+    encode_power_measurement,
+    encode_teros12_measurement,
+)
+
+
+def archive(records: int) -> bytes:
+    """Creates an archive of power and teros12 measurements
+
+    Args:
+        records: Number of measurements.
+
+    Returns:
+        Length-delimited Measurement messages.
+    """
+
+    measurements = []
+    for i in range(records):
+        ts = 1436079600 + 60 * (i // 2)
+        if i % 2:
+            meas = encode_teros12_measurement(ts, 1, 2, 2124.62, 0.43, 24.8, 123)
+        else:
+            meas = encode_power_measurement(ts, 1, 2, 37.13 + i % 7, 185.29)
+        measurements.append(bytes([len(meas)]) + meas)
+    return b"".join(measurements)
+
+
+def bench(func, data: bytes, records: int, repeat: int) -> float:
+    """Times a decode function
+
+    Args:
+        func: Decode function taking the archive.
+        data: Archive of measurements.
+        records: Number of measurements in the archive.
+        repeat: Number of runs, the fastest is used.
+
+    Returns:
+        Throughput in records/s.
+    """
+
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        func(data)
+        best = min(best, time.perf_counter() - start)
+    return records / best
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--records", type=int, default=100000)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    data = archive(args.records)
+
+    print(f"protobuf backend: {api_implementation.Type()}")
+    print(f"records: {args.records}, bytes: {len(data)}")
+    for func in (decode_measurements, decode_measurement_frames):
+        rate = bench(func, data, args.records, args.repeat)
+        print(f"{func.__name__}: {rate:,.0f} records/s")
+
+
+if __name__ == "__main__":
+    main()
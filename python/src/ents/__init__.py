@@ -4,9 +4,18 @@ from .proto.encode import (
     encode_teros12_measurement,
     encode_phytos31_measurement,
     encode_bme280_measurement,
+    encode_power_summary,
+    encode_measurement_batch,
 )
 
-from .proto.decode import decode_response, decode_measurement
+from .proto.decode import (
+    decode_response,
+    decode_measurement,
+    decode_measurements,
+    decode_measurement_frames,
+    decode_measurement_batch,
+    decode_burst_samples,
+)
 
 from .proto.esp32 import encode_esp32command, decode_esp32command
 
@@ -16,8 +25,14 @@ __all__ = [
     "encode_teros12_measurement",
     "encode_phytos31_measurement",
     "encode_bme280_measurement",
+    "encode_power_summary",
+    "encode_measurement_batch",
     "decode_response",
     "decode_measurement",
+    "decode_measurements",
+    "decode_measurement_frames",
+    "decode_measurement_batch",
+    "decode_burst_samples",
     "encode_esp32command",
     "decode_esp32command",
 ]
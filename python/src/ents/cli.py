@@ -26,7 +26,12 @@ from .proto.encode import (
     encode_teros12_measurement,
     encode_response,
 )
-from .proto.decode import decode_measurement, decode_response
+from .proto.decode import (
+    decode_measurement,
+    decode_measurements,
+    decode_measurement_batch,
+    decode_response,
+)
 from .proto.esp32 import encode_esp32command, decode_esp32command
 
 from .simulator.node import NodeSimulator
@@ -403,6 +408,18 @@ def create_decode_parser(subparsers):
     )
     measurement_parser.set_defaults(func=handle_decode_measurement)
 
+    # batch of measurements
+    measurements_parser = decode_subparsers.add_parser(
+        "measurements", help='Length-delimited batch of "Measurement" messages'
+    )
+    measurements_parser.set_defaults(func=handle_decode_measurements)
+
+    # compact batch of measurements
+    measurement_batch_parser = decode_subparsers.add_parser(
+        "measurement_batch", help='Proto "MeasurementBatch" message'
+    )
+    measurement_batch_parser.set_defaults(func=handle_decode_measurement_batch)
+
     # response
     response_parser = decode_subparsers.add_parser(
         "response", help='Proto "Response" message'
@@ -428,6 +445,20 @@ def handle_decode_measurement(args):
     print(vals)
 
 
+def handle_decode_measurements(args):
+    data = bytes.fromhex(args.data)
+    vals = decode_measurements(data)
+    for val in vals:
+        print(val)
+
+
+def handle_decode_measurement_batch(args):
+    data = bytes.fromhex(args.data)
+    vals = decode_measurement_batch(data)
+    for val in vals:
+        print(val)
+
+
 def handle_decode_response(args):
     data = bytes.fromhex(args.data)
     vals = decode_response(data)
@@ -4,15 +4,31 @@ from .encode import (
     encode_teros12_measurement,
     encode_phytos31_measurement,
     encode_teros21_measurement,
+    encode_power_summary,
+    encode_measurement_batch,
     encode_user_configuration,
 )
 
 from .decode import (
     decode_response,
     decode_measurement,
+    decode_measurements,
+    decode_measurement_frames,
+    decode_measurement_batch,
+    decode_burst_samples,
     decode_user_configuration,
 )
 
+from .delta import (
+    MeasurementCompressor,
+    MeasurementDecompressor,
+)
+
+from .archive import (
+    ArchiveReader,
+    ArchiveWriter,
+)
+
 from .esp32 import (
     encode_esp32command,
     decode_esp32command,
@@ -24,8 +40,18 @@ __all__ = [
     "encode_teros12_measurement",
     "encode_phytos31_measurement",
     "encode_teros21_measurement",
+    "encode_power_summary",
+    "encode_measurement_batch",
     "decode_response",
     "decode_measurement",
+    "decode_measurements",
+    "decode_measurement_frames",
+    "decode_measurement_batch",
+    "decode_burst_samples",
+    "MeasurementCompressor",
+    "MeasurementDecompressor",
+    "ArchiveReader",
+    "ArchiveWriter",
     "encode_user_configuration",
     "decode_user_configuration",
     "encode_esp32command",
@@ -0,0 +1,328 @@
+"""Module to store measurements in an indexed archive file
+
+An archive holds serialized Measurement messages in blocks, followed by an
+index of the blocks. Each block holds length-delimited measurements of a single
+logger and cell, the same format as LoRaWAN port 4 batches. The index stores
+the logger, cell, timestamp range and location of each block, so queries only
+read the matching blocks.
+
+All integers are little-endian.
+
+    header:  | magic "ENTSARC" | version (u8) |
+    blocks:  | varint length | Measurement | ... |
+    index:   | logger_id (u32) | cell_id (u32) | ts_min (u32) | ts_max (u32) |
+             | offset (u64) | length (u32) | count (u32) | ...
+    trailer: | index offset (u64) | number of blocks (u32) | magic "EIDX" |
+
+Archives are append-only. Opening an existing archive for writing reads the
+index and overwrites it with the next block, so the index is only valid once
+the writer is closed. The C reader is in proto/c/include/archive.h.
+"""
+
+import os
+import struct
+from typing import BinaryIO, Iterator, NamedTuple
+
+import pandas as pd
+
+from .decode import _decode_varint, decode_measurement_frames
+from .soil_power_sensor_pb2 import Measurement
+
+MAGIC = b"ENTSARC\x01"
+"""Header of an archive, including the version"""
+
+INDEX_MAGIC = b"EIDX"
+"""Magic number at the end of the trailer"""
+
+BLOCK_SIZE = 4096
+"""Default number of bytes of measurements that closes a block"""
+
+_ENTRY = struct.Struct("<IIIIQII")
+_TRAILER = struct.Struct("<QI4s")
+
+
+class IndexEntry(NamedTuple):
+    """Location and contents of a block"""
+
+    logger_id: int
+    cell_id: int
+    ts_min: int
+    ts_max: int
+    offset: int
+    length: int
+    count: int
+
+
+def _open(file: str | os.PathLike | BinaryIO, mode: str) -> tuple[BinaryIO, bool]:
+    """Opens a path, or uses an open binary file
+
+    Returns:
+        Tuple of the file and whether it was opened here, to be closed.
+    """
+
+    if isinstance(file, (str, os.PathLike)):
+        return open(file, mode), True
+    return file, False
+
+
+def _read_index(file: BinaryIO) -> tuple[list[IndexEntry], int]:
+    """Reads the index of an archive
+
+    Args:
+        file: Archive opened in binary mode.
+
+    Returns:
+        Tuple of the index entries and the offset of the index.
+
+    Raises:
+        ValueError: When the file is not a closed archive.
+    """
+
+    file.seek(0)
+    if file.read(len(MAGIC)) != MAGIC:
+        raise ValueError("Not a measurement archive")
+
+    size = file.seek(0, os.SEEK_END)
+    if size < len(MAGIC) + _TRAILER.size:
+        raise ValueError("Archive missing index")
+    file.seek(size - _TRAILER.size)
+    index_offset, count, magic = _TRAILER.unpack(file.read(_TRAILER.size))
+    index_size = count * _ENTRY.size
+    if magic != INDEX_MAGIC or index_offset + index_size != size - _TRAILER.size:
+        raise ValueError("Archive missing index")
+
+    file.seek(index_offset)
+    data = file.read(index_size)
+    index = [IndexEntry._make(entry) for entry in _ENTRY.iter_unpack(data)]
+    return index, index_offset
+
+
+class ArchiveWriter:
+    """Appends measurements to an archive
+
+    Measurements are buffered per logger and cell until BLOCK_SIZE bytes are
+    collected, and the remaining ones are written when the writer is closed.
+    Use as a context manager to ensure the index is written.
+    """
+
+    def __init__(
+        self, file: str | os.PathLike | BinaryIO, block_size: int = BLOCK_SIZE
+    ):
+        """Opens an archive for appending, creating it if needed
+
+        Args:
+            file: Path of the archive, or a file opened in binary read/write
+                mode.
+            block_size: Number of bytes of measurements that closes a block.
+
+        Raises:
+            ValueError: When an existing file is not a closed archive.
+        """
+
+        if isinstance(file, (str, os.PathLike)) and not os.path.exists(file):
+            self._file, self._owned = _open(file, "w+b")
+        else:
+            self._file, self._owned = _open(file, "r+b")
+
+        self.block_size = block_size
+        self._blocks = {}
+
+        if self._file.seek(0, os.SEEK_END) == 0:
+            self._file.write(MAGIC)
+            self.index = []
+        else:
+            self.index, index_offset = _read_index(self._file)
+            self._file.seek(index_offset)
+            self._file.truncate()
+
+    def write(self, data: bytes):
+        """Adds a measurement
+
+        Args:
+            data: Byte array of Measurement message.
+
+        Raises:
+            KeyError: When the measurement is missing metadata.
+        """
+
+        meas = Measurement.FromString(data)
+        if not meas.HasField("meta"):
+            raise KeyError("Measurement missing metadata")
+
+        key = (meas.meta.logger_id, meas.meta.cell_id)
+        if key not in self._blocks:
+            self._blocks[key] = [bytearray(), 0, meas.meta.ts, meas.meta.ts]
+        block = self._blocks[key]
+
+        buffer = block[0]
+        length = len(data)
+        while length > 0x7F:
+            buffer.append((length & 0x7F) | 0x80)
+            length >>= 7
+        buffer.append(length)
+        buffer += data
+        block[1] += 1
+        block[2] = min(block[2], meas.meta.ts)
+        block[3] = max(block[3], meas.meta.ts)
+
+        if len(buffer) >= self.block_size:
+            self._write_block(key)
+
+    def _write_block(self, key: tuple[int, int]):
+        """Writes the buffered measurements of a logger and cell"""
+
+        buffer, count, ts_min, ts_max = self._blocks.pop(key)
+        offset = self._file.tell()
+        self._file.write(buffer)
+        self.index.append(IndexEntry(*key, ts_min, ts_max, offset, len(buffer), count))
+
+    def close(self):
+        """Writes the remaining measurements and the index"""
+
+        for key in list(self._blocks):
+            self._write_block(key)
+
+        index_offset = self._file.tell()
+        for entry in self.index:
+            self._file.write(_ENTRY.pack(*entry))
+        self._file.write(_TRAILER.pack(index_offset, len(self.index), INDEX_MAGIC))
+        self._file.flush()
+
+        if self._owned:
+            self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+class ArchiveReader:
+    """Queries the measurements of an archive by logger, cell and time"""
+
+    def __init__(self, file: str | os.PathLike | BinaryIO):
+        """Opens an archive and reads its index
+
+        Args:
+            file: Path of the archive, or a file opened in binary mode.
+
+        Raises:
+            ValueError: When the file is not a closed archive.
+        """
+
+        self._file, self._owned = _open(file, "rb")
+        self.index, _ = _read_index(self._file)
+
+    def blocks(
+        self,
+        logger_id: int | None = None,
+        cell_id: int | None = None,
+        start: int | None = None,
+        end: int | None = None,
+    ) -> list[IndexEntry]:
+        """Finds the blocks that may hold matching measurements
+
+        Args:
+            logger_id: Logger to match, any if None.
+            cell_id: Cell to match, any if None.
+            start: Earliest timestamp to match, inclusive.
+            end: Latest timestamp to match, inclusive.
+
+        Returns:
+            Index entries of the blocks in the order of the archive.
+        """
+
+        return [
+            entry
+            for entry in self.index
+            if (logger_id is None or entry.logger_id == logger_id)
+            and (cell_id is None or entry.cell_id == cell_id)
+            and (start is None or entry.ts_max >= start)
+            and (end is None or entry.ts_min <= end)
+        ]
+
+    def measurements(
+        self,
+        logger_id: int | None = None,
+        cell_id: int | None = None,
+        start: int | None = None,
+        end: int | None = None,
+    ) -> Iterator[bytes]:
+        """Reads matching measurements
+
+        Args:
+            logger_id: Logger to match, any if None.
+            cell_id: Cell to match, any if None.
+            start: Earliest timestamp to match, inclusive.
+            end: Latest timestamp to match, inclusive.
+
+        Yields:
+            Byte arrays of Measurement messages, in the order they were written
+            for each logger and cell.
+        """
+
+        for entry in self.blocks(logger_id, cell_id, start, end):
+            self._file.seek(entry.offset)
+            data = self._file.read(entry.length)
+
+            pos = 0
+            while pos < len(data):
+                length, pos = _decode_varint(data, pos)
+                meas_data = data[pos : pos + length]
+                pos += length
+
+                # blocks only hold one logger and cell
+                ts = Measurement.FromString(meas_data).meta.ts
+                if (start is None or ts >= start) and (end is None or ts <= end):
+                    yield meas_data
+
+    def frames(
+        self,
+        logger_id: int | None = None,
+        cell_id: int | None = None,
+        start: int | None = None,
+        end: int | None = None,
+        raw: bool = True,
+    ) -> dict[str, pd.DataFrame]:
+        """Reads matching measurements into a table per type
+
+        Args:
+            logger_id: Logger to match, any if None.
+            cell_id: Cell to match, any if None.
+            start: Earliest timestamp to match, inclusive.
+            end: Latest timestamp to match, inclusive.
+            raw: Flag to return raw or adjusted measurements
+
+        Returns:
+            Dictionary of DataFrames keyed by measurement type, see
+            decode_measurement_frames().
+        """
+
+        data = bytearray()
+        for entry in self.blocks(logger_id, cell_id, start, end):
+            self._file.seek(entry.offset)
+            data += self._file.read(entry.length)
+
+        frames = decode_measurement_frames(data, raw=raw)
+        for measurement_type, frame in frames.items():
+            mask = pd.Series(True, index=frame.index)
+            if start is not None:
+                mask &= frame["ts"] >= start
+            if end is not None:
+                mask &= frame["ts"] <= end
+            frames[measurement_type] = frame[mask].reset_index(drop=True)
+
+        return frames
+
+    def close(self):
+        """Closes the archive"""
+
+        if self._owned:
+            self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
@@ -1,8 +1,17 @@
 """Module to decode soil power sensor messages"""
 
+from operator import attrgetter
+from typing import BinaryIO
+
+import pandas as pd
 from google.protobuf.json_format import MessageToDict
 
-from .soil_power_sensor_pb2 import Measurement, Response, UserConfiguration
+from .soil_power_sensor_pb2 import (
+    Measurement,
+    MeasurementBatch,
+    Response,
+    UserConfiguration,
+)
 
 
 def decode_response(data: bytes):
@@ -60,6 +69,11 @@ def decode_measurement(data: bytes, raw: bool = True) -> dict:
     measurement_dict = MessageToDict(
         getattr(meas, measurement_type), always_print_fields_with_no_presence=True
     )
+    _upgrade_double_fields(getattr(meas, measurement_type), measurement_dict)
+
+    # samples of bursts are compressed
+    if measurement_type == "power_burst":
+        measurement_dict["samples"] = decode_burst_samples(meas.power_burst.samples)
 
     # store measurement type
     meta_dict["type"] = measurement_type
@@ -82,6 +96,287 @@ def decode_measurement(data: bytes, raw: bool = True) -> dict:
     return meta_dict
 
 
+def _upgrade_double_fields(values, values_dict: dict):
+    """Replaces float values with the values of deprecated double fields
+
+    Measurements encoded before sensor values were sent as float only set the
+    double fields, which are named after the float fields with a "_double"
+    suffix. The double fields are removed from the dictionary.
+
+    Args:
+        values: Measurement values message.
+        values_dict: Dictionary of values from MessageToDict(), modified in
+            place.
+    """
+
+    set_fields = {field.name: value for field, value in values.ListFields()}
+    for field in values.DESCRIPTOR.fields:
+        if not field.name.endswith("_double"):
+            continue
+
+        values_dict.pop(field.json_name, None)
+
+        if field.name in set_fields:
+            float_name = field.name.removesuffix("_double")
+            float_field = values.DESCRIPTOR.fields_by_name[float_name]
+            values_dict[float_field.json_name] = set_fields[field.name]
+
+
+def _decode_varint(data: bytes, pos: int) -> tuple[int, int]:
+    """Decodes a varint
+
+    Args:
+        data: Byte array containing the varint.
+        pos: Index of the first byte of the varint.
+
+    Returns:
+        Tuple of the decoded value and the index after the varint.
+
+    Raises:
+        ValueError: When the varint is truncated.
+    """
+
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data):
+            raise ValueError("Truncated varint")
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def decode_burst_samples(data: bytes) -> list[int]:
+    """Decodes the samples of a PowerBurst block
+
+    Each sample is stored as the zigzag encoded varint of the difference to
+    the previous sample of the block, starting from 0.
+
+    Args:
+        data: Byte array of the samples field.
+
+    Returns:
+        List of raw adc samples.
+
+    Raises:
+        ValueError: When a sample is truncated.
+    """
+
+    samples = []
+    sample = 0
+    pos = 0
+    while pos < len(data):
+        value, pos = _decode_varint(data, pos)
+        sample += (value >> 1) ^ -(value & 1)
+        samples.append(sample)
+
+    return samples
+
+
+def decode_measurements(data: bytes, raw: bool = True) -> list[dict]:
+    """Decodes a batch of length-delimited Measurement messages
+
+    Batches are sent over LoRaWAN on port 4. Each Measurement message is
+    preceded by its length as a varint.
+
+    Args:
+        data: Byte array of the batch.
+        raw: Flag to return raw or adjusted measurements
+
+    Returns:
+        List of measurement dictionaries in the order of the batch, see
+        decode_measurement().
+
+    Raises:
+        KeyError: When a measurement is missing a required field.
+        ValueError: When the batch is truncated.
+    """
+
+    measurements = []
+    pos = 0
+    while pos < len(data):
+        length, pos = _decode_varint(data, pos)
+        if pos + length > len(data):
+            raise ValueError("Truncated measurement")
+        measurements.append(decode_measurement(data[pos : pos + length], raw=raw))
+        pos += length
+
+    return measurements
+
+
+def decode_measurement_frames(
+    data: bytes | BinaryIO, raw: bool = True
+) -> dict[str, pd.DataFrame]:
+    """Decodes length-delimited Measurement messages into a table per type
+
+    Bulk alternative to decode_measurements() for archives of stored uplinks.
+    Values are read straight from the parsed messages into one row per
+    measurement, skipping the conversion of each message to a dictionary.
+    Parsing uses the protobuf backend selected by the protobuf package, which
+    is upb unless PROTOCOL_BUFFERS_PYTHON_IMPLEMENTATION is set.
+
+    Args:
+        data: Byte array or binary file of length-delimited Measurement
+            messages, as sent over LoRaWAN on port 4.
+        raw: Flag to return raw or adjusted measurements
+
+    Returns:
+        Dictionary of DataFrames keyed by measurement type. The columns are
+        the keys of decode_measurement() with the meta fields, such as "ts",
+        "cellId" and "loggerId", followed by the values in "data".
+
+    Raises:
+        KeyError: When a measurement is missing a required field.
+        ValueError: When the data is truncated.
+    """
+
+    if hasattr(data, "read"):
+        data = data.read()
+    view = memoryview(data)
+
+    rows = {}
+    getters = {}
+    pos = 0
+    while pos < len(view):
+        # lengths of measurements fit in a single byte
+        length = view[pos]
+        if length < 0x80:
+            pos += 1
+        else:
+            length, pos = _decode_varint(view, pos)
+        if pos + length > len(view):
+            raise ValueError("Truncated measurement")
+
+        meas = Measurement.FromString(view[pos : pos + length])
+        pos += length
+
+        if not meas.HasField("meta"):
+            raise KeyError("Measurement missing metadata")
+        measurement_type = meas.WhichOneof("measurement")
+        if measurement_type is None:
+            raise KeyError("Measurement missing data")
+
+        if measurement_type not in getters:
+            names = _frame_fields(measurement_type)
+            getters[measurement_type] = attrgetter(*names)
+            rows[measurement_type] = []
+        rows[measurement_type].append(getters[measurement_type](meas))
+
+    return {
+        measurement_type: _measurement_frame(measurement_type, type_rows, raw)
+        for measurement_type, type_rows in rows.items()
+    }
+
+
+def _frame_fields(measurement_type: str) -> list[str]:
+    """Gets the attribute paths of the columns of a measurement type
+
+    Args:
+        measurement_type: Name of the measurement field.
+
+    Returns:
+        Paths of the meta fields followed by the measurement values.
+    """
+
+    meta = Measurement.DESCRIPTOR.fields_by_name["meta"].message_type
+    values = Measurement.DESCRIPTOR.fields_by_name[measurement_type].message_type
+    meta_fields = [f"meta.{field.name}" for field in meta.fields]
+    value_fields = [f"{measurement_type}.{field.name}" for field in values.fields]
+    return meta_fields + value_fields
+
+
+def _measurement_frame(measurement_type: str, rows: list, raw: bool) -> pd.DataFrame:
+    """Builds the DataFrame of a measurement type
+
+    Args:
+        measurement_type: Name of the measurement field.
+        rows: Tuples of values in the order of _frame_fields().
+        raw: Flag to return raw or adjusted measurements
+
+    Returns:
+        DataFrame with the keys of decode_measurement() as columns.
+    """
+
+    meta = Measurement.DESCRIPTOR.fields_by_name["meta"].message_type
+    values = Measurement.DESCRIPTOR.fields_by_name[measurement_type].message_type
+    fields = list(meta.fields) + list(values.fields)
+    frame = pd.DataFrame.from_records(
+        rows, columns=[field.json_name for field in fields]
+    )
+
+    # same as _upgrade_double_fields(), set double fields replace float values
+    for field in values.fields:
+        if not field.name.endswith("_double"):
+            continue
+        float_field = values.fields_by_name[field.name.removesuffix("_double")]
+        double_values = frame.pop(field.json_name)
+        frame[float_field.json_name] = double_values.where(
+            double_values != 0, frame[float_field.json_name]
+        )
+
+    if not raw and measurement_type == "bme280":
+        # convert measurements to hPa, C, and %
+        frame["pressure"] /= 10.0
+        frame["temperature"] /= 100.0
+        frame["humidity"] /= 1000.0
+
+    return frame
+
+
+def decode_measurement_batch(data: bytes, raw: bool = True) -> list[dict]:
+    """Decodes a MeasurementBatch message
+
+    Batches are sent over LoRaWAN on port 5.
+
+    Args:
+        data: Byte array of MeasurementBatch message.
+        raw: Flag to return raw or adjusted measurements
+
+    Returns:
+        List of measurement dictionaries in the order of the batch, see
+        decode_measurement().
+
+    Raises:
+        KeyError: When the serialized data is missing a required field.
+        ValueError: When the fields of the batch differ in length.
+    """
+
+    batch = MeasurementBatch()
+    batch.ParseFromString(data)
+
+    if not batch.HasField("meta"):
+        raise KeyError("Measurement batch missing metadata")
+    if not batch.HasField("batch"):
+        raise KeyError("Measurement batch missing data")
+
+    measurement_type = batch.WhichOneof("batch")
+    columns = getattr(batch, measurement_type)
+    names = [field.name for field in columns.DESCRIPTOR.fields]
+    for name in names:
+        if len(getattr(columns, name)) != len(batch.ts_delta):
+            raise ValueError(f"Length of {name} does not match number of samples")
+
+    measurements = []
+    ts = batch.meta.ts
+    for i, delta in enumerate(batch.ts_delta):
+        ts += delta
+
+        # expand sample into a measurement
+        meas = Measurement()
+        meas.meta.CopyFrom(batch.meta)
+        meas.meta.ts = ts
+        values = getattr(meas, measurement_type)
+        for name in names:
+            setattr(values, name, getattr(columns, name)[i])
+
+        measurements.append(decode_measurement(meas.SerializeToString(), raw=raw))
+
+    return measurements
+
+
 def decode_user_configuration(data: bytes) -> dict:
     """Decodes a UserConfiguration message
 
@@ -0,0 +1,315 @@
+"""Module to compress and decompress consecutive measurements
+
+Implements the format of EncodeMeasurementDelta() in transcoder.h. Each
+measurement type is a separate stream. The first measurement of a stream, and
+every KEYFRAME_INTERVAL-th measurement after, is a keyframe holding the
+serialized Measurement message. The others are deltas holding the values that
+changed since the previous measurement of the stream.
+
+Float and double values are stored as the XOR of their bits with the previous
+value, integers as the difference. Types with more values than fit the bitmap,
+such as power summaries, or without numeric values, such as power bursts, are
+always stored as keyframes. Compressed measurements are decompressed in the
+order they were compressed.
+"""
+
+import struct
+
+from .decode import _decode_varint, decode_measurement
+from .soil_power_sensor_pb2 import Measurement
+
+KEYFRAME_INTERVAL = 16
+"""Maximum number of measurements of a stream between keyframes"""
+
+_KEYFRAME = 0x80
+
+# values of each measurement type in the order of the message fields, types
+# that are missing are only stored as keyframes
+_VALUES = {
+    "power": [
+        ("voltage_double", "xor64"),
+        ("current_double", "xor64"),
+        ("voltage", "xor32"),
+        ("current", "xor32"),
+    ],
+    "teros12": [
+        ("vwc_raw_double", "xor64"),
+        ("vwc_adj_double", "xor64"),
+        ("temp_double", "xor64"),
+        ("ec", "diff32"),
+        ("vwc_raw", "xor32"),
+        ("vwc_adj", "xor32"),
+        ("temp", "xor32"),
+    ],
+    "phytos31": [
+        ("voltage_double", "xor64"),
+        ("leaf_wetness_double", "xor64"),
+        ("voltage", "xor32"),
+        ("leaf_wetness", "xor32"),
+    ],
+    "bme280": [
+        ("pressure", "diff32"),
+        ("temperature", "diff32"),
+        ("humidity", "diff32"),
+    ],
+    "teros21": [
+        ("matric_pot_double", "xor64"),
+        ("temp_double", "xor64"),
+        ("matric_pot", "xor32"),
+        ("temp", "xor32"),
+    ],
+}
+
+
+def _encode_varint(value: int) -> bytes:
+    """Encodes an unsigned varint"""
+
+    out = bytearray()
+    while value > 0x7F:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def _zigzag(value: int) -> int:
+    """Maps signed integers to unsigned, small magnitudes to small values"""
+
+    return value << 1 if value >= 0 else (-value << 1) - 1
+
+
+def _unzigzag(value: int) -> int:
+    """Inverse of _zigzag()"""
+
+    return value >> 1 if not value & 1 else -((value + 1) >> 1)
+
+
+def _signed32(value: int) -> int:
+    """Wraps an integer to a signed 32-bit integer"""
+
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def _load(values, name: str, kind: str) -> int:
+    """Gets the bits of a value as stored by the firmware"""
+
+    value = getattr(values, name)
+    if kind == "xor64":
+        return struct.unpack("<Q", struct.pack("<d", value))[0]
+    if kind == "xor32":
+        return struct.unpack("<I", struct.pack("<f", value))[0]
+    return value & 0xFFFFFFFF
+
+
+def _store(values, name: str, kind: str, bits: int):
+    """Sets a value from its bits"""
+
+    field = values.DESCRIPTOR.fields_by_name[name]
+    if kind == "xor64":
+        value = struct.unpack("<d", struct.pack("<Q", bits))[0]
+    elif kind == "xor32":
+        value = struct.unpack("<f", struct.pack("<I", bits))[0]
+    elif field.type == field.TYPE_INT32:
+        value = _signed32(bits)
+    else:
+        value = bits & 0xFFFFFFFF
+    setattr(values, name, value)
+
+
+def _upgrade(meas: Measurement) -> Measurement:
+    """Copies values of deprecated double fields to zero float fields
+
+    Matches the references of the firmware, see DecodeMeasurement().
+    """
+
+    measurement_type = meas.WhichOneof("measurement")
+    values = getattr(meas, measurement_type)
+    for name, kind in _VALUES.get(measurement_type, []):
+        if kind != "xor64":
+            continue
+        float_name = name.removesuffix("_double")
+        if getattr(values, float_name) == 0:
+            bits = struct.pack("<f", getattr(values, name))
+            setattr(values, float_name, struct.unpack("<f", bits)[0])
+    return meas
+
+
+class _Stream:
+    """Reference of a stream of compressed measurements"""
+
+    def __init__(self):
+        self.ref = None
+        self.period = 0
+        self.seq = 0
+        self.since_keyframe = 0
+
+    def advance(self, data: bytes, meas: Measurement):
+        """Makes a measurement the reference of the stream"""
+
+        if data[0] & _KEYFRAME:
+            self.period = 0
+            self.since_keyframe = 0
+        else:
+            self.period = (meas.meta.ts - self.ref.meta.ts) & 0xFFFFFFFF
+            self.since_keyframe += 1
+
+        self.ref = _upgrade(Measurement.FromString(meas.SerializeToString()))
+        self.seq = data[1]
+
+
+def _measurement_types() -> dict[str, int]:
+    """Gets the field numbers of the measurement types"""
+
+    oneof = Measurement.DESCRIPTOR.oneofs_by_name["measurement"]
+    return {field.name: field.number for field in oneof.fields}
+
+
+class MeasurementCompressor:
+    """Compresses measurements against the previous one of the same type"""
+
+    def __init__(self):
+        self._types = _measurement_types()
+        self._streams = {}
+
+    def compress(self, data: bytes) -> bytes:
+        """Compresses a Measurement message
+
+        Args:
+            data: Byte array of Measurement message.
+
+        Returns:
+            Byte array of the compressed measurement.
+
+        Raises:
+            KeyError: When the measurement type is not supported.
+        """
+
+        meas = Measurement.FromString(data)
+        name = meas.WhichOneof("measurement")
+        if name is None:
+            raise KeyError("Measurement missing data")
+
+        which = self._types[name]
+        stream = self._streams.setdefault(which, _Stream())
+        seq = (stream.seq + 1) & 0xFF
+
+        ref = stream.ref
+        if (
+            name not in _VALUES
+            or ref is None
+            or stream.since_keyframe + 1 >= KEYFRAME_INTERVAL
+            or meas.HasField("meta") != ref.HasField("meta")
+            or meas.meta.cell_id != ref.meta.cell_id
+            or meas.meta.logger_id != ref.meta.logger_id
+        ):
+            out = bytes([_KEYFRAME | which, seq]) + meas.SerializeToString()
+            stream.advance(out, meas)
+            return out
+
+        interval = (meas.meta.ts - ref.meta.ts) & 0xFFFFFFFF
+        change = _signed32(interval - stream.period)
+        body = bytearray(_encode_varint(_zigzag(change)))
+
+        # compared as decoded, so float fields of double values are not stored
+        bitmap = 0
+        values = getattr(_upgrade(Measurement.FromString(data)), name)
+        ref_values = getattr(ref, name)
+        for i, (field, kind) in enumerate(_VALUES[name]):
+            ref_bits = _load(ref_values, field, kind)
+            bits = _load(values, field, kind)
+            if bits == ref_bits:
+                continue
+
+            bitmap |= 1 << i
+            if kind == "diff32":
+                body += _encode_varint(_zigzag(_signed32(bits - ref_bits)))
+            else:
+                body += _encode_varint(bits ^ ref_bits)
+
+        out = bytes([which, seq, bitmap]) + bytes(body)
+        stream.advance(out, meas)
+        return out
+
+
+class MeasurementDecompressor:
+    """Decompresses measurements in the order they were compressed"""
+
+    def __init__(self):
+        self._names = {number: name for name, number in _measurement_types().items()}
+        self._streams = {}
+
+    def decompress(self, data: bytes, raw: bool = True) -> dict:
+        """Decompresses a measurement
+
+        Args:
+            data: Byte array of the compressed measurement, the data of a
+                FRAM_RECORD_DELTA record.
+            raw: Flag to return raw or adjusted measurements
+
+        Returns:
+            Measurement dictionary, see decode_measurement().
+
+        Raises:
+            KeyError: When the serialized data is missing a required field.
+            ValueError: When the data is malformed or the reference of a delta
+                is missing.
+        """
+
+        if len(data) < 2:
+            raise ValueError("Truncated compressed measurement")
+
+        which = data[0] & ~_KEYFRAME
+        name = self._names.get(which)
+        if name is None:
+            raise ValueError(f"Unknown measurement type {which}")
+        stream = self._streams.setdefault(which, _Stream())
+
+        if data[0] & _KEYFRAME:
+            meas = Measurement.FromString(data[2:])
+            if meas.WhichOneof("measurement") != name:
+                raise ValueError("Keyframe does not match its measurement type")
+        else:
+            meas = self._decode_delta(stream, name, data)
+
+        stream.advance(data, meas)
+        return decode_measurement(meas.SerializeToString(), raw=raw)
+
+    @staticmethod
+    def _decode_delta(stream: _Stream, name: str, data: bytes) -> Measurement:
+        """Applies a delta to the reference of its stream"""
+
+        if name not in _VALUES:
+            raise ValueError(f"Measurement type {name} is only stored as keyframes")
+        if stream.ref is None or data[1] != (stream.seq + 1) & 0xFF:
+            raise ValueError("Missing reference of compressed measurement")
+        if len(data) < 3:
+            raise ValueError("Truncated compressed measurement")
+
+        fields = _VALUES[name]
+        bitmap = data[2]
+        if bitmap >> len(fields):
+            raise ValueError("Invalid bitmap of compressed measurement")
+
+        meas = Measurement.FromString(stream.ref.SerializeToString())
+        change, pos = _decode_varint(data, 3)
+        meas.meta.ts = (
+            stream.ref.meta.ts + stream.period + _unzigzag(change)
+        ) & 0xFFFFFFFF
+
+        values = getattr(meas, name)
+        for i, (field, kind) in enumerate(fields):
+            if not bitmap & (1 << i):
+                continue
+
+            ref_bits = _load(values, field, kind)
+            value, pos = _decode_varint(data, pos)
+            if kind == "diff32":
+                _store(values, field, kind, ref_bits + _unzigzag(value))
+            else:
+                _store(values, field, kind, ref_bits ^ value)
+
+        if pos != len(data):
+            raise ValueError("Trailing bytes in compressed measurement")
+
+        return _upgrade(meas)
@@ -8,10 +8,20 @@ Each type of measurement has a corresponding encoding function as follows:
 
     PowerMeasurement -> encode_power_measurement()
     Teros12Measurement -> encode_teros12_measurement()
+    PowerSummary -> encode_power_summary()
+
+Sensor values are encoded as float. Pass double=True to encode the deprecated
+double fields for backends that do not decode the float fields yet.
+
+Measurements of the same type, cell and logger can be combined into a compact
+batch with
+
+    encode_measurement_batch()
 """
 
 from .soil_power_sensor_pb2 import (
     Measurement,
+    MeasurementBatch,
     Response,
     UserConfiguration,
     EnabledSensor,
@@ -44,7 +54,12 @@ def encode_response(success: bool = True) -> bytes:
 
 
 def encode_power_measurement(
-    ts: int, cell_id: int, logger_id: int, voltage: float, current: float
+    ts: int,
+    cell_id: int,
+    logger_id: int,
+    voltage: float,
+    current: float,
+    double: bool = False,
 ) -> bytes:
     """Encodes a PowerMeasurement within the Measurement message
 
@@ -54,6 +69,7 @@ def encode_power_measurement(
         logger_id: Logger Id from Dirtviz
         voltage: Voltage in V (Volts)
         current: Current in A (Amps)
+        double: Encode values in the deprecated double fields
 
     Returns:
         Serialized Power measurement
@@ -67,8 +83,12 @@ def encode_power_measurement(
     meas.meta.logger_id = logger_id
 
     # power
-    meas.power.voltage = voltage
-    meas.power.current = current
+    if double:
+        meas.power.voltage_double = voltage
+        meas.power.current_double = current
+    else:
+        meas.power.voltage = voltage
+        meas.power.current = current
 
     return meas.SerializeToString()
 
@@ -81,6 +101,7 @@ def encode_teros12_measurement(
     vwc_adj: float,
     temp: float,
     ec: int,
+    double: bool = False,
 ) -> bytes:
     """Encodes a Teros12Measurment within the Measurement message
 
@@ -92,6 +113,7 @@ def encode_teros12_measurement(
         vwc_adj: Volumetric water content from Teros12 with calibration applied
         temp: Temperature in C
         ec: Electrical conductivity
+        double: Encode values in the deprecated double fields
 
     Returns:
         Serialized Teros12 measurement
@@ -105,16 +127,26 @@ def encode_teros12_measurement(
     meas.meta.logger_id = logger_id
 
     # teros12
-    meas.teros12.vwc_raw = vwc_raw
-    meas.teros12.vwc_adj = vwc_adj
-    meas.teros12.temp = temp
+    if double:
+        meas.teros12.vwc_raw_double = vwc_raw
+        meas.teros12.vwc_adj_double = vwc_adj
+        meas.teros12.temp_double = temp
+    else:
+        meas.teros12.vwc_raw = vwc_raw
+        meas.teros12.vwc_adj = vwc_adj
+        meas.teros12.temp = temp
     meas.teros12.ec = ec
 
     return meas.SerializeToString()
 
 
 def encode_phytos31_measurement(
-    ts: int, cell_id: int, logger_id: int, voltage: float, leaf_wetness: float
+    ts: int,
+    cell_id: int,
+    logger_id: int,
+    voltage: float,
+    leaf_wetness: float,
+    double: bool = False,
 ) -> bytes:
     """Encodes a Phytos31Measurement within the Measurement message
 
@@ -124,6 +156,7 @@ def encode_phytos31_measurement(
         logger_id: Logger Id from Dirtviz
         voltage: Raw voltage reading
         leaf_wetness: Calibrated leaf wetness
+        double: Encode values in the deprecated double fields
 
     Returns:
         Serialized Phytos31 measurement
@@ -137,8 +170,12 @@ def encode_phytos31_measurement(
     meas.meta.logger_id = logger_id
 
     # phytos31
-    meas.phytos31.voltage = voltage
-    meas.phytos31.leaf_wetness = leaf_wetness
+    if double:
+        meas.phytos31.voltage_double = voltage
+        meas.phytos31.leaf_wetness_double = leaf_wetness
+    else:
+        meas.phytos31.voltage = voltage
+        meas.phytos31.leaf_wetness = leaf_wetness
     return meas.SerializeToString()
 
     return meas.SerializeToString()
@@ -201,7 +238,21 @@ def encode_teros21_measurement(
     cell_id: int,
     matric_pot: float,
     temp: float,
+    double: bool = False,
 ) -> bytes:
+    """Encodes a Teros21Measurement within the Measurement message
+
+    Args:
+        ts: Timestamp in unix epochs
+        logger_id: Logger Id from Dirtviz
+        cell_id: Cell Id from Dirtviz
+        matric_pot: Matric potential in kPa
+        temp: Temperature in C
+        double: Encode values in the deprecated double fields
+
+    Returns:
+        Serialized Teros21 measurement
+    """
 
     meas = Measurement()
 
@@ -210,12 +261,129 @@ def encode_teros21_measurement(
     meas.meta.cell_id = cell_id
     meas.meta.logger_id = logger_id
 
-    meas.teros21.matric_pot = matric_pot
-    meas.teros21.temp = temp
+    # teros21
+    if double:
+        meas.teros21.matric_pot_double = matric_pot
+        meas.teros21.temp_double = temp
+    else:
+        meas.teros21.matric_pot = matric_pot
+        meas.teros21.temp = temp
 
     return meas.SerializeToString()
 
 
+def encode_power_summary(
+    ts: int,
+    cell_id: int,
+    logger_id: int,
+    count: int,
+    voltage: tuple[float, float, float, float],
+    current: tuple[float, float, float, float],
+) -> bytes:
+    """Encodes a PowerSummary within the Measurement message
+
+    Args:
+        ts: Timestamp in unix epochs of the start of the window
+        cell_id: Cell Id from Dirtviz
+        logger_id: Logger Id from Dirtviz
+        count: Number of samples of each channel
+        voltage: Mean, minimum, maximum and standard deviation of voltage
+        current: Mean, minimum, maximum and standard deviation of current
+
+    Returns:
+        Serialized power summary
+    """
+
+    meas = Measurement()
+
+    # metadata
+    meas.meta.ts = ts
+    meas.meta.cell_id = cell_id
+    meas.meta.logger_id = logger_id
+
+    # power summary
+    summary = meas.power_summary
+    summary.count = count
+    (
+        summary.voltage_mean,
+        summary.voltage_min,
+        summary.voltage_max,
+        summary.voltage_stddev,
+    ) = voltage
+    (
+        summary.current_mean,
+        summary.current_min,
+        summary.current_max,
+        summary.current_stddev,
+    ) = current
+
+    return meas.SerializeToString()
+
+
+def encode_measurement_batch(measurements: list[bytes]) -> bytes:
+    """Encodes Measurement messages into a MeasurementBatch message
+
+    The metadata of the first measurement is used for the batch. Timestamps are
+    stored as the difference to the previous measurement and values are
+    converted to float.
+
+    Args:
+        measurements: Serialized Measurement messages of the same type, cell
+            and logger.
+
+    Returns:
+        Serialized MeasurementBatch message
+
+    Raises:
+        ValueError: When the measurements are empty, do not share the type,
+            cell or logger, or their type can not be batched.
+    """
+
+    if len(measurements) == 0:
+        raise ValueError("No measurements to batch")
+
+    batch = MeasurementBatch()
+    measurement_type = None
+    prev_ts = None
+
+    for data in measurements:
+        meas = Measurement()
+        meas.ParseFromString(data)
+
+        if measurement_type is None:
+            measurement_type = meas.WhichOneof("measurement")
+            if measurement_type is None:
+                raise ValueError("Measurement missing data")
+            if measurement_type not in batch.DESCRIPTOR.fields_by_name:
+                raise ValueError(
+                    f"Measurement type {measurement_type} can not be batched"
+                )
+            batch.meta.CopyFrom(meas.meta)
+            prev_ts = meas.meta.ts
+        elif (
+            meas.WhichOneof("measurement") != measurement_type
+            or meas.meta.cell_id != batch.meta.cell_id
+            or meas.meta.logger_id != batch.meta.logger_id
+        ):
+            raise ValueError("Measurements do not share type, cell and logger")
+
+        batch.ts_delta.append(meas.meta.ts - prev_ts)
+        prev_ts = meas.meta.ts
+
+        # append each value to the column of the same name
+        values = getattr(meas, measurement_type)
+        columns = getattr(batch, measurement_type)
+        for field in columns.DESCRIPTOR.fields:
+            value = getattr(values, field.name)
+            # measurements encoded before values were sent as float
+            double_name = f"{field.name}_double"
+            if value == 0 and double_name in values.DESCRIPTOR.fields_by_name:
+                value = getattr(values, double_name)
+            getattr(columns, field.name).append(value)
+
+    return batch.SerializeToString()
+
+
 def encode_user_configuration(
     logger_id: int,
     cell_id: int,
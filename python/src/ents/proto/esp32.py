@@ -32,7 +32,9 @@ def encode_esp32command(cmd_type: str, **kwargs) -> bytes:
     return cmd.SerializeToString()
 
 
-def encode_page_command(req: str, fd: int, bs: int = 0, n: int = 0) -> message:
+def encode_page_command(
+    req: str, fd: int, bs: int = 0, n: int = 0, data: bytes = b"", offset: int = 0
+) -> message:
     """Encodes a command for memory paging
 
     Args:
@@ -40,6 +42,8 @@ def encode_page_command(req: str, fd: int, bs: int = 0, n: int = 0) -> message:
         fd: File descriptor
         bs: Block size
         n: Number of bytes
+        data: Bytes to write
+        offset: Offset into the file to read from
 
     Return:
         PageCommand message
@@ -54,6 +58,7 @@ def encode_page_command(req: str, fd: int, bs: int = 0, n: int = 0) -> message:
         "close": PageCommand.RequestType.CLOSE,
         "read": PageCommand.RequestType.READ,
         "write": PageCommand.RequestType.WRITE,
+        "delete": PageCommand.RequestType.DELETE,
     }
 
     # ensure lower case
@@ -67,6 +72,8 @@ def encode_page_command(req: str, fd: int, bs: int = 0, n: int = 0) -> message:
     page_cmd.file_descriptor = fd
     page_cmd.block_size = bs
     page_cmd.num_bytes = n
+    page_cmd.data = data
+    page_cmd.offset = offset
 
     return page_cmd
 
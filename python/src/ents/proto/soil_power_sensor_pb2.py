@@ -24,49 +24,65 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x17soil_power_sensor.proto\"E\n\x13MeasurementMetadata\x12\x0f\n\x07\x63\x65ll_id\x18\x01 \x01(\r\x12\x11\n\tlogger_id\x18\x02 \x01(\r\x12\n\n\x02ts\x18\x03 \x01(\r\"4\n\x10PowerMeasurement\x12\x0f\n\x07voltage\x18\x02 \x01(\x01\x12\x0f\n\x07\x63urrent\x18\x03 \x01(\x01\"P\n\x12Teros12Measurement\x12\x0f\n\x07vwc_raw\x18\x02 \x01(\x01\x12\x0f\n\x07vwc_adj\x18\x03 \x01(\x01\x12\x0c\n\x04temp\x18\x04 \x01(\x01\x12\n\n\x02\x65\x63\x18\x05 \x01(\r\"6\n\x12Teros21Measurement\x12\x12\n\nmatric_pot\x18\x01 \x01(\x01\x12\x0c\n\x04temp\x18\x02 \x01(\x01\"<\n\x13Phytos31Measurement\x12\x0f\n\x07voltage\x18\x01 \x01(\x01\x12\x14\n\x0cleaf_wetness\x18\x02 \x01(\x01\"L\n\x11\x42ME280Measurement\x12\x10\n\x08pressure\x18\x01 \x01(\r\x12\x13\n\x0btemperature\x18\x02 \x01(\x05\x12\x10\n\x08humidity\x18\x03 \x01(\r\"\x84\x02\n\x0bMeasurement\x12\"\n\x04meta\x18\x01 \x01(\x0b\x32\x14.MeasurementMetadata\x12\"\n\x05power\x18\x02 \x01(\x0b\x32\x11.PowerMeasurementH\x00\x12&\n\x07teros12\x18\x03 \x01(\x0b\x32\x13.Teros12MeasurementH\x00\x12(\n\x08phytos31\x18\x04 \x01(\x0b\x32\x14.Phytos31MeasurementH\x00\x12$\n\x06\x62me280\x18\x05 \x01(\x0b\x32\x12.BME280MeasurementH\x00\x12&\n\x07teros21\x18\x06 \x01(\x0b\x32\x13.Teros21MeasurementH\x00\x42\r\n\x0bmeasurement\"X\n\x08Response\x12$\n\x04resp\x18\x01 \x01(\x0e\x32\x16.Response.ResponseType\"&\n\x0cResponseType\x12\x0b\n\x07SUCCESS\x10\x00\x12\t\n\x05\x45RROR\x10\x01\"\x8b\x01\n\x0c\x45sp32Command\x12$\n\x0cpage_command\x18\x01 \x01(\x0b\x32\x0c.PageCommandH\x00\x12$\n\x0ctest_command\x18\x02 \x01(\x0b\x32\x0c.TestCommandH\x00\x12$\n\x0cwifi_command\x18\x03 \x01(\x0b\x32\x0c.WiFiCommandH\x00\x42\t\n\x07\x63ommand\"\xb6\x01\n\x0bPageCommand\x12.\n\x0c\x66ile_request\x18\x01 \x01(\x0e\x32\x18.PageCommand.RequestType\x12\x17\n\x0f\x66ile_descriptor\x18\x02 \x01(\r\x12\x12\n\nblock_size\x18\x03 \x01(\r\x12\x11\n\tnum_bytes\x18\x04 \x01(\r\"7\n\x0bRequestType\x12\x08\n\x04OPEN\x10\x00\x12\t\n\x05\x43LOSE\x10\x01\x12\x08\n\x04READ\x10\x02\x12\t\n\x05WRITE\x10\x03\"\x82\x01\n\x0bTestCommand\x12\'\n\x05state\x18\x01 \x01(\x0e\x32\x18.TestCommand.ChangeState\x12\x0c\n\x04\x64\x61ta\x18\x02 \x01(\x05\"<\n\x0b\x43hangeState\x12\x0b\n\x07RECEIVE\x10\x00\x12\x13\n\x0fRECEIVE_REQUEST\x10\x01\x12\x0b\n\x07REQUEST\x10\x02\"\xfe\x01\n\x0bWiFiCommand\x12\x1f\n\x04type\x18\x01 \x01(\x0e\x32\x11.WiFiCommand.Type\x12\x0c\n\x04ssid\x18\x02 \x01(\t\x12\x0e\n\x06passwd\x18\x03 \x01(\t\x12\x0b\n\x03url\x18\x04 \x01(\t\x12\x0c\n\x04port\x18\x08 \x01(\r\x12\n\n\x02rc\x18\x05 \x01(\r\x12\n\n\x02ts\x18\x06 \x01(\r\x12\x0c\n\x04resp\x18\x07 \x01(\x0c\"o\n\x04Type\x12\x0b\n\x07\x43ONNECT\x10\x00\x12\x08\n\x04POST\x10\x01\x12\t\n\x05\x43HECK\x10\x02\x12\x08\n\x04TIME\x10\x03\x12\x0e\n\nDISCONNECT\x10\x04\x12\x0e\n\nCHECK_WIFI\x10\x05\x12\r\n\tCHECK_API\x10\x06\x12\x0c\n\x08NTP_SYNC\x10\x07\"\xdc\x02\n\x11UserConfiguration\x12\x11\n\tlogger_id\x18\x01 \x01(\r\x12\x0f\n\x07\x63\x65ll_id\x18\x02 \x01(\r\x12$\n\rUpload_method\x18\x03 \x01(\x0e\x32\r.Uploadmethod\x12\x17\n\x0fUpload_interval\x18\x04 \x01(\r\x12\'\n\x0f\x65nabled_sensors\x18\x05 \x03(\x0e\x32\x0e.EnabledSensor\x12\x15\n\rVoltage_Slope\x18\x06 \x01(\x01\x12\x16\n\x0eVoltage_Offset\x18\x07 \x01(\x01\x12\x15\n\rCurrent_Slope\x18\x08 \x01(\x01\x12\x16\n\x0e\x43urrent_Offset\x18\t \x01(\x01\x12\x11\n\tWiFi_SSID\x18\n \x01(\t\x12\x15\n\rWiFi_Password\x18\x0b \x01(\t\x12\x18\n\x10\x41PI_Endpoint_URL\x18\x0c \x01(\t\x12\x19\n\x11\x41PI_Endpoint_Port\x18\r \x01(\r*O\n\rEnabledSensor\x12\x0b\n\x07Voltage\x10\x00\x12\x0b\n\x07\x43urrent\x10\x01\x12\x0b\n\x07Teros12\x10\x02\x12\x0b\n\x07Teros21\x10\x03\x12\n\n\x06\x42ME280\x10\x04*\"\n\x0cUploadmethod\x12\x08\n\x04LoRa\x10\x00\x12\x08\n\x04WiFi\x10\x01\x62\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x17soil_power_sensor.proto\"E\n\x13MeasurementMetadata\x12\x0f\n\x07\x63\x65ll_id\x18\x01 \x01(\r\x12\x11\n\tlogger_id\x18\x02 \x01(\r\x12\n\n\x02ts\x18\x03 \x01(\r\"l\n\x10PowerMeasurement\x12\x1a\n\x0evoltage_double\x18\x02 \x01(\x01\x42\x02\x18\x01\x12\x1a\n\x0e\x63urrent_double\x18\x03 \x01(\x01\x42\x02\x18\x01\x12\x0f\n\x07voltage\x18\x04 \x01(\x02\x12\x0f\n\x07\x63urrent\x18\x05 \x01(\x02\"\xa1\x01\n\x12Teros12Measurement\x12\x1a\n\x0evwc_raw_double\x18\x02 \x01(\x01\x42\x02\x18\x01\x12\x1a\n\x0evwc_adj_double\x18\x03 \x01(\x01\x42\x02\x18\x01\x12\x17\n\x0btemp_double\x18\x04 \x01(\x01\x42\x02\x18\x01\x12\n\n\x02\x65\x63\x18\x05 \x01(\r\x12\x0f\n\x07vwc_raw\x18\x06 \x01(\x02\x12\x0f\n\x07vwc_adj\x18\x07 \x01(\x02\x12\x0c\n\x04temp\x18\x08 \x01(\x02\"n\n\x12Teros21Measurement\x12\x1d\n\x11matric_pot_double\x18\x01 \x01(\x01\x42\x02\x18\x01\x12\x17\n\x0btemp_double\x18\x02 \x01(\x01\x42\x02\x18\x01\x12\x12\n\nmatric_pot\x18\x03 \x01(\x02\x12\x0c\n\x04temp\x18\x04 \x01(\x02\"y\n\x13Phytos31Measurement\x12\x1a\n\x0evoltage_double\x18\x01 \x01(\x01\x42\x02\x18\x01\x12\x1f\n\x13leaf_wetness_double\x18\x02 \x01(\x01\x42\x02\x18\x01\x12\x0f\n\x07voltage\x18\x03 \x01(\x02\x12\x14\n\x0cleaf_wetness\x18\x04 \x01(\x02\"L\n\x11\x42ME280Measurement\x12\x10\n\x08pressure\x18\x01 \x01(\r\x12\x13\n\x0btemperature\x18\x02 \x01(\x05\x12\x10\n\x08humidity\x18\x03 \x01(\r\"\xcd\x01\n\x0cPowerSummary\x12\r\n\x05\x63ount\x18\x01 \x01(\r\x12\x14\n\x0cvoltage_mean\x18\x02 \x01(\x02\x12\x13\n\x0bvoltage_min\x18\x03 \x01(\x02\x12\x13\n\x0bvoltage_max\x18\x04 \x01(\x02\x12\x16\n\x0evoltage_stddev\x18\x05 \x01(\x02\x12\x14\n\x0c\x63urrent_mean\x18\x06 \x01(\x02\x12\x13\n\x0b\x63urrent_min\x18\x07 \x01(\x02\x12\x13\n\x0b\x63urrent_max\x18\x08 \x01(\x02\x12\x16\n\x0e\x63urrent_stddev\x18\t \x01(\x02\"~\n\nPowerBurst\x12\x10\n\x08\x62urst_id\x18\x01 \x01(\r\x12\x0f\n\x07\x63urrent\x18\x02 \x01(\x08\x12\x0c\n\x04rate\x18\x03 \x01(\r\x12\x0e\n\x06offset\x18\x04 \x01(\r\x12\r\n\x05total\x18\x05 \x01(\r\x12\x0f\n\x07\x64ropped\x18\x06 \x01(\r\x12\x0f\n\x07samples\x18\x07 \x01(\x0c\"\xd0\x02\n\x0bMeasurement\x12\"\n\x04meta\x18\x01 \x01(\x0b\x32\x14.MeasurementMetadata\x12\"\n\x05power\x18\x02 \x01(\x0b\x32\x11.PowerMeasurementH\x00\x12&\n\x07teros12\x18\x03 \x01(\x0b\x32\x13.Teros12MeasurementH\x00\x12(\n\x08phytos31\x18\x04 \x01(\x0b\x32\x14.Phytos31MeasurementH\x00\x12$\n\x06\x62me280\x18\x05 \x01(\x0b\x32\x12.BME280MeasurementH\x00\x12&\n\x07teros21\x18\x06 \x01(\x0b\x32\x13.Teros21MeasurementH\x00\x12&\n\rpower_summary\x18\x07 \x01(\x0b\x32\r.PowerSummaryH\x00\x12\"\n\x0bpower_burst\x18\x08 \x01(\x0b\x32\x0b.PowerBurstH\x00\x42\r\n\x0bmeasurement\".\n\nPowerBatch\x12\x0f\n\x07voltage\x18\x01 \x03(\x02\x12\x0f\n\x07\x63urrent\x18\x02 \x03(\x02\"J\n\x0cTeros12Batch\x12\x0f\n\x07vwc_raw\x18\x01 \x03(\x02\x12\x0f\n\x07vwc_adj\x18\x02 \x03(\x02\x12\x0c\n\x04temp\x18\x03 \x03(\x02\x12\n\n\x02\x65\x63\x18\x04 \x03(\r\"0\n\x0cTeros21Batch\x12\x12\n\nmatric_pot\x18\x01 \x03(\x02\x12\x0c\n\x04temp\x18\x02 \x03(\x02\"6\n\rPhytos31Batch\x12\x0f\n\x07voltage\x18\x01 \x03(\x02\x12\x14\n\x0cleaf_wetness\x18\x02 \x03(\x02\"F\n\x0b\x42ME280Batch\x12\x10\n\x08pressure\x18\x01 \x03(\r\x12\x13\n\x0btemperature\x18\x02 \x03(\x11\x12\x10\n\x08humidity\x18\x03 \x03(\r\"\xf7\x01\n\x10MeasurementBatch\x12\"\n\x04meta\x18\x01 \x01(\x0b\x32\x14.MeasurementMetadata\x12\x10\n\x08ts_delta\x18\x02 \x03(\x11\x12\x1c\n\x05power\x18\x03 \x01(\x0b\x32\x0b.PowerBatchH\x00\x12 \n\x07teros12\x18\x04 \x01(\x0b\x32\r.Teros12BatchH\x00\x12\"\n\x08phytos31\x18\x05 \x01(\x0b\x32\x0e.Phytos31BatchH\x00\x12\x1e\n\x06\x62me280\x18\x06 \x01(\x0b\x32\x0c.BME280BatchH\x00\x12 \n\x07teros21\x18\x07 \x01(\x0b\x32\r.Teros21BatchH\x00\x42\x07\n\x05\x62\x61tch\"X\n\x08Response\x12$\n\x04resp\x18\x01 \x01(\x0e\x32\x16.Response.ResponseType\"&\n\x0cResponseType\x12\x0b\n\x07SUCCESS\x10\x00\x12\t\n\x05\x45RROR\x10\x01\"\x8b\x01\n\x0c\x45sp32Command\x12$\n\x0cpage_command\x18\x01 \x01(\x0b\x32\x0c.PageCommandH\x00\x12$\n\x0ctest_command\x18\x02 \x01(\x0b\x32\x0c.TestCommandH\x00\x12$\n\x0cwifi_command\x18\x03 \x01(\x0b\x32\x0c.WiFiCommandH\x00\x42\t\n\x07\x63ommand\"\xec\x01\n\x0bPageCommand\x12.\n\x0c\x66ile_request\x18\x01 \x01(\x0e\x32\x18.PageCommand.RequestType\x12\x17\n\x0f\x66ile_descriptor\x18\x02 \x01(\r\x12\x12\n\nblock_size\x18\x03 \x01(\r\x12\x11\n\tnum_bytes\x18\x04 \x01(\r\x12\x0c\n\x04\x64\x61ta\x18\x05 \x01(\x0c\x12\x0e\n\x06offset\x18\x06 \x01(\r\x12\n\n\x02rc\x18\x07 \x01(\r\"C\n\x0bRequestType\x12\x08\n\x04OPEN\x10\x00\x12\t\n\x05\x43LOSE\x10\x01\x12\x08\n\x04READ\x10\x02\x12\t\n\x05WRITE\x10\x03\x12\n\n\x06\x44\x45LETE\x10\x04\"\x82\x01\n\x0bTestCommand\x12\'\n\x05state\x18\x01 \x01(\x0e\x32\x18.TestCommand.ChangeState\x12\x0c\n\x04\x64\x61ta\x18\x02 \x01(\x05\"<\n\x0b\x43hangeState\x12\x0b\n\x07RECEIVE\x10\x00\x12\x13\n\x0fRECEIVE_REQUEST\x10\x01\x12\x0b\n\x07REQUEST\x10\x02\"\xfe\x01\n\x0bWiFiCommand\x12\x1f\n\x04type\x18\x01 \x01(\x0e\x32\x11.WiFiCommand.Type\x12\x0c\n\x04ssid\x18\x02 \x01(\t\x12\x0e\n\x06passwd\x18\x03 \x01(\t\x12\x0b\n\x03url\x18\x04 \x01(\t\x12\x0c\n\x04port\x18\x08 \x01(\r\x12\n\n\x02rc\x18\x05 \x01(\r\x12\n\n\x02ts\x18\x06 \x01(\r\x12\x0c\n\x04resp\x18\x07 \x01(\x0c\"o\n\x04Type\x12\x0b\n\x07\x43ONNECT\x10\x00\x12\x08\n\x04POST\x10\x01\x12\t\n\x05\x43HECK\x10\x02\x12\x08\n\x04TIME\x10\x03\x12\x0e\n\nDISCONNECT\x10\x04\x12\x0e\n\nCHECK_WIFI\x10\x05\x12\r\n\tCHECK_API\x10\x06\x12\x0c\n\x08NTP_SYNC\x10\x07\"\xdc\x02\n\x11UserConfiguration\x12\x11\n\tlogger_id\x18\x01 \x01(\r\x12\x0f\n\x07\x63\x65ll_id\x18\x02 \x01(\r\x12$\n\rUpload_method\x18\x03 \x01(\x0e\x32\r.Uploadmethod\x12\x17\n\x0fUpload_interval\x18\x04 \x01(\r\x12\'\n\x0f\x65nabled_sensors\x18\x05 \x03(\x0e\x32\x0e.EnabledSensor\x12\x15\n\rVoltage_Slope\x18\x06 \x01(\x01\x12\x16\n\x0eVoltage_Offset\x18\x07 \x01(\x01\x12\x15\n\rCurrent_Slope\x18\x08 \x01(\x01\x12\x16\n\x0e\x43urrent_Offset\x18\t \x01(\x01\x12\x11\n\tWiFi_SSID\x18\n \x01(\t\x12\x15\n\rWiFi_Password\x18\x0b \x01(\t\x12\x18\n\x10\x41PI_Endpoint_URL\x18\x0c \x01(\t\x12\x19\n\x11\x41PI_Endpoint_Port\x18\r \x01(\r*O\n\rEnabledSensor\x12\x0b\n\x07Voltage\x10\x00\x12\x0b\n\x07\x43urrent\x10\x01\x12\x0b\n\x07Teros12\x10\x02\x12\x0b\n\x07Teros21\x10\x03\x12\n\n\x06\x42ME280\x10\x04*\"\n\x0cUploadmethod\x12\x08\n\x04LoRa\x10\x00\x12\x08\n\x04WiFi\x10\x01\x62\x06proto3')
 
 _globals = globals()
 _builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, _globals)
 _builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'soil_power_sensor_pb2', _globals)
 if not _descriptor._USE_C_DESCRIPTORS:
   DESCRIPTOR._loaded_options = None
-  _globals['_ENABLEDSENSOR']._serialized_start=1851
-  _globals['_ENABLEDSENSOR']._serialized_end=1930
-  _globals['_UPLOADMETHOD']._serialized_start=1932
-  _globals['_UPLOADMETHOD']._serialized_end=1966
+  _globals['_ENABLEDSENSOR']._serialized_start=3124
+  _globals['_ENABLEDSENSOR']._serialized_end=3203
+  _globals['_UPLOADMETHOD']._serialized_start=3205
+  _globals['_UPLOADMETHOD']._serialized_end=3239
   _globals['_MEASUREMENTMETADATA']._serialized_start=27
   _globals['_MEASUREMENTMETADATA']._serialized_end=96
   _globals['_POWERMEASUREMENT']._serialized_start=98
-  _globals['_POWERMEASUREMENT']._serialized_end=150
-  _globals['_TEROS12MEASUREMENT']._serialized_start=152
-  _globals['_TEROS12MEASUREMENT']._serialized_end=232
-  _globals['_TEROS21MEASUREMENT']._serialized_start=234
-  _globals['_TEROS21MEASUREMENT']._serialized_end=288
-  _globals['_PHYTOS31MEASUREMENT']._serialized_start=290
-  _globals['_PHYTOS31MEASUREMENT']._serialized_end=350
-  _globals['_BME280MEASUREMENT']._serialized_start=352
-  _globals['_BME280MEASUREMENT']._serialized_end=428
-  _globals['_MEASUREMENT']._serialized_start=431
-  _globals['_MEASUREMENT']._serialized_end=691
-  _globals['_RESPONSE']._serialized_start=693
-  _globals['_RESPONSE']._serialized_end=781
-  _globals['_RESPONSE_RESPONSETYPE']._serialized_start=743
-  _globals['_RESPONSE_RESPONSETYPE']._serialized_end=781
-  _globals['_ESP32COMMAND']._serialized_start=784
-  _globals['_ESP32COMMAND']._serialized_end=923
-  _globals['_PAGECOMMAND']._serialized_start=926
-  _globals['_PAGECOMMAND']._serialized_end=1108
-  _globals['_PAGECOMMAND_REQUESTTYPE']._serialized_start=1053
-  _globals['_PAGECOMMAND_REQUESTTYPE']._serialized_end=1108
-  _globals['_TESTCOMMAND']._serialized_start=1111
-  _globals['_TESTCOMMAND']._serialized_end=1241
-  _globals['_TESTCOMMAND_CHANGESTATE']._serialized_start=1181
-  _globals['_TESTCOMMAND_CHANGESTATE']._serialized_end=1241
-  _globals['_WIFICOMMAND']._serialized_start=1244
-  _globals['_WIFICOMMAND']._serialized_end=1498
-  _globals['_WIFICOMMAND_TYPE']._serialized_start=1387
-  _globals['_WIFICOMMAND_TYPE']._serialized_end=1498
-  _globals['_USERCONFIGURATION']._serialized_start=1501
-  _globals['_USERCONFIGURATION']._serialized_end=1849
+  _globals['_POWERMEASUREMENT']._serialized_end=206
+  _globals['_TEROS12MEASUREMENT']._serialized_start=209
+  _globals['_TEROS12MEASUREMENT']._serialized_end=370
+  _globals['_TEROS21MEASUREMENT']._serialized_start=372
+  _globals['_TEROS21MEASUREMENT']._serialized_end=482
+  _globals['_PHYTOS31MEASUREMENT']._serialized_start=484
+  _globals['_PHYTOS31MEASUREMENT']._serialized_end=605
+  _globals['_BME280MEASUREMENT']._serialized_start=607
+  _globals['_BME280MEASUREMENT']._serialized_end=683
+  _globals['_POWERSUMMARY']._serialized_start=686
+  _globals['_POWERSUMMARY']._serialized_end=891
+  _globals['_POWERBURST']._serialized_start=893
+  _globals['_POWERBURST']._serialized_end=1019
+  _globals['_MEASUREMENT']._serialized_start=1022
+  _globals['_MEASUREMENT']._serialized_end=1358
+  _globals['_POWERBATCH']._serialized_start=1360
+  _globals['_POWERBATCH']._serialized_end=1406
+  _globals['_TEROS12BATCH']._serialized_start=1408
+  _globals['_TEROS12BATCH']._serialized_end=1482
+  _globals['_TEROS21BATCH']._serialized_start=1484
+  _globals['_TEROS21BATCH']._serialized_end=1532
+  _globals['_PHYTOS31BATCH']._serialized_start=1534
+  _globals['_PHYTOS31BATCH']._serialized_end=1588
+  _globals['_BME280BATCH']._serialized_start=1590
+  _globals['_BME280BATCH']._serialized_end=1660
+  _globals['_MEASUREMENTBATCH']._serialized_start=1663
+  _globals['_MEASUREMENTBATCH']._serialized_end=1910
+  _globals['_RESPONSE']._serialized_start=1912
+  _globals['_RESPONSE']._serialized_end=2000
+  _globals['_RESPONSE_RESPONSETYPE']._serialized_start=1962
+  _globals['_RESPONSE_RESPONSETYPE']._serialized_end=2000
+  _globals['_ESP32COMMAND']._serialized_start=2003
+  _globals['_ESP32COMMAND']._serialized_end=2142
+  _globals['_PAGECOMMAND']._serialized_start=2145
+  _globals['_PAGECOMMAND']._serialized_end=2381
+  _globals['_PAGECOMMAND_REQUESTTYPE']._serialized_start=2314
+  _globals['_PAGECOMMAND_REQUESTTYPE']._serialized_end=2381
+  _globals['_TESTCOMMAND']._serialized_start=2384
+  _globals['_TESTCOMMAND']._serialized_end=2514
+  _globals['_TESTCOMMAND_CHANGESTATE']._serialized_start=2454
+  _globals['_TESTCOMMAND_CHANGESTATE']._serialized_end=2514
+  _globals['_WIFICOMMAND']._serialized_start=2517
+  _globals['_WIFICOMMAND']._serialized_end=2771
+  _globals['_WIFICOMMAND_TYPE']._serialized_start=2660
+  _globals['_WIFICOMMAND_TYPE']._serialized_end=2771
+  _globals['_USERCONFIGURATION']._serialized_start=2774
+  _globals['_USERCONFIGURATION']._serialized_end=3122
 # @@protoc_insertion_point(module_scope)
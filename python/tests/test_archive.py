@@ -0,0 +1,105 @@
+"""Tests writing and querying measurement archives
+
+Measurements of several cells are written to an archive in memory. Queries by
+logger, cell and time range are checked to return the same measurements as a
+full scan while only reading the matching blocks.
+"""
+
+import io
+import unittest
+
+from ents.proto import (
+    ArchiveReader,
+    ArchiveWriter,
+    decode_measurement,
+    encode_power_measurement,
+)
+
+
+class TestArchive(unittest.TestCase):
+    def setUp(self):
+        """Writes an hour of power measurements of four cells of two loggers"""
+
+        self.file = io.BytesIO()
+        self.measurements = []
+        with ArchiveWriter(self.file, block_size=256) as writer:
+            for i in range(60):
+                for logger_id in (1, 2):
+                    for cell_id in (10, 11):
+                        ts = 1436079600 + 60 * i
+                        meas = encode_power_measurement(
+                            ts, cell_id, logger_id, 37.13 + i, 185.29
+                        )
+                        writer.write(meas)
+                        self.measurements.append(meas)
+
+    def test_index(self):
+        """Test blocks only hold a single logger and cell"""
+
+        reader = ArchiveReader(self.file)
+
+        self.assertGreater(len(reader.index), 4)
+        self.assertEqual(len(self.measurements), sum(e.count for e in reader.index))
+        for entry in reader.index:
+            self.assertLessEqual(entry.length, 256 + 32)
+            self.assertLessEqual(entry.ts_min, entry.ts_max)
+
+    def test_query(self):
+        """Test queries match a full scan"""
+
+        reader = ArchiveReader(self.file)
+
+        start = 1436079600 + 60 * 20
+        end = 1436079600 + 60 * 29
+        result = reader.measurements(logger_id=2, cell_id=11, start=start, end=end)
+
+        expected = []
+        for meas in self.measurements:
+            meas_dict = decode_measurement(meas)
+            if (
+                meas_dict["loggerId"] == 2
+                and meas_dict["cellId"] == 11
+                and start <= meas_dict["ts"] <= end
+            ):
+                expected.append(meas)
+        self.assertEqual(10, len(expected))
+        self.assertEqual(expected, list(result))
+
+        # only the blocks of the time range are read
+        blocks = reader.blocks(logger_id=2, cell_id=11, start=start, end=end)
+        self.assertLess(len(blocks), len(reader.index) / 4)
+
+        frames = reader.frames(logger_id=2, cell_id=11, start=start, end=end)
+        power = frames["power"]
+        self.assertEqual(list(range(start, end + 1, 60)), list(power["ts"]))
+        self.assertTrue((power["cellId"] == 11).all())
+
+        # no match
+        self.assertEqual([], list(reader.measurements(logger_id=3)))
+        self.assertEqual({}, reader.frames(start=1436079600 + 3600))
+
+    def test_append(self):
+        """Test appending to a closed archive keeps existing measurements"""
+
+        with ArchiveWriter(self.file) as writer:
+            meas = encode_power_measurement(1436083200, 12, 1, 1.0, 2.0)
+            writer.write(meas)
+
+        reader = ArchiveReader(self.file)
+        self.assertEqual([meas], list(reader.measurements(cell_id=12)))
+        self.assertEqual(len(self.measurements) + 1, len(list(reader.measurements())))
+
+    def test_invalid(self):
+        """Test files without an index are refused"""
+
+        with self.assertRaises(ValueError):
+            ArchiveReader(io.BytesIO(b"not an archive"))
+
+        # missing the trailer of an unclosed writer
+        data = self.file.getvalue()
+        with self.assertRaises(ValueError):
+            ArchiveReader(io.BytesIO(data[:-1]))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -8,16 +8,29 @@ encoding/decoding cycle. Checks that missing fields result in an error and the
 correct dictionary format is returned.
 """
 
+import io
 import unittest
 import base64
 
 from ents.proto import (
     encode_response,
     decode_measurement,
+    decode_measurements,
+    decode_measurement_frames,
+    encode_power_measurement,
+    encode_power_summary,
+    encode_teros12_measurement,
+    encode_measurement_batch,
+    decode_measurement_batch,
+    decode_burst_samples,
     encode_esp32command,
     decode_esp32command,
+    MeasurementCompressor,
+    MeasurementDecompressor,
 )
 
+from ents.proto.encode import encode_bme280_measurement
+
 from ents.proto.soil_power_sensor_pb2 import (
     Measurement,
     Response,
@@ -91,6 +104,204 @@ class TestDecode(unittest.TestCase):
         self.assertAlmostEqual(514.81, meas_dict["data"]["current"])
         self.assertEqual(float, meas_dict["data_type"]["current"])
 
+    def test_power_double(self):
+        """Test decoding of PowerMeasurement with deprecated double values"""
+
+        meas = Measurement()
+        meas.meta.CopyFrom(self.meta)
+        meas.power.voltage_double = 122.38
+        meas.power.current_double = 514.81
+
+        meas_str = meas.SerializeToString()
+
+        meas_dict = decode_measurement(data=meas_str)
+
+        # values are returned under the names of the float fields
+        self.assertEqual("power", meas_dict["type"])
+        self.check_meta(meas_dict)
+        self.assertEqual(122.38, meas_dict["data"]["voltage"])
+        self.assertEqual(514.81, meas_dict["data"]["current"])
+        self.assertNotIn("voltageDouble", meas_dict["data"])
+        self.assertNotIn("currentDouble", meas_dict["data"])
+
+    def test_power_summary(self):
+        """Test decoding of PowerSummary encoded by the firmware"""
+
+        meas_str = bytes.fromhex(
+            "0a0a0804100718f0abe3ac053a2a0810151f8514421d9a9913"
+            "42259a9915422d8fc2f53d353d4a39433d0080344345"
+            "00403e434d00002040"
+        )
+        self.assertEqual(
+            meas_str,
+            encode_power_summary(
+                1436079600,
+                4,
+                7,
+                16,
+                (37.13, 36.9, 37.4, 0.12),
+                (185.29, 180.5, 190.25, 2.5),
+            ),
+        )
+
+        meas_dict = decode_measurement(data=meas_str)
+
+        self.assertEqual("power_summary", meas_dict["type"])
+        self.assertEqual(1436079600, meas_dict["ts"])
+        self.assertEqual(4, meas_dict["cellId"])
+        self.assertEqual(7, meas_dict["loggerId"])
+        self.assertEqual(16, meas_dict["data"]["count"])
+        self.assertAlmostEqual(37.13, meas_dict["data"]["voltageMean"], places=4)
+        self.assertAlmostEqual(180.5, meas_dict["data"]["currentMin"])
+        self.assertAlmostEqual(2.5, meas_dict["data"]["currentStddev"])
+
+        # summaries can not be batched
+        with self.assertRaises(ValueError):
+            encode_measurement_batch([meas_str])
+
+    def test_power_burst(self):
+        """Test decoding of a PowerBurst block encoded by the firmware"""
+
+        meas_str = bytes.fromhex(
+            "0a0a0804100718f0abe3ac054218080318e80720402880083a"
+            "0c80c8d0070619dc01d1c9d007"
+        )
+        samples = [8000000, 8000003, 7999990, 8000100, -5]
+
+        meas_dict = decode_measurement(data=meas_str)
+
+        self.assertEqual("power_burst", meas_dict["type"])
+        self.assertEqual(1436079600, meas_dict["ts"])
+        self.assertEqual(4, meas_dict["cellId"])
+        self.assertEqual(7, meas_dict["loggerId"])
+        self.assertEqual(3, meas_dict["data"]["burstId"])
+        self.assertEqual(1000, meas_dict["data"]["rate"])
+        self.assertEqual(64, meas_dict["data"]["offset"])
+        self.assertEqual(1024, meas_dict["data"]["total"])
+        self.assertEqual(samples, meas_dict["data"]["samples"])
+
+        # bursts can not be batched
+        with self.assertRaises(ValueError):
+            encode_measurement_batch([meas_str])
+
+    def test_burst_samples(self):
+        """Test decoding of zigzag delta samples"""
+
+        self.assertEqual([], decode_burst_samples(b""))
+        self.assertEqual([0, -1, 1, 64], decode_burst_samples(bytes([0, 1, 4, 0x7E])))
+
+        # full scale swing of 24-bit samples
+        data = bytes.fromhex("feffff07fdffff0f")
+        self.assertEqual([(1 << 23) - 1, -(1 << 23)], decode_burst_samples(data))
+
+        with self.assertRaises(ValueError):
+            decode_burst_samples(bytes([0x80]))
+
+    def test_batch(self):
+        """Test decoding of a length-delimited batch of measurements"""
+
+        batch = b""
+        for voltage in [122.38, 130.5]:
+            meas = Measurement()
+            meas.meta.CopyFrom(self.meta)
+            meas.power.voltage = voltage
+            meas.power.current = 514.81
+            meas_str = meas.SerializeToString()
+            batch += bytes([len(meas_str)]) + meas_str
+
+        meas_list = decode_measurements(data=batch)
+
+        self.assertEqual(2, len(meas_list))
+        for meas_dict, voltage in zip(meas_list, [122.38, 130.5]):
+            self.assertEqual("power", meas_dict["type"])
+            self.check_meta(meas_dict)
+            self.assertAlmostEqual(voltage, meas_dict["data"]["voltage"])
+
+        # empty batch
+        self.assertEqual([], decode_measurements(data=b""))
+
+        # truncated measurement
+        with self.assertRaises(ValueError):
+            decode_measurements(data=batch[:-1])
+
+    def test_measurement_frames(self):
+        """Test bulk decoding into a table per measurement type"""
+
+        measurements = [
+            encode_power_measurement(1436079600, 20, 4, 122.38, 514.81),
+            encode_bme280_measurement(1436079600, 20, 4, 98473, -2275, 43600),
+            # double values as sent before float values
+            encode_power_measurement(1436079660, 20, 4, 130.5, 514.81, double=True),
+            encode_teros12_measurement(1436079600, 20, 4, 2124.62, 0.43, 24.8, 123),
+        ]
+        data = b"".join(bytes([len(m)]) + m for m in measurements)
+
+        frames = decode_measurement_frames(io.BytesIO(data))
+
+        self.assertEqual({"power", "bme280", "teros12"}, set(frames))
+
+        # same values as decoding one measurement at a time
+        expected = {}
+        for meas_dict in decode_measurements(data):
+            row = {k: v for k, v in meas_dict.items() if k not in ("type", "data_type")}
+            row.update(row.pop("data"))
+            expected.setdefault(meas_dict["type"], []).append(row)
+        for measurement_type, rows in expected.items():
+            frame = frames[measurement_type]
+            self.assertEqual(list(rows[0]), list(frame.columns))
+            self.assertEqual(len(rows), len(frame))
+            # float values are not rounded to the shortest representation
+            for row, (_, frame_row) in zip(rows, frame.iterrows()):
+                for key, value in row.items():
+                    delta = 1e-6 * abs(value)
+                    self.assertAlmostEqual(value, frame_row[key], delta=delta)
+
+        # adjusted bme280 values
+        frames = decode_measurement_frames(data, raw=False)
+        self.assertAlmostEqual(9847.3, frames["bme280"]["pressure"][0])
+        self.assertAlmostEqual(-22.75, frames["bme280"]["temperature"][0])
+
+        self.assertEqual({}, decode_measurement_frames(b""))
+
+        # truncated measurement
+        with self.assertRaises(ValueError):
+            decode_measurement_frames(data[:-1])
+
+    def test_measurement_batch(self):
+        """Test round trip of a MeasurementBatch"""
+
+        ts = [1436079600, 1436079660, 1436079630]
+        voltages = [122.38, 130.5, 128.25]
+        # measurements with double values as sent before float values
+        measurements = [
+            encode_power_measurement(
+                t, self.meta.cell_id, self.meta.logger_id, v, 514.81, double=True
+            )
+            for t, v in zip(ts, voltages)
+        ]
+
+        batch = encode_measurement_batch(measurements)
+        self.assertLess(len(batch), sum(len(m) for m in measurements) / 2)
+
+        meas_list = decode_measurement_batch(data=batch)
+
+        self.assertEqual(3, len(meas_list))
+        for meas_dict, t, voltage in zip(meas_list, ts, voltages):
+            self.assertEqual("power", meas_dict["type"])
+            self.assertEqual(t, meas_dict["ts"])
+            self.assertEqual(self.meta.cell_id, meas_dict["cellId"])
+            self.assertEqual(self.meta.logger_id, meas_dict["loggerId"])
+            self.assertAlmostEqual(voltage, meas_dict["data"]["voltage"], places=4)
+            self.assertAlmostEqual(514.81, meas_dict["data"]["current"], places=4)
+
+        # measurements of another cell
+        other = encode_power_measurement(ts[0], 1, self.meta.logger_id, 1.0, 1.0)
+        with self.assertRaises(ValueError):
+            encode_measurement_batch(measurements + [other])
+
+        with self.assertRaises(ValueError):
+            encode_measurement_batch([])
+
     def test_teros12(self):
         """Test decoding of Teros12Measurement"""
 
@@ -230,6 +441,150 @@ class TestDecode(unittest.TestCase):
         self.assertIn("ec", meas_dict["data"])
 
 
+class TestDelta(unittest.TestCase):
+    # compressed by the firmware, power measurements followed by bme280
+    # measurements of cell 4 and logger 7 every 60 s
+    firmware = [
+        bytes.fromhex("82010a0a0804100718f0abe3ac05120a251f8514422d3d4a3943"),
+        bytes.fromhex("02020478c314"),
+        bytes.fromhex("02030400c62d"),
+        bytes.fromhex("02040400cd74"),
+        bytes.fromhex(
+            "85010a0a0804100718f0abe3ac052a1308a9810610fbffffffffffffffff0118d0d402"
+        ),
+        bytes.fromhex("050203780110"),
+        bytes.fromhex("0503030001cb23"),
+    ]
+
+    def test_firmware(self):
+        """Test decompression of measurements compressed by the firmware"""
+
+        decompressor = MeasurementDecompressor()
+        meas_list = [decompressor.decompress(data) for data in self.firmware]
+
+        for i, meas_dict in enumerate(meas_list[:4]):
+            self.assertEqual("power", meas_dict["type"])
+            self.assertEqual(1436079600 + 60 * i, meas_dict["ts"])
+            self.assertEqual(4, meas_dict["cellId"])
+            self.assertEqual(7, meas_dict["loggerId"])
+            voltage = meas_dict["data"]["voltage"]
+            self.assertAlmostEqual(37.13 + 0.01 * i, voltage, places=4)
+            self.assertAlmostEqual(185.29, meas_dict["data"]["current"], places=4)
+
+        for i, meas_dict in enumerate(meas_list[4:]):
+            self.assertEqual("bme280", meas_dict["type"])
+            self.assertEqual(1436079600 + 60 * i, meas_dict["ts"])
+            self.assertEqual(98473 - i, meas_dict["data"]["pressure"])
+            self.assertEqual([-5, 3, -2275][i], meas_dict["data"]["temperature"])
+            self.assertEqual(43600, meas_dict["data"]["humidity"])
+
+        # compressing the same measurements gives the same bytes
+        compressor = MeasurementCompressor()
+        for data, meas_dict in zip(self.firmware, meas_list):
+            meas = Measurement()
+            meas.meta.ts = meas_dict["ts"]
+            meas.meta.cell_id = meas_dict["cellId"]
+            meas.meta.logger_id = meas_dict["loggerId"]
+            values = getattr(meas, meas_dict["type"])
+            values.MergeFrom(type(values)(**meas_dict["data"]))
+            self.assertEqual(data, compressor.compress(meas.SerializeToString()))
+
+    def test_round_trip(self):
+        """Test round trip with double values and keyframes"""
+
+        compressor = MeasurementCompressor()
+        decompressor = MeasurementDecompressor()
+
+        # measurements with double values as sent before float values
+        measurements = [
+            encode_power_measurement(
+                1436079600 + 60 * i, 4, 7, 122.38 + i, 514.81, double=True
+            )
+            for i in range(40)
+        ]
+        compressed = [compressor.compress(m) for m in measurements]
+        self.assertLess(
+            sum(len(c) for c in compressed), sum(len(m) for m in measurements) / 2
+        )
+        # keyframes every 16 measurements
+        keyframes = [i for i, data in enumerate(compressed) if data[0] & 0x80]
+        self.assertEqual([0, 16, 32], keyframes)
+
+        for i, data in enumerate(compressed):
+            meas_dict = decompressor.decompress(data)
+            self.assertEqual(1436079600 + 60 * i, meas_dict["ts"])
+            self.assertAlmostEqual(122.38 + i, meas_dict["data"]["voltage"])
+            self.assertAlmostEqual(514.81, meas_dict["data"]["current"])
+
+    def test_missing_reference(self):
+        """Test deltas are refused without their reference"""
+
+        decompressor = MeasurementDecompressor()
+
+        # delta before its keyframe
+        with self.assertRaises(ValueError):
+            decompressor.decompress(self.firmware[1])
+
+        decompressor.decompress(self.firmware[0])
+
+        # delta out of sequence
+        with self.assertRaises(ValueError):
+            decompressor.decompress(self.firmware[2])
+
+        # unknown measurement type
+        with self.assertRaises(ValueError):
+            decompressor.decompress(bytes([0x7F, 0x01, 0x00, 0x00]))
+
+    def test_power_summary(self):
+        """Test summaries are only stored as keyframes"""
+
+        compressor = MeasurementCompressor()
+        decompressor = MeasurementDecompressor()
+
+        measurements = [
+            encode_power_summary(
+                1436079600 + 60 * i,
+                4,
+                7,
+                16,
+                (37.13 + i, 36.9, 37.4, 0.12),
+                (185.29, 180.5, 190.25, 2.5),
+            )
+            for i in range(4)
+        ]
+        for i, meas_str in enumerate(measurements):
+            data = compressor.compress(meas_str)
+            self.assertEqual(0x87, data[0])
+
+            meas_dict = decompressor.decompress(data)
+            self.assertEqual("power_summary", meas_dict["type"])
+            self.assertEqual(1436079600 + 60 * i, meas_dict["ts"])
+            voltage = meas_dict["data"]["voltageMean"]
+            self.assertAlmostEqual(37.13 + i, voltage, places=4)
+
+        # summaries have no delta values
+        with self.assertRaises(ValueError):
+            decompressor.decompress(bytes([0x07, 0x04, 0x00, 0x00]))
+
+    def test_power_burst(self):
+        """Test bursts are only stored as keyframes"""
+
+        compressor = MeasurementCompressor()
+        decompressor = MeasurementDecompressor()
+
+        meas_str = bytes.fromhex(
+            "0a0a0804100718f0abe3ac054218080318e80720402880083a"
+            "0c80c8d0070619dc01d1c9d007"
+        )
+        for _ in range(2):
+            data = compressor.compress(meas_str)
+            self.assertEqual(0x88, data[0])
+
+            meas_dict = decompressor.decompress(data)
+            self.assertEqual("power_burst", meas_dict["type"])
+            self.assertEqual(5, len(meas_dict["data"]["samples"]))
+
+
 class TestEsp32(unittest.TestCase):
     def test_cmd_not_implemented(self):
         """Checks that an exception is raised when a non-existing command is
@@ -284,6 +639,23 @@ class TestEsp32(unittest.TestCase):
         self.assertEqual(cmd["blockSize"], bs)
         self.assertEqual(cmd["numBytes"], n)
 
+    def test_page_encode_data(self):
+        """Test encoding a page command with data and an offset"""
+
+        data = b"\x03\x01\x02\x03"
+
+        cmd_str = encode_esp32command(
+            "page", req="write", fd=2, n=len(data), data=data, offset=16
+        )
+
+        cmd = Esp32Command()
+        cmd.ParseFromString(cmd_str)
+
+        self.assertEqual(cmd.page_command.file_request, PageCommand.RequestType.WRITE)
+        self.assertEqual(cmd.page_command.num_bytes, len(data))
+        self.assertEqual(cmd.page_command.data, data)
+        self.assertEqual(cmd.page_command.offset, 16)
+
     def test_page_req_not_implemented(self):
         """Test encoding a page command with a not implemented request"""
 
@@ -136,6 +136,24 @@ extern "C" {
  */
 #define LORAWAN_SPS_MEAS_PORT                       1
 
+/*!
+ * LoRaWAN port of batches of measurements, each preceded by its length as a
+ * varint, see FramPackBatch()
+ */
+#define LORAWAN_SPS_BATCH_PORT                      4
+
+/*!
+ * LoRaWAN port of MeasurementBatch messages
+ */
+#define LORAWAN_SPS_MEAS_BATCH_PORT                 5
+
+/*!
+ * LoRaWAN port of power burst requests. The payload is the channel, 0 for
+ * voltage and 1 for current, followed by the number of samples as a big
+ * endian uint16, where 0 or a missing count captures ADC_burstCapacity()
+ */
+#define LORAWAN_BURST_PORT                          6
+
 /* USER CODE END EC */
 
 /* Exported macros -----------------------------------------------------------*/
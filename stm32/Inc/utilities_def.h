@@ -48,6 +48,8 @@ typedef enum
   CFG_LPM_APPLI_Id,
   CFG_LPM_UART_TX_Id,
   /* USER CODE BEGIN CFG_LPM_Id_t */
+  CFG_LPM_FRAM_Id,
+  CFG_LPM_SDI12_Id,
 
   /* USER CODE END CFG_LPM_Id_t */
 } CFG_LPM_Id_t;
@@ -81,8 +83,11 @@ typedef enum
   CFG_SEQ_Task_LoRaStopJoinEvent,
   /* USER CODE BEGIN CFG_SEQ_Task_Id_t */
   CFG_SEQ_Task_Measurement,
+  CFG_SEQ_Task_MeasurementStored,
+  CFG_SEQ_Task_MeasurementFlush,
   CFG_SEQ_Task_TimeSync,
   CFG_SEQ_Task_WiFiUpload,
+  CFG_SEQ_Task_PowerBurst,
   /* USER CODE END CFG_SEQ_Task_Id_t */
   CFG_SEQ_Task_NBR
 } CFG_SEQ_Task_Id_t;
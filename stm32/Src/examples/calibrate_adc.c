@@ -151,12 +151,13 @@ int main(void) {
 
     // check command input
     if (controller_input[0] == '0') {
-      size_t measurement_size = ADC_measure(
-          encoded_measurment);  // Read the measurment, and store it's size in
-                                // measurement_size (size int 64)
-      if (measurement_size == -1) {
+      // Read the measurment, and store it's size in measurement_size
+      pb_ostream_t ostream = pb_ostream_from_buffer(
+          encoded_measurment, sizeof(encoded_measurment));
+      if (!ADC_measure(&ostream)) {
         continue;
       }
+      size_t measurement_size = ostream.bytes_written;
 
       // send length
       status = HAL_UART_Transmit(&huart1, (uint8_t *)&measurement_size, 1,
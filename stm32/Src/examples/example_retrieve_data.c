@@ -67,17 +67,19 @@ int main(void) {
     status = FramPut(test_data, sizeof(test_data));
   }
 
-  uint16_t read_addr, write_addr, buffer_len;
+  FramAddr read_addr, write_addr;
+  uint32_t buffer_len;
   status = FramLoadBufferState(&read_addr, &write_addr, &buffer_len);
 
   uint8_t retrieved_data[sizeof(test_data)];
-  uint8_t retrieved_len;
+  size_t retrieved_len;
 
   APP_PRINTF("Press the Restart button to add more data to FRAM...\n");
 
   // Visualizing actual data (commented out)
   // while (FramBufferLen() > 0) {
-  //     status = FramGet(retrieved_data, &retrieved_len);
+  //     status = FramGet(retrieved_data, sizeof(retrieved_data),
+  //                      &retrieved_len);
   //     if (status == FRAM_OK) {
   //         // Loop through retrieved_data and print each byte in hexadecimal
   //         format print("Data length: %d\n", retrieved_len); for (int i = 0; i
@@ -37,11 +37,17 @@
 /* USER CODE BEGIN Includes */
 #include "LmhpClockSync.h"
 
+#include "ads.h"
 #include "sdi12.h"
 #include "rtc.h"
 #include "sensors.h"
 #include "userConfig.h"
 #include "status_led.h"
+#include "transcoder.h"
+
+#ifdef SENSORS_COMPRESS
+#include "soil_power_sensor.fast.h"
+#endif /* SENSORS_COMPRESS */
 
 #include <time.h>
 /* USER CODE END Includes */
@@ -222,6 +228,49 @@ static void OnPingSlotPeriodicityChanged(uint8_t pingSlotPeriodicity);
 static void OnSystemReset(void);
 
 /* USER CODE BEGIN PFP */
+
+/**
+ * @brief Packs a batch of records into a MeasurementBatch for uplinks
+ *
+ * Measurements are added in order until the next one has another type, cell
+ * or logger, or does not fit in the uplink. Records that fail their CRC are
+ * skipped, as are compressed measurements without their reference.
+ *
+ * @param batch Records returned by FramPeekBatch()
+ * @param batch_len Number of bytes in batch
+ * @param count Number of records in batch, set to the number of records
+ * consumed including skipped records, to be passed to FramCommit(). Zero if
+ * the first measurement can not be batched.
+ * @param out Array to be packed into
+ * @param out_size Size of out in bytes
+ * @return Number of bytes packed into out, 0 if the first measurement can not
+ * be batched or all consumed records were skipped
+ */
+static size_t PackMeasurementBatch(const uint8_t *batch, size_t batch_len,
+                                   uint32_t *count, uint8_t *out,
+                                   size_t out_size);
+
+#ifdef SENSORS_COMPRESS
+/**
+ * @brief Packs a batch of records into length-delimited Measurement messages
+ *
+ * Same as FramPackBatch(), except compressed measurements are decompressed
+ * and serialized as a Measurement. Compressed measurements without their
+ * reference are skipped.
+ *
+ * @param batch Records returned by FramPeekBatch()
+ * @param batch_len Number of bytes in batch
+ * @param count Number of records in batch, set to the number of records
+ * consumed including skipped records, to be passed to FramCommit()
+ * @param out Array to be packed into
+ * @param out_size Size of out in bytes
+ * @return Number of bytes packed into out
+ */
+static size_t PackDelimitedBatch(const uint8_t *batch, size_t batch_len,
+                                 uint32_t *count, uint8_t *out,
+                                 size_t out_size);
+#endif /* SENSORS_COMPRESS */
+
 /* USER CODE END PFP */
 
 /* Private variables ---------------------------------------------------------*/
@@ -309,6 +358,31 @@ static uint8_t AppDataBuffer[LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
  */
 static LmHandlerAppData_t AppData = {0, 0, AppDataBuffer};
 
+/**
+ * @brief Records read from the fram buffer before packing into an uplink
+ *
+ * Stored records are several times larger than measurements in a
+ * MeasurementBatch, so four times the size of an uplink is read.
+ */
+static uint8_t BatchBuffer[4 * LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
+
+/**
+ * @brief Measurements of the next uplink
+ */
+static MeasurementBatch MeasBatch;
+
+#ifdef SENSORS_COMPRESS
+/**
+ * @brief Compression state of the measurements removed from the fram buffer
+ */
+static MeasurementDelta UplinkDelta;
+
+/**
+ * @brief Compression state including the measurements of the next uplink
+ */
+static MeasurementDelta UplinkDeltaPending;
+#endif /* SENSORS_COMPRESS */
+
 /* USER CODE END PV */
 
 /* Exported functions ---------------------------------------------------------*/
@@ -394,6 +468,158 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 /* Private functions ---------------------------------------------------------*/
 /* USER CODE BEGIN PrFD */
 
+static size_t PackMeasurementBatch(const uint8_t *batch, size_t batch_len,
+                                   uint32_t *count, uint8_t *out,
+                                   size_t out_size)
+{
+  MeasBatch = (MeasurementBatch)MeasurementBatch_init_zero;
+#ifdef SENSORS_COMPRESS
+  // measurements are only removed once the uplink is sent
+  UplinkDeltaPending = UplinkDelta;
+#endif /* SENSORS_COMPRESS */
+
+  size_t offset = 0;
+  uint32_t consumed = 0;
+  while (consumed < *count)
+  {
+    FramRecord record;
+    FramStatus status = FramRecordDecode(batch + offset, batch_len - offset,
+                                         &record);
+    if (status == FRAM_CORRUPT)
+    {
+      offset += record.size;
+      ++consumed;
+      continue;
+    }
+    else if (status != FRAM_OK)
+    {
+      break;
+    }
+
+    Measurement meas = Measurement_init_zero;
+#ifdef SENSORS_COMPRESS
+    if (record.type == FRAM_RECORD_DELTA)
+    {
+      if (DecodeMeasurementDelta(&UplinkDeltaPending, record.data, record.len,
+                                 &meas) != 0)
+      {
+        // reference was lost, skipped until the next keyframe
+        offset += record.size;
+        ++consumed;
+        continue;
+      }
+      if (MeasurementBatchAdd(&MeasBatch, &meas, out_size) != 0)
+      {
+        break;
+      }
+      MeasurementDeltaAdvance(&UplinkDeltaPending, record.data, &meas);
+
+      offset += record.size;
+      ++consumed;
+      continue;
+    }
+#endif /* SENSORS_COMPRESS */
+    if (record.type != FRAM_RECORD_MEASUREMENT ||
+        DecodeMeasurement(record.data, record.len, &meas) != 0 ||
+        MeasurementBatchAdd(&MeasBatch, &meas, out_size) != 0)
+    {
+      break;
+    }
+
+    offset += record.size;
+    ++consumed;
+  }
+
+  // only skipped records are consumed if nothing was batched
+  *count = consumed;
+  if (MeasBatch.ts_delta_count == 0)
+  {
+    return 0;
+  }
+
+  size_t len = EncodeMeasurementBatch(&MeasBatch, out, out_size);
+  if (len == (size_t)-1)
+  {
+    *count = 0;
+    return 0;
+  }
+
+  return len;
+}
+
+#ifdef SENSORS_COMPRESS
+static size_t PackDelimitedBatch(const uint8_t *batch, size_t batch_len,
+                                 uint32_t *count, uint8_t *out,
+                                 size_t out_size)
+{
+  // measurements are only removed once the uplink is sent
+  UplinkDeltaPending = UplinkDelta;
+
+  static uint8_t meas_buffer[Measurement_size];
+  size_t offset = 0;
+  size_t packed = 0;
+  uint32_t consumed = 0;
+  while (consumed < *count)
+  {
+    FramRecord record;
+    FramStatus status = FramRecordDecode(batch + offset, batch_len - offset,
+                                         &record);
+    if (status == FRAM_CORRUPT)
+    {
+      offset += record.size;
+      ++consumed;
+      continue;
+    }
+    else if (status != FRAM_OK)
+    {
+      break;
+    }
+
+    const uint8_t *payload = record.data;
+    size_t payload_len = record.len;
+    Measurement meas = Measurement_init_zero;
+    if (record.type == FRAM_RECORD_DELTA)
+    {
+      if (DecodeMeasurementDelta(&UplinkDeltaPending, record.data, record.len,
+                                 &meas) != 0 ||
+          !Measurement_fast_encode(&meas, meas_buffer, sizeof(meas_buffer),
+                                   &payload_len))
+      {
+        // reference was lost, skipped until the next keyframe
+        offset += record.size;
+        ++consumed;
+        continue;
+      }
+      payload = meas_buffer;
+    }
+    else if (record.type != FRAM_RECORD_MEASUREMENT)
+    {
+      break;
+    }
+
+    // each measurement is preceded by its length
+    pb_ostream_t ostream = pb_ostream_from_buffer(out + packed,
+                                                  out_size - packed);
+    if (!pb_encode_varint(&ostream, payload_len) ||
+        !pb_write(&ostream, payload, payload_len))
+    {
+      break;
+    }
+    if (record.type == FRAM_RECORD_DELTA)
+    {
+      MeasurementDeltaAdvance(&UplinkDeltaPending, record.data, &meas);
+    }
+
+    packed += ostream.bytes_written;
+    offset += record.size;
+    ++consumed;
+  }
+
+  *count = consumed;
+  return packed;
+}
+#endif /* SENSORS_COMPRESS */
+
 /* USER CODE END PrFD */
 
 static void OnRxData(LmHandlerAppData_t *appData, LmHandlerRxParams_t *params)
@@ -410,6 +636,20 @@ static void OnRxData(LmHandlerAppData_t *appData, LmHandlerRxParams_t *params)
     switch (appData->Port)
     {
     // TODO add cases for incoming data on ports
+    case LORAWAN_BURST_PORT:
+      if (appData->BufferSize >= 1)
+      {
+        uint32_t samples = 0;
+        if (appData->BufferSize >= 3)
+        {
+          samples = ((uint32_t)appData->Buffer[1] << 8) | appData->Buffer[2];
+        }
+        if (ADC_burstRequest(samples, appData->Buffer[0] != 0) != 0)
+        {
+          APP_LOG(TS_OFF, VLEVEL_M, "Power bursts are disabled\r\n");
+        }
+      }
+      break;
     default:
       break;
     }
@@ -436,6 +676,10 @@ static void SendTxData(void)
       clock_synced = true;
       // start taking measurements
       SensorsStart();
+#if ADS_BURST_SAMPLES > 0
+      // captured after the clock sync so the burst is timestamped
+      ADC_burstRequest(ADS_BURST_SAMPLES, false);
+#endif /* ADS_BURST_SAMPLES > 0 */
     }
     else {
       APP_LOG(TS_OFF, VLEVEL_M, "Could not sync clock, retrying on next tx\r\n");
@@ -451,6 +695,12 @@ static void SendTxData(void)
     return;
   }
 
+  // captured bursts are sent once there are no measurements left
+  if (FramBufferLen() <= 0)
+  {
+    ADC_burstUpload(1);
+  }
+
   // check if buffer is empty
   if (FramBufferLen() <= 0)
   {
@@ -461,14 +711,76 @@ static void SendTxData(void)
   uint8_t battery_level = GetBatteryLevel();
   uint16_t temperature = SYS_GetTemperatureLevel();
 
-  FramStatus status = FramGet(AppData.Buffer, &AppData.BufferSize);
-  if (status != FRAM_OK)
+  // fill the uplink up to the max payload of the current datarate
+  size_t max_payload = LORAWAN_APP_DATA_BUFFER_MAX_SIZE;
+  LoRaMacTxInfo_t tx_info;
+  if (LoRaMacQueryTxPossible(0, &tx_info) == LORAMAC_STATUS_OK &&
+      tx_info.MaxPossibleApplicationDataSize < max_payload)
+  {
+    max_payload = tx_info.MaxPossibleApplicationDataSize;
+  }
+
+  // records stay in the buffer until the uplink is sent
+  uint32_t count = 0;
+  FramStatus status = FramPeekBatch(BatchBuffer, sizeof(BatchBuffer), &count);
+  if (status == FRAM_OUT_OF_RANGE)
+  {
+    APP_LOG(TS_OFF, VLEVEL_M, "Measurement too large for uplink, dropping\r\n");
+    FramCommit(1);
+    return;
+  }
+  else if (status != FRAM_OK)
   {
     APP_LOG(TS_OFF, VLEVEL_M,
             "Error getting data from fram buffer. FramStatus = %d", status);
     return;
   }
 
+  // measurements of the same type are sent as a MeasurementBatch, otherwise
+  // as a length-delimited batch
+  uint32_t batch_count = count;
+  AppData.BufferSize = PackMeasurementBatch(BatchBuffer, sizeof(BatchBuffer),
+                                            &batch_count, AppData.Buffer,
+                                            max_payload);
+  if (AppData.BufferSize > 0)
+  {
+    count = batch_count;
+    AppData.Port = LORAWAN_SPS_MEAS_BATCH_PORT;
+  }
+  else if (batch_count > 0)
+  {
+    // remove skipped records so they do not block the buffer
+    APP_LOG(TS_OFF, VLEVEL_M, "Skipping %u undecodable records\r\n",
+            (unsigned int)batch_count);
+    FramCommit(batch_count);
+    return;
+  }
+  else
+  {
+#ifdef SENSORS_COMPRESS
+    // compressed measurements are sent as a Measurement
+    AppData.BufferSize = PackDelimitedBatch(BatchBuffer, sizeof(BatchBuffer),
+                                            &count, AppData.Buffer,
+                                            max_payload);
+#else
+    AppData.BufferSize = FramPackBatch(BatchBuffer, sizeof(BatchBuffer),
+                                       &count, AppData.Buffer, max_payload);
+#endif /* SENSORS_COMPRESS */
+    AppData.Port = LORAWAN_SPS_BATCH_PORT;
+  }
+
+  if (AppData.BufferSize == 0)
+  {
+    // drop a measurement that does not fit the current datarate on its own
+    // so it does not block the buffer
+    APP_LOG(TS_OFF, VLEVEL_M,
+            "Measurement too large for max payload %u, dropping\r\n",
+            (unsigned int)max_payload);
+    FramCommit((count > 0) ? count : 1);
+    return;
+  }
+
+  APP_LOG(TS_ON, VLEVEL_M, "Packed %u measurements\r\n", (unsigned int)count);
   APP_LOG(TS_ON, VLEVEL_M, "Payload: ");
   for (int i = 0; i < AppData.BufferSize; i++)
   {
@@ -477,11 +789,24 @@ static void SendTxData(void)
   APP_LOG(TS_OFF, VLEVEL_M, "\r\n");
   APP_LOG(TS_ON, VLEVEL_M, "%d\r\n", AppData.BufferSize);
 
-  AppData.Port = LORAWAN_SPS_MEAS_PORT;
-
   if (LORAMAC_HANDLER_SUCCESS == LmHandlerSend(&AppData, LORAWAN_DEFAULT_CONFIRMED_MSG_STATE, false))
   {
     APP_LOG(TS_ON, VLEVEL_L, "SEND REQUEST\r\n");
+
+    // remove the sent measurements from the buffer
+    status = FramCommit(count);
+    if (status != FRAM_OK)
+    {
+      APP_LOG(TS_OFF, VLEVEL_M,
+              "Error removing data from fram buffer. FramStatus = %d\r\n",
+              status);
+    }
+#ifdef SENSORS_COMPRESS
+    else
+    {
+      UplinkDelta = UplinkDeltaPending;
+    }
+#endif /* SENSORS_COMPRESS */
   }
   else
   {
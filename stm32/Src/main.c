@@ -147,21 +147,31 @@ int main(void)
   // alternative blocking polling method
   //UserConfig_ProcessDataPolling();
 
-  // currently not functional
-  //FIFO_Init();
+  // resume buffered measurements from before the reset, read errors are
+  // retried so a bus glitch does not discard the backlog
+  FramStatus fifo_status = FIFO_Init();
+  for (int i = 0; fifo_status != FRAM_OK && i < 3; i++)
+  {
+    HAL_Delay(10);
+    fifo_status = FIFO_Init();
+  }
+  if (fifo_status != FRAM_OK)
+  {
+    APP_PRINTF("Failed to load FIFO state. FramStatus = %d\n", fifo_status);
+  }
 
   // Debug message, gets printed after init code
   APP_PRINTF("Soil Power Sensor Wio-E5 firmware, compiled on %s %s\n", __DATE__, __TIME__);
   APP_PRINTF("Git SHA: %s\n", GIT_REV);
 
   // configure sensors
-  //SensorsAdd(SensorsMeasureTest);
-  //SensorsAdd(ADC_measure);
-  //SensorsAdd(SDI12_Teros12Measure);
-  //SensorsAdd(Phytos31_measure);
+  //SensorsAdd(SensorsMeasureTest, 0, 0);
+  //SensorsAdd(ADC_measure, 0, 0);
+  //SensorsAdd(SDI12_Teros12Measure, 0, 0);
+  //SensorsAdd(Phytos31_measure, 0, 0);
   
   //BME280Init();
-  //SensorsAdd(BME280Measure); 
+  //SensorsAdd(BME280Measure, 0, 0); 
 
   // initialize WiFi
   ControllerInit();
@@ -177,20 +187,24 @@ int main(void)
     EnabledSensor sensor = cfg->enabled_sensors[i];
     if ((sensor == EnabledSensor_Voltage) || (sensor == EnabledSensor_Current)) {
       ADC_init();
-      SensorsAdd(ADC_measure);
+      SensorsAddAsync(ADC_measureStart, ADC_measurePoll, ADC_measureCollect,
+                      0, 0);
       APP_LOG(TS_OFF, VLEVEL_M, "ADS Enabled!\n");
     }
     if (sensor == EnabledSensor_Teros12) {
       APP_LOG(TS_OFF, VLEVEL_M, "Teros12 Enabled!\n");
-      SensorsAdd(Teros12Measure);
+      SensorsAddAsync(Teros12MeasureStart, Teros12MeasurePoll,
+                      Teros12MeasureCollect, 0, 0);
     }
     if (sensor == EnabledSensor_BME280) {
       BME280Init();
-      SensorsAdd(BME280Measure);
+      SensorsAddAsync(BME280MeasureStart, BME280MeasurePoll,
+                      BME280MeasureCollect, 0, 0);
       APP_LOG(TS_OFF, VLEVEL_M, "BME280 Enabled!\n");
     }
     if (sensor == EnabledSensor_Teros21) {
-      SensorsAdd(Teros21Measure);
+      SensorsAddAsync(Teros21MeasureStart, Teros21MeasurePoll,
+                      Teros21MeasureCollect, 0, 0);
       APP_LOG(TS_OFF, VLEVEL_M, "Teros21 Enabled!\n");
     }
     // TODO add support for dummy sensor
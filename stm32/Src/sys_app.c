@@ -32,7 +32,7 @@
 #include "sys_sensors.h"
 
 /* USER CODE BEGIN Includes */
-
+#include "fifo.h"
 /* USER CODE END Includes */
 
 /* External variables ---------------------------------------------------------*/
@@ -141,7 +141,12 @@ void SystemApp_Init(void)
 void UTIL_SEQ_Idle(void)
 {
   /* USER CODE BEGIN UTIL_SEQ_Idle_1 */
-
+  // write staged measurements before sleeping, STOP mode is disabled until the
+  // transfer completes
+  if (FramFlushPending())
+  {
+    FramFlushAsync();
+  }
   /* USER CODE END UTIL_SEQ_Idle_1 */
   UTIL_LPM_EnterLowPower();
   /* USER CODE BEGIN UTIL_SEQ_Idle_2 */
@@ -2,21 +2,45 @@
 
 #include <stm32_systime.h>
 
+#include "ads.h"
 #include "sys_app.h"
 #include "sensors.h"
 #include "stm32_seq.h"
 #include "stm32_timer.h"
 #include "fifo.h"
 #include "controller/wifi.h"
+#include "controller/page.h"
+#include "page.h"
 #include "userConfig.h"
 #include "status_led.h"
 
+#ifdef SENSORS_COMPRESS
+#include "soil_power_sensor.fast.h"
+#include "transcoder.h"
+#endif /* SENSORS_COMPRESS */
+
 /**
  * @brief Timer for uploads
  * 
  */
 static UTIL_TIMER_Object_t UploadTimer = {};
 
+#ifndef SENSORS_COMPRESS
+/**
+ * @brief Pages are stored on the sd card of the esp32
+ *
+ * Not used with SENSORS_COMPRESS, restored pages are put behind newer
+ * measurements, so compressed records would lose their references.
+ */
+static const PageInterfaceType page_interface = {
+  .OpenPtr = ControllerPageOpen,
+  .ClosePtr = ControllerPageClose,
+  .WritePtr = ControllerPageWrite,
+  .ReadPtr = ControllerPageRead,
+  .DeletePtr = ControllerPageDelete,
+};
+#endif /* SENSORS_COMPRESS */
+
 /**
  * @brief Maximum number of retries for any event
  */
@@ -27,6 +51,18 @@ const unsigned int max_retries = 5;
  */
 const unsigned int retry_delay = 1000;
 
+/**
+ * @brief Maximum number of burst blocks moved to the buffer per upload
+ */
+static const uint32_t burst_upload_blocks = 16;
+
+#ifdef SENSORS_COMPRESS
+/**
+ * @brief Compression state of the uploaded measurements
+ */
+static MeasurementDelta upload_delta;
+#endif /* SENSORS_COMPRESS */
+
 
 /**
  * @brief Function call for upload event
@@ -113,6 +149,12 @@ void WiFiInit(void) {
     Disconnect();
   }
 
+#ifndef SENSORS_COMPRESS
+  // spill measurements to the sd card when the fram buffer fills up
+  PageInit();
+  PageSetInterface(&page_interface);
+#endif /* SENSORS_COMPRESS */
+
   // start timers for uploading
   StartUploads();
 }
@@ -122,15 +164,28 @@ void UploadEvent(void *context) {
 }
 
 void Upload(void) {
-  const size_t buffer_size = 256;
-  size_t buffer_len = 0;
-  uint8_t buffer[buffer_size];
+  // holds at least the largest record
+  static uint8_t buffer[FRAM_RECORD_MAX_SIZE];
+  const size_t buffer_size = sizeof(buffer);
+  uint32_t count = 0;
+
+  FramStatus status = FRAM_OK;
+#ifndef SENSORS_COMPRESS
+  // spill to or restore from the sd card depending on the fram fill level
+  status = PageBalance();
+  if (status != FRAM_OK) {
+    APP_LOG(TS_OFF, VLEVEL_M,
+        "Error paging data to sd card. FramStatus = %d\r\n", status);
+  }
+#endif /* SENSORS_COMPRESS */
 
-  // get buffer data
-  FramStatus status = FramGet(buffer, &buffer_len);
+  // get buffer data, measurements stay in the buffer until confirmed
+  status = FramPeekBatch(buffer, buffer_size, &count);
   if (status != FRAM_OK) {
     if (status == FRAM_BUFFER_EMPTY) {
       APP_LOG(TS_OFF, VLEVEL_M, "Buffer empty!\r\n")
+      // captured bursts are sent once there are no measurements left
+      ADC_burstUpload(burst_upload_blocks);
     } else {
       APP_LOG(TS_OFF, VLEVEL_M,
           "Error getting data from fram buffer. FramStatus = %d\r\n", status);
@@ -138,48 +193,94 @@ void Upload(void) {
     return;
   }
 
-  // print buffer
-  APP_LOG(TS_ON, VLEVEL_M, "Payload[%d]: ", buffer_len);
-  for (int i = 0; i < buffer_len; i++)
-  {
-    APP_LOG(TS_OFF, VLEVEL_M, "%x ", buffer[i]);
-  }
-  APP_LOG(TS_OFF, VLEVEL_M, "\r\n");
+  // measurements are stored as records
+  size_t offset = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    FramRecord record;
+    status = FramRecordDecode(buffer + offset, buffer_size - offset, &record);
+    offset += record.size;
+
+    // corrupted records are removed with the rest of the batch
+    if (status != FRAM_OK) {
+      APP_LOG(TS_OFF, VLEVEL_M, "Skipping corrupted measurement\r\n");
+      continue;
+    }
+
+    size_t buffer_len = record.len;
+    const uint8_t *payload = record.data;
+
+#ifdef SENSORS_COMPRESS
+    // compressed measurements are posted as a Measurement
+    static uint8_t meas_buffer[Measurement_size];
+    Measurement meas = Measurement_init_zero;
+    if (record.type == FRAM_RECORD_DELTA) {
+      if (DecodeMeasurementDelta(&upload_delta, record.data, record.len,
+                                 &meas) != 0 ||
+          !Measurement_fast_encode(&meas, meas_buffer, sizeof(meas_buffer),
+                                   &buffer_len)) {
+        APP_LOG(TS_OFF, VLEVEL_M, "Skipping measurement without reference\r\n");
+        continue;
+      }
+      payload = meas_buffer;
+    }
+#endif /* SENSORS_COMPRESS */
+
+    // print buffer
+    APP_LOG(TS_ON, VLEVEL_M, "Payload[%u]: ", (unsigned int)buffer_len);
+    for (int j = 0; j < buffer_len; j++)
+    {
+      APP_LOG(TS_OFF, VLEVEL_M, "%x ", payload[j]);
+    }
+    APP_LOG(TS_OFF, VLEVEL_M, "\r\n");
  
-  // posts data to website
-  APP_LOG(TS_ON, VLEVEL_M, "Uploading data.");
-  if (!ControllerWiFiPost(buffer, buffer_len)) {
-    APP_LOG(TS_OFF, VLEVEL_M, "Error! Could not communicate with esp32!\r\n");
-  }
+    // posts data to website
+    APP_LOG(TS_ON, VLEVEL_M, "Uploading data.");
+    if (!ControllerWiFiPost(payload, buffer_len)) {
+      APP_LOG(TS_OFF, VLEVEL_M, "Error! Could not communicate with esp32!\r\n");
+    }
     
-  for (unsigned int retries = 0;; retries++) { 
-    HAL_Delay(retry_delay);
-    APP_LOG(TS_OFF, VLEVEL_M, ".");
+    for (unsigned int retries = 0;; retries++) { 
+      HAL_Delay(retry_delay);
+      APP_LOG(TS_OFF, VLEVEL_M, ".");
 
-    ControllerWiFiResponse resp = ControllerWiFiCheckRequest();
-    APP_LOG(TS_OFF, VLEVEL_M, "(%d) \r\n", resp.http_code);
+      ControllerWiFiResponse resp = ControllerWiFiCheckRequest();
+      APP_LOG(TS_OFF, VLEVEL_M, "(%d) \r\n", resp.http_code);
 
-    if (resp.http_code == 200) {
-      break;
-    } else {
-      // check category of error
-      if (resp.http_code == 0) {
-        APP_LOG(TS_OFF, VLEVEL_M, "Error when posting data! Likely error with WiFi or response timeout.\r\n");
+      if (resp.http_code == 200) {
+#ifdef SENSORS_COMPRESS
+        if (record.type == FRAM_RECORD_DELTA) {
+          MeasurementDeltaAdvance(&upload_delta, record.data, &meas);
+        }
+#endif /* SENSORS_COMPRESS */
+        break;
       } else {
-        APP_LOG(TS_OFF, VLEVEL_M, "Error with HTTP code! Likely error with measurement format or backend.\r\n");
-      }
+        // check category of error
+        if (resp.http_code == 0) {
+          APP_LOG(TS_OFF, VLEVEL_M, "Error when posting data! Likely error with WiFi or response timeout.\r\n");
+        } else {
+          APP_LOG(TS_OFF, VLEVEL_M, "Error with HTTP code! Likely error with measurement format or backend.\r\n");
+        }
 
-      // give up after max retries and tirgger error handler
-      if (retries >= max_retries) {
-        APP_LOG(TS_ON, VLEVEL_M, "Max retries reached! Stopping upload.\r\n");
-        ErrorHandler();
-        return;
+        // give up after max retries and tirgger error handler
+        if (retries >= max_retries) {
+          APP_LOG(TS_ON, VLEVEL_M, "Max retries reached! Stopping upload.\r\n");
+          // keep unconfirmed measurements for the next upload
+          FramCommit(i);
+          ErrorHandler();
+          return;
+        }
       }
     }
+  }
 
+  // remove confirmed measurements from the buffer
+  status = FramCommit(count);
+  if (status != FRAM_OK) {
+    APP_LOG(TS_OFF, VLEVEL_M,
+        "Error removing data from fram buffer. FramStatus = %d\r\n", status);
   }
   
-  if (FramBufferLen() > 0) {
+  if (FramBufferLen() > 0 || !PageEmpty()) {
     APP_LOG(TS_ON, VLEVEL_M, "Buffer not empty, starting another upload\r\n");
     UploadEvent(NULL);
   }
@@ -35,6 +35,17 @@ extern "C" {
  *
  * Library expected I2C and GPIO to be initialized before use.
  *
+ * Power measurements convert voltage then current back to back in continuous
+ * mode, switching the mux once voltage is read, so the analog frontend is only
+ * powered up once per measurement. The falling edge of DRDY wakes the sensors
+ * task through EXTI0, see ADC_dataReadyIRQHandler().
+ *
+ * Bursts capture thousands of raw samples of a single channel at the maximum
+ * data rate into a region of FRAM, turning the node into a transient recorder.
+ * A burst is requested by a downlink or at boot, see ADC_burstRequest(), and
+ * uploaded afterwards as compressed PowerBurst blocks, see ADC_burstUpload().
+ * Set FRAM_BURST_SIZE to enable bursts.
+ *
  * Example: @ref example_adc.c
  *
  * Datasheet: https://www.ti.com/product/ADS1219
@@ -43,6 +54,70 @@ extern "C" {
  * @{
  */
 
+#ifndef ADS_DATA_RATE
+/**
+ * @brief Data rate setting of conversions
+ *
+ * 0 = 20 SPS, 1 = 90 SPS, 2 = 330 SPS, 3 = 1000 SPS. Faster rates shorten
+ * measurements at the cost of noise.
+ */
+#define ADS_DATA_RATE 0
+#endif /* ADS_DATA_RATE */
+
+#if ADS_DATA_RATE < 0 || ADS_DATA_RATE > 3
+#error "ADS_DATA_RATE must be between 0 and 3"
+#endif
+
+#ifndef ADS_OVERSAMPLE
+/**
+ * @brief Number of conversions of each channel per measurement
+ *
+ * With more than one conversion the minimum, maximum, mean and standard
+ * deviation of the samples are sent as a PowerSummary instead of a
+ * PowerMeasurement. Limited to STATS_MAX_COUNT.
+ */
+#define ADS_OVERSAMPLE 1
+#endif /* ADS_OVERSAMPLE */
+
+#ifndef ADS_BURST_DATA_RATE
+/**
+ * @brief Data rate setting of bursts, see ADS_DATA_RATE
+ *
+ * 1000 SPS by default, the maximum of the ADS1219.
+ */
+#define ADS_BURST_DATA_RATE 3
+#endif /* ADS_BURST_DATA_RATE */
+
+#if ADS_BURST_DATA_RATE < 0 || ADS_BURST_DATA_RATE > 3
+#error "ADS_BURST_DATA_RATE must be between 0 and 3"
+#endif
+
+#ifndef ADS_BURST_I2C_TIMING
+/**
+ * @brief Timing register of I2C2 during bursts
+ *
+ * I2C2 runs at 100 kHz and is shared with the FRAM, which is too slow to read
+ * 1000 SPS and write them to FRAM. Bursts switch the bus to 400 kHz, from the
+ * 48 MHz system clock, and restore the timing of MX_I2C2_Init() after.
+ */
+#define ADS_BURST_I2C_TIMING 0x2010091A
+#endif /* ADS_BURST_I2C_TIMING */
+
+#ifndef ADS_BURST_SAMPLES
+/** Number of samples of a burst at boot, 0 to only capture on request */
+#define ADS_BURST_SAMPLES 0
+#endif /* ADS_BURST_SAMPLES */
+
+#ifndef ADS_BURST_BLOCK_SIZE
+/**
+ * @brief Maximum number of bytes of compressed samples of an uploaded block
+ *
+ * Sized so a block fits the smallest LoRaWAN payload of 51 bytes. At most the
+ * max_size of PowerBurst.samples.
+ */
+#define ADS_BURST_BLOCK_SIZE 12
+#endif /* ADS_BURST_BLOCK_SIZE */
+
 /**
 ******************************************************************************
 * @brief    This function starts up the ADS1219
@@ -100,11 +175,131 @@ HAL_StatusTypeDef ADC_probe(void);
 ******************************************************************************
 * @brief    This function encodes the ADS1219 power measurments into protobuf
 *
-* @param    *data
-* @return   size_t
+*           Encodes a PowerSummary of the samples when ADS_OVERSAMPLE is
+*greater than one.
+*
+* @param    stream Output stream for the serialized measurement
+* @return   true on success, false on error
 *******************************************f***********************************
 */
-size_t ADC_measure(uint8_t *data);
+bool ADC_measure(pb_ostream_t *stream);
+
+/**
+******************************************************************************
+* @brief    This function starts an asynchronous power measurement
+*
+*           Voltage and current are converted one after the other in
+*continuous mode. The conversions run while the caller sleeps or serves other
+*sensors, instead of blocking as in ADC_measure, and DRDY wakes the sensors
+*task when each channel is ready.
+*
+* @param    void
+* @return   Time until ADC_measurePoll should be called in ms, -1 on error
+* @see      SensorsPrototypeStart
+******************************************************************************
+*/
+int ADC_measureStart(void);
+
+/**
+******************************************************************************
+* @brief    This function advances the asynchronous power measurement
+*
+*           Conversions are read once the DRDY pin is low, so this function
+*may be called early.
+*
+* @param    void
+* @return   0 when done, time until the next poll in ms or -1 on error
+* @see      SensorsPrototypePoll
+******************************************************************************
+*/
+int ADC_measurePoll(void);
+
+/**
+******************************************************************************
+* @brief    This function encodes the asynchronous power measurement into
+*           protobuf
+*
+* @param    stream Output stream for the serialized measurement
+* @return   true on success, false on error
+* @see      SensorsPrototypeMeasure
+******************************************************************************
+*/
+bool ADC_measureCollect(pb_ostream_t *stream);
+
+/**
+******************************************************************************
+* @brief    This function handles the DRDY interrupt
+*
+*           Called from EXTI0_IRQHandler. Conversions are read by
+*ADC_measurePoll in the sensors task, since I2C2 is shared with the FRAM.
+*
+* @param    void
+* @return   void
+******************************************************************************
+*/
+void ADC_dataReadyIRQHandler(void);
+
+/**
+******************************************************************************
+* @brief    This function requests a burst capture
+*
+*           The burst is captured by a sequencer task once the power
+*measurement in progress is done, see ADC_burstCapture. Called from the
+*downlink handler and at boot when ADS_BURST_SAMPLES is set.
+*
+* @param    samples Number of samples, 0 for ADC_burstCapacity
+* @param    current true for the current channel, false for voltage
+* @return   0 if the burst was requested, -1 if bursts are disabled
+******************************************************************************
+*/
+int ADC_burstRequest(uint32_t samples, bool current);
+
+/**
+******************************************************************************
+* @brief    This function captures a burst of raw samples into FRAM
+*
+*           One channel is converted continuously at ADS_BURST_DATA_RATE and
+*the samples replace the previous burst in the region of FRAM_BURST_SIZE
+*bytes. Samples fill one half of a buffer in RAM while the other half is
+*written to FRAM with DMA. I2C2 is shared by both, so the half is written in
+*chunks that fit the time between conversions. Conversions that are not read
+*before the next one completes are counted as dropped.
+*
+*           Blocks until all samples are captured, about one second per 1000
+*samples at the default rate.
+*
+* @param    samples Number of samples, at most ADC_burstCapacity
+* @param    current true for the current channel, false for voltage
+* @return   0 on success, -1 on error
+******************************************************************************
+*/
+int ADC_burstCapture(uint32_t samples, bool current);
+
+/**
+******************************************************************************
+* @brief    This function gets the maximum number of samples of a burst
+*
+* @param    void
+* @return   Number of samples, 0 if bursts are disabled
+******************************************************************************
+*/
+uint32_t ADC_burstCapacity(void);
+
+/**
+******************************************************************************
+* @brief    This function moves blocks of the captured burst to the FIFO
+*
+*           Samples are compressed into PowerBurst measurements of at most
+*ADS_BURST_BLOCK_SIZE bytes of samples and stored in the FIFO buffer, so they
+*are uploaded like other measurements. Progress is saved with the burst, so
+*the upload resumes after a reset or once the buffer has room. Called when
+*the buffer is empty so bursts do not delay measurements.
+*
+* @param    max_blocks Maximum number of blocks to move
+* @return   Number of samples left to upload, -1 on error
+******************************************************************************
+*/
+int ADC_burstUpload(uint32_t max_blocks);
 
 /**
  * @}
@@ -12,9 +12,39 @@
 
 #include "ads.h"
 
+#include <math.h>
 #include <stm32wlxx_hal_gpio.h>
 
+#include "fifo.h"
+#include "sensors.h"
+#include "stats.h"
+#include "stm32_seq.h"
 #include "userConfig.h"
+#include "utilities_def.h"
+
+#if ADS_OVERSAMPLE < 1 || ADS_OVERSAMPLE > STATS_MAX_COUNT
+#error "ADS_OVERSAMPLE must be between 1 and STATS_MAX_COUNT"
+#endif
+
+// a full scale sample takes 4 bytes compressed
+#if ADS_BURST_BLOCK_SIZE < 4 || ADS_BURST_BLOCK_SIZE > 64
+#error "ADS_BURST_BLOCK_SIZE must be between 4 and 64"
+#endif
+
+/** Bytes of a raw sample of a burst in FRAM */
+#define BURST_SAMPLE_SIZE 3
+
+/** Bytes reserved for the header at the start of the burst region */
+#define BURST_HEADER_SIZE 32
+
+/** Samples of each half of the burst buffer */
+#define BURST_HALF_SAMPLES 32
+
+/** Bytes written to FRAM between two conversions of a burst */
+#define BURST_CHUNK_SIZE 12
+
+/** Marks a valid burst header, changed with the layout */
+#define BURST_MAGIC 0x42535701
 
 /** i2c address */
 static const uint8_t addr = 0x40;
@@ -82,6 +112,83 @@ const uint16_t data_ready_pin = GPIO_PIN_0;
 /** Uart timeout in ms */
 static const unsigned int g_timeout = 5000;
 
+/** Time to wait for a single-shot conversion before checking data ready */
+static const int conversion_delay = 60;
+
+/** Samples per second of each data rate setting */
+static const uint16_t data_rate_sps[4] = {20, 90, 330, 1000};
+
+/** Channel being converted by the pipeline */
+static enum {
+  ADS_PIPELINE_IDLE,
+  ADS_PIPELINE_VOLTAGE,
+  ADS_PIPELINE_CURRENT,
+} pipeline_state = ADS_PIPELINE_IDLE;
+
+/** Statistics of the raw voltage samples of the pipeline */
+static Stats voltage_stats;
+
+/** Statistics of the raw current samples of the pipeline */
+static Stats current_stats;
+
+/** Time the conversion in progress times out, from HAL_GetTick() */
+static uint32_t pipeline_deadline = 0;
+
+/** Wake the sensors task when data is ready */
+static volatile bool pipeline_wake = false;
+
+/** Timestamp of the asynchronous measurement */
+static uint32_t async_ts = 0;
+
+/**
+ * @brief Header of the burst stored at FRAM_BURST_ADDR
+ */
+typedef struct {
+  /** BURST_MAGIC once a burst is captured */
+  uint32_t magic;
+  /** Timestamp of the first sample */
+  uint32_t ts;
+  /** Number of samples captured */
+  uint32_t total;
+  /** Number of samples moved to the FIFO */
+  uint32_t uploaded;
+  /** Number of conversions that were not read */
+  uint32_t dropped;
+  /** Samples per second */
+  uint16_t rate;
+  /** Incremented on every capture */
+  uint8_t id;
+  /** Channel of the samples, 1 for current */
+  uint8_t current;
+} BurstHeader;
+
+/** Header of the latest burst */
+static BurstHeader burst = {0};
+
+/** The header was read from FRAM */
+static bool burst_loaded = false;
+
+/** Raw samples waiting to be written to FRAM, in two halves */
+static uint8_t burst_buffer[2][BURST_HALF_SAMPLES * BURST_SAMPLE_SIZE];
+
+/** Count DRDY edges while a burst is captured */
+static volatile bool burst_active = false;
+
+/** Number of DRDY edges since the start of the burst */
+static volatile uint32_t burst_ready = 0;
+
+/** An asynchronous write of the burst failed */
+static volatile bool burst_write_error = false;
+
+/** Number of samples of the requested burst */
+static uint32_t burst_request_samples = 0;
+
+/** Channel of the requested burst */
+static bool burst_request_current = false;
+
+/** The requested burst waits for the power measurement in progress */
+static bool burst_deferred = false;
+
 /**
  * @brief Turn on power to analog circuit
  *
@@ -102,7 +209,7 @@ void PowerOn(void);
  *
  * @see data_ready_pin
  */
-void PowerDown(void);
+void PowerOff(void);
 
 /**
  * @brief Measure from the adc
@@ -113,6 +220,174 @@ void PowerDown(void);
  */
 HAL_StatusTypeDef Measure(int32_t *meas);
 
+/**
+ * @brief Starts or restarts a conversion
+ *
+ * @return HAL_StatusTypeDef
+ */
+static HAL_StatusTypeDef StartConversion(void);
+
+/**
+ * @brief Reads the result of the latest conversion
+ *
+ * @param meas Raw measurement
+ * @return HAL_StatusTypeDef
+ */
+static HAL_StatusTypeDef ReadConversion(int32_t *meas);
+
+/**
+ * @brief Configures the channel and mode of conversions
+ *
+ * @param current true for the current channel, false for voltage
+ * @param continuous true for continuous conversions, false for single-shot
+ * @return HAL_StatusTypeDef
+ */
+static HAL_StatusTypeDef ConfigureChannel(bool current, bool continuous);
+
+/**
+ * @brief Configures the channel, mode and data rate of conversions
+ *
+ * @param current true for the current channel, false for voltage
+ * @param continuous true for continuous conversions, false for single-shot
+ * @param dr Data rate setting, see ADS_DATA_RATE
+ * @return HAL_StatusTypeDef
+ */
+static HAL_StatusTypeDef ConfigureChannelRate(bool current, bool continuous,
+                                              uint8_t dr);
+
+/**
+ * @brief Time to wait for data ready before giving up on a conversion
+ *
+ * @return Timeout in ms
+ */
+static int ConversionTimeout(void);
+
+/**
+ * @brief Time to wait for data ready at a data rate
+ *
+ * @param dr Data rate setting, see ADS_DATA_RATE
+ * @return Timeout in ms
+ */
+static int ConversionTimeoutRate(uint8_t dr);
+
+/**
+ * @brief Starts converting voltage then current in continuous mode
+ *
+ * The analog circuit is powered until ADS_OVERSAMPLE samples of both channels
+ * are read.
+ *
+ * @return Timeout of the first conversion in ms, -1 on error
+ */
+static int PipelineStart(void);
+
+/**
+ * @brief Reads the sample that is ready and switches channels once all
+ * samples of a channel are read
+ *
+ * @return 0 once both channels are read, time until the conversion in
+ * progress times out in ms or -1 on error
+ */
+static int PipelineStep(void);
+
+/**
+ * @brief Encodes the samples of the pipeline
+ *
+ * A single sample is encoded as a PowerMeasurement, oversampled power as a
+ * PowerSummary.
+ *
+ * @param ts Timestamp of the measurement
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
+ */
+static bool PipelineEncode(uint32_t ts, pb_ostream_t *stream);
+
+/**
+ * @brief Powers down the adc and the analog circuit
+ */
+static void PipelineStop(void);
+
+/**
+ * @brief Sets the timing register of I2C2
+ *
+ * @param timing Value of TIMINGR
+ */
+static void SetI2CTiming(uint32_t timing);
+
+/**
+ * @brief Captures the requested burst, run by the sequencer
+ */
+static void BurstTask(void);
+
+/**
+ * @brief Reads conversions into the burst buffer and writes full halves to
+ * FRAM
+ *
+ * @param samples Number of samples
+ * @param header Header of the burst, counts captured and dropped samples
+ * @return 0 on success, -1 on error
+ */
+static int BurstLoop(uint32_t samples, BurstHeader *header);
+
+/**
+ * @brief Records errors of asynchronous burst writes
+ *
+ * @param status Status of the write
+ */
+static void BurstWriteDone(FramStatus status);
+
+/**
+ * @brief Reads the burst header from FRAM once
+ *
+ * @return true if a burst was captured
+ */
+static bool BurstLoad(void);
+
+/**
+ * @brief Writes the burst header to FRAM
+ *
+ * @return 0 on success, -1 on error
+ */
+static int BurstSave(void);
+
+/**
+ * @brief Encodes a block of the burst as a measurement
+ *
+ * @param stream Output stream
+ * @param arg PowerBurst of the block
+ * @return true on success, false on error
+ */
+static bool BurstEncode(pb_ostream_t *stream, void *arg);
+
+/**
+ * @brief Applies the voltage calibration to a raw measurement
+ *
+ * @param raw Raw measurement, fractional for the mean of samples
+ * @return Voltage
+ */
+static double CalibrateVoltage(double raw);
+
+/**
+ * @brief Applies the current calibration to a raw measurement
+ *
+ * @param raw Raw measurement, fractional for the mean of samples
+ * @return Current
+ */
+static double CalibrateCurrent(double raw);
+
+/**
+ * @brief Calibrates the statistics of raw samples
+ *
+ * @param stats Statistics of raw samples
+ * @param calibrate Calibration of the channel
+ * @param mean Calibrated mean
+ * @param min Calibrated minimum
+ * @param max Calibrated maximum
+ * @param stddev Calibrated standard deviation
+ */
+static void CalibrateStats(const Stats *stats, double (*calibrate)(double),
+                           float *mean, float *min, float *max,
+                           float *stddev);
+
 /**
  * @brief This function reconfigures the ADS1219 based on the parameter reg_data
  *
@@ -141,6 +416,18 @@ HAL_StatusTypeDef ADC_init(void) {
   // wait minimum 500 us to reach steady state
   HAL_Delay(1);
 
+  // DRDY is open-drain and falls when a conversion is ready
+  GPIO_InitTypeDef gpio_init = {0};
+  gpio_init.Pin = data_ready_pin;
+  gpio_init.Mode = GPIO_MODE_IT_FALLING;
+  gpio_init.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init((GPIO_TypeDef *)data_ready_port, &gpio_init);
+
+  HAL_NVIC_SetPriority(EXTI0_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+
+  UTIL_SEQ_RegTask((1 << CFG_SEQ_Task_PowerBurst), UTIL_SEQ_RFU, BurstTask);
+
   return ret;
 }
 
@@ -152,27 +439,29 @@ HAL_StatusTypeDef Configure(const ConfigReg reg_data) {
   return ret;
 }
 
-double ADC_readVoltage(void) {
-  HAL_StatusTypeDef ret = HAL_OK;
-  int32_t raw = 0;
-  double meas = 0.0;
+static HAL_StatusTypeDef ConfigureChannel(bool current, bool continuous) {
+  return ConfigureChannelRate(current, continuous, ADS_DATA_RATE);
+}
 
+static HAL_StatusTypeDef ConfigureChannelRate(bool current, bool continuous,
+                                              uint8_t dr) {
   ConfigReg reg_data = {0};
+  if (current) {
+    reg_data.bits.mux = 0b001;
+  }
+  reg_data.bits.dr = dr;
+  reg_data.bits.mode = continuous;
   reg_data.bits.vref = 1;
 
   // 0x21 is single shot and 0x23 is continuos
-  ret = Configure(reg_data);  // configure to read current
-  if (ret != HAL_OK) {
-    return -1;
-  }
+  return Configure(reg_data);
+}
 
-  ret = Measure(&raw);
-  if (ret != HAL_OK) {
-    return -1;
-  }
+static double CalibrateVoltage(double raw) {
+  double meas = 0.0;
 
 #ifdef CALIBRATION
-  meas = (double)raw;
+  meas = raw;
 #else
   meas = (voltage_calibration_m * raw) + voltage_calibration_b;
 #endif
@@ -182,17 +471,38 @@ double ADC_readVoltage(void) {
   return meas;
 }
 
-double ADC_readCurrent(void) {
-  HAL_StatusTypeDef ret = HAL_OK;
-  int32_t raw = 0;
+static double CalibrateCurrent(double raw) {
   double meas = 0.0;
 
-  ConfigReg reg_data = {0};
-  reg_data.bits.mux = 0b001;
-  reg_data.bits.vref = 1;
+#ifdef CALIBRATION
+  meas = raw;
+#else
+  meas = (current_calibration_m * raw) + current_calibration_b;
+#endif
 
-  // 0x21 is single shot and 0x23 is continuos
-  ret = Configure(reg_data);  // configure to read current
+  return meas;
+}
+
+static void CalibrateStats(const Stats *stats, double (*calibrate)(double),
+                           float *mean, float *min, float *max,
+                           float *stddev) {
+  *mean = (float)calibrate(StatsMean(stats));
+
+  // a negative slope swaps the minimum and maximum
+  const double low = calibrate(stats->min);
+  const double high = calibrate(stats->max);
+  *min = (float)fmin(low, high);
+  *max = (float)fmax(low, high);
+
+  // only the slope applies to the spread
+  *stddev = (float)fabs(calibrate(StatsStddev(stats)) - calibrate(0));
+}
+
+double ADC_readVoltage(void) {
+  HAL_StatusTypeDef ret = HAL_OK;
+  int32_t raw = 0;
+
+  ret = ConfigureChannel(false, false);  // configure to read voltage
   if (ret != HAL_OK) {
     return -1;
   }
@@ -202,13 +512,24 @@ double ADC_readCurrent(void) {
     return -1;
   }
 
-#ifdef CALIBRATION
-  meas = (double)raw;
-#else
-  meas = (current_calibration_m * raw) + current_calibration_b;
-#endif
+  return CalibrateVoltage(raw);
+}
 
-  return meas;
+double ADC_readCurrent(void) {
+  HAL_StatusTypeDef ret = HAL_OK;
+  int32_t raw = 0;
+
+  ret = ConfigureChannel(true, false);  // configure to read current
+  if (ret != HAL_OK) {
+    return -1;
+  }
+
+  ret = Measure(&raw);
+  if (ret != HAL_OK) {
+    return -1;
+  }
+
+  return CalibrateCurrent(raw);
 }
 
 HAL_StatusTypeDef probeADS12(void) {
@@ -217,22 +538,438 @@ HAL_StatusTypeDef probeADS12(void) {
   return ret;
 }
 
-size_t ADC_measure(uint8_t *data) {
+bool ADC_measure(pb_ostream_t *stream) {
   // get timestamp
   SysTime_t ts = SysTimeGet();
 
-  // read power
-  double adc_voltage = ADC_readVoltage();
-  double adc_current = ADC_readCurrent();
+  // read power, waiting on DRDY for both conversions
+  int ret = PipelineStart();
+  while (ret > 0) {
+    ret = PipelineStep();
+  }
+  if (ret < 0) {
+    return false;
+  }
+
+  return PipelineEncode(ts.Seconds, stream);
+}
+
+int ADC_measureStart(void) {
+  // get timestamp
+  async_ts = SysTimeGet().Seconds;
+
+  int ret = PipelineStart();
+  pipeline_wake = (ret > 0);
+  return ret;
+}
+
+int ADC_measurePoll(void) {
+  int ret = PipelineStep();
+  pipeline_wake = (ret > 0);
+  return ret;
+}
+
+bool ADC_measureCollect(pb_ostream_t *stream) {
+  return PipelineEncode(async_ts, stream);
+}
+
+void ADC_dataReadyIRQHandler(void) {
+  __HAL_GPIO_EXTI_CLEAR_IT(data_ready_pin);
+
+  // conversions of a burst are read in a loop, edges count dropped samples
+  if (burst_active) {
+    ++burst_ready;
+  }
+
+  // data is read by the sensors task
+  if (pipeline_wake) {
+    SensorsWake();
+  }
+}
+
+int ADC_burstRequest(uint32_t samples, bool current) {
+  const uint32_t capacity = ADC_burstCapacity();
+  if (capacity == 0) {
+    return -1;
+  }
+
+  if (samples == 0 || samples > capacity) {
+    samples = capacity;
+  }
+  burst_request_samples = samples;
+  burst_request_current = current;
+
+  UTIL_SEQ_SetTask((1 << CFG_SEQ_Task_PowerBurst), CFG_SEQ_Prio_0);
+
+  return 0;
+}
+
+int ADC_burstCapture(uint32_t samples, bool current) {
+  if (samples == 0 || samples > ADC_burstCapacity() ||
+      pipeline_state != ADS_PIPELINE_IDLE) {
+    return -1;
+  }
+
+  BurstLoad();
+
+  BurstHeader header = {0};
+  header.magic = BURST_MAGIC;
+  header.ts = SysTimeGet().Seconds;
+  header.rate = data_rate_sps[ADS_BURST_DATA_RATE];
+  header.id = (burst.magic == BURST_MAGIC) ? burst.id + 1 : 0;
+  header.current = current;
+
+  // the previous burst is invalid once its samples are overwritten
+  burst.magic = 0;
+  if (BurstSave() != 0) {
+    return -1;
+  }
+
+  // the bus is shared with the FRAM
+  FramWaitIdle();
+  SetI2CTiming(ADS_BURST_I2C_TIMING);
+  PowerOn();
+
+  burst_ready = 0;
+  burst_write_error = false;
+  burst_active = true;
+
+  int ret = -1;
+  if (ConfigureChannelRate(current, true, ADS_BURST_DATA_RATE) == HAL_OK &&
+      StartConversion() == HAL_OK) {
+    ret = BurstLoop(samples, &header);
+  }
+
+  burst_active = false;
+
+  // stop continuous conversions
+  HAL_I2C_Master_Transmit(&hi2c2, addrls, &cmd_powerdown, 1, g_timeout);
+  PowerOff();
+  SetI2CTiming(hi2c2.Init.Timing);
+
+  if (ret != 0) {
+    return -1;
+  }
+
+  burst = header;
+  return BurstSave();
+}
+
+uint32_t ADC_burstCapacity(void) {
+  if (FRAM_BURST_SIZE <= BURST_HEADER_SIZE) {
+    return 0;
+  }
+
+  return (FRAM_BURST_SIZE - BURST_HEADER_SIZE) / BURST_SAMPLE_SIZE;
+}
+
+int ADC_burstUpload(uint32_t max_blocks) {
+  if (ADC_burstCapacity() == 0 || !BurstLoad()) {
+    return 0;
+  }
+
+  const uint32_t uploaded = burst.uploaded;
+
+  for (uint32_t i = 0; i < max_blocks && burst.uploaded < burst.total; i++) {
+    // every sample takes at least a byte compressed
+    uint32_t count = burst.total - burst.uploaded;
+    if (count > ADS_BURST_BLOCK_SIZE) {
+      count = ADS_BURST_BLOCK_SIZE;
+    }
+
+    uint8_t raw[ADS_BURST_BLOCK_SIZE * BURST_SAMPLE_SIZE];
+    const FramAddr addr = FRAM_BURST_ADDR + BURST_HEADER_SIZE +
+                          (burst.uploaded * BURST_SAMPLE_SIZE);
+    if (FramRead(addr, count * BURST_SAMPLE_SIZE, raw) != FRAM_OK) {
+      return -1;
+    }
+
+    int32_t samples[ADS_BURST_BLOCK_SIZE];
+    for (uint32_t j = 0; j < count; j++) {
+      const uint8_t *p = &raw[j * BURST_SAMPLE_SIZE];
+      samples[j] = ((int32_t)p[0] << 16) | ((int32_t)p[1] << 8) | p[2];
+      // extend the sign of the 24-bit sample
+      if (samples[j] & 0x800000) {
+        samples[j] |= 0xFF000000;
+      }
+    }
+
+    PowerBurst block = PowerBurst_init_zero;
+    block.burst_id = burst.id;
+    block.current = burst.current;
+    block.rate = burst.rate;
+    block.offset = burst.uploaded;
+    block.total = burst.total;
+    block.dropped = burst.dropped;
+
+    size_t len = 0;
+    count = EncodeBurstSamples(samples, count, block.samples.bytes,
+                               ADS_BURST_BLOCK_SIZE, &len);
+    block.samples.size = len;
+
+    const FramStatus status = FramPutStream(
+        FRAM_RECORD_MEASUREMENT, Measurement_size, BurstEncode, &block);
+    if (status == FRAM_BUFFER_FULL) {
+      // resumed once measurements are uploaded
+      break;
+    } else if (status != FRAM_OK) {
+      return -1;
+    }
+
+    burst.uploaded += count;
+  }
+
+  if (burst.uploaded != uploaded && BurstSave() != 0) {
+    return -1;
+  }
+
+  return burst.total - burst.uploaded;
+}
+
+static void SetI2CTiming(uint32_t timing) {
+  // TIMINGR is only writable while the peripheral is disabled
+  __HAL_I2C_DISABLE(&hi2c2);
+  hi2c2.Instance->TIMINGR = timing;
+  __HAL_I2C_ENABLE(&hi2c2);
+}
+
+static void BurstTask(void) {
+  // the frontend is in use, started again by PipelineStop()
+  if (pipeline_state != ADS_PIPELINE_IDLE) {
+    burst_deferred = true;
+    return;
+  }
+
+  ADC_burstCapture(burst_request_samples, burst_request_current);
+}
+
+static int BurstLoop(uint32_t samples, BurstHeader *header) {
+  FramAddr addr = FRAM_BURST_ADDR + BURST_HEADER_SIZE;
+  const int timeout = ConversionTimeoutRate(ADS_BURST_DATA_RATE);
+  uint32_t deadline = HAL_GetTick() + timeout;
+  uint32_t handled = 0;
+
+  // half being filled with samples and the other half being written
+  uint8_t fill = 0;
+  size_t fill_len = 0;
+  size_t drain_pos = 0;
+  size_t drain_len = 0;
+
+  while (header->total < samples) {
+    if (burst_ready == handled) {
+      if ((int32_t)(deadline - HAL_GetTick()) <= 0) {
+        return -1;
+      }
+      // woken by DRDY, DMA or the tick
+      __WFI();
+      continue;
+    }
+
+    // the chunk in progress holds the bus
+    FramWaitIdle();
+
+    const uint32_t ready = burst_ready;
+    header->dropped += ready - handled - 1;
+    handled = ready;
+
+    int32_t raw = 0;
+    if (ReadConversion(&raw) != HAL_OK) {
+      return -1;
+    }
+    deadline = HAL_GetTick() + timeout;
+
+    uint8_t *sample = &burst_buffer[fill][fill_len];
+    sample[0] = raw >> 16;
+    sample[1] = raw >> 8;
+    sample[2] = raw;
+    fill_len += BURST_SAMPLE_SIZE;
+    ++header->total;
+
+    if (fill_len == sizeof(burst_buffer[0]) || header->total == samples) {
+      // the other half is reused, finish writing it if conversions outpaced
+      // the chunks
+      if (drain_pos < drain_len) {
+        if (FramWrite(addr, &burst_buffer[fill ^ 1][drain_pos],
+                      drain_len - drain_pos) != FRAM_OK) {
+          return -1;
+        }
+        addr += drain_len - drain_pos;
+      }
+
+      fill ^= 1;
+      drain_pos = 0;
+      drain_len = fill_len;
+      fill_len = 0;
+    }
+
+    // written in the background until the next conversion
+    if (drain_pos < drain_len) {
+      size_t len = drain_len - drain_pos;
+      if (len > BURST_CHUNK_SIZE) {
+        len = BURST_CHUNK_SIZE;
+      }
+      if (FramWriteAsync(addr, &burst_buffer[fill ^ 1][drain_pos], len,
+                         BurstWriteDone) != FRAM_OK) {
+        return -1;
+      }
+      addr += len;
+      drain_pos += len;
+    }
+
+    if (burst_write_error) {
+      return -1;
+    }
+  }
+
+  // rest of the last half
+  if (drain_pos < drain_len &&
+      FramWrite(addr, &burst_buffer[fill ^ 1][drain_pos],
+                drain_len - drain_pos) != FRAM_OK) {
+    return -1;
+  }
+
+  FramWaitIdle();
+  return burst_write_error ? -1 : 0;
+}
+
+static void BurstWriteDone(FramStatus status) {
+  if (status != FRAM_OK) {
+    burst_write_error = true;
+  }
+}
+
+static bool BurstLoad(void) {
+  if (!burst_loaded) {
+    if (FramRead(FRAM_BURST_ADDR, sizeof(burst), (uint8_t *)&burst) !=
+        FRAM_OK) {
+      return false;
+    }
+    burst_loaded = true;
+  }
+
+  return burst.magic == BURST_MAGIC;
+}
+
+static int BurstSave(void) {
+  if (FramWrite(FRAM_BURST_ADDR, (const uint8_t *)&burst, sizeof(burst)) !=
+      FRAM_OK) {
+    return -1;
+  }
+
+  burst_loaded = true;
+  return 0;
+}
+
+static bool BurstEncode(pb_ostream_t *stream, void *arg) {
+  const UserConfiguration *cfg = UserConfigGet();
+  return EncodePowerBurstStream(burst.ts, cfg->logger_id, cfg->cell_id,
+                                (const PowerBurst *)arg, stream);
+}
+
+static int ConversionTimeout(void) {
+  return ConversionTimeoutRate(ADS_DATA_RATE);
+}
+
+static int ConversionTimeoutRate(uint8_t dr) {
+  // twice the conversion time, with a margin for the delay to the read
+  return (2 * 1000 / data_rate_sps[dr]) + 10;
+}
+
+static int PipelineStart(void) {
+  StatsInit(&voltage_stats);
+  StatsInit(&current_stats);
+
+  PowerOn();
+
+  // voltage is converted first
+  if (ConfigureChannel(false, true) != HAL_OK || StartConversion() != HAL_OK) {
+    PipelineStop();
+    return -1;
+  }
+
+  pipeline_state = ADS_PIPELINE_VOLTAGE;
+  pipeline_deadline = HAL_GetTick() + ConversionTimeout();
+  return ConversionTimeout();
+}
+
+static int PipelineStep(void) {
+  if (pipeline_state == ADS_PIPELINE_IDLE) {
+    return -1;
+  }
 
+  // DRDY is low once data is ready
+  if (HAL_GPIO_ReadPin(data_ready_port, data_ready_pin)) {
+    const int32_t remaining = (int32_t)(pipeline_deadline - HAL_GetTick());
+    if (remaining <= 0) {
+      PipelineStop();
+      return -1;
+    }
+    return remaining;
+  }
+
+  Stats *stats = (pipeline_state == ADS_PIPELINE_VOLTAGE) ? &voltage_stats
+                                                           : &current_stats;
+  int32_t raw = 0;
+  if (ReadConversion(&raw) != HAL_OK || StatsAdd(stats, raw) != 0) {
+    PipelineStop();
+    return -1;
+  }
+
+  if (stats->count < ADS_OVERSAMPLE) {
+    // next sample of the channel is converted without a restart
+  } else if (pipeline_state == ADS_PIPELINE_VOLTAGE) {
+    // switch the mux and restart so the next conversion is only current
+    if (ConfigureChannel(true, true) != HAL_OK ||
+        StartConversion() != HAL_OK) {
+      PipelineStop();
+      return -1;
+    }
+    pipeline_state = ADS_PIPELINE_CURRENT;
+  } else {
+    PipelineStop();
+    return 0;
+  }
+
+  pipeline_deadline = HAL_GetTick() + ConversionTimeout();
+  return ConversionTimeout();
+}
+
+static bool PipelineEncode(uint32_t ts, pb_ostream_t *stream) {
   const UserConfiguration *cfg = UserConfigGet();
 
+#if ADS_OVERSAMPLE > 1
+  PowerSummary summary = PowerSummary_init_zero;
+  summary.count = voltage_stats.count;
+  CalibrateStats(&voltage_stats, CalibrateVoltage, &summary.voltage_mean,
+                 &summary.voltage_min, &summary.voltage_max,
+                 &summary.voltage_stddev);
+  CalibrateStats(&current_stats, CalibrateCurrent, &summary.current_mean,
+                 &summary.current_min, &summary.current_max,
+                 &summary.current_stddev);
+
+  // encode summary
+  return EncodePowerSummaryStream(ts, cfg->logger_id, cfg->cell_id, &summary,
+                                  stream);
+#else
   // encode measurement
-  size_t data_len = EncodePowerMeasurement(
-      ts.Seconds, cfg->logger_id, cfg->cell_id, adc_voltage, adc_current, data);
+  return EncodePowerMeasurementStream(
+      ts, cfg->logger_id, cfg->cell_id,
+      CalibrateVoltage(StatsMean(&voltage_stats)),
+      CalibrateCurrent(StatsMean(&current_stats)), stream);
+#endif /* ADS_OVERSAMPLE > 1 */
+}
 
-  // return number of bytes in serialized measurement
-  return data_len;
+static void PipelineStop(void) {
+  pipeline_state = ADS_PIPELINE_IDLE;
+
+  // stop continuous conversions
+  HAL_I2C_Master_Transmit(&hi2c2, addrls, &cmd_powerdown, 1, g_timeout);
+  PowerOff();
+
+  if (burst_deferred) {
+    burst_deferred = false;
+    UTIL_SEQ_SetTask((1 << CFG_SEQ_Task_PowerBurst), CFG_SEQ_Prio_0);
+  }
 }
 
 void PowerOn(void) {
@@ -248,21 +985,33 @@ void PowerOff(void) {
 }
 
 HAL_StatusTypeDef Measure(int32_t *meas) {
-  HAL_StatusTypeDef ret = HAL_OK;
-  uint8_t rx_data[3] = {0x00, 0x00, 0x00};
-
   PowerOn();
 
-  // start conversion
-  HAL_I2C_Master_Transmit(&hi2c2, addrls, &cmd_start, 1, g_timeout);
+  StartConversion();
 
   // wait for conversion
-  HAL_Delay(60);
+  HAL_Delay(conversion_delay);
 
   // Wait for the DRDY pin on the ADS12 to go low, this means data is ready
   while (HAL_GPIO_ReadPin(data_ready_port, data_ready_pin)) {
   }
 
+  HAL_StatusTypeDef ret = ReadConversion(meas);
+
+  PowerOff();
+
+  return ret;
+}
+
+static HAL_StatusTypeDef StartConversion(void) {
+  // start conversion
+  return HAL_I2C_Master_Transmit(&hi2c2, addrls, &cmd_start, 1, g_timeout);
+}
+
+static HAL_StatusTypeDef ReadConversion(int32_t *meas) {
+  HAL_StatusTypeDef ret = HAL_OK;
+  uint8_t rx_data[3] = {0x00, 0x00, 0x00};
+
   // send read data command
   ret = HAL_I2C_Master_Transmit(&hi2c2, addrls, &cmd_rdata, 1, g_timeout);
   if (ret != HAL_OK) {
@@ -275,8 +1024,6 @@ HAL_StatusTypeDef Measure(int32_t *meas) {
     return -1;
   }
 
-  PowerOff();
-
   // Combine the 3 bytes into a 24-bit value
   *meas = ((int32_t)rx_data[0] << 16) | ((int32_t)rx_data[1] << 8) |
           ((int32_t)rx_data[2]);
@@ -21,6 +21,7 @@
 #include <stddef.h>
 
 #include "i2c.h"
+#include "pb_encode.h"
 #include "stm32wlxx_hal_i2c.h"
 #include "stm32wlxx_hal_def.h"
 
@@ -75,12 +76,46 @@ BME280Status BME280MeasureAll(BME280Data *data);
  * appropriate calibration are applied. Data gets encoded into a serialized
  * measurement.
  * 
- * @param data Buffer to store measurement
- * @return Length of measurement
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
  * 
  * @see SensorsPrototypeMeasure
  */
-size_t BME280Measure(uint8_t *data);
+bool BME280Measure(pb_ostream_t *stream);
+
+/**
+ * @brief Starts an asynchronous measurement
+ *
+ * Triggers a measurement in forced mode. The sensor converts while the caller
+ * sleeps or serves other sensors.
+ *
+ * @return Time until BME280MeasurePoll() should be called in ms, -1 on error
+ *
+ * @see SensorsPrototypeStart
+ */
+int BME280MeasureStart(void);
+
+/**
+ * @brief Advances the asynchronous measurement
+ *
+ * Reads the measurement once the sensor is done converting, so this function
+ * may be called early.
+ *
+ * @return 0 when done, time until the next poll in ms or -1 on error
+ *
+ * @see SensorsPrototypePoll
+ */
+int BME280MeasurePoll(void);
+
+/**
+ * @brief Encodes the asynchronous measurement into a serialized measurement
+ *
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
+ *
+ * @see SensorsPrototypeMeasure
+ */
+bool BME280MeasureCollect(pb_ostream_t *stream);
 
 #ifdef __cplusplus
 }
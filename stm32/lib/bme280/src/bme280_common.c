@@ -11,6 +11,7 @@
 #include "sys_app.h"
 #include "stm32wlxx_hal.h"
 #include "i2c.h"
+#include "fram.h"
 
 #include "bme280.h"
 #include "bme280_common.h"
@@ -40,6 +41,9 @@ BME280_INTF_RET_TYPE bme280_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32
 {
     dev_addr = *(uint8_t*)intf_ptr;
 
+    // the bus is shared with the FRAM
+    FramWaitIdle();
+
     HAL_StatusTypeDef status = HAL_I2C_Mem_Read(&hi2c2, dev_addr << 1, reg_addr,
                                                 I2C_MEMADD_SIZE_8BIT, reg_data,
                                                 length, i2c_timeout);
@@ -58,6 +62,9 @@ BME280_INTF_RET_TYPE bme280_i2c_write(uint8_t reg_addr, const uint8_t *reg_data,
 {
     dev_addr = *(uint8_t*)intf_ptr;
 
+    // the bus is shared with the FRAM
+    FramWaitIdle();
+
     HAL_StatusTypeDef status = HAL_I2C_Mem_Write(&hi2c2, dev_addr << 1,
                                                  reg_addr, I2C_MEMADD_SIZE_8BIT,
                                                  reg_data, length, i2c_timeout);
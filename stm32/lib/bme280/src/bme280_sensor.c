@@ -26,6 +26,27 @@ static struct bme280_dev dev;
  */
 static struct bme280_settings settings;
 
+/**
+ * @brief Data of the asynchronous measurement
+ *
+ * @see BME280MeasureStart
+ */
+static BME280Data async_data;
+
+/**
+ * @brief Timestamp of the asynchronous measurement
+ *
+ * @see BME280MeasureStart
+ */
+static uint32_t async_ts = 0;
+
+/**
+ * @brief Scales measurements based on defines
+ *
+ * @param data Measurement to scale
+ */
+static void BME280Scale(BME280Data *data);
+
 
 BME280Status BME280Init(void) {
   int8_t rslt;
@@ -110,6 +131,12 @@ BME280Status BME280MeasureAll(BME280Data *data) {
     }
   }
 
+  BME280Scale(data);
+
+  return rslt;
+}
+
+static void BME280Scale(BME280Data *data) {
   // adjust based on defines
 #ifndef BME280_DOUBLE_ENABLE
 /*
@@ -123,11 +150,9 @@ BME280Status BME280MeasureAll(BME280Data *data) {
 #ifdef BME280_64BIT_ENABLE 
   data->pressure = data->pressure / 100;
 #endif
-
-  return rslt;
 }
 
-size_t BME280Measure(uint8_t *data) {
+bool BME280Measure(pb_ostream_t *stream) {
   // get timestamp
   SysTime_t ts = SysTimeGet();
 
@@ -135,16 +160,60 @@ size_t BME280Measure(uint8_t *data) {
   BME280Data sens_data;
   BME280Status status = BME280MeasureAll(&sens_data);
   if (status != BME280_STATUS_OK) {
-    return -1;
+    return false;
   }
 
   const UserConfiguration* cfg = UserConfigGet();
 
   // encode measurement
-  size_t data_len = EncodeBME280Measurement(ts.Seconds, cfg->logger_id, cfg->cell_id,
-                                            sens_data.pressure,
-                                            sens_data.temperature,
-                                            sens_data.humidity, data);
+  return EncodeBME280MeasurementStream(ts.Seconds, cfg->logger_id, cfg->cell_id,
+                                       sens_data.pressure,
+                                       sens_data.temperature,
+                                       sens_data.humidity, stream);
+}
+
+int BME280MeasureStart(void) {
+  // get timestamp
+  async_ts = SysTimeGet().Seconds;
+
+  // trigger measurement
+  if (bme280_set_sensor_mode(BME280_POWERMODE_FORCED, &dev) != BME280_OK) {
+    return -1;
+  }
+
+  // measurement time is in microseconds
+  return (period + 999) / 1000;
+}
+
+int BME280MeasurePoll(void) {
+  uint8_t status_reg;
 
-  return data_len;
+  // check the status
+  if (bme280_get_regs(BME280_REG_STATUS, &status_reg, 1, &dev) != BME280_OK) {
+    return -1;
+  }
+
+  // measuring bit is set while converting
+  if (status_reg & BME280_STATUS_MEAS_DONE) {
+    return 1;
+  }
+
+  /* Read compensated data */
+  if (bme280_get_sensor_data(BME280_ALL, &async_data, &dev) != BME280_OK) {
+    return -1;
+  }
+
+  BME280Scale(&async_data);
+
+  return 0;
+}
+
+bool BME280MeasureCollect(pb_ostream_t *stream) {
+  const UserConfiguration* cfg = UserConfigGet();
+
+  // encode measurement
+  return EncodeBME280MeasurementStream(async_ts, cfg->logger_id, cfg->cell_id,
+                                       async_data.pressure,
+                                       async_data.temperature,
+                                       async_data.humidity, stream);
 }
@@ -0,0 +1,99 @@
+/**
+ * @file page.h
+ * @date 2026-10-16
+ * @author John Madden <jmadden173@pm.me>
+ * @brief Page storage interface implementation with the esp32
+ */
+
+#ifndef LIB_CONTROLLER_INCLUDE_CONTROLLER_PAGE_H_
+#define LIB_CONTROLLER_INCLUDE_CONTROLLER_PAGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @ingroup controller
+ * @defgroup controllerPage Page
+ * @brief Page storage interface for the esp32
+ *
+ * The *PageCommand* message is used to store pages of measurements as files
+ * on the sd card of the esp32. Files are identified by the file descriptor
+ * and are created on `OPEN`. `WRITE` appends the bytes in `data` to the file
+ * and `READ` returns up to `num_bytes` bytes starting at `offset` in `data`.
+ * `DELETE` removes the file.
+ *
+ * The return code (`rc`) of the response is 0 on success. For `WRITE` and
+ * `READ`, `num_bytes` is set to the number of bytes written or read.
+ *
+ * The signatures match the storage interface of the page library so the
+ * functions can be used for @ref PageInterfaceType directly.
+ *
+ * @{
+ */
+
+/**
+ * @brief Opens a file on the sd card, creating it if it does not exist
+ *
+ * @param fd File descriptor
+ *
+ * @return If the command succeeded
+ */
+bool ControllerPageOpen(uint32_t fd);
+
+/**
+ * @brief Closes a file on the sd card
+ *
+ * @param fd File descriptor
+ *
+ * @return If the command succeeded
+ */
+bool ControllerPageClose(uint32_t fd);
+
+/**
+ * @brief Appends bytes to a file on the sd card
+ *
+ * @param fd File descriptor
+ * @param data Binary data
+ * @param data_len Length of @p data, limited to the size of the data field of
+ * PageCommand
+ *
+ * @return Number of bytes written
+ */
+size_t ControllerPageWrite(uint32_t fd, const uint8_t *data, size_t data_len);
+
+/**
+ * @brief Reads bytes from a file on the sd card
+ *
+ * @param fd File descriptor
+ * @param offset Offset of the first byte to read
+ * @param data Buffer to store bytes
+ * @param data_len Maximum number of bytes to read
+ *
+ * @return Number of bytes read, 0 at the end of the file or on error
+ */
+size_t ControllerPageRead(uint32_t fd, uint32_t offset, uint8_t *data,
+                          size_t data_len);
+
+/**
+ * @brief Deletes a file on the sd card
+ *
+ * @param fd File descriptor
+ *
+ * @return If the command succeeded
+ */
+bool ControllerPageDelete(uint32_t fd);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIB_CONTROLLER_INCLUDE_CONTROLLER_PAGE_H_
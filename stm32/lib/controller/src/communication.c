@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <stm32wlxx_hal.h>
 
+#include "fram.h"
 #include "i2c.h"
 
 /**
@@ -54,6 +55,10 @@ ControllerStatus ControllerTransmit(unsigned int timeout) {
   // Lock mutex
   g_controller_mutex_lock = true;
 
+  // the bus is shared with the FRAM, which may be transferring in the
+  // background
+  FramWaitIdle();
+
   HAL_StatusTypeDef hal_status = HAL_OK;
 
   // return code storage
@@ -111,6 +116,9 @@ ControllerStatus ControllerTransmit(unsigned int timeout) {
 }
 
 ControllerStatus ControllerReceive(unsigned int timeout) {
+  // the bus is shared with the FRAM
+  FramWaitIdle();
+
   HAL_StatusTypeDef hal_status = HAL_OK;
 
   ControllerStatus cont_status = CONTROLLER_SUCCESS;
@@ -0,0 +1,124 @@
+#include "controller/page.h"
+
+#include <string.h>
+
+#include "communication.h"
+#include "transcoder.h"
+
+extern unsigned int g_controller_i2c_timeout;
+
+/**
+ * @brief Sends a page command and receives the response
+ *
+ * The command is encoded before the response is decoded, so @p output can
+ * point to the same struct as @p input to save stack space.
+ *
+ * @param input Command to send
+ * @param output Response from the esp32
+ *
+ * @return CONTROLLER_ERROR if the esp32 responded with a non-zero return code,
+ * otherwise see ControllerStatus
+ */
+static ControllerStatus PageCommandTransaction(const PageCommand *input,
+                                               PageCommand *output) {
+  // get reference to tx and rx buffers
+  Buffer *tx = ControllerTx();
+  Buffer *rx = ControllerRx();
+
+  // encode command
+  tx->len = EncodePageCommandMsg(input, tx->data, tx->size);
+
+  // send transaction
+  ControllerStatus status = CONTROLLER_SUCCESS;
+  status = ControllerTransaction(g_controller_i2c_timeout);
+  if (status != CONTROLLER_SUCCESS) {
+    return status;
+  }
+
+  // check for errors
+  if (rx->len == 0) {
+    return CONTROLLER_ERROR;
+  }
+
+  // decode command
+  if (DecodePageCommand(rx->data, rx->len, output) != 0) {
+    return CONTROLLER_ERROR;
+  }
+
+  if (output->rc != 0) {
+    return CONTROLLER_ERROR;
+  }
+
+  return CONTROLLER_SUCCESS;
+}
+
+/**
+ * @brief Sends a page command without data
+ *
+ * @param req Request type
+ * @param fd File descriptor
+ *
+ * @return If the command succeeded
+ */
+static bool PageRequest(PageCommand_RequestType req, uint32_t fd) {
+  PageCommand page_cmd = PageCommand_init_zero;
+  page_cmd.file_request = req;
+  page_cmd.file_descriptor = fd;
+  if (PageCommandTransaction(&page_cmd, &page_cmd) != CONTROLLER_SUCCESS) {
+    return false;
+  }
+
+  return true;
+}
+
+bool ControllerPageOpen(uint32_t fd) {
+  return PageRequest(PageCommand_RequestType_OPEN, fd);
+}
+
+bool ControllerPageClose(uint32_t fd) {
+  return PageRequest(PageCommand_RequestType_CLOSE, fd);
+}
+
+size_t ControllerPageWrite(uint32_t fd, const uint8_t *data, size_t data_len) {
+  PageCommand page_cmd = PageCommand_init_zero;
+  page_cmd.file_request = PageCommand_RequestType_WRITE;
+  page_cmd.file_descriptor = fd;
+
+  // limit to size of data field
+  if (data_len > sizeof(page_cmd.data.bytes)) {
+    data_len = sizeof(page_cmd.data.bytes);
+  }
+  memcpy(page_cmd.data.bytes, data, data_len);
+  page_cmd.data.size = data_len;
+  page_cmd.num_bytes = data_len;
+  if (PageCommandTransaction(&page_cmd, &page_cmd) != CONTROLLER_SUCCESS) {
+    return 0;
+  }
+
+  return page_cmd.num_bytes;
+}
+
+size_t ControllerPageRead(uint32_t fd, uint32_t offset, uint8_t *data,
+                          size_t data_len) {
+  PageCommand page_cmd = PageCommand_init_zero;
+  page_cmd.file_request = PageCommand_RequestType_READ;
+  page_cmd.file_descriptor = fd;
+  page_cmd.offset = offset;
+  page_cmd.num_bytes = data_len;
+  if (PageCommandTransaction(&page_cmd, &page_cmd) != CONTROLLER_SUCCESS) {
+    return 0;
+  }
+
+  // never copy more than requested
+  size_t len = page_cmd.data.size;
+  if (len > data_len) {
+    len = data_len;
+  }
+  memcpy(data, page_cmd.data.bytes, len);
+
+  return len;
+}
+
+bool ControllerPageDelete(uint32_t fd) {
+  return PageRequest(PageCommand_RequestType_DELETE, fd);
+}
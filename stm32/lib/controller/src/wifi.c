@@ -6,6 +6,18 @@
 /** Timeout for i2c communication with esp32 */
 unsigned int g_controller_i2c_timeout = 10000;
 
+/**
+ * @brief Sends a WiFi command and receives the response
+ *
+ * The command is encoded before the response is decoded, so @p output can
+ * point to the same struct as @p input to save stack space.
+ *
+ * @param input Command to send
+ * @param output Response from the esp32
+ *
+ * @return CONTROLLER_ERROR if the response could not be decoded, otherwise see
+ * ControllerStatus
+ */
 ControllerStatus WiFiCommandTransaction(const WiFiCommand *input,
                                         WiFiCommand *output) {
   // get reference to tx and rx buffers
@@ -28,11 +40,9 @@ ControllerStatus WiFiCommandTransaction(const WiFiCommand *input,
   }
 
   // decode command
-  Esp32Command cmd = Esp32Command_init_default;
-  cmd = DecodeEsp32Command(rx->data, rx->len);
-
-  // copy output data
-  memcpy(output, &cmd.command.wifi_command, sizeof(WiFiCommand));
+  if (DecodeWiFiCommand(rx->data, rx->len, output) != 0) {
+    return CONTROLLER_ERROR;
+  }
 
   return CONTROLLER_SUCCESS;
 }
@@ -43,10 +53,7 @@ bool ControllerWiFiConnect(const char *ssid, const char *passwd) {
   wifi_cmd.type = WiFiCommand_Type_CONNECT;
   strncpy(wifi_cmd.ssid, ssid, sizeof(wifi_cmd.ssid));
   strncpy(wifi_cmd.passwd, passwd, sizeof(wifi_cmd.passwd));
-
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  if (WiFiCommandTransaction(&wifi_cmd, &resp) != CONTROLLER_SUCCESS) {
+  if (WiFiCommandTransaction(&wifi_cmd, &wifi_cmd) != CONTROLLER_SUCCESS) {
     return false;
   }
 
@@ -56,10 +63,7 @@ bool ControllerWiFiConnect(const char *ssid, const char *passwd) {
 bool ControllerWiFiDisconnect(void) {
   WiFiCommand wifi_cmd = WiFiCommand_init_zero;
   wifi_cmd.type = WiFiCommand_Type_DISCONNECT;
-
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  if (WiFiCommandTransaction(&wifi_cmd, &resp) != CONTROLLER_SUCCESS) {
+  if (WiFiCommandTransaction(&wifi_cmd, &wifi_cmd) != CONTROLLER_SUCCESS) {
     return false;
   }
 
@@ -69,21 +73,15 @@ bool ControllerWiFiDisconnect(void) {
 ControllerWiFiStatus ControllerWiFiCheckWiFi(void) {
   WiFiCommand wifi_cmd = WiFiCommand_init_zero;
   wifi_cmd.type = WiFiCommand_Type_CHECK_WIFI;
+  WiFiCommandTransaction(&wifi_cmd, &wifi_cmd);
 
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  WiFiCommandTransaction(&wifi_cmd, &resp);
-
-  return resp.rc;
+  return wifi_cmd.rc;
 }
 
 bool ControllerWiFiNtpSync(void) {
   WiFiCommand wifi_cmd = WiFiCommand_init_zero;
   wifi_cmd.type = WiFiCommand_Type_NTP_SYNC;
-
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  if (WiFiCommandTransaction(&wifi_cmd, &resp) != CONTROLLER_SUCCESS) {
+  if (WiFiCommandTransaction(&wifi_cmd, &wifi_cmd) != CONTROLLER_SUCCESS) {
     return false;
   }
 
@@ -93,22 +91,16 @@ bool ControllerWiFiNtpSync(void) {
 uint32_t ControllerWiFiTime(void) {
   WiFiCommand wifi_cmd = WiFiCommand_init_zero;
   wifi_cmd.type = WiFiCommand_Type_TIME;
+  WiFiCommandTransaction(&wifi_cmd, &wifi_cmd);
 
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  WiFiCommandTransaction(&wifi_cmd, &resp);
-
-  return resp.ts;
+  return wifi_cmd.ts;
 }
 
 bool ControllerWiFiCheckApi(const char *url) {
   WiFiCommand wifi_cmd = WiFiCommand_init_zero;
   wifi_cmd.type = WiFiCommand_Type_CHECK_API;
   strncpy(wifi_cmd.url, url, sizeof(wifi_cmd.url));
-
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  if (WiFiCommandTransaction(&wifi_cmd, &resp) != CONTROLLER_SUCCESS) {
+  if (WiFiCommandTransaction(&wifi_cmd, &wifi_cmd) != CONTROLLER_SUCCESS) {
     return false;
   }
 
@@ -122,10 +114,7 @@ bool ControllerWiFiPost(const uint8_t *data, size_t data_len) {
   if (data_len > 0) {
     memcpy(wifi_cmd.resp.bytes, data, data_len);
   }
-
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  if (WiFiCommandTransaction(&wifi_cmd, &resp) != CONTROLLER_SUCCESS) {
+  if (WiFiCommandTransaction(&wifi_cmd, &wifi_cmd) != CONTROLLER_SUCCESS) {
     return false;
   }
 
@@ -136,17 +125,14 @@ ControllerWiFiResponse ControllerWiFiCheckRequest(void) {
   WiFiCommand wifi_cmd = WiFiCommand_init_zero;
   wifi_cmd.type = WiFiCommand_Type_CHECK;
 
-  // naming here doesn't really make sense since resp has a resp field
-  WiFiCommand resp = WiFiCommand_init_zero;
-
-  WiFiCommandTransaction(&wifi_cmd, &resp);
+  WiFiCommandTransaction(&wifi_cmd, &wifi_cmd);
 
   // copy the response
   ControllerWiFiResponse http_resp = {};
-  http_resp.http_code = resp.rc;
-  http_resp.size = resp.resp.size;
+  http_resp.http_code = wifi_cmd.rc;
+  http_resp.size = wifi_cmd.resp.size;
   if (http_resp.size > 0) {
-    memcpy(http_resp.bytes, resp.resp.bytes, http_resp.size);
+    memcpy(http_resp.bytes, wifi_cmd.resp.bytes, http_resp.size);
   }
 
   // return timestamp
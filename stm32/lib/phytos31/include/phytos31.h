@@ -74,9 +74,12 @@ phytos_measurments Phytos31GetMeasurment(void);
  *
  * @note Implemented for the sensors library
  *
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
+ *
  * @see SensorsPrototypeMeasure
  */
-size_t Phytos31_measure(uint8_t *data);
+bool Phytos31_measure(pb_ostream_t *stream);
 
 /**
  * @}
@@ -0,0 +1,117 @@
+/**
+ * @file schedule.h
+ * @author John Madden <jmadden173@pm.me>
+ * @brief Deadline ordered schedule of periodic tasks
+ * @date 2026-10-16
+ */
+
+#ifndef LIB_SCHEDULE_INCLUDE_SCHEDULE_H_
+#define LIB_SCHEDULE_INCLUDE_SCHEDULE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @ingroup stm32
+ * @defgroup schedule Schedule
+ * @brief Deadline ordered schedule of periodic tasks
+ *
+ * Tasks are kept in a binary min-heap ordered by their next deadline, so the
+ * earliest deadline is found in constant time and a single timer can be armed
+ * for it. Tasks with the same deadline are ordered by id. All tasks that are
+ * due at a time are popped together, coalescing them into a single wake-up.
+ *
+ * Deadlines are in ms of a free running 32-bit clock, such as
+ * UTIL_TIMER_GetCurrentTime(), and are compared relative to each other so the
+ * clock may wrap. Periods must be less than 2^31 ms.
+ *
+ * A task that is due is rescheduled one period after its deadline. Periods
+ * that were missed entirely, such as during a long measurement, are skipped
+ * instead of run back to back.
+ *
+ * @{
+ */
+
+#ifndef SCHEDULE_MAX_ENTRIES
+/** Maximum number of tasks */
+#define SCHEDULE_MAX_ENTRIES 32
+#endif /* SCHEDULE_MAX_ENTRIES */
+
+/**
+ * @brief Scheduled task
+ */
+typedef struct {
+  /** Next deadline in ms */
+  uint32_t deadline;
+  /** Period in ms */
+  uint32_t period;
+  /** Id of the task */
+  uint8_t id;
+} ScheduleEntry;
+
+/**
+ * @brief Schedule of tasks
+ */
+typedef struct {
+  /** Min-heap of tasks ordered by deadline */
+  ScheduleEntry heap[SCHEDULE_MAX_ENTRIES];
+  /** Number of tasks */
+  size_t len;
+} Schedule;
+
+/**
+ * @brief Removes all tasks
+ *
+ * @param schedule Schedule
+ */
+void ScheduleInit(Schedule *schedule);
+
+/**
+ * @brief Adds a task
+ *
+ * @param schedule Schedule
+ * @param id Id of the task, returned by SchedulePopDue()
+ * @param deadline First deadline in ms
+ * @param period Period in ms
+ * @return 0 on success, -1 if the schedule is full or the period is zero
+ */
+int ScheduleAdd(Schedule *schedule, uint8_t id, uint32_t deadline,
+                uint32_t period);
+
+/**
+ * @brief Gets the earliest deadline
+ *
+ * @param schedule Schedule
+ * @param deadline Earliest deadline in ms
+ * @return true on success, false if the schedule is empty
+ */
+bool ScheduleNext(const Schedule *schedule, uint32_t *deadline);
+
+/**
+ * @brief Pops the tasks that are due and reschedules them
+ *
+ * Each task is returned at most once per call.
+ *
+ * @param schedule Schedule
+ * @param now Current time in ms
+ * @param ids Ids of the due tasks in deadline order
+ * @param max Size of @p ids
+ * @return Number of due tasks in @p ids
+ */
+size_t SchedulePopDue(Schedule *schedule, uint32_t now, uint8_t *ids,
+                      size_t max);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIB_SCHEDULE_INCLUDE_SCHEDULE_H_
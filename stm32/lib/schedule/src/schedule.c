@@ -0,0 +1,113 @@
+/**
+ * @file schedule.c
+ * @author John Madden <jmadden173@pm.me>
+ * @brief See schedule.h
+ * @date 2026-10-16
+ */
+
+#include "schedule.h"
+
+/**
+ * @brief Checks if a task runs before another
+ *
+ * @param a Task
+ * @param b Other task
+ * @return true if @p a runs first
+ */
+static bool ScheduleBefore(const ScheduleEntry *a, const ScheduleEntry *b) {
+  // relative to each other so the clock may wrap
+  const int32_t diff = (int32_t)(a->deadline - b->deadline);
+  return diff < 0 || (diff == 0 && a->id < b->id);
+}
+
+/**
+ * @brief Moves a task towards the root until the heap is ordered
+ *
+ * @param schedule Schedule
+ * @param i Position of the task
+ */
+static void ScheduleSiftUp(Schedule *schedule, size_t i) {
+  ScheduleEntry entry = schedule->heap[i];
+  while (i > 0) {
+    const size_t parent = (i - 1) / 2;
+    if (!ScheduleBefore(&entry, &schedule->heap[parent])) {
+      break;
+    }
+    schedule->heap[i] = schedule->heap[parent];
+    i = parent;
+  }
+  schedule->heap[i] = entry;
+}
+
+/**
+ * @brief Moves a task towards the leaves until the heap is ordered
+ *
+ * @param schedule Schedule
+ * @param i Position of the task
+ */
+static void ScheduleSiftDown(Schedule *schedule, size_t i) {
+  ScheduleEntry entry = schedule->heap[i];
+  for (;;) {
+    size_t child = 2 * i + 1;
+    if (child >= schedule->len) {
+      break;
+    }
+    if (child + 1 < schedule->len &&
+        ScheduleBefore(&schedule->heap[child + 1], &schedule->heap[child])) {
+      ++child;
+    }
+    if (!ScheduleBefore(&schedule->heap[child], &entry)) {
+      break;
+    }
+    schedule->heap[i] = schedule->heap[child];
+    i = child;
+  }
+  schedule->heap[i] = entry;
+}
+
+void ScheduleInit(Schedule *schedule) { schedule->len = 0; }
+
+int ScheduleAdd(Schedule *schedule, uint8_t id, uint32_t deadline,
+                uint32_t period) {
+  if (schedule->len >= SCHEDULE_MAX_ENTRIES || period == 0) {
+    return -1;
+  }
+
+  ScheduleEntry *entry = &schedule->heap[schedule->len];
+  entry->deadline = deadline;
+  entry->period = period;
+  entry->id = id;
+  ScheduleSiftUp(schedule, schedule->len++);
+
+  return 0;
+}
+
+bool ScheduleNext(const Schedule *schedule, uint32_t *deadline) {
+  if (schedule->len == 0) {
+    return false;
+  }
+
+  *deadline = schedule->heap[0].deadline;
+  return true;
+}
+
+size_t SchedulePopDue(Schedule *schedule, uint32_t now, uint8_t *ids,
+                      size_t max) {
+  size_t count = 0;
+
+  while (schedule->len > 0 && count < max) {
+    ScheduleEntry *entry = &schedule->heap[0];
+    const uint32_t late = now - entry->deadline;
+    if ((int32_t)late < 0) {
+      break;
+    }
+
+    ids[count++] = entry->id;
+
+    // next deadline after now, skipping missed periods
+    entry->deadline += entry->period * (late / entry->period + 1);
+    ScheduleSiftDown(schedule, 0);
+  }
+
+  return count;
+}
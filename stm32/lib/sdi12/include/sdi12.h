@@ -34,6 +34,14 @@ extern "C" {
  *
  * This library is designed to read measurements from SDI-12 sensors.
  *
+ * SDI12GetMeasurment() blocks until the measurement is received. The
+ * SDI12MeasureStart() and SDI12MeasurePoll() pair reads the same measurement
+ * as a state machine instead, so the caller can sleep or serve other sensors
+ * while the sensor converts. Responses are collected from the receive FIFO of
+ * the uart when polled, which holds 8 characters or 80 ms at 1200 baud. STOP
+ * mode is disabled while the bus is in use since the uart is not clocked in
+ * STOP mode.
+ *
  * Protocol Specification: https://www.sdi-12.org/
  * Implemented hardware interface: https://www.osti.gov/servlets/purl/1214143
  *
@@ -58,6 +66,54 @@ typedef struct {
   uint8_t NumValues;
 } SDI12_Measure_TypeDef;
 
+/** Time between polls of an asynchronous measurement in ms */
+#define SDI12_POLL_INTERVAL 20
+
+/** Time of the break and marking that wake sensors in ms */
+#define SDI12_WAKE_DELAY 25
+
+/** Size of the response buffer, including <CR><LF> and terminator */
+#define SDI12_RESPONSE_SIZE 40
+
+/** Steps of an asynchronous measurement */
+typedef enum {
+  SDI12_MEASURE_IDLE,
+  /** Waiting for another measurement to release the bus */
+  SDI12_MEASURE_BUS,
+  /** Waking sensors before requesting a measurement */
+  SDI12_MEASURE_REQUEST,
+  /** Waiting for the response to the measurement request */
+  SDI12_MEASURE_RESPONSE,
+  /** Waiting for the service request */
+  SDI12_MEASURE_SERVICE,
+  /** Waking sensors before requesting the data */
+  SDI12_MEASURE_DATA_REQUEST,
+  /** Waiting for the data */
+  SDI12_MEASURE_DATA,
+  /** Data is in the response buffer */
+  SDI12_MEASURE_DONE,
+} SDI12MeasureState;
+
+/** Asynchronous measurement */
+typedef struct {
+  /** Current step */
+  SDI12MeasureState state;
+  /** Status of the last failed step */
+  SDI12Status status;
+  /** Address of the sensor */
+  char addr;
+  /** Timeout for each response in ms */
+  uint16_t timeout;
+  /** Time the current response times out, from HAL_GetTick() */
+  uint32_t deadline;
+  /** Response to the measurement request */
+  SDI12_Measure_TypeDef info;
+  /** Received response, the data without <CR><LF> once done */
+  char buffer[SDI12_RESPONSE_SIZE];
+  /** Number of characters in buffer */
+  uint8_t len;
+} SDI12Measure;
+
 /**
 ******************************************************************************
 * @brief    Wake all sensors on the data line.
@@ -108,6 +164,30 @@ SDI12Status SDI12GetMeasurment(uint8_t addr,
                                SDI12_Measure_TypeDef *measurment_info,
                                char *measurment_data, uint16_t timeoutMillis);
 
+/**
+ * @brief Starts an asynchronous measurement
+ *
+ * Measurements of different sensors wait for each other to release the bus.
+ *
+ * @param meas Measurement state, kept until the measurement is done
+ * @param addr Address of the sensor
+ * @param timeoutMillis Timeout for each response in milliseconds
+ * @return Time until SDI12MeasurePoll() should be called in ms
+ */
+int SDI12MeasureStart(SDI12Measure *meas, char addr, uint16_t timeoutMillis);
+
+/**
+ * @brief Advances an asynchronous measurement
+ *
+ * May be called early, the measurement only advances once the sensor has
+ * responded.
+ *
+ * @param meas Measurement state
+ * @return 0 once the data is in meas->buffer, time until the next poll in ms
+ * or -1 on error with the status in meas->status
+ */
+int SDI12MeasurePoll(SDI12Measure *meas);
+
 /**
  * @}
  */
@@ -10,6 +10,8 @@
 
 #include <sdi12.h>
 
+#include "pb_encode.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -67,13 +69,41 @@ SDI12Status Teros12GetMeasurement(char addr, Teros12Data *data);
  * Measures a Teros12 at address 0 and encodes it into a serialized
  * measurement.
  *
- * @param data Buffer to store measurement
- * @return Length of measurement
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
  *
  * @see SensorsPrototypeMeasure
  *
  */
-size_t Teros12Measure(uint8_t *data);
+bool Teros12Measure(pb_ostream_t *stream);
+
+/**
+ * @brief Starts an asynchronous measurement of a Teros12 at address 0
+ *
+ * @return Time until Teros12MeasurePoll() should be called in ms
+ *
+ * @see SensorsPrototypeStart
+ */
+int Teros12MeasureStart(void);
+
+/**
+ * @brief Advances the asynchronous measurement
+ *
+ * @return 0 when done, time until the next poll in ms or -1 on error
+ *
+ * @see SensorsPrototypePoll
+ */
+int Teros12MeasurePoll(void);
+
+/**
+ * @brief Encodes the asynchronous measurement into a serialized measurement
+ *
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
+ *
+ * @see SensorsPrototypeMeasure
+ */
+bool Teros12MeasureCollect(pb_ostream_t *stream);
 
 /**
  * @}
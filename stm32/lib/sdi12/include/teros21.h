@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 
+#include "pb_encode.h"
 #include "sdi12.h"
 
 #ifdef __cplusplus
@@ -58,13 +59,41 @@ SDI12Status Teros21GetMeasurement(char addr, Teros21Data *data);
  * Measures a Teros21 at address 0 and encodes it into a serialized
  * measurement.
  *
- * @param data Buffer to store measurement
- * @return Length of measurement
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
  *
  * @see SensorsPrototypeMeasure
  *
  */
-size_t Teros21Measure(uint8_t *data);
+bool Teros21Measure(pb_ostream_t *stream);
+
+/**
+ * @brief Starts an asynchronous measurement of a Teros21 at address 0
+ *
+ * @return Time until Teros21MeasurePoll() should be called in ms
+ *
+ * @see SensorsPrototypeStart
+ */
+int Teros21MeasureStart(void);
+
+/**
+ * @brief Advances the asynchronous measurement
+ *
+ * @return 0 when done, time until the next poll in ms or -1 on error
+ *
+ * @see SensorsPrototypePoll
+ */
+int Teros21MeasurePoll(void);
+
+/**
+ * @brief Encodes the asynchronous measurement into a serialized measurement
+ *
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
+ *
+ * @see SensorsPrototypeMeasure
+ */
+bool Teros21MeasureCollect(pb_ostream_t *stream);
 
 /**
  * @}
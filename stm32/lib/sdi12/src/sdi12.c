@@ -18,6 +18,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "stm32_lpm.h"
+#include "utilities_def.h"
+
 static const uint16_t REQUEST_MEASURMENT_RESPONSE_SIZE = 7;
 static const uint16_t SERVICE_REQUEST_SIZE = 3;
 static const uint16_t MEASURMENT_DATA_SIZE = 30;
@@ -30,9 +33,58 @@ SDI12Status ParseMeasurementResponse(const char *responseBuffer, char addr,
 /* Helper function to parse a sensor's service request */
 SDI12Status ParseServiceRequest(const char *requestBuffer, char addr);
 
-void SDI12WakeSensors(void) {
+/** Asynchronous measurement using the bus, NULL if free */
+static SDI12Measure *bus_owner = NULL;
+
+/**
+ * @brief Sends a break followed by marking to wake sensors
+ *
+ * The break is sent in the background, sensors are awake after
+ * SDI12_WAKE_DELAY ms.
+ */
+static void SDI12Break(void) {
   HAL_LIN_SendBreak(&huart2);                            // Send a break
   HAL_GPIO_WritePin(GPIOC, GPIO_PIN_1, GPIO_PIN_RESET);  // Send the marking
+}
+
+/**
+ * @brief Sends a command of a measurement and listens for the response
+ *
+ * Blocks for the transmission of the few characters of the command.
+ *
+ * @param meas Measurement state
+ * @param command Command without the address
+ */
+static void SDI12Request(SDI12Measure *meas, const char *command);
+
+/**
+ * @brief Moves received characters from the receive FIFO to the response
+ *
+ * @param meas Measurement state
+ * @return true once the response ends with <CR><LF>
+ */
+static bool SDI12Receive(SDI12Measure *meas);
+
+/**
+ * @brief Waits for the rest of a response
+ *
+ * @param meas Measurement state
+ * @return Time until the next poll in ms, -1 on timeout
+ */
+static int SDI12Wait(SDI12Measure *meas);
+
+/**
+ * @brief Ends a measurement, releasing the bus
+ *
+ * @param meas Measurement state
+ * @param state Final state
+ * @param status Final status
+ */
+static void SDI12Release(SDI12Measure *meas, SDI12MeasureState state,
+                         SDI12Status status);
+
+void SDI12WakeSensors(void) {
+  SDI12Break();
   // HAL_Delay(20); // Need an extra 10ms to account for the fact
   // that HAL_LIN_SendBreak is nonblocking
   for (int i = 0; i <= 40000; i++) {
@@ -185,3 +237,155 @@ SDI12Status SDI12GetMeasurment(uint8_t addr,
   // Or maybe slightly smaller, but any greater causes the program to hang
   return ret;
 }
+
+int SDI12MeasureStart(SDI12Measure *meas, char addr, uint16_t timeoutMillis) {
+  // restarting a measurement in progress
+  if (bus_owner == meas) {
+    SDI12Release(meas, SDI12_MEASURE_IDLE, SDI12_OK);
+  }
+
+  meas->addr = addr;
+  meas->timeout = timeoutMillis;
+  meas->status = SDI12_OK;
+  meas->len = 0;
+  meas->state = SDI12_MEASURE_BUS;
+
+  return SDI12MeasurePoll(meas);
+}
+
+int SDI12MeasurePoll(SDI12Measure *meas) {
+  SDI12Status status = SDI12_OK;
+
+  switch (meas->state) {
+    case SDI12_MEASURE_BUS:
+      if (bus_owner != NULL) {
+        return SDI12_POLL_INTERVAL;
+      }
+      bus_owner = meas;
+
+      // uart is not clocked in STOP mode
+      UTIL_LPM_SetStopMode((1 << CFG_LPM_SDI12_Id), UTIL_LPM_DISABLE);
+
+      SDI12Break();
+      meas->state = SDI12_MEASURE_REQUEST;
+      return SDI12_WAKE_DELAY;
+
+    case SDI12_MEASURE_REQUEST:
+      SDI12Request(meas, "M!");
+      meas->state = SDI12_MEASURE_RESPONSE;
+      return SDI12_POLL_INTERVAL;
+
+    case SDI12_MEASURE_RESPONSE:
+      if (!SDI12Receive(meas)) {
+        return SDI12Wait(meas);
+      }
+
+      status = ParseMeasurementResponse(meas->buffer, meas->addr, &meas->info);
+      if (status != SDI12_OK) {
+        SDI12Release(meas, SDI12_MEASURE_IDLE, status);
+        return -1;
+      }
+
+      // data is ready now
+      if (meas->info.Time == 0) {
+        SDI12Break();
+        meas->state = SDI12_MEASURE_DATA_REQUEST;
+        return SDI12_WAKE_DELAY;
+      }
+
+      // service request is sent within Time seconds
+      meas->len = 0;
+      meas->deadline = HAL_GetTick() + meas->info.Time * 1000 + meas->timeout;
+      meas->state = SDI12_MEASURE_SERVICE;
+      return SDI12_POLL_INTERVAL;
+
+    case SDI12_MEASURE_SERVICE:
+      if (!SDI12Receive(meas)) {
+        return SDI12Wait(meas);
+      }
+
+      status = ParseServiceRequest(meas->buffer, meas->info.Address);
+      if (status != SDI12_OK) {
+        SDI12Release(meas, SDI12_MEASURE_IDLE, status);
+        return -1;
+      }
+
+      SDI12Break();
+      meas->state = SDI12_MEASURE_DATA_REQUEST;
+      return SDI12_WAKE_DELAY;
+
+    case SDI12_MEASURE_DATA_REQUEST:
+      SDI12Request(meas, "D0!");
+      meas->state = SDI12_MEASURE_DATA;
+      return SDI12_POLL_INTERVAL;
+
+    case SDI12_MEASURE_DATA:
+      if (!SDI12Receive(meas)) {
+        return SDI12Wait(meas);
+      }
+
+      // remove trailing <CR><LF>
+      meas->len -= 2;
+      meas->buffer[meas->len] = '\0';
+
+      SDI12Release(meas, SDI12_MEASURE_DONE, SDI12_OK);
+      return 0;
+
+    case SDI12_MEASURE_DONE:
+      return 0;
+
+    default:
+      return -1;
+  }
+}
+
+static void SDI12Request(SDI12Measure *meas, const char *command) {
+  char buffer[5];
+  uint8_t size = snprintf(buffer, sizeof(buffer), "%c%s", meas->addr, command);
+
+  HAL_UART_Transmit(&huart2, (const uint8_t *)buffer, size,
+                    SEND_COMMAND_TIMEOUT);
+  HAL_GPIO_WritePin(GPIOC, GPIO_PIN_1, GPIO_PIN_SET);  // Set to RX mode
+
+  // discard anything received before the response
+  __HAL_UART_SEND_REQ(&huart2, UART_RXDATA_FLUSH_REQUEST);
+  __HAL_UART_CLEAR_OREFLAG(&huart2);
+
+  meas->len = 0;
+  meas->deadline = HAL_GetTick() + meas->timeout;
+}
+
+static bool SDI12Receive(SDI12Measure *meas) {
+  while (__HAL_UART_GET_FLAG(&huart2, UART_FLAG_RXNE)) {
+    char c = (char)(huart2.Instance->RDR & 0xFF);
+    // keeps room for the terminator, the end of long responses is dropped
+    if (meas->len < sizeof(meas->buffer) - 1) {
+      meas->buffer[meas->len++] = c;
+    }
+  }
+  __HAL_UART_CLEAR_OREFLAG(&huart2);
+
+  meas->buffer[meas->len] = '\0';
+  return (meas->len >= 2) && (meas->buffer[meas->len - 2] == '\r') &&
+         (meas->buffer[meas->len - 1] == '\n');
+}
+
+static int SDI12Wait(SDI12Measure *meas) {
+  if ((int32_t)(HAL_GetTick() - meas->deadline) >= 0) {
+    SDI12Release(meas, SDI12_MEASURE_IDLE, SDI12_TIMEOUT_ON_READ);
+    return -1;
+  }
+
+  return SDI12_POLL_INTERVAL;
+}
+
+static void SDI12Release(SDI12Measure *meas, SDI12MeasureState state,
+                         SDI12Status status) {
+  meas->state = state;
+  meas->status = status;
+
+  if (bus_owner == meas) {
+    bus_owner = NULL;
+    UTIL_LPM_SetStopMode((1 << CFG_LPM_SDI12_Id), UTIL_LPM_ENABLE);
+  }
+}
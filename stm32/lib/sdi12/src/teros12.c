@@ -3,6 +3,23 @@
 #include "stm32_systime.h"
 #include "userConfig.h"
 
+/** Asynchronous measurement in progress */
+static SDI12Measure async_meas;
+
+/** Timestamp of the asynchronous measurement */
+static uint32_t async_ts = 0;
+
+/**
+ * @brief Calibrates and encodes a measurement
+ *
+ * @param ts Timestamp of the measurement
+ * @param data Parsed measurement
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
+ */
+static bool Teros12Encode(uint32_t ts, const Teros12Data *data,
+                          pb_ostream_t *stream);
+
 SDI12Status Teros12ParseMeasurement(const char *buffer, Teros12Data *data) {
   // parse string and check number of characters parsed
   int rc = sscanf(buffer, "%1c+%f%f+%d", &data->addr, &data->vwc, &data->temp,
@@ -41,25 +58,47 @@ SDI12Status Teros12GetMeasurement(char addr, Teros12Data *data) {
   return status;
 }
 
-size_t Teros12Measure(uint8_t *data) {
+bool Teros12Measure(pb_ostream_t *stream) {
   // get timestamp
   SysTime_t ts = SysTimeGet();
 
   Teros12Data sens_data = {};
   SDI12Status status = Teros12GetMeasurement('0', &sens_data);
   if (status != SDI12_OK) {
-    return -1;
+    return false;
   }
 
+  return Teros12Encode(ts.Seconds, &sens_data, stream);
+}
+
+int Teros12MeasureStart(void) {
+  // get timestamp
+  async_ts = SysTimeGet().Seconds;
+
+  return SDI12MeasureStart(&async_meas, '0', 1000);
+}
+
+int Teros12MeasurePoll(void) { return SDI12MeasurePoll(&async_meas); }
+
+bool Teros12MeasureCollect(pb_ostream_t *stream) {
+  Teros12Data sens_data = {};
+  SDI12Status status = Teros12ParseMeasurement(async_meas.buffer, &sens_data);
+  if (status != SDI12_OK) {
+    return false;
+  }
+
+  return Teros12Encode(async_ts, &sens_data, stream);
+}
+
+static bool Teros12Encode(uint32_t ts, const Teros12Data *data,
+                          pb_ostream_t *stream) {
   const UserConfiguration *cfg = UserConfigGet();
 
   // calibration equation for mineral soils from Teros12 user manual
   // https://publications.metergroup.com/Manuals/20587_TEROS11-12_Manual_Web.pdf?_gl=1*174xdyp*_gcl_au*MTIxODkwMzcuMTc0MTIwMjU3Nw..
-  float vwc_adj = (3.879e-4 * sens_data.vwc) - 0.6956;
-
-  size_t data_len = EncodeTeros12Measurement(
-      ts.Seconds, cfg->logger_id, cfg->cell_id, sens_data.vwc, vwc_adj,
-      sens_data.temp, sens_data.ec, data);
+  float vwc_adj = (3.879e-4 * data->vwc) - 0.6956;
 
-  return data_len;
+  return EncodeTeros12MeasurementStream(ts, cfg->logger_id, cfg->cell_id,
+                                        data->vwc, vwc_adj, data->temp,
+                                        data->ec, stream);
 }
@@ -3,6 +3,23 @@
 #include "stm32_systime.h"
 #include "userConfig.h"
 
+/** Asynchronous measurement in progress */
+static SDI12Measure async_meas;
+
+/** Timestamp of the asynchronous measurement */
+static uint32_t async_ts = 0;
+
+/**
+ * @brief Encodes a measurement
+ *
+ * @param ts Timestamp of the measurement
+ * @param data Parsed measurement
+ * @param stream Output stream for the serialized measurement
+ * @return true on success, false on error
+ */
+static bool Teros21Encode(uint32_t ts, const Teros21Data *data,
+                          pb_ostream_t *stream);
+
 SDI12Status Teros21ParseMeasurement(const char *buffer, Teros21Data *data) {
   char addr = 0;
   float matric_pot = 0.;
@@ -47,21 +64,42 @@ SDI12Status Teros21GetMeasurement(char addr, Teros21Data *data) {
   return status;
 }
 
-size_t Teros21Measure(uint8_t *data) {
+bool Teros21Measure(pb_ostream_t *stream) {
   // get timestamp
   SysTime_t ts = SysTimeGet();
 
   Teros21Data sens_data = {};
   SDI12Status status = Teros21GetMeasurement('0', &sens_data);
   if (status != SDI12_OK) {
-    return -1;
+    return false;
   }
 
-  const UserConfiguration *cfg = UserConfigGet();
+  return Teros21Encode(ts.Seconds, &sens_data, stream);
+}
+
+int Teros21MeasureStart(void) {
+  // get timestamp
+  async_ts = SysTimeGet().Seconds;
+
+  return SDI12MeasureStart(&async_meas, '0', 1000);
+}
 
-  size_t data_len =
-      EncodeTeros21Measurement(ts.Seconds, cfg->logger_id, cfg->cell_id,
-                               sens_data.matric_pot, sens_data.temp, data);
+int Teros21MeasurePoll(void) { return SDI12MeasurePoll(&async_meas); }
+
+bool Teros21MeasureCollect(pb_ostream_t *stream) {
+  Teros21Data sens_data = {};
+  SDI12Status status = Teros21ParseMeasurement(async_meas.buffer, &sens_data);
+  if (status != SDI12_OK) {
+    return false;
+  }
+
+  return Teros21Encode(async_ts, &sens_data, stream);
+}
+
+static bool Teros21Encode(uint32_t ts, const Teros21Data *data,
+                          pb_ostream_t *stream) {
+  const UserConfiguration *cfg = UserConfigGet();
 
-  return data_len;
+  return EncodeTeros21MeasurementStream(ts, cfg->logger_id, cfg->cell_id,
+                                        data->matric_pot, data->temp, stream);
 }
@@ -10,6 +10,7 @@
 
 #include "fifo.h"
 #include "lora_app.h"
+#include "pb_encode.h"
 #include "stm32_seq.h"
 #include "stm32_timer.h"
 #include "sys_app.h"
@@ -25,8 +26,23 @@ extern "C" {
  * and uploading them to the server
  *
  * Provides an interface for querying sensors and adding the measurements to the
- * transmit buffer. Functions to query sensors are registered and called on a
- * interval that is global to all sensors.
+ * transmit buffer. Functions to query sensors are registered with their own
+ * period and phase, defaulting to the upload interval of the user
+ * configuration.
+ *
+ * The deadlines of the sensors are kept in a min-heap (see schedule.h) that
+ * drives a single one-shot timer armed for the earliest deadline. Sensors that
+ * are due at the same time are measured in one wake-up, so sensors sharing a
+ * period and phase are measured together as before.
+ *
+ * Sensors are either synchronous, measured by a single blocking call, or
+ * asynchronous, added with SensorsAddAsync(). Asynchronous sensors are state
+ * machines that start a conversion, are polled after the time they request and
+ * are collected once done. The same timer drives the polls from the
+ * sequencer, so sensors on different buses convert concurrently and the MCU
+ * sleeps in between. Drivers waiting on an interrupt can call SensorsWake() to
+ * be polled early. Steps are deferred while the FRAM is transferring in the
+ * background since it shares the I2C bus.
  *
  * The library expects all initialization code for registered sensors to be
  * called before SensorsStart. The timer utility library (UTIL_TIMER_Init) and
@@ -37,6 +53,21 @@ extern "C" {
  * to be dynamically added or removed during firmware runtime. Also new sensors
  * will require updates to the firmware binaries.
  *
+ * Measurements are serialized directly into the staging ring of the FRAM
+ * buffer with FramPutStream(), without an intermediate buffer. Measurements
+ * of a cycle are written to FRAM together, at the latest SENSORS_FLUSH_DELAY
+ * ms after the last measurement in progress is done.
+ *
+ * With SENSORS_COMPRESS defined, measurements are instead compressed against
+ * the previous measurement of the same type with EncodeMeasurementDelta() and
+ * stored as FRAM_RECORD_DELTA records. Readers of the buffer decompress the
+ * records in order with their own MeasurementDelta state. A delta whose
+ * reference was evicted by FIFO_POLICY_DROP_OLD is dropped until the next
+ * keyframe of its type. With FIFO_POLICY_DECIMATE every measurement is stored
+ * as a keyframe, since decimation evicts records throughout the buffer. Paging
+ * is not supported, restored records are put behind newer ones, so the WiFi
+ * app does not spill to the sd card when compressing.
+ *
  * The measurement interval is determined by the user. This value should be an
  * order of magnitude greater than the upload frequency that is defined by
  * APP_TX_DUTY_CYCLE.
@@ -54,14 +85,45 @@ extern "C" {
 #define MEASUREMENT_PERIOD 15000
 #endif /* MEASUREMENT_PERIOD */
 
+#ifndef SENSORS_FLUSH_DELAY
+/** Time after measuring before staged measurements are written to FRAM */
+#define SENSORS_FLUSH_DELAY 1000
+#endif /* SENSORS_FLUSH_DELAY */
+
+#ifndef SENSORS_BUS_RETRY_DELAY
+/** Time a step is deferred while the FRAM holds the I2C bus in ms */
+#define SENSORS_BUS_RETRY_DELAY 2
+#endif /* SENSORS_BUS_RETRY_DELAY */
+
 /**
  * @brief Function prototype for measure functions
  *
- * @param data Location to store data
+ * The measurement is serialized into the stream, which refuses writes beyond
+ * Measurement_size bytes.
+ *
+ * @param stream Output stream for the serialized measurement
+ *
+ * @return true on success, false on error
+ */
+typedef bool (*SensorsPrototypeMeasure)(pb_ostream_t *stream);
+
+/**
+ * @brief Function prototype for starting asynchronous measurements
+ *
+ * @return Time until the measurement should be polled in ms, 0 if already done
+ * or -1 on error
+ */
+typedef int (*SensorsPrototypeStart)(void);
+
+/**
+ * @brief Function prototype for polling asynchronous measurements
+ *
+ * Must tolerate being called before the requested time, such as after
+ * SensorsWake().
  *
- * @return Number of bytes in data
+ * @return 0 once done, time until the next poll in ms or -1 on error
  */
-typedef size_t (*SensorsPrototypeMeasure)(uint8_t *data);
+typedef int (*SensorsPrototypePoll)(void);
 
 /**
  * @brief Registers the measurement task with the sequencer
@@ -84,11 +146,45 @@ void SensorsStop(void);
 /**
  * @brief Adds sensor call to measurement cycle
  *
+ * The sensor is first measured @p phase + @p period ms after SensorsStart(),
+ * then every @p period ms.
+ *
  * @param cb Callback to the measurement function
+ * @param period Measurement period in ms, 0 for the upload interval
+ * @param phase Delay of the first measurement in ms
  *
  * @return Index of callback in internal array, -1 indicates an error
  */
-int SensorsAdd(SensorsPrototypeMeasure cb);
+int SensorsAdd(SensorsPrototypeMeasure cb, uint32_t period, uint32_t phase);
+
+/**
+ * @brief Adds an asynchronous sensor to the measurement cycle
+ *
+ * On each deadline @p start is called, then @p poll until the measurement is
+ * done and @p collect serializes it. A deadline that passes while the
+ * previous measurement is in progress is skipped.
+ *
+ * @param start Starts a measurement
+ * @param poll Advances the measurement
+ * @param collect Serializes the collected measurement
+ * @param period Measurement period in ms, 0 for the upload interval
+ * @param phase Delay of the first measurement in ms
+ *
+ * @return Index of sensor in internal array, -1 indicates an error
+ *
+ * @see SensorsAdd
+ */
+int SensorsAddAsync(SensorsPrototypeStart start, SensorsPrototypePoll poll,
+                    SensorsPrototypeMeasure collect, uint32_t period,
+                    uint32_t phase);
+
+/**
+ * @brief Polls measurements in progress as soon as possible
+ *
+ * Can be called from interrupt context when an event a sensor waits on
+ * occurs.
+ */
+void SensorsWake(void);
 
 /**
  * @brief Function for adding static test measurements
@@ -98,7 +194,7 @@ int SensorsAdd(SensorsPrototypeMeasure cb);
  *
  * @see SensorsPrototypeMeasure
  */
-size_t SensorsMeasureTest(uint8_t *data);
+bool SensorsMeasureTest(pb_ostream_t *stream);
 
 /**
  * @}
@@ -31,29 +31,136 @@
 
 #include "sensors.h"
 
+#include "schedule.h"
+#include "soil_power_sensor.pb.h"
 #include "userConfig.h"
 
-/** Array for holding function callbacks */
-static SensorsPrototypeMeasure callback_arr[MAX_SENSORS];
+#ifdef SENSORS_COMPRESS
+#include "pb_decode.h"
+#include "transcoder.h"
+#endif /* SENSORS_COMPRESS */
 
-/** Length of @ref callback_arr */
-static unsigned int callback_arr_len = 0;
+#if MAX_SENSORS > SCHEDULE_MAX_ENTRIES
+#error "MAX_SENSORS exceeds SCHEDULE_MAX_ENTRIES"
+#endif
 
-static const uint8_t kBufferSize = LORAWAN_APP_DATA_BUFFER_MAX_SIZE;
+/** Steps of a measurement */
+typedef enum {
+  /** Waiting for the next deadline */
+  SENSORS_IDLE,
+  /** Deadline passed, waiting to start */
+  SENSORS_DUE,
+  /** Asynchronous measurement in progress, waiting to poll */
+  SENSORS_CONVERTING,
+} SensorsState;
 
-/** Periodic timer for querying sensors */
+/** Registered sensor */
+typedef struct {
+  /** Measures the sensor, or encodes the collected asynchronous measurement */
+  SensorsPrototypeMeasure measure;
+  /** Starts an asynchronous measurement, NULL for synchronous sensors */
+  SensorsPrototypeStart start;
+  /** Advances an asynchronous measurement */
+  SensorsPrototypePoll poll;
+  /** Measurement period in ms, 0 for the upload interval */
+  uint32_t period;
+  /** Delay of the first measurement in ms */
+  uint32_t phase;
+  /** Current step */
+  SensorsState state;
+  /** Time of the next step in ms */
+  uint32_t deadline;
+} SensorsEntry;
+
+/** Array for holding registered sensors */
+static SensorsEntry sensors_arr[MAX_SENSORS];
+
+/** Length of @ref sensors_arr */
+static unsigned int sensors_arr_len = 0;
+
+/** One-shot timer for the next deadline or poll */
 static UTIL_TIMER_Object_t MeasureTimer;
 
+/** Default measurement period in ms */
 static uint32_t measure_period = 0;
 
+/** Deadlines of the sensors, ids are indices of @ref sensors_arr */
+static Schedule sensors_schedule;
+
+/** Measurements are scheduled between SensorsStart() and SensorsStop() */
+static bool sensors_running = false;
+
+/** Set by SensorsWake() to poll measurements in progress early */
+static volatile bool sensors_woken = false;
+
+/** Measurements were stored since the last flush */
+static bool sensors_staged = false;
+
+/** One-shot timer for writing staged measurements to FRAM */
+static UTIL_TIMER_Object_t FlushTimer;
+
+/** Number of failed writes to FRAM */
+static volatile uint32_t store_failures = 0;
+
+/** Status of the last failed write to FRAM */
+static volatile FramStatus store_status = FRAM_OK;
+
+#ifdef SENSORS_COMPRESS
+/** Previous stored measurement of each type */
+static MeasurementDelta sensors_delta;
+#endif /* SENSORS_COMPRESS */
+
 /**
  * @brief Measures sensors and adds to tx buffer
  *
- * Loops through all added callbacks and calls the functions. The resulting
- * serialized data is added to the buffer.
+ * Starts the sensors that are due and reschedules them, then advances the
+ * measurements that are in progress. The resulting serialized data is added
+ * to the buffer.
  */
 void SensorsMeasure(void);
 
+/**
+ * @brief Runs the next step of a sensor
+ *
+ * Starts or polls the measurement, and stores it once done.
+ *
+ * @param entry Sensor in the SENSORS_DUE or SENSORS_CONVERTING state
+ */
+static void SensorsStep(SensorsEntry *entry);
+
+/**
+ * @brief Stores a measurement and logs failures
+ *
+ * @param entry Sensor with a measurement to store
+ */
+static void SensorsCollect(SensorsEntry *entry);
+
+/**
+ * @brief Arms the measure timer for the earliest deadline or poll
+ *
+ * Runs the SensorsMeasure task immediately if the time has passed.
+ *
+ * @param now Current time in ms
+ */
+static void SensorsArm(uint32_t now);
+
+/**
+ * @brief Calls a measure function with a stream of FramPutStream()
+ *
+ * @param stream Output stream at the write cursor of the FRAM buffer
+ * @param arg Pointer to the SensorsPrototypeMeasure to call
+ * @return Return value of the measure function
+ */
+static bool SensorsEncode(pb_ostream_t *stream, void *arg);
+
+/**
+ * @brief Stores the measurement of a measure function in the FRAM buffer
+ *
+ * @param cb Measure function
+ * @return Status of the write to the staging ring
+ */
+static FramStatus SensorsStore(SensorsPrototypeMeasure *cb);
+
 /**
  * @brief Runs the SensorsMeasure task
  *
@@ -61,82 +168,336 @@ void SensorsMeasure(void);
  */
 void SensorsRun(void);
 
+/**
+ * @brief Called on completion of writing staged measurements to FRAM
+ *
+ * Runs in interrupt context. Failures are reported by the
+ * SensorsStoredReport task.
+ *
+ * @param status Status of the write
+ */
+static void SensorsStored(FramStatus status);
+
+/**
+ * @brief Reports failed writes of measurements to FRAM
+ */
+static void SensorsStoredReport(void);
+
+/**
+ * @brief Runs the SensorsFlush task
+ *
+ * @param context Unused
+ */
+static void SensorsFlushRun(void *context);
+
+/**
+ * @brief Starts writing staged measurements to FRAM
+ */
+static void SensorsFlush(void);
+
 void SensorsInit(void) {
   // set upload interval
   const UserConfiguration *cfg = UserConfigGet();
   // convert to ms
   measure_period = cfg->Upload_interval * 1000;
 
+#ifdef SENSORS_COMPRESS
+  // first measurement of each type is a keyframe
+  MeasurementDeltaInit(&sensors_delta);
+#endif /* SENSORS_COMPRESS */
+
   // registers the task
   UTIL_SEQ_RegTask((1 << CFG_SEQ_Task_Measurement), UTIL_SEQ_RFU,
                    SensorsMeasure);
+  UTIL_SEQ_RegTask((1 << CFG_SEQ_Task_MeasurementStored), UTIL_SEQ_RFU,
+                   SensorsStoredReport);
+  UTIL_SEQ_RegTask((1 << CFG_SEQ_Task_MeasurementFlush), UTIL_SEQ_RFU,
+                   SensorsFlush);
+
+  // measurements are written in the background
+  FramSetFlushCallback(SensorsStored);
 
-  // create the run timer
-  UTIL_TIMER_Create(&MeasureTimer, measure_period, UTIL_TIMER_PERIODIC,
+  // create the run timer, period is set to the next deadline
+  UTIL_TIMER_Create(&MeasureTimer, measure_period, UTIL_TIMER_ONESHOT,
                     SensorsRun, NULL);
+
+  // create the flush timer
+  UTIL_TIMER_Create(&FlushTimer, SENSORS_FLUSH_DELAY, UTIL_TIMER_ONESHOT,
+                    SensorsFlushRun, NULL);
 }
 
 void SensorsStart(void) {
-  // start the timer
-  UTIL_TIMER_Start(&MeasureTimer);
+  // deadlines are relative to the start
+  const uint32_t now = UTIL_TIMER_GetCurrentTime();
+
+  ScheduleInit(&sensors_schedule);
+  for (unsigned int i = 0; i < sensors_arr_len; i++) {
+    const SensorsEntry *entry = &sensors_arr[i];
+    uint32_t period = entry->period ? entry->period : measure_period;
+    // first measurement is one period after the phase
+    if (ScheduleAdd(&sensors_schedule, i, now + entry->phase + period,
+                    period) != 0) {
+      APP_LOG(TS_OFF, VLEVEL_M, "Error: Sensor %u has no period!\r\n", i);
+    }
+  }
+
+  sensors_running = true;
+  SensorsArm(now);
 }
 
 void SensorsStop(void) {
+  // prevents a running measurement from scheduling the next one
+  sensors_running = false;
+
   // stop the timer
   UTIL_TIMER_Stop(&MeasureTimer);
+
+  // measurements in progress are finished
+  SensorsArm(UTIL_TIMER_GetCurrentTime());
+}
+
+int SensorsAdd(SensorsPrototypeMeasure cb, uint32_t period, uint32_t phase) {
+  return SensorsAddAsync(NULL, NULL, cb, period, phase);
 }
 
-int SensorsAdd(SensorsPrototypeMeasure cb) {
+int SensorsAddAsync(SensorsPrototypeStart start, SensorsPrototypePoll poll,
+                    SensorsPrototypeMeasure collect, uint32_t period,
+                    uint32_t phase) {
   // check for out of range error
-  if (callback_arr_len >= MAX_SENSORS) {
+  if (sensors_arr_len >= MAX_SENSORS) {
     APP_LOG(TS_OFF, VLEVEL_M, "Error: Too many sensors added!\r\n");
     return -1;
   }
 
-  // store callback in array
-  callback_arr[callback_arr_len] = cb;
+  // asynchronous sensors are polled until done
+  if (collect == NULL || (start != NULL && poll == NULL)) {
+    APP_LOG(TS_OFF, VLEVEL_M, "Error: Sensor missing functions!\r\n");
+    return -1;
+  }
+
+  // store sensor in array
+  SensorsEntry *entry = &sensors_arr[sensors_arr_len];
+  entry->measure = collect;
+  entry->start = start;
+  entry->poll = poll;
+  entry->period = period;
+  entry->phase = phase;
+  entry->state = SENSORS_IDLE;
 
   // return index and increment
-  return callback_arr_len++;
+  return sensors_arr_len++;
 }
 
+void SensorsWake(void) {
+  sensors_woken = true;
+  SensorsRun();
+}
+
+static bool SensorsEncode(pb_ostream_t *stream, void *arg) {
+  SensorsPrototypeMeasure cb = *(SensorsPrototypeMeasure *)arg;
+  return cb(stream);
+}
+
+#ifdef SENSORS_COMPRESS
+static FramStatus SensorsStore(SensorsPrototypeMeasure *cb) {
+  uint8_t buffer[Measurement_size];
+  pb_ostream_t ostream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+  if (!SensorsEncode(&ostream, cb)) {
+    return FRAM_ERROR;
+  }
+
+  // raw decode keeps the values of the double fields
+  Measurement meas = Measurement_init_zero;
+  pb_istream_t istream = pb_istream_from_buffer(buffer, ostream.bytes_written);
+  if (!pb_decode(&istream, Measurement_fields, &meas)) {
+    return FRAM_ERROR;
+  }
+
+  // decimation evicts records between the deltas and their references, so
+  // every measurement is stored in full
+  if (FramGetPolicy() == FIFO_POLICY_DECIMATE) {
+    MeasurementDeltaInit(&sensors_delta);
+  }
+
+  uint8_t delta[TRANSCODER_DELTA_MAX_SIZE];
+  size_t delta_len =
+      EncodeMeasurementDelta(&sensors_delta, &meas, delta, sizeof(delta));
+  if (delta_len == (size_t)-1) {
+    return FRAM_ERROR;
+  }
+
+  FramStatus status = FramPutRecord(FRAM_RECORD_DELTA, delta, delta_len);
+  if (status == FRAM_OK) {
+    MeasurementDeltaAdvance(&sensors_delta, delta, &meas);
+  }
+  return status;
+}
+#else
+static FramStatus SensorsStore(SensorsPrototypeMeasure *cb) {
+  // measurement is serialized straight into the tx buffer
+  return FramPutStream(FRAM_RECORD_MEASUREMENT, Measurement_size,
+                       SensorsEncode, cb);
+}
+#endif /* SENSORS_COMPRESS */
+
 void SensorsMeasure(void) {
-  // buffer to store measurements
-  uint8_t buffer[kBufferSize];
-  size_t buffer_len;
-
-  // loop over callbacks
-  for (int i = 0; i < callback_arr_len; i++) {
-    // call measurement function
-    buffer_len = callback_arr[i](buffer);
-    APP_LOG(TS_ON, VLEVEL_M, "Callback index: %d\r\n", i);
-    APP_LOG(TS_ON, VLEVEL_M, "Buffer length: %u\r\n", buffer_len);
-    APP_LOG(TS_ON, VLEVEL_M, "Buffer: ");
-    for (int j = 0; j < buffer_len; j++) {
-      APP_LOG(TS_OFF, VLEVEL_M, "%x", buffer[j]);
+  const uint32_t now = UTIL_TIMER_GetCurrentTime();
+
+  // sensors due at the same time are started in one wake-up
+  if (sensors_running) {
+    uint8_t due[MAX_SENSORS];
+    const size_t due_len =
+        SchedulePopDue(&sensors_schedule, now, due, MAX_SENSORS);
+
+    for (size_t i = 0; i < due_len; i++) {
+      SensorsEntry *entry = &sensors_arr[due[i]];
+      if (entry->state != SENSORS_IDLE) {
+        APP_LOG(TS_OFF, VLEVEL_M,
+                "Error: Sensor %d still measuring, skipped!\r\n", due[i]);
+        continue;
+      }
+
+      entry->state = SENSORS_DUE;
+      entry->deadline = now;
+    }
+  }
+
+  // sensors on different buses convert concurrently, each step is short
+  const bool woken = sensors_woken;
+  sensors_woken = false;
+  bool in_progress = false;
+  for (unsigned int i = 0; i < sensors_arr_len; i++) {
+    SensorsEntry *entry = &sensors_arr[i];
+    if (entry->state == SENSORS_IDLE) {
+      continue;
+    }
+
+    const uint32_t step_now = UTIL_TIMER_GetCurrentTime();
+    if (woken || (int32_t)(entry->deadline - step_now) <= 0) {
+      // background FRAM transfers hold the I2C bus
+      if (FramBusy()) {
+        entry->deadline = step_now + SENSORS_BUS_RETRY_DELAY;
+      } else {
+        APP_LOG(TS_ON, VLEVEL_M, "Callback index: %d\r\n", i);
+        SensorsStep(entry);
+      }
+    }
+
+    in_progress = in_progress || (entry->state != SENSORS_IDLE);
+  }
+
+  // write the staged measurements of this cycle together
+  if (sensors_staged && !in_progress) {
+    sensors_staged = false;
+    UTIL_TIMER_Start(&FlushTimer);
+  }
+
+  // measuring takes time, so the next deadline is relative to the end
+  SensorsArm(UTIL_TIMER_GetCurrentTime());
+}
+
+static void SensorsStep(SensorsEntry *entry) {
+  int delay = 0;
+  if (entry->state == SENSORS_CONVERTING) {
+    delay = entry->poll();
+  } else if (entry->start != NULL) {
+    delay = entry->start();
+  }
+
+  if (delay > 0) {
+    entry->state = SENSORS_CONVERTING;
+    entry->deadline = UTIL_TIMER_GetCurrentTime() + delay;
+    return;
+  }
+
+  entry->state = SENSORS_IDLE;
+  if (delay < 0) {
+    APP_LOG(TS_OFF, VLEVEL_M, "Error: Measurement failed!\r\n");
+    return;
+  }
+
+  SensorsCollect(entry);
+}
+
+static void SensorsCollect(SensorsEntry *entry) {
+  FramStatus status = SensorsStore(&entry->measure);
+  if (status == FRAM_BUFFER_FULL) {
+    APP_LOG(TS_OFF, VLEVEL_M, "Error: TX Buffer full!\r\n");
+  } else if (status == FRAM_ERROR) {
+    APP_LOG(TS_OFF, VLEVEL_M, "Error: Measurement failed!\r\n");
+  } else if (status != FRAM_OK) {
+    APP_LOG(TS_OFF, VLEVEL_M, "Error: General FRAM buffer!\r\n");
+  }
+
+  sensors_staged = true;
+}
+
+static void SensorsArm(uint32_t now) {
+  uint32_t deadline = 0;
+  bool armed = sensors_running && ScheduleNext(&sensors_schedule, &deadline);
+
+  // polls of measurements in progress
+  for (unsigned int i = 0; i < sensors_arr_len; i++) {
+    const SensorsEntry *entry = &sensors_arr[i];
+    if (entry->state == SENSORS_IDLE) {
+      continue;
     }
-    APP_LOG(TS_OFF, VLEVEL_M, "\r\n");
-
-    // add to tx buffer
-    FramStatus status = FramPut(buffer, buffer_len);
-    if (status == FRAM_BUFFER_FULL) {
-      APP_LOG(TS_OFF, VLEVEL_M, "Error: TX Buffer full!\r\n");
-    } else if (status != FRAM_OK) {
-      APP_LOG(TS_OFF, VLEVEL_M, "Error: General FRAM buffer!\r\n");
+
+    if (!armed || (int32_t)(entry->deadline - deadline) < 0) {
+      deadline = entry->deadline;
+      armed = true;
     }
   }
+
+  if (!armed) {
+    return;
+  }
+
+  const int32_t delay = (int32_t)(deadline - now);
+  if (delay <= 0) {
+    SensorsRun();
+    return;
+  }
+
+  UTIL_TIMER_Stop(&MeasureTimer);
+  UTIL_TIMER_SetPeriod(&MeasureTimer, delay);
+  UTIL_TIMER_Start(&MeasureTimer);
 }
 
-size_t SensorsMeasureTest(uint8_t *data) {
+bool SensorsMeasureTest(pb_ostream_t *stream) {
   uint8_t static_data[] = {0xa,  0xc,  0x8,  0xc8, 0x1,  0x10, 0xc8, 0x1,  0x18,
                            0x88, 0xba, 0xf3, 0xba, 0x6,  0x12, 0x9,  0x11, 0xd9,
                            0xce, 0xf7, 0x53, 0x3,  0x88, 0xb7, 0xc0};
 
-  memcpy(data, static_data, sizeof(static_data));
-  return sizeof(static_data);
+  return pb_write(stream, static_data, sizeof(static_data));
 }
 
 void SensorsRun(void) {
   // trigger task to run
   UTIL_SEQ_SetTask((1 << CFG_SEQ_Task_Measurement), CFG_SEQ_Prio_0);
 }
+
+static void SensorsStored(FramStatus status) {
+  if (status != FRAM_OK) {
+    store_status = status;
+    ++store_failures;
+    UTIL_SEQ_SetTask((1 << CFG_SEQ_Task_MeasurementStored), CFG_SEQ_Prio_0);
+  }
+}
+
+static void SensorsStoredReport(void) {
+  APP_LOG(TS_OFF, VLEVEL_M,
+          "Error: %lu failed writes to FRAM, measurements remain staged. "
+          "FramStatus = %d\r\n",
+          store_failures, store_status);
+  store_failures = 0;
+}
+
+static void SensorsFlushRun(void *context) {
+  UTIL_SEQ_SetTask((1 << CFG_SEQ_Task_MeasurementFlush), CFG_SEQ_Prio_0);
+}
+
+static void SensorsFlush(void) {
+  // retried before entering low power mode if the FRAM is busy
+  FramFlushAsync();
+}
@@ -0,0 +1,112 @@
+/**
+ * @file stats.h
+ * @author John Madden <jmadden173@pm.me>
+ * @brief Running statistics of integer samples in fixed point
+ * @date 2026-10-16
+ */
+
+#ifndef LIB_STATS_INCLUDE_STATS_H_
+#define LIB_STATS_INCLUDE_STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @ingroup stm32
+ * @defgroup stats Stats
+ * @brief Running statistics of integer samples in fixed point
+ *
+ * Computes the count, minimum, maximum, mean and variance of samples one at a
+ * time with Welford's algorithm, so samples do not need to be stored. The
+ * mean and the sum of squared differences from the mean are kept in fixed
+ * point with STATS_FRAC_BITS fractional bits. Unlike a sum of squares, the
+ * variance keeps its precision when the samples have a large offset, such as
+ * raw ADC codes.
+ *
+ * Samples are limited to 24 bits, the resolution of the ADS1219, and to
+ * STATS_MAX_COUNT samples so the sums fit in 64 bits.
+ *
+ * @{
+ */
+
+/** Number of fractional bits of the mean and sum of squared differences */
+#define STATS_FRAC_BITS 8
+
+/** Maximum number of samples */
+#define STATS_MAX_COUNT 256
+
+/** Minimum value of a sample */
+#define STATS_SAMPLE_MIN (-(1 << 23))
+
+/** Maximum value of a sample */
+#define STATS_SAMPLE_MAX ((1 << 23) - 1)
+
+/**
+ * @brief Running statistics
+ */
+typedef struct {
+  /** Number of samples */
+  uint32_t count;
+  /** Minimum sample */
+  int32_t min;
+  /** Maximum sample */
+  int32_t max;
+  /** Mean of the samples in fixed point */
+  int64_t mean;
+  /** Sum of squared differences from the mean in fixed point */
+  uint64_t m2;
+} Stats;
+
+/**
+ * @brief Removes all samples
+ *
+ * @param stats Statistics
+ */
+void StatsInit(Stats *stats);
+
+/**
+ * @brief Adds a sample
+ *
+ * @param stats Statistics
+ * @param sample Sample between STATS_SAMPLE_MIN and STATS_SAMPLE_MAX
+ * @return 0 on success, -1 if the sample is out of range or STATS_MAX_COUNT
+ * samples were added
+ */
+int StatsAdd(Stats *stats, int32_t sample);
+
+/**
+ * @brief Gets the mean of the samples
+ *
+ * @param stats Statistics
+ * @return Mean, 0 without samples
+ */
+double StatsMean(const Stats *stats);
+
+/**
+ * @brief Gets the sample variance
+ *
+ * @param stats Statistics
+ * @return Variance with Bessel's correction, 0 with less than two samples
+ */
+double StatsVariance(const Stats *stats);
+
+/**
+ * @brief Gets the sample standard deviation
+ *
+ * @param stats Statistics
+ * @return Square root of StatsVariance()
+ */
+double StatsStddev(const Stats *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIB_STATS_INCLUDE_STATS_H_
@@ -0,0 +1,71 @@
+/**
+ * @file stats.c
+ * @author John Madden <jmadden173@pm.me>
+ * @brief See stats.h
+ * @date 2026-10-16
+ */
+
+#include "stats.h"
+
+#include <math.h>
+
+/** Fixed point value of one */
+#define STATS_ONE (1 << STATS_FRAC_BITS)
+
+void StatsInit(Stats *stats) {
+  stats->count = 0;
+  stats->min = 0;
+  stats->max = 0;
+  stats->mean = 0;
+  stats->m2 = 0;
+}
+
+int StatsAdd(Stats *stats, int32_t sample) {
+  if (stats->count >= STATS_MAX_COUNT || sample < STATS_SAMPLE_MIN ||
+      sample > STATS_SAMPLE_MAX) {
+    return -1;
+  }
+
+  const int64_t x = (int64_t)sample * STATS_ONE;
+
+  if (stats->count++ == 0) {
+    stats->min = sample;
+    stats->max = sample;
+    stats->mean = x;
+    stats->m2 = 0;
+    return 0;
+  }
+
+  if (sample < stats->min) {
+    stats->min = sample;
+  }
+  if (sample > stats->max) {
+    stats->max = sample;
+  }
+
+  // the mean moves towards the sample, so both differences have the same
+  // sign and their product fits 64 bits
+  const int64_t delta = x - stats->mean;
+  stats->mean += delta / (int64_t)stats->count;
+  const int64_t delta2 = x - stats->mean;
+
+  const uint64_t abs_delta = (delta < 0) ? -delta : delta;
+  const uint64_t abs_delta2 = (delta2 < 0) ? -delta2 : delta2;
+  stats->m2 += (abs_delta * abs_delta2) >> STATS_FRAC_BITS;
+
+  return 0;
+}
+
+double StatsMean(const Stats *stats) {
+  return (double)stats->mean / STATS_ONE;
+}
+
+double StatsVariance(const Stats *stats) {
+  if (stats->count < 2) {
+    return 0.0;
+  }
+
+  return (double)stats->m2 / STATS_ONE / (stats->count - 1);
+}
+
+double StatsStddev(const Stats *stats) { return sqrt(StatsVariance(stats)); }
@@ -13,10 +13,12 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdio.h>
 
 #include "fram.h"
 #include "i2c.h"
+#include "pb_encode.h"
 
 /**
  * @ingroup storage
@@ -24,19 +26,73 @@ extern "C" {
  * @brief Circular buffer for measurements
  *
  * A circular buffer is implemented on part of the memory space of the fram
- * chip. The address space used can be modified with FRAM_BUFFER_START and
- * FRAM_BUFFER_END depending on user needs.
+ * chip. By default the buffer spans from the end of the page state (see
+ * FRAM_PAGE_STATE_ADDR) to the last address of the chip, as reported by
+ * FramSize(), or to the start of the burst region if FRAM_BURST_SIZE is set.
+ * On the 2 KiB FM24CL16B the buffer is placed below the page state instead.
+ * The address space used can be modified with FRAM_BUFFER_START and
+ * FRAM_BUFFER_END depending on user needs. Addresses are
+ * 32-bit to cover the full address space of larger chips such as the
+ * MB85RC1MT.
  *
- * Measurements are stored with a single uint8_t of their length followed by
- * the serialized protobuf message. On reads, the length is first read, then
- * the length number of bytes are read into RAM. Ensure the read buffer used
- * is of sufficient size.
+ * Measurements are stored as records. A record starts with the length of its
+ * data as a varint of 1 or 2 bytes, followed by a byte of type and flags,
+ * the data, such as a serialized protobuf message, and a CRC-8 of all
+ * preceding bytes of the record.
  *
- * The buffer's implementation does not allow for overwriting of data. Once
- * the buffer is full, indicated by FRAM_BUFFER_FULL, data needs to be removed
- * by getting the next measurement or clearing the buffer entirely.
+ * @verbatim
+ * +--------------+------+------------------+-------+
+ * | len (varint) | type | data (len bytes) | CRC-8 |
+ * +--------------+------+------------------+-------+
+ * @endverbatim
  *
- * @todo Implement a clear pointer in the following
+ * Records hold up to FRAM_RECORD_MAX_LEN bytes of data, so several samples
+ * can be stored in a single record. A record that fails its CRC is skipped
+ * using its length and counted as discarded, without affecting the following
+ * records. A length that is out of range cannot be skipped, the buffer is
+ * cleared instead. Reads validate the CRC while the record is read.
+ *
+ * Measurements can also be serialized straight into the staging ring with
+ * FramPutStream(), which provides a nanopb output stream at the write cursor.
+ * Room for the largest record is reserved up front, the stream wraps around
+ * the end of the ring and the length is back-patched once the message is
+ * encoded. The length keeps the number of bytes reserved for it, so it may be
+ * padded with a continuation byte, which decodes to the same value.
+ *
+ * Measurements are first copied to a staging ring in RAM of
+ * FRAM_STAGING_SIZE bytes. A flush writes all staged measurements with a
+ * single sequential write and a single save of the buffer state, instead of
+ * separate writes for every measurement. Flushes run in the background on
+ * reaching FRAM_STAGING_HIGH_WATER and are started by the application on a
+ * timer and before entering low power mode, see FramFlushAsync(). Reads flush
+ * first so staged measurements are included. Staged measurements are lost on
+ * a reset.
+ *
+ * Transfers use DMA through FramWriteAsync() and FramReadAsync(), allowing
+ * the core to sleep while data is moved.
+ *
+ * The buffer state (read address, write address and number of measurements)
+ * is saved to FRAM after every operation so buffered measurements survive a
+ * reset. The state is versioned and protected with a CRC. Two copies are kept
+ * and written alternately, each with a single write, so a power loss during a
+ * save leaves the previous copy intact. On boot FIFO_Init() resumes from the
+ * latest valid copy.
+ *
+ * What happens once the buffer is full is set by the retention policy, see
+ * FifoPolicy and FramSetPolicy(). By default new measurements are refused
+ * with FRAM_BUFFER_FULL until data is removed by getting the next measurement
+ * or clearing the buffer entirely. Nodes that are offline for long periods
+ * can instead keep the most recent measurements, evicting the oldest ones.
+ * Eviction reads only the header of the oldest measurement to find the next
+ * one, so each eviction is a single read of FRAM_RECORD_HEADER_MAX bytes
+ * holding the varint length and type. Discarded measurements are counted per
+ * policy, see FramGetDiscards().
+ *
+ * Measurements can also be read in batches. FramPeekBatch() reads as many
+ * measurements as fit in an array with a single sequential read, without
+ * removing them from the buffer. Once the measurements are confirmed by the
+ * backend, FramCommit() removes them from the buffer. Until then a reset or
+ * a failed upload leaves them in the buffer to be retried.
  *
  * The buffer operates as a circular queue with three pointers:
  *
@@ -52,59 +108,409 @@ extern "C" {
  * data is not overwritten by subsequent writes. The write pointer is allowed
  * to wrap around but is restricted from advancing past the clear pointer. This
  * constraint protects data integrity in field deployments where network
- * failures may delay acknowledgment indefinitely.
+ * failures may delay acknowledgment indefinitely. In the implementation the
+ * saved read address acts as the clear pointer and the read pointer is the
+ * end of the last batch from FramPeekBatch().
  *
  * @{
  */
 
 #ifndef FRAM_BUFFER_START
+#ifdef FRAM_FM24CL16B
 /** Starting address of buffer, which is INCLUSIVE */
 #define FRAM_BUFFER_START 0
+#else
+/** Starting address of buffer, which is INCLUSIVE. After the page state. */
+#define FRAM_BUFFER_START (FRAM_PAGE_STATE_ADDR + FRAM_PAGE_STATE_SIZE)
+#endif /* FRAM_FM24CL16B */
 #endif /* FRAM_BUFFER_START */
 
 #ifndef FRAM_BUFFER_END
-/** Ending address of buffer, which is INCLUSIVE */
-#define FRAM_BUFFER_END 1769
+#ifdef FRAM_FM24CL16B
+/** Ending address of buffer, which is INCLUSIVE. Below the page state. */
+#define FRAM_BUFFER_END (FRAM_PAGE_STATE_ADDR - 1)
+#else
+/** Ending address of buffer, which is INCLUSIVE. Below the burst region. */
+#define FRAM_BUFFER_END (FramSize() - FRAM_BURST_SIZE - 1)
+#endif /* FRAM_FM24CL16B */
 #endif /* FRAM_BUFFER_END */
 
-#if FRAM_BUFFER_START > FRAM_BUFFER_END
-#error "Buffer end address must be greater than buffer start address"
+#ifndef FRAM_RECORD_MAX_LEN
+/** Maximum number of bytes of data in a record */
+#define FRAM_RECORD_MAX_LEN 1024
+#endif /* FRAM_RECORD_MAX_LEN */
+
+#if FRAM_RECORD_MAX_LEN > 0x3FFF
+#error FRAM_RECORD_MAX_LEN must fit in a varint of 2 bytes
+#endif
+
+/** Maximum number of bytes before the data of a record, length and type */
+#define FRAM_RECORD_HEADER_MAX 3
+
+/** Maximum number of bytes added to the data of a record */
+#define FRAM_RECORD_OVERHEAD (FRAM_RECORD_HEADER_MAX + 1)
+
+/** Maximum number of bytes of a stored record */
+#define FRAM_RECORD_MAX_SIZE (FRAM_RECORD_MAX_LEN + FRAM_RECORD_OVERHEAD)
+
+/** Record type of a single serialized measurement */
+#define FRAM_RECORD_MEASUREMENT 0x00
+
+/** Record type of a measurement compressed with EncodeMeasurementDelta() */
+#define FRAM_RECORD_DELTA 0x01
+
+#ifndef FRAM_STAGING_SIZE
+/** Size of the staging ring in RAM in bytes. Must hold the largest record. */
+#define FRAM_STAGING_SIZE 1536
+#endif /* FRAM_STAGING_SIZE */
+
+#ifndef FRAM_STAGING_HIGH_WATER
+/** Number of staged bytes that starts a flush */
+#define FRAM_STAGING_HIGH_WATER (FRAM_STAGING_SIZE * 3 / 4)
+#endif /* FRAM_STAGING_HIGH_WATER */
+
+#if FRAM_STAGING_SIZE < FRAM_RECORD_MAX_SIZE
+#error FRAM_STAGING_SIZE must hold a record of FRAM_RECORD_MAX_SIZE bytes
 #endif
 
-/** Amount of bytes that can be stored in the buffer*/
-static const uint16_t kFramBufferSize = FRAM_BUFFER_END - FRAM_BUFFER_START + 1;
+/**
+ * @brief Record decoded from an array of stored records
+ */
+typedef struct {
+  /** Type and flags */
+  uint8_t type;
+  /** Data of the record, points into the decoded array */
+  const uint8_t *data;
+  /** Number of bytes of data */
+  size_t len;
+  /** Number of bytes of the stored record, 0 if the header is incomplete or
+   * invalid */
+  size_t size;
+} FramRecord;
+
+/**
+ * @brief Retention policy once the buffer is full
+ */
+typedef enum {
+  /** Refuse new measurements */
+  FIFO_POLICY_DROP_NEW = 0,
+  /** Evict the oldest measurements to make room */
+  FIFO_POLICY_DROP_OLD = 1,
+  /**
+   * Store every FIFO_DECIMATE_FACTOR-th new measurement by evicting the
+   * oldest measurements and refuse the others, extending the time covered by
+   * the buffer at a lower resolution
+   */
+  FIFO_POLICY_DECIMATE = 2,
+} FifoPolicy;
+
+#ifndef FIFO_POLICY_DEFAULT
+/** Retention policy on boot */
+#define FIFO_POLICY_DEFAULT FIFO_POLICY_DROP_NEW
+#endif /* FIFO_POLICY_DEFAULT */
+
+#ifndef FIFO_DECIMATE_FACTOR
+/** One of this many new measurements is stored by FIFO_POLICY_DECIMATE */
+#define FIFO_DECIMATE_FACTOR 2
+#endif /* FIFO_DECIMATE_FACTOR */
+
+#if FIFO_DECIMATE_FACTOR < 1
+#error FIFO_DECIMATE_FACTOR must be at least 1
+#endif
+
+/**
+ * @brief Number of measurements discarded by each retention policy
+ *
+ * Counted since boot or the last FramResetDiscards().
+ */
+typedef struct {
+  /** New measurements refused by FIFO_POLICY_DROP_NEW */
+  uint32_t drop_new;
+  /** Old measurements evicted by FIFO_POLICY_DROP_OLD */
+  uint32_t drop_old;
+  /** New measurements refused and old measurements evicted by
+   * FIFO_POLICY_DECIMATE */
+  uint32_t decimate;
+  /** Records that failed validation */
+  uint32_t corrupt;
+} FifoDiscards;
+
+/**
+ * @brief Get the number of bytes that can be stored in the buffer
+ *
+ * @return Size of the buffer in bytes
+ */
+FramAddr FramBufferSize(void);
+
+/**
+ * @brief Decodes the next record of an array of stored records
+ *
+ * Used to iterate over the records returned by FramPeekBatch(). The next
+ * record starts record->size bytes after the current one.
+ *
+ * @param buf Array of stored records
+ * @param len Number of bytes in buf
+ * @param record Decoded record
+ * @return FRAM_OUT_OF_RANGE if buf does not hold the complete record,
+ * FRAM_CORRUPT if the CRC does not match and the record is to be skipped,
+ * FRAM_ERROR if the length is invalid and the record cannot be skipped,
+ * otherwise FRAM_OK
+ */
+FramStatus FramRecordDecode(const uint8_t *buf, size_t len, FramRecord *record);
+
+/**
+ * @brief Puts a record into the circular buffer
+ *
+ * @see FramPut
+ *
+ * @param type Type and flags of the record
+ * @param data An array of data bytes.
+ * @param num_bytes The number of bytes to be written, at most
+ * FRAM_RECORD_MAX_LEN.
+ * @return FRAM_BUFFER_FULL if the record was refused, otherwise see
+ * FramStatus
+ */
+FramStatus FramPutRecord(uint8_t type, const uint8_t *data, size_t num_bytes);
+
+/**
+ * @brief Serializes data into an output stream
+ *
+ * @param stream Output stream to write to
+ * @param arg Argument passed to FramPutStream()
+ * @return true on success, false to discard the record
+ */
+typedef bool (*FramStreamEncoder)(pb_ostream_t *stream, void *arg);
+
+/**
+ * @brief Puts a record into the circular buffer by encoding it in place
+ *
+ * The encoder writes directly to the write cursor of the staging ring, so
+ * the data is serialized once without an intermediate copy. Space for a
+ * record of max_len bytes of data is made before encoding, including
+ * applying the retention policy, and the stream refuses writes beyond
+ * max_len bytes.
+ *
+ * @see FramPutRecord
+ *
+ * @param type Type and flags of the record
+ * @param max_len Maximum number of bytes of data, at most FRAM_RECORD_MAX_LEN
+ * @param encoder Called once with a stream at the write cursor
+ * @param arg Passed to encoder
+ * @return FRAM_BUFFER_FULL if the record was refused, FRAM_OUT_OF_RANGE if
+ * max_len is too large, FRAM_ERROR if the encoder failed, in which case
+ * nothing is stored, otherwise see FramStatus
+ */
+FramStatus FramPutStream(uint8_t type, size_t max_len,
+                         FramStreamEncoder encoder, void *arg);
 
 /**
  * @brief Puts a measurement into the circular buffer
  *
+ * Stored as a record of type FRAM_RECORD_MEASUREMENT, see FramPutRecord().
+ *
+ * The measurement is copied to the staging ring in RAM, so data can be reused
+ * once the function returns. Staged measurements are written to FRAM by a
+ * flush, which starts in the background once FRAM_STAGING_HIGH_WATER bytes
+ * are staged. If the staging ring is full the staged measurements are
+ * flushed before returning.
+ *
+ * If the buffer is full the retention policy is applied. Evicting
+ * measurements flushes the staging ring and saves the buffer state before
+ * returning.
+ *
  * @param    data An array of data bytes.
  * @param    num_bytes The number of bytes to be written.
- * @return   See FramStatus
+ * @return   FRAM_BUFFER_FULL if the measurement was refused, otherwise see
+ * FramStatus
+ */
+FramStatus FramPut(const uint8_t *data, size_t num_bytes);
+
+/**
+ * @brief Sets the retention policy once the buffer is full
+ *
+ * @param policy Retention policy
+ */
+void FramSetPolicy(FifoPolicy policy);
+
+/**
+ * @brief Get the retention policy
+ *
+ * @return Retention policy
+ */
+FifoPolicy FramGetPolicy(void);
+
+/**
+ * @brief Get the number of measurements discarded by each retention policy
+ *
+ * @param discards Counters to be read into
+ */
+void FramGetDiscards(FifoDiscards *discards);
+
+/**
+ * @brief Resets the counters of discarded measurements
+ */
+void FramResetDiscards(void);
+
+/**
+ * @brief Starts writing staged measurements to FRAM without blocking
+ *
+ * Staged measurements are written with a single sequential write, split only
+ * where the staging ring or the buffer in FRAM wraps around, followed by a
+ * single save of the buffer state. Measurements staged after the flush starts
+ * are written by the next flush. If the flush fails the measurements remain
+ * staged.
+ *
+ * Does not wait on the FRAM, so it can be called before entering low power
+ * mode.
+ *
+ * @return FRAM_OK if the flush was started or nothing is staged, FRAM_BUSY if
+ * a flush or another transfer is in progress, otherwise see FramStatus
+ */
+FramStatus FramFlushAsync(void);
+
+/**
+ * @brief Writes all staged measurements to FRAM
+ *
+ * Waits for a flush in progress, then flushes until nothing is staged.
+ *
+ * @return See FramStatus
+ */
+FramStatus FramFlush(void);
+
+/**
+ * @brief Checks for measurements staged since the last flush started
+ *
+ * Measurements of a failed flush are not pending until another measurement
+ * is staged, preventing retries of a failing FRAM on every call.
+ *
+ * @return true if a flush is needed, false otherwise
+ */
+bool FramFlushPending(void);
+
+/**
+ * @brief Get the number of staged bytes
+ *
+ * @return Number of bytes, including the length of each measurement
+ */
+size_t FramStagedLen(void);
+
+/**
+ * @brief Sets the callback on completion of a flush
+ *
+ * Called from interrupt context with the status of the flush.
+ *
+ * @param callback Called on completion, can be NULL
+ */
+void FramSetFlushCallback(FramCallback callback);
+
+/**
+ * @brief Reads and removes the oldest record from the buffer
+ *
+ * Records that fail their CRC are skipped and counted as discarded.
+ *
+ * @param type Type and flags of the record, can be NULL
+ * @param data Array to be read into
+ * @param size Size of data in bytes
+ * @param len Number of bytes read into data
+ * @return FRAM_BUFFER_EMPTY if there are no valid records, FRAM_OUT_OF_RANGE
+ * if the record does not fit in data, in which case it stays in the buffer,
+ * FRAM_ERROR if the buffer was cleared due to an invalid length, otherwise
+ * see FramStatus
  */
-FramStatus FramPut(const uint8_t *data, uint16_t num_bytes);
+FramStatus FramGetRecord(uint8_t *type, uint8_t *data, size_t size,
+                         size_t *len);
 
 /**
  * @brief    Reads a measurement from the queue
  *
+ * @see FramGetRecord
  *
  * @param    data Array to be read into
+ * @param    size Size of data in bytes
  * @param    len Length of data
- * @return   See FramStatus
+ * @return   See FramGetRecord
  */
-FramStatus FramGet(uint8_t *data, uint8_t *len);
+FramStatus FramGet(uint8_t *data, size_t size, size_t *len);
+
+/**
+ * @brief Reads a batch of measurements without removing them from the buffer
+ *
+ * Measurements are read from the oldest unconfirmed measurement with a single
+ * sequential read. The array contains the records as stored, see
+ * FramRecordDecode(). Only complete records are counted, including records
+ * that fail their CRC so they are committed with the rest of the batch.
+ * Calling again before FramCommit() returns the same measurements.
+ *
+ * @param data Array to be read into
+ * @param max_bytes Size of data in bytes
+ * @param count Number of measurements in data
+ * @return FRAM_BUFFER_EMPTY if there are no measurements, FRAM_OUT_OF_RANGE if
+ * the first measurement does not fit in data, FRAM_ERROR if the buffer was
+ * cleared due to an invalid length, otherwise see FramStatus
+ */
+FramStatus FramPeekBatch(uint8_t *data, size_t max_bytes, uint32_t *count);
+
+/**
+ * @brief Packs a batch of records into length-delimited data for uplinks
+ *
+ * The data of each record is copied preceded by its length as a varint,
+ * dropping the type and CRC, which is the delimited format of protobuf
+ * messages. Records are packed in order until the next one does not fit or
+ * is not a FRAM_RECORD_MEASUREMENT. Records that fail their CRC are skipped.
+ * The output may overlap the batch if it starts at or before it, allowing
+ * packing in place.
+ *
+ * @param batch Records returned by FramPeekBatch()
+ * @param batch_len Number of bytes in batch
+ * @param count Number of records in batch, set to the number of records
+ * consumed including skipped records, to be passed to FramCommit()
+ * @param out Array to be packed into
+ * @param out_size Size of out in bytes
+ * @return Number of bytes packed into out
+ */
+size_t FramPackBatch(const uint8_t *batch, size_t batch_len, uint32_t *count,
+                     uint8_t *out, size_t out_size);
+
+/**
+ * @brief Removes confirmed measurements from the buffer
+ *
+ * Advances the clear pointer past the oldest count measurements and saves
+ * the buffer state. Committing the count returned by the previous
+ * FramPeekBatch() does not require any reads. Measurements of that batch that
+ * were evicted by the retention policy in the meantime are not removed again.
+ *
+ * @param count Number of measurements to remove
+ * @return FRAM_OUT_OF_RANGE if count is larger than the number of stored
+ * measurements, otherwise see FramStatus
+ */
+FramStatus FramCommit(uint32_t count);
 
 /**
  * @brief Get the current number of measurements stored in the buffer
  *
+ * Includes staged measurements.
+ *
  * @return Number of measurements
  */
-uint16_t FramBufferLen(void);
+uint32_t FramBufferLen(void);
+
+/**
+ * @brief Get the number of bytes used by stored measurements
+ *
+ * Includes staged measurements and the overhead of each record. Used to
+ * compare the fill level of the buffer against FramBufferSize().
+ *
+ * @return Number of bytes
+ */
+FramAddr FramBufferUsed(void);
 
 /**
  * @brief Clears the buffer
  *
  * Read and write addresses are set to their default values allowing for the
  * buffer to be overwritten.
+ *
+ * @return Status of saving the buffer state, see FramStatus
  */
 FramStatus FramBufferClear(void);
 
@@ -117,8 +523,8 @@ FramStatus FramBufferClear(void);
  * @param buffer_len Current length of the circular buffer.
  * @return FramStatus, status of the FRAM operation.
  */
-FramStatus FramSaveBufferState(uint16_t read_addr, uint16_t write_addr,
-                               uint16_t buffer_len);
+FramStatus FramSaveBufferState(FramAddr read_addr, FramAddr write_addr,
+                               uint32_t buffer_len);
 
 /**
  * @brief Loads the buffer state (read address, write address, and buffer
@@ -127,15 +533,18 @@ FramStatus FramSaveBufferState(uint16_t read_addr, uint16_t write_addr,
  * @param read_addr Pointer to store the retrieved read address.
  * @param write_addr Pointer to store the retrieved write address.
  * @param buffer_len Pointer to store the retrieved buffer length.
- * @return FramStatus, status of the FRAM operation.
+ * @return FRAM_CORRUPT if no copy of the state is valid, otherwise
+ * FramStatus, status of the FRAM operation.
  */
-FramStatus FramLoadBufferState(uint16_t *read_addr, uint16_t *write_addr,
-                               uint16_t *buffer_len);
+FramStatus FramLoadBufferState(FramAddr *read_addr, FramAddr *write_addr,
+                               uint32_t *buffer_len);
 
 /**
  * @brief Initializes the FIFO buffer by loading the buffer state (read address,
- *        write address, and buffer length) from FRAM. If the state cannot be
- *        loaded or is invalid, it initializes the buffer with default values.
+ *        write address, and buffer length) from FRAM. If no copy of the state
+ *        is valid, or the state is invalid, such as addresses outside of the
+ *        buffer, it initializes the buffer with default values. The saved
+ *        state is kept if it cannot be read, so the call can be retried.
  * @return FramStatus, status of the FRAM operation.
  */
 FramStatus FIFO_Init(void);
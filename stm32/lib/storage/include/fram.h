@@ -26,6 +26,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "stm32wlxx_hal.h"
@@ -54,6 +55,72 @@ extern "C" {
 #define LOGGING_INTERVAL_IN_SECONDS_MEMORY_ADDRESS 0x27
 #define UPLOAD_INTERVAL_IN_MINUTES_MEMORY_ADDRESS 0x29
 
+/**
+ * @brief Start of the region reserved for library state and user configuration
+ *
+ * The reserved region holds the FIFO state and the user configuration. The
+ * default address keeps the user configuration at the address used by
+ * previous firmware versions so existing configurations are preserved. The
+ * region can be relocated by defining FRAM_RESERVED_START at compile time.
+ */
+#ifndef FRAM_RESERVED_START
+#define FRAM_RESERVED_START 0x06E0
+#endif /* FRAM_RESERVED_START */
+
+/** Size of the reserved region in bytes */
+#define FRAM_RESERVED_SIZE 0x0120
+
+/** Address of the FIFO state */
+#define FRAM_FIFO_STATE_ADDR (FRAM_RESERVED_START + 0x00)
+/** Size of the FIFO state in bytes */
+#define FRAM_FIFO_STATE_SIZE 0x20
+/** Address of the length of the encoded user configuration */
+#define FRAM_USER_CONFIG_LEN_ADDR (FRAM_RESERVED_START + 0x20)
+/** Address of the encoded user configuration */
+#define FRAM_USER_CONFIG_ADDR (FRAM_RESERVED_START + 0x22)
+
+/**
+ * @brief Size of the region holding the page state in bytes, see @ref page
+ */
+#ifndef FRAM_PAGE_STATE_SIZE
+#ifdef FRAM_FM24CL16B
+#define FRAM_PAGE_STATE_SIZE 0x00B0
+#else
+#define FRAM_PAGE_STATE_SIZE 0x0440
+#endif /* FRAM_FM24CL16B */
+#endif /* FRAM_PAGE_STATE_SIZE */
+
+/**
+ * @brief Address of the page state
+ *
+ * Placed after the reserved region. On the 2 KiB FM24CL16B the page state is
+ * placed below the reserved region instead, at the end of the FIFO buffer.
+ */
+#ifndef FRAM_PAGE_STATE_ADDR
+#ifdef FRAM_FM24CL16B
+#define FRAM_PAGE_STATE_ADDR (1744 - FRAM_PAGE_STATE_SIZE)
+#else
+#define FRAM_PAGE_STATE_ADDR (FRAM_RESERVED_START + FRAM_RESERVED_SIZE)
+#endif /* FRAM_FM24CL16B */
+#endif /* FRAM_PAGE_STATE_ADDR */
+
+/**
+ * @brief Size of the region holding a power burst in bytes
+ *
+ * Taken from the end of the chip, which shortens the FIFO buffer by the same
+ * amount. Disabled by default. See ADC_burstCapture().
+ */
+#ifndef FRAM_BURST_SIZE
+#define FRAM_BURST_SIZE 0
+#endif /* FRAM_BURST_SIZE */
+
+#if defined(FRAM_FM24CL16B) && FRAM_BURST_SIZE > 0
+#error "FRAM_BURST_SIZE is not supported on the FM24CL16B"
+#endif
+
+/** Address of the region holding a power burst */
+#define FRAM_BURST_ADDR (FramSize() - FRAM_BURST_SIZE)
+
 #define DUMP_FRAM_DISPLAY_HEX 0
 #define DUMP_FRAM_DISPLAY_DECIMAL 1
 #define DUMP_FRAM_OMIT_NONE 0
@@ -76,6 +143,8 @@ typedef enum {
   FRAM_OUT_OF_RANGE = -2,
   FRAM_BUFFER_FULL = -3,
   FRAM_BUFFER_EMPTY = -4,
+  FRAM_BUSY = -5,
+  FRAM_CORRUPT = -6,
 } FramStatus;
 
 /** Address size definition */
@@ -101,6 +170,66 @@ FramStatus FramWrite(FramAddr addr, const uint8_t *data, size_t len);
  */
 FramStatus FramRead(FramAddr addr, size_t len, uint8_t *data);
 
+/**
+ * @brief Callback on completion of an asynchronous transfer
+ *
+ * Called from interrupt context. Keep processing short, such as posting a
+ * task with UTIL_SEQ_SetTask().
+ *
+ * @param status Status of the transfer
+ */
+typedef void (*FramCallback)(FramStatus status);
+
+/**
+ * @brief Starts writing bytes to an address without blocking
+ *
+ * The transfer uses DMA when supported by the chip, otherwise the write is
+ * performed before returning. The data must remain valid until the callback
+ * is called. STOP mode is disabled while the transfer is in progress since
+ * the I2C peripheral is not clocked in STOP mode.
+ *
+ * @param addr Address of write
+ * @param data An array of data bytes.
+ * @param len The number of bytes to be written.
+ * @param callback Called on completion, can be NULL
+ * @return FRAM_OK if the transfer was started, FRAM_BUSY if another transfer
+ * is in progress, otherwise see FramStatus. The callback is only called when
+ * FRAM_OK is returned.
+ */
+FramStatus FramWriteAsync(FramAddr addr, const uint8_t *data, size_t len,
+                          FramCallback callback);
+
+/**
+ * @brief Starts reading bytes from an address without blocking
+ *
+ * @see FramWriteAsync
+ *
+ * @param addr Address of read
+ * @param len Number of sequential bytes to read
+ * @param data Array to be read into
+ * @param callback Called on completion, can be NULL
+ * @return FRAM_OK if the transfer was started, FRAM_BUSY if another transfer
+ * is in progress, otherwise see FramStatus. The callback is only called when
+ * FRAM_OK is returned.
+ */
+FramStatus FramReadAsync(FramAddr addr, size_t len, uint8_t *data,
+                         FramCallback callback);
+
+/**
+ * @brief Checks if an asynchronous transfer is in progress
+ *
+ * @return true if busy, false otherwise
+ */
+bool FramBusy(void);
+
+/**
+ * @brief Waits for the asynchronous transfer in progress to complete
+ *
+ * The core sleeps until an interrupt occurs while waiting. Blocking reads and
+ * writes wait automatically.
+ */
+void FramWaitIdle(void);
+
 /**
  * @brief Get the number of available bytes in FRAM
  *
@@ -125,8 +254,8 @@ FramAddr FramSize(void);
  * @return see FramStatus
  */
 FramStatus FramDump(uint16_t linesize, uint8_t displayformat, uint8_t omitjunk,
-                    uint8_t printdelay_ms, uint16_t startaddress,
-                    uint16_t endaddress);
+                    uint8_t printdelay_ms, FramAddr startaddress,
+                    FramAddr endaddress);
 
 /**
  * @}
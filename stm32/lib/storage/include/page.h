@@ -19,10 +19,12 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+#include "fram.h"
+
 /**
  * @ingroup storage
- * @defgroup page Page (WIP)
- * @brief Paging system for fram with external sd card (WIP)
+ * @defgroup page Page
+ * @brief Paging system for fram with external sd card
  *
  * @verbatim
  * Implements a linked list for storing pages on external memory.
@@ -38,37 +40,185 @@ extern "C" {
  *    NULL                           NULL
  * @endverbatim
  *
- * Each page in the linked list contains a 'next' pointer pointing towards the
- * tail (Back) and a 'prev' pointer pointing towards the head (Front).
+ * Each page in the linked list contains a 'next' link pointing towards the
+ * tail (Back) and a 'prev' link pointing towards the head (Front).
+ *
+ * Pages are taken from a static pool of PAGE_POOL_SIZE pages, so pushing and
+ * popping never allocates memory and runs in constant time. Links are indices
+ * into the pool, with unused pages kept in a free list. The pool, including
+ * the free list, is saved to FRAM at FRAM_PAGE_STATE_ADDR on every push and
+ * pop and by PageStateSave(), and is loaded by PageInit() so pages survive a
+ * reset. Two copies are kept and written alternately, each protected with a
+ * CRC, so a power loss during a save leaves the previous copy intact.
+ *
+ * Pages are files on external storage, such as the sd card of the esp32. The
+ * storage is accessed through the functions in @ref PageInterfaceType, set
+ * with PageSetInterface(), so the library does not depend on the transport.
+ *
+ * The pages act as a second tier behind the FRAM FIFO. When the fill level of
+ * the FIFO passes PAGE_HIGH_WATER, PageBalance() spills the oldest
+ * measurements to the back page until the fill level is half way between the
+ * watermarks. Once the FIFO drains below PAGE_LOW_WATER, measurements are
+ * streamed back from the front page into the FIFO. Pages are deleted once
+ * they are read in full. Measurements are stored in pages as records in the
+ * same format as the FIFO, see FramRecordDecode(). Records that fail their
+ * CRC are dropped on restore.
+ *
+ * Restored measurements are put behind measurements that are in the FIFO, so
+ * the order of uploads is not preserved across tiers. Measurements are
+ * timestamped so the order can be recovered by the backend.
  *
  * @{
  */
 
+/**
+ * @brief Fill level of the FIFO in bytes above which measurements are spilled
+ * to pages
+ */
+#ifndef PAGE_HIGH_WATER
+#define PAGE_HIGH_WATER (FramBufferSize() * 3 / 4)
+#endif /* PAGE_HIGH_WATER */
+
+/**
+ * @brief Fill level of the FIFO in bytes below which measurements are
+ * restored from pages
+ */
+#ifndef PAGE_LOW_WATER
+#define PAGE_LOW_WATER (FramBufferSize() / 4)
+#endif /* PAGE_LOW_WATER */
+
+/** Maximum number of bytes written to a page before starting a new page */
+#ifndef PAGE_MAX_BYTES
+#define PAGE_MAX_BYTES (64 * 1024)
+#endif /* PAGE_MAX_BYTES */
+
+/** Number of pages in the pool */
+#ifndef PAGE_POOL_SIZE
+#ifdef FRAM_FM24CL16B
+#define PAGE_POOL_SIZE 4
+#else
+#define PAGE_POOL_SIZE 32
+#endif /* FRAM_FM24CL16B */
+#endif /* PAGE_POOL_SIZE */
+
+/** Index of a page in the pool */
+typedef uint16_t PageIdx;
+
+/** Index representing no page */
+#define PAGE_NULL UINT16_MAX
+
+/**
+ * @brief Number of bytes transferred to or from a page at once
+ *
+ * Must fit in the data field of the PageCommand message. Records larger than
+ * a block are split over several transfers.
+ */
+#define PAGE_BLOCK_SIZE 256
+
 typedef struct Page_s Page;
 
 struct Page_s {
-  /** Next element in ll */
-  Page *next;
+  /** Next element in ll, or next free page */
+  PageIdx next;
   /** Prev element in ll */
-  Page *prev;
+  PageIdx prev;
   /** File index the page corresponds to */
-  size_t file_idx;
+  uint32_t file_idx;
   /** Flag for file open */
   bool open;
+  /** Number of bytes written to the page */
+  uint32_t write_len;
+  /** Offset of the next byte to be read from the page */
+  uint32_t read_offset;
 };
 
+/**
+ * @brief Opens a file on external storage
+ *
+ * The file is created if it does not exist.
+ *
+ * @param file_idx File index
+ * @return true if successful, false otherwise
+ */
+typedef bool (*PageOpenPtrType)(uint32_t file_idx);
+
+/**
+ * @brief Closes a file on external storage
+ *
+ * @param file_idx File index
+ * @return true if successful, false otherwise
+ */
+typedef bool (*PageClosePtrType)(uint32_t file_idx);
+
+/**
+ * @brief Appends bytes to a file on external storage
+ *
+ * @param file_idx File index
+ * @param buf Bytes to write
+ * @param len Number of bytes to write, at most PAGE_BLOCK_SIZE
+ * @return Number of bytes written
+ */
+typedef size_t (*PageWritePtrType)(uint32_t file_idx, const uint8_t *buf,
+                                   size_t len);
+
+/**
+ * @brief Reads bytes from a file on external storage
+ *
+ * @param file_idx File index
+ * @param offset Offset of the first byte to read
+ * @param buf Array to be read into
+ * @param len Maximum number of bytes to read, at most PAGE_BLOCK_SIZE
+ * @return Number of bytes read, 0 at the end of the file
+ */
+typedef size_t (*PageReadPtrType)(uint32_t file_idx, uint32_t offset,
+                                  uint8_t *buf, size_t len);
+
+/**
+ * @brief Deletes a file on external storage
+ *
+ * @param file_idx File index
+ * @return true if successful, false otherwise
+ */
+typedef bool (*PageDeletePtrType)(uint32_t file_idx);
+
+/**
+ * @brief Interface to external storage
+ */
+typedef struct {
+  /** Pointer to open function */
+  PageOpenPtrType OpenPtr;
+  /** Pointer to close function */
+  PageClosePtrType ClosePtr;
+  /** Pointer to write function */
+  PageWritePtrType WritePtr;
+  /** Pointer to read function */
+  PageReadPtrType ReadPtr;
+  /** Pointer to delete function */
+  PageDeletePtrType DeletePtr;
+} PageInterfaceType;
+
 /**
  * @brief Loads the last saved page state
  *
+ * Starts with an empty list if no valid state is saved.
  */
 void PageInit(void);
 
 /**
- * @brief Safely frees all memory in linked list
+ * @brief Pops all pages from the linked list
  *
+ * Files on external storage are not deleted. The saved page state is reset to
+ * an empty list.
  */
 void PageDeinit(void);
 
+/**
+ * @brief Sets the interface to external storage
+ *
+ * @param interface Storage functions, NULL to disable paging
+ */
+void PageSetInterface(const PageInterfaceType *interface);
+
 /**
  * @brief Get the front page
  *
@@ -81,89 +231,173 @@ Page *PageFront(void);
  */
 Page *PageBack(void);
 
+/**
+ * @brief Get the page after a page, towards the back
+ *
+ * @param page Page reference
+ * @return Next page, NULL if page is the back
+ */
+Page *PageNext(const Page *page);
+
+/**
+ * @brief Get the page before a page, towards the front
+ *
+ * @param page Page reference
+ * @return Previous page, NULL if page is the front
+ */
+Page *PagePrev(const Page *page);
+
 /**
  * @brief Push a page to the front of the linked list
+ *
+ * @return Reference to page, NULL if the pool is exhausted
  */
 Page *PagePushFront(void);
 
 /**
  * @brief Pop a page from the front of the linked list
  *
- * @param
+ * The page is closed if open. The file on external storage is not deleted,
+ * see PageDelete().
  */
 void PagePopFront(void);
 
 /**
  * @brief Push a page to the back of the linked list
  *
+ * @return Reference to page, NULL if the pool is exhausted
  */
 Page *PagePushBack(void);
 
 /**
  * @brief Pop a page from the back of the linked list
  *
+ * @see PagePopFront
  */
 void PagePopBack(void);
 
 /**
  * @brief Opens a memory page for read/writing
  *
- * @return Reference to open
+ * If the page is already open, nothing is done
+ *
+ * @param page Page reference
+ * @return true if successful, false otherwise
  */
-void PageOpen(Page *page);
+bool PageOpen(Page *page);
 
 /**
  * @brief Close a page
  *
  * If the page is already closed, nothing is done
  *
+ * @param page Page reference
+ * @return true if successful, false otherwise
+ */
+bool PageClose(Page *page);
+
+/**
+ * @brief Deletes the file of a page from external storage
+ *
+ * The page is closed first if open. The page stays in the linked list.
+ *
+ * @param page Page reference
+ * @return true if successful, false otherwise
  */
-void PageClose(Page *page);
+bool PageDelete(Page *page);
 
 /**
- * @brief Writes to a page
+ * @brief Writes to the end of a page
+ *
+ * The bytes are written in blocks of at most PAGE_BLOCK_SIZE. The number of
+ * bytes written is saved by the next PageStateSave().
  *
  * @param page Page reference
  * @param buf Pointer to buffer
  * @param len Number of bytes to write from buffer
+ * @return Number of bytes written
  */
-void PageWrite(Page *page, const uint8_t *buf, size_t len);
+size_t PageWrite(Page *page, const uint8_t *buf, size_t len);
 
 /**
  * @brief Reads bytes from a page
  *
+ * Reading continues from the end of the previous read. The read offset is
+ * saved by the next PageStateSave().
+ *
  * @param page Page reference
  * @param buf Pointer to buffer
  * @param buf_size Max number of bytes to write
- * @return Number of bytes written
+ * @return Number of bytes written, 0 once the page is read in full
  */
 size_t PageRead(Page *page, uint8_t *buf, size_t buf_size);
 
+/**
+ * @brief Moves measurements between the FIFO and pages
+ *
+ * Spills the oldest measurements of the FIFO to pages when above
+ * PAGE_HIGH_WATER, and restores measurements from pages when below
+ * PAGE_LOW_WATER. Blocks until the transfers are complete, call from the
+ * main context when external storage is available.
+ *
+ * @return FRAM_ERROR if external storage failed, otherwise see FramStatus
+ */
+FramStatus PageBalance(void);
+
+/**
+ * @brief Spills the oldest measurements of the FIFO to the back page
+ *
+ * Measurements are spilled until the fill level of the FIFO is at most
+ * target bytes.
+ *
+ * @param target Fill level of the FIFO in bytes
+ * @return FRAM_ERROR if external storage failed, FRAM_BUFFER_FULL if the
+ * pool of pages is exhausted, otherwise see FramStatus
+ */
+FramStatus PageSpill(FramAddr target);
+
+/**
+ * @brief Restores measurements from the front page to the FIFO
+ *
+ * Measurements are restored until the fill level of the FIFO is at least
+ * target bytes or all pages are read in full.
+ *
+ * @param target Fill level of the FIFO in bytes
+ * @return FRAM_ERROR if external storage failed, otherwise see FramStatus
+ */
+FramStatus PageRestore(FramAddr target);
+
 /**
  * @brief Get the number of elements in the linked list
  *
  * @return Number of elements in the linked list
  */
-inline size_t PageSize(void);
+size_t PageSize(void);
 
 /**
  * @brief Check if linked list is empty
  *
  * @return true if linked list is empty, false otherwise
  */
-inline bool PageEmpty(void);
+bool PageEmpty(void);
 
 /**
  * @brief Saves the current page state
  *
+ * @return See FramStatus
  */
-void PageStateSave(void);
+FramStatus PageStateSave(void);
 
 /**
  * @brief Load the current page state
  *
+ * Pages are loaded closed. The state is left unchanged if no valid state is
+ * saved.
+ *
+ * @return FRAM_ERROR if no valid state is saved, FRAM_OUT_OF_RANGE if the
+ * saved state is inconsistent, otherwise see FramStatus
  */
-void PageStateLoad(void);
+FramStatus PageStateLoad(void);
 
 /**
  * @}
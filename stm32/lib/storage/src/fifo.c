@@ -10,17 +10,78 @@
 
 #include "fifo.h"
 
+#include <stdbool.h>
+#include <string.h>
+
+#include "state_def.h"
 #include "sys_app.h"
 #include "usart.h"
 
-static const uint16_t FRAM_BUFFER_READ_ADDR = 0x06F0;   // 1776
-static const uint16_t FRAM_BUFFER_WRITE_ADDR = 0x06F2;  // 1778
-static const uint16_t FRAM_BUFFER_LEN_ADDR = 0x06F4;    // 1780
+/** Version of the layout of the saved buffer state */
+static const uint8_t kStateVersion = 2;
+
+/** Size of a single copy of the saved buffer state in bytes */
+#define STATE_SLOT_SIZE 16
+
+/** Number of copies of the saved buffer state */
+#define STATE_NUM_SLOTS 2
 
 // head and tail
-static uint16_t read_addr;
-static uint16_t write_addr;
-static uint16_t buffer_len;
+static FramAddr read_addr = FRAM_BUFFER_START;
+static FramAddr write_addr = FRAM_BUFFER_START;
+static uint32_t buffer_len = 0;
+
+/** Sequence number of the last saved buffer state */
+static uint8_t state_seq = 0;
+
+/** Staging ring of records waiting to be written to FRAM */
+static uint8_t staging[FRAM_STAGING_SIZE];
+/** Index of the oldest staged byte */
+static size_t staging_head = 0;
+/** Number of staged bytes, including those being flushed */
+static size_t staging_len = 0;
+/** Number of staged records, including those being flushed */
+static uint32_t staging_count = 0;
+/** Records were staged since the last flush was started */
+static bool staging_dirty = false;
+
+/** Flush is in progress */
+static volatile bool flush_active = false;
+/** Status of the last flush */
+static volatile FramStatus flush_status = FRAM_OK;
+/** Number of staged bytes in the flush */
+static size_t flush_total = 0;
+/** Number of staged records in the flush */
+static uint32_t flush_count = 0;
+/** Number of bytes of the flush that have been written */
+static size_t flush_done = 0;
+/** FRAM address of the next byte of the flush */
+static FramAddr flush_addr = FRAM_BUFFER_START;
+
+/** Called on completion of a flush */
+static FramCallback flush_callback = NULL;
+
+/** Buffer state being saved asynchronously */
+static uint8_t state_buffer[STATE_SLOT_SIZE];
+
+/** Status of the last asynchronous read */
+static volatile FramStatus read_status = FRAM_OK;
+
+/** Read address of the last batch returned by FramPeekBatch() */
+static FramAddr peek_addr = FRAM_BUFFER_START;
+/** Number of records in the last batch */
+static uint32_t peek_count = 0;
+/** Number of bytes in the last batch */
+static FramAddr peek_bytes = 0;
+/** Number of records of the last batch evicted by the retention policy */
+static uint32_t peek_evicted = 0;
+
+/** Retention policy once the buffer is full */
+static FifoPolicy policy = FIFO_POLICY_DEFAULT;
+/** Number of records discarded by each retention policy */
+static FifoDiscards discards = {0};
+/** Number of records put while full under FIFO_POLICY_DECIMATE */
+static uint32_t decimate_phase = 0;
 
 /**
  * @brief Updates circular buffer address based on number of bytes
@@ -28,8 +89,9 @@ static uint16_t buffer_len;
  * @param addr
  * @param num_bytes
  */
-static inline void update_addr(uint16_t *addr, const uint16_t num_bytes) {
-  *addr = (*addr + num_bytes) % kFramBufferSize;
+static inline void update_addr(FramAddr *addr, const FramAddr num_bytes) {
+  *addr = FRAM_BUFFER_START +
+          ((*addr - FRAM_BUFFER_START + num_bytes) % FramBufferSize());
 }
 
 /**
@@ -41,139 +103,959 @@ static inline void update_addr(uint16_t *addr, const uint16_t num_bytes) {
  *
  * @return Remaining space in bytes
  */
-static uint16_t get_remaining_space(void) {
-  uint16_t space_used = 0;
+static FramAddr get_remaining_space(void) {
+  const FramAddr buffer_size = FramBufferSize();
+  FramAddr space_used = 0;
   if (write_addr > read_addr) {
     space_used = write_addr - read_addr;
   } else if (write_addr < read_addr) {
-    space_used = kFramBufferSize - (read_addr - write_addr);
+    space_used = buffer_size - (read_addr - write_addr);
   } else {
     // if anything is stored in buffer than entire capacity is used
     // otherwise buffer is empty and all free space is available
     if (buffer_len > 0) {
-      space_used = kFramBufferSize;
+      space_used = buffer_size;
     } else {
       space_used = 0;
     }
   }
 
-  uint16_t remaining_space = kFramBufferSize - space_used;
+  FramAddr remaining_space = buffer_size - space_used;
   return remaining_space;
 }
 
-FramStatus FramPut(const uint8_t *data, const uint16_t num_bytes) {
-  // check remaining space
-  if (num_bytes > get_remaining_space()) {
-    return FRAM_BUFFER_FULL;
+FramAddr FramBufferSize(void) {
+  return (FramAddr)(FRAM_BUFFER_END) - (FramAddr)(FRAM_BUFFER_START) + 1;
+}
+
+/**
+ * @brief Encodes the header of a record
+ *
+ * @param header Destination of up to FRAM_RECORD_HEADER_MAX bytes
+ * @param type Type and flags of the record
+ * @param len Number of bytes of data
+ * @return Number of bytes of the header
+ */
+static size_t encode_header(uint8_t *header, uint8_t type, size_t len) {
+  size_t n = 0;
+  if (len < 0x80) {
+    header[n++] = (uint8_t)len;
+  } else {
+    header[n++] = (uint8_t)(len & 0x7F) | 0x80;
+    header[n++] = (uint8_t)(len >> 7);
   }
+  header[n++] = type;
+  return n;
+}
 
-  FramStatus status;
+/**
+ * @brief Encodes the header of a record into a reserved number of bytes
+ *
+ * A length that is shorter than reserved is padded with a continuation byte.
+ *
+ * @param header Destination of header_len bytes
+ * @param header_len Number of bytes reserved by encode_header()
+ * @param type Type and flags of the record
+ * @param len Number of bytes of data
+ */
+static void patch_header(uint8_t *header, size_t header_len, uint8_t type,
+                         size_t len) {
+  if (header_len == 2) {
+    header[0] = (uint8_t)len;
+  } else {
+    header[0] = (uint8_t)(len & 0x7F) | 0x80;
+    header[1] = (uint8_t)(len >> 7);
+  }
+  header[header_len - 1] = type;
+}
+
+/**
+ * @brief Decodes the header of a record
+ *
+ * @param buf Start of the record
+ * @param avail Number of bytes available in buf
+ * @param header_len Number of bytes of the header
+ * @param len Number of bytes of data
+ * @return FRAM_OUT_OF_RANGE if the header is incomplete, FRAM_ERROR if the
+ * length is invalid, otherwise FRAM_OK
+ */
+static FramStatus decode_header(const uint8_t *buf, size_t avail,
+                                size_t *header_len, size_t *len) {
+  if (avail < 1) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  size_t n = 1;
+  size_t value = buf[0] & 0x7F;
+  if (buf[0] & 0x80) {
+    if (avail < 2) {
+      return FRAM_OUT_OF_RANGE;
+    }
+    // lengths are at most 2 bytes
+    if (buf[1] & 0x80) {
+      return FRAM_ERROR;
+    }
+    value |= (size_t)buf[1] << 7;
+    n = 2;
+  }
 
-  // write single byte length to buffer
-  status = FramWrite(write_addr, (uint8_t *)&num_bytes, 1);
+  if (value > FRAM_RECORD_MAX_LEN) {
+    return FRAM_ERROR;
+  }
+
+  // type follows the length
+  if (avail < n + 1) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  *header_len = n + 1;
+  *len = value;
+  return FRAM_OK;
+}
+
+FramStatus FramRecordDecode(const uint8_t *buf, size_t len,
+                            FramRecord *record) {
+  size_t header_len = 0;
+  size_t data_len = 0;
+  record->size = 0;
+
+  FramStatus status = decode_header(buf, len, &header_len, &data_len);
   if (status != FRAM_OK) {
     return status;
   }
-  update_addr(&write_addr, 1);
 
-  // Write data to FRAM circular buffer
-  // if the data must wraparound, then make two writes
-  if (write_addr + num_bytes > (FRAM_BUFFER_END + 1)) {
-    // write up to the buffer end
-    uint8_t num_bytes_first_half = (FRAM_BUFFER_END + 1) - write_addr;
-    status = FramWrite(write_addr, data, num_bytes_first_half);
-    if (status != FRAM_OK) {
-      return status;
+  record->type = buf[header_len - 1];
+  record->data = buf + header_len;
+  record->len = data_len;
+  record->size = header_len + data_len + 1;
+
+  if (record->size > len) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  if (crc8(0, buf, record->size - 1) != buf[record->size - 1]) {
+    return FRAM_CORRUPT;
+  }
+
+  return FRAM_OK;
+}
+
+/**
+ * @brief Encodes a copy of the buffer state
+ *
+ * Layout of a copy
+ * [0] version, [1] sequence number, [2:5] read address,
+ * [6:9] write address, [10:13] buffer length, [14:15] CRC of [0:13]
+ *
+ * @param slot Destination of STATE_SLOT_SIZE bytes
+ * @param seq Sequence number
+ * @param read_addr Read address of the circular buffer
+ * @param write_addr Write address of the circular buffer
+ * @param buffer_len Length of the circular buffer
+ * @return Address of the copy in FRAM
+ */
+static FramAddr encode_state(uint8_t *slot, uint8_t seq, FramAddr read_addr,
+                             FramAddr write_addr, uint32_t buffer_len);
+
+/**
+ * @brief Completion of the asynchronous state save
+ *
+ * @param status Status of the write
+ */
+static void save_state_complete(FramStatus status) {
+  // the copy is only valid once written
+  if (status == FRAM_OK) {
+    ++state_seq;
+  }
+}
+
+/**
+ * @brief Saves the current buffer state without blocking
+ *
+ * @param callback Called on completion
+ * @return See FramWriteAsync
+ */
+static FramStatus save_state_async(FramCallback callback) {
+  FramAddr slot_addr = encode_state(state_buffer, state_seq + 1, read_addr,
+                                    write_addr, buffer_len);
+  return FramWriteAsync(slot_addr, state_buffer, sizeof(state_buffer),
+                        callback);
+}
+
+/**
+ * @brief Final step of a flush
+ *
+ * Runs in interrupt context. The buffer in RAM is updated by flush_reap()
+ * from the main context.
+ *
+ * @param status Status of the flush
+ */
+static void flush_end(FramStatus status) {
+  flush_status = status;
+  flush_active = false;
+
+  if (flush_callback != NULL) {
+    flush_callback(status);
+  }
+}
+
+/**
+ * @brief Completion of the state save of a flush
+ *
+ * @param status Status of the write
+ */
+static void flush_state_complete(FramStatus status) {
+  save_state_complete(status);
+  flush_end(status);
+}
+
+/**
+ * @brief Writes the next contiguous part of the flush
+ *
+ * A part ends at the end of the staging ring or the end of the buffer in
+ * FRAM, otherwise the flush is written with a single transfer. Once all
+ * records are written the buffer state is saved.
+ *
+ * @param status Status of the previous write
+ */
+static void flush_next(FramStatus status) {
+  if (status == FRAM_OK && flush_done < flush_total) {
+    size_t index = (staging_head + flush_done) % FRAM_STAGING_SIZE;
+    size_t len = flush_total - flush_done;
+    if (len > FRAM_STAGING_SIZE - index) {
+      len = FRAM_STAGING_SIZE - index;
+    }
+    if (len > (FRAM_BUFFER_END + 1) - flush_addr) {
+      len = (FRAM_BUFFER_END + 1) - flush_addr;
     }
-    update_addr(&write_addr, num_bytes_first_half);
-    // write from the buffer start
-    status = FramWrite(write_addr, data + num_bytes_first_half,
-                       num_bytes - num_bytes_first_half);
+
+    // update before starting since the callback may be called immediately
+    FramAddr addr = flush_addr;
+    flush_done += len;
+    update_addr(&flush_addr, len);
+
+    status = FramWriteAsync(addr, staging + index, len, flush_next);
+    if (status == FRAM_OK) {
+      return;
+    }
+  } else if (status == FRAM_OK) {
+    FramAddr slot_addr =
+        encode_state(state_buffer, state_seq + 1, read_addr, flush_addr,
+                     buffer_len + flush_count);
+    status = FramWriteAsync(slot_addr, state_buffer, sizeof(state_buffer),
+                            flush_state_complete);
+    if (status == FRAM_OK) {
+      return;
+    }
+  }
+
+  flush_end(status);
+}
+
+/**
+ * @brief Applies a completed flush to the buffer in RAM
+ *
+ * On failure the records remain staged and are retried by the next flush.
+ */
+static void flush_reap(void) {
+  if (flush_active || flush_total == 0) {
+    return;
+  }
+
+  if (flush_status == FRAM_OK) {
+    write_addr = flush_addr;
+    buffer_len += flush_count;
+    staging_head = (staging_head + flush_total) % FRAM_STAGING_SIZE;
+    staging_len -= flush_total;
+    staging_count -= flush_count;
+  }
+
+  flush_total = 0;
+  flush_count = 0;
+}
+
+FramStatus FramFlushAsync(void) {
+  flush_reap();
+
+  if (flush_active || FramBusy()) {
+    return FRAM_BUSY;
+  }
+
+  if (staging_len == 0) {
+    return FRAM_OK;
+  }
+
+  flush_total = staging_len;
+  flush_count = staging_count;
+  flush_done = 0;
+  flush_addr = write_addr;
+  flush_status = FRAM_OK;
+  flush_active = true;
+  staging_dirty = false;
+
+  flush_next(FRAM_OK);
+
+  return FRAM_OK;
+}
+
+FramStatus FramFlush(void) {
+  do {
+    FramWaitIdle();
+
+    FramStatus status = FramFlushAsync();
     if (status != FRAM_OK) {
       return status;
     }
-    update_addr(&write_addr, num_bytes - num_bytes_first_half);
-  } else {
-    status = FramWrite(write_addr, data, num_bytes);
+
+    // the core sleeps between the transfers of the flush
+    while (flush_active) {
+      FramWaitIdle();
+    }
+
+    flush_reap();
+    if (flush_status != FRAM_OK) {
+      return flush_status;
+    }
+  } while (staging_len > 0);
+
+  return FRAM_OK;
+}
+
+bool FramFlushPending(void) { return staging_dirty; }
+
+size_t FramStagedLen(void) {
+  flush_reap();
+  return staging_len;
+}
+
+/**
+ * @brief Reads bytes, sleeping while the transfer is in progress
+ *
+ * @param addr Address of read
+ * @param len Number of sequential bytes to read
+ * @param data Array to be read into
+ * @return See FramStatus
+ */
+static FramStatus read_sleep(FramAddr addr, size_t len, uint8_t *data);
+
+static FramStatus read_wrapped(FramAddr addr, size_t len, uint8_t *data);
+
+/**
+ * @brief Reads the size of the record at an address
+ *
+ * Only the header of the record is read.
+ *
+ * @param addr Address of the record
+ * @param size Number of bytes of the stored record
+ * @return FRAM_ERROR if the length is invalid, otherwise see FramStatus
+ */
+static FramStatus read_record_size(FramAddr addr, FramAddr *size) {
+  // the smallest record is as long as the longest header
+  uint8_t header[FRAM_RECORD_HEADER_MAX];
+  FramStatus status = read_wrapped(addr, sizeof(header), header);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  size_t header_len = 0;
+  size_t len = 0;
+  status = decode_header(header, sizeof(header), &header_len, &len);
+  if (status != FRAM_OK) {
+    return FRAM_ERROR;
+  }
+
+  *size = header_len + len + 1;
+  return FRAM_OK;
+}
+
+/**
+ * @brief Clears the buffer after finding a record with an invalid length
+ *
+ * Records following an invalid length cannot be found, so all records are
+ * counted as discarded.
+ *
+ * @return FRAM_ERROR
+ */
+static FramStatus discard_desync(void) {
+  discards.corrupt += buffer_len;
+  FramBufferClear();
+  return FRAM_ERROR;
+}
+
+/**
+ * @brief Evicts the oldest records until a record fits in the buffer
+ *
+ * Staged records are flushed first so all records are in FRAM. Only the
+ * header of each evicted record is read. The buffer state is saved before
+ * returning so the evicted space is not reused with a stale state.
+ *
+ * @param record_len Length of the record including its header and CRC
+ * @param counter Incremented for every evicted record
+ * @return See FramStatus
+ */
+static FramStatus evict_oldest(size_t record_len, uint32_t *counter) {
+  FramStatus status = FramFlush();
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  bool evicted = false;
+  while (record_len > get_remaining_space()) {
+    FramAddr size = 0;
+    status = read_record_size(read_addr, &size);
+    if (status == FRAM_ERROR) {
+      return discard_desync();
+    } else if (status != FRAM_OK) {
+      break;
+    }
+
+    // evicted records of the last batch are not committed again
+    if (peek_count > 0 && peek_addr == read_addr) {
+      update_addr(&peek_addr, size);
+      --peek_count;
+      peek_bytes -= size;
+      ++peek_evicted;
+    }
+
+    update_addr(&read_addr, size);
+    --buffer_len;
+    ++(*counter);
+    evicted = true;
+  }
+
+  if (evicted) {
+    FramStatus save_status =
+        FramSaveBufferState(read_addr, write_addr, buffer_len);
+    if (status == FRAM_OK) {
+      status = save_status;
+    }
+  }
+
+  return status;
+}
+
+/**
+ * @brief Applies the retention policy to make room for a record
+ *
+ * @param record_len Length of the record including its header and CRC
+ * @return FRAM_BUFFER_FULL if the record is refused, otherwise see FramStatus
+ */
+static FramStatus make_room(size_t record_len) {
+  // a record larger than the buffer never fits
+  if (record_len > FramBufferSize()) {
+    return FRAM_BUFFER_FULL;
+  }
+
+  switch (policy) {
+    case FIFO_POLICY_DROP_OLD:
+      return evict_oldest(record_len, &discards.drop_old);
+    case FIFO_POLICY_DECIMATE:
+      if (++decimate_phase % FIFO_DECIMATE_FACTOR != 0) {
+        ++discards.decimate;
+        return FRAM_BUFFER_FULL;
+      }
+      return evict_oldest(record_len, &discards.decimate);
+    case FIFO_POLICY_DROP_NEW:
+    default:
+      ++discards.drop_new;
+      return FRAM_BUFFER_FULL;
+  }
+}
+
+/**
+ * @brief Copies bytes into the staging ring, wrapping around its end
+ *
+ * @param index Index in the staging ring to copy to
+ * @param data Bytes to copy
+ * @param len Number of bytes
+ * @return Index following the copied bytes
+ */
+static size_t ring_copy(size_t index, const uint8_t *data, size_t len) {
+  size_t first = FRAM_STAGING_SIZE - index;
+  if (first > len) {
+    first = len;
+  }
+  memcpy(staging + index, data, first);
+  memcpy(staging, data + first, len - first);
+  return (index + len) % FRAM_STAGING_SIZE;
+}
+
+/**
+ * @brief Updates a CRC-8 with bytes of the staging ring
+ *
+ * @param crc CRC of the preceding bytes
+ * @param index Index in the staging ring of the first byte
+ * @param len Number of bytes
+ * @return CRC including the bytes
+ */
+static uint8_t ring_crc8(uint8_t crc, size_t index, size_t len) {
+  size_t first = FRAM_STAGING_SIZE - index;
+  if (first > len) {
+    first = len;
+  }
+  crc = crc8(crc, staging + index, first);
+  return crc8(crc, staging, len - first);
+}
+
+/**
+ * @brief Adds a record that was written to the end of the staging ring
+ *
+ * @param record_len Number of bytes of the record
+ */
+static void stage_commit(size_t record_len) {
+  staging_len += record_len;
+  ++staging_count;
+  staging_dirty = true;
+
+  // write in the background once the high-water mark is reached, the flush
+  // is retried later if the FRAM is busy
+  if (staging_len >= FRAM_STAGING_HIGH_WATER) {
+    FramFlushAsync();
+  }
+}
+
+/** Index in the staging ring of the next byte of the stream */
+static size_t stream_index = 0;
+
+/**
+ * @brief Writes bytes of a stream of FramPutStream() to the staging ring
+ *
+ * The stream checks the number of bytes against the reserved space.
+ *
+ * @param stream Output stream
+ * @param buf Bytes to write
+ * @param count Number of bytes
+ * @return true
+ */
+static bool stream_write(pb_ostream_t *stream, const pb_byte_t *buf,
+                         size_t count) {
+  (void)stream;
+  stream_index = ring_copy(stream_index, buf, count);
+  return true;
+}
+
+/**
+ * @brief Makes room for a record in the buffer and the staging ring
+ *
+ * @param record_len Number of bytes of the record
+ * @return FRAM_BUFFER_FULL if the record is refused, otherwise see FramStatus
+ */
+static FramStatus reserve(size_t record_len) {
+  // check remaining space, including staged records
+  if (record_len + staging_len > get_remaining_space()) {
+    FramStatus status = make_room(record_len);
     if (status != FRAM_OK) {
       return status;
     }
-    update_addr(&write_addr, num_bytes);
   }
 
-  // increment buffer length
-  ++buffer_len;
+  // make room in the staging ring
+  if (record_len > FRAM_STAGING_SIZE - staging_len) {
+    return FramFlush();
+  }
 
-  FramSaveBufferState(read_addr, write_addr, buffer_len);
   return FRAM_OK;
 }
 
-FramStatus FramGet(uint8_t *data, uint8_t *len) {
-  // Check if buffer is empty
-  if (buffer_len == 0) {
-    return FRAM_BUFFER_EMPTY;
+FramStatus FramPutRecord(uint8_t type, const uint8_t *data,
+                         const size_t num_bytes) {
+  flush_reap();
+
+  if (num_bytes > FRAM_RECORD_MAX_LEN) {
+    return FRAM_OUT_OF_RANGE;
   }
 
-  FramStatus status;
+  uint8_t header[FRAM_RECORD_HEADER_MAX];
+  const size_t header_len = encode_header(header, type, num_bytes);
 
-  status = FramRead(read_addr, 1, len);
+  // the overhead is the header and the CRC
+  const size_t record_len = header_len + num_bytes + 1;
+  FramStatus status = reserve(record_len);
   if (status != FRAM_OK) {
     return status;
   }
-  update_addr(&read_addr, 1);
 
-  // Read data from FRAM circular buffer
+  // copy the record so the caller can reuse data
+  const uint8_t crc = crc8(crc8(0, header, header_len), data, num_bytes);
+  size_t index = (staging_head + staging_len) % FRAM_STAGING_SIZE;
+  index = ring_copy(index, header, header_len);
+  index = ring_copy(index, data, num_bytes);
+  ring_copy(index, &crc, 1);
+  stage_commit(record_len);
+
+  return FRAM_OK;
+}
+
+FramStatus FramPutStream(uint8_t type, size_t max_len,
+                         FramStreamEncoder encoder, void *arg) {
+  flush_reap();
+
+  if (max_len > FRAM_RECORD_MAX_LEN) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  // the number of bytes of the length is set by the largest record
+  uint8_t header[FRAM_RECORD_HEADER_MAX];
+  const size_t header_len = encode_header(header, type, max_len);
+
+  FramStatus status = reserve(header_len + max_len + 1);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  // encode after the header, a flush in progress only reads staged bytes
+  const size_t start = (staging_head + staging_len) % FRAM_STAGING_SIZE;
+  stream_index = (start + header_len) % FRAM_STAGING_SIZE;
+  pb_ostream_t stream = {.callback = stream_write, .max_size = max_len};
+  if (!encoder(&stream, arg)) {
+    return FRAM_ERROR;
+  }
+
+  // back-patch the length now that it is known
+  const size_t len = stream.bytes_written;
+  patch_header(header, header_len, type, len);
+  ring_copy(start, header, header_len);
+
+  const uint8_t crc = ring_crc8(0, start, header_len + len);
+  ring_copy(stream_index, &crc, 1);
+  stage_commit(header_len + len + 1);
+
+  return FRAM_OK;
+}
+
+FramStatus FramPut(const uint8_t *data, const size_t num_bytes) {
+  return FramPutRecord(FRAM_RECORD_MEASUREMENT, data, num_bytes);
+}
+
+void FramSetFlushCallback(FramCallback callback) { flush_callback = callback; }
+
+void FramSetPolicy(FifoPolicy new_policy) {
+  policy = new_policy;
+  decimate_phase = 0;
+}
+
+FifoPolicy FramGetPolicy(void) { return policy; }
+
+void FramGetDiscards(FifoDiscards *out) { *out = discards; }
+
+void FramResetDiscards(void) { memset(&discards, 0, sizeof(discards)); }
+
+/**
+ * @brief Completion of an asynchronous read
+ *
+ * @param status Status of the read
+ */
+static void read_complete(FramStatus status) { read_status = status; }
+
+static FramStatus read_sleep(FramAddr addr, size_t len, uint8_t *data) {
+  FramWaitIdle();
+
+  read_status = FRAM_OK;
+  FramStatus status = FramReadAsync(addr, len, data, read_complete);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  FramWaitIdle();
+  return read_status;
+}
+
+/**
+ * @brief Reads from the circular buffer, wrapping around the buffer end
+ *
+ * @param addr Address within the buffer to start reading from
+ * @param len Number of bytes to read
+ * @param data Array to be read into
+ * @return See FramStatus
+ */
+static FramStatus read_wrapped(FramAddr addr, size_t len, uint8_t *data) {
   // if the data must wraparound, then make two reads
-  if (read_addr + *len > (FRAM_BUFFER_END + 1)) {
-    // read up to the buffer end
-    uint8_t len_first_half = (FRAM_BUFFER_END + 1) - read_addr;
-    status = FramRead(read_addr, len_first_half, data);
+  if (addr + len > (FRAM_BUFFER_END + 1)) {
+    FramAddr len_first_half = (FRAM_BUFFER_END + 1) - addr;
+    FramStatus status = read_sleep(addr, len_first_half, data);
     if (status != FRAM_OK) {
       return status;
     }
-    update_addr(&read_addr, len_first_half);
-    // read from the buffer start
-    status = FramRead(read_addr, *len - len_first_half, data + len_first_half);
+    return read_sleep(FRAM_BUFFER_START, len - len_first_half,
+                      data + len_first_half);
+  }
+
+  return read_sleep(addr, len, data);
+}
+
+FramStatus FramGetRecord(uint8_t *type, uint8_t *data, const size_t size,
+                         size_t *len) {
+  // staged records are read from FRAM
+  FramStatus status = FramFlush();
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  bool skipped = false;
+  while (buffer_len > 0) {
+    uint8_t header[FRAM_RECORD_HEADER_MAX];
+    status = read_wrapped(read_addr, sizeof(header), header);
     if (status != FRAM_OK) {
       return status;
     }
-    update_addr(&read_addr, *len - len_first_half);
-  } else {
-    status = FramRead(read_addr, *len, data);
+
+    size_t header_len = 0;
+    size_t data_len = 0;
+    if (decode_header(header, sizeof(header), &header_len, &data_len) !=
+        FRAM_OK) {
+      return discard_desync();
+    }
+
+    if (data_len > size) {
+      status = FRAM_OUT_OF_RANGE;
+      break;
+    }
+
+    // read the data and the CRC
+    FramAddr data_addr = read_addr;
+    update_addr(&data_addr, header_len);
+    if (data_len > 0) {
+      status = read_wrapped(data_addr, data_len, data);
+      if (status != FRAM_OK) {
+        return status;
+      }
+    }
+
+    FramAddr crc_addr = data_addr;
+    update_addr(&crc_addr, data_len);
+    uint8_t crc = 0;
+    status = read_sleep(crc_addr, 1, &crc);
     if (status != FRAM_OK) {
       return status;
     }
-    update_addr(&read_addr, *len);
+
+    update_addr(&read_addr, header_len + data_len + 1);
+    --buffer_len;
+
+    // skip a corrupted record and continue with the next one
+    if (crc8(crc8(0, header, header_len), data, data_len) != crc) {
+      ++discards.corrupt;
+      skipped = true;
+      continue;
+    }
+
+    if (type != NULL) {
+      *type = header[header_len - 1];
+    }
+    *len = data_len;
+    return save_state_async(save_state_complete);
+  }
+
+  if (skipped) {
+    save_state_async(save_state_complete);
+  }
+
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  return FRAM_BUFFER_EMPTY;
+}
+
+FramStatus FramGet(uint8_t *data, const size_t size, size_t *len) {
+  return FramGetRecord(NULL, data, size, len);
+}
+
+FramStatus FramPeekBatch(uint8_t *data, size_t max_bytes, uint32_t *count) {
+  *count = 0;
+
+  // staged records are read from FRAM
+  FramStatus status = FramFlush();
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  if (buffer_len == 0) {
+    return FRAM_BUFFER_EMPTY;
+  }
+
+  // read everything that is stored, up to the size of the array
+  FramAddr space_used = FramBufferSize() - get_remaining_space();
+  size_t len = (space_used < max_bytes) ? space_used : max_bytes;
+
+  status = read_wrapped(read_addr, len, data);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  // count the records that were read in full, corrupted records are left
+  // for the caller to skip
+  size_t offset = 0;
+  while (*count < buffer_len && offset < len) {
+    FramRecord record;
+    status = FramRecordDecode(data + offset, len - offset, &record);
+    if (status != FRAM_OK && status != FRAM_CORRUPT) {
+      break;
+    }
+    offset += record.size;
+    ++(*count);
   }
 
-  // Decrement buffer length
-  --buffer_len;
+  if (*count == 0) {
+    // records after an invalid length cannot be found
+    if (status == FRAM_ERROR) {
+      return discard_desync();
+    }
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  peek_addr = read_addr;
+  peek_count = *count;
+  peek_bytes = offset;
+  peek_evicted = 0;
 
-  FramSaveBufferState(read_addr, write_addr, buffer_len);
   return FRAM_OK;
 }
 
-uint16_t FramBufferLen(void) { return buffer_len; }
+size_t FramPackBatch(const uint8_t *batch, size_t batch_len, uint32_t *count,
+                     uint8_t *out, size_t out_size) {
+  size_t offset = 0;
+  size_t packed = 0;
+  uint32_t consumed = 0;
+
+  while (consumed < *count) {
+    FramRecord record;
+    FramStatus status =
+        FramRecordDecode(batch + offset, batch_len - offset, &record);
+    if (status == FRAM_CORRUPT) {
+      offset += record.size;
+      ++consumed;
+      continue;
+    } else if (status != FRAM_OK || record.type != FRAM_RECORD_MEASUREMENT) {
+      break;
+    }
+
+    // the length prefix is the header without the type
+    uint8_t header[FRAM_RECORD_HEADER_MAX];
+    const size_t prefix_len = encode_header(header, 0, record.len) - 1;
+    if (packed + prefix_len + record.len > out_size) {
+      break;
+    }
+
+    // the packed record is shorter than the stored record, so the output
+    // never passes the input
+    memmove(out + packed, header, prefix_len);
+    memmove(out + packed + prefix_len, record.data, record.len);
+    packed += prefix_len + record.len;
+    offset += record.size;
+    ++consumed;
+  }
+
+  *count = consumed;
+  return packed;
+}
+
+FramStatus FramCommit(uint32_t count) {
+  // staged records are read from FRAM
+  FramStatus status = FramFlush();
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  // records of the last batch that were evicted are already removed
+  const uint32_t evicted = (count < peek_evicted) ? count : peek_evicted;
+  count -= evicted;
+  peek_evicted -= evicted;
+
+  if (count > buffer_len) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  if (count == 0) {
+    return FRAM_OK;
+  }
+
+  FramAddr num_bytes = 0;
+  if (peek_addr == read_addr && count == peek_count) {
+    // size of the batch is known from FramPeekBatch()
+    num_bytes = peek_bytes;
+  } else {
+    // walk the length of each record
+    FramAddr addr = read_addr;
+    for (uint32_t i = 0; i < count; i++) {
+      FramAddr size = 0;
+      status = read_record_size(addr, &size);
+      if (status == FRAM_ERROR) {
+        return discard_desync();
+      } else if (status != FRAM_OK) {
+        return status;
+      }
+      update_addr(&addr, size);
+      num_bytes += size;
+    }
+  }
+
+  update_addr(&read_addr, num_bytes);
+  buffer_len -= count;
+  peek_count = 0;
+
+  return save_state_async(save_state_complete);
+}
+
+uint32_t FramBufferLen(void) {
+  flush_reap();
+  return buffer_len + staging_count;
+}
+
+FramAddr FramBufferUsed(void) {
+  flush_reap();
+  return FramBufferSize() - get_remaining_space() + staging_len;
+}
 
 FramStatus FramBufferClear(void) {
+  // wait for a flush in progress then discard staged records
+  while (flush_active) {
+    FramWaitIdle();
+  }
+  FramWaitIdle();
+  flush_reap();
+  staging_head = 0;
+  staging_len = 0;
+  staging_count = 0;
+  staging_dirty = false;
+
   // Set read and write addresses to their default values
   read_addr = FRAM_BUFFER_START;
   write_addr = FRAM_BUFFER_START;
 
   // reset buffer len
   buffer_len = 0;
-  FramSaveBufferState(read_addr, write_addr, buffer_len);
+  peek_count = 0;
+  peek_evicted = 0;
 
-  return FRAM_OK;
+  return FramSaveBufferState(read_addr, write_addr, buffer_len);
 }
 
 FramStatus FIFO_Init(void) {
-  FramStatus status = FramLoadBufferState(&read_addr, &write_addr, &buffer_len);
+  // persist staged records before reloading the state
+  FramStatus status = FramFlush();
   if (status != FRAM_OK) {
-    // APP_PRINTF("Failed to load FIFO state. FRAM Status: %d\n", status);
-    // If loading the buffer state fails, assume it's an empty state
-    // APP_PRINTF("Initialized to empty buffer state.\n");
+    return status;
+  }
+
+  status = FramLoadBufferState(&read_addr, &write_addr, &buffer_len);
+
+  // a valid state from a different buffer configuration can point outside of
+  // the buffer
+  if (status == FRAM_OK &&
+      (read_addr < FRAM_BUFFER_START || read_addr > FRAM_BUFFER_END ||
+       write_addr < FRAM_BUFFER_START || write_addr > FRAM_BUFFER_END ||
+       buffer_len > FramBufferSize())) {
+    status = FRAM_CORRUPT;
+  }
+
+  if (status == FRAM_CORRUPT) {
+    // no usable state, such as on the first boot, so start with an empty
+    // buffer
     return FramBufferClear();
+  } else if (status != FRAM_OK) {
+    // the saved state is kept on read errors so the backlog can be resumed
+    return status;
   } else {
     if (read_addr == FRAM_BUFFER_START && write_addr == FRAM_BUFFER_START &&
         buffer_len == 0) {
@@ -185,70 +1067,90 @@ FramStatus FIFO_Init(void) {
   return FRAM_OK;
 }
 
-FramStatus FramSaveBufferState(uint16_t read_addr, uint16_t write_addr,
-                               uint16_t buffer_len) {
-  uint8_t *read_addr_bytes = (uint8_t *)&read_addr;
-  uint8_t *write_addr_bytes = (uint8_t *)&write_addr;
-  uint8_t *buffer_len_bytes = (uint8_t *)&buffer_len;
-
-  // Save read_addr
-  FramStatus status =
-      FramWrite(FRAM_BUFFER_READ_ADDR, read_addr_bytes, sizeof(read_addr));
-  if (status != FRAM_OK) {
-    // APP_PRINTF("Failed to save read address. FRAM Status: %d\n", status);
-    return status;
+/**
+ * @brief Checks if a copy of the saved buffer state is valid
+ *
+ * @param slot Copy of the buffer state
+ * @return true if the version and CRC match, false otherwise
+ */
+static bool state_slot_valid(const uint8_t *slot) {
+  if (slot[0] != kStateVersion) {
+    return false;
   }
 
-  // Save write_addr
-  status =
-      FramWrite(FRAM_BUFFER_WRITE_ADDR, write_addr_bytes, sizeof(write_addr));
+  uint16_t crc = (uint16_t)slot[14] | ((uint16_t)slot[15] << 8);
+  return crc == crc16(slot, STATE_SLOT_SIZE - 2);
+}
+
+static FramAddr encode_state(uint8_t *slot, uint8_t seq, FramAddr read_addr,
+                             FramAddr write_addr, uint32_t buffer_len) {
+  slot[0] = kStateVersion;
+  slot[1] = seq;
+  store_u32(slot + 2, read_addr);
+  store_u32(slot + 6, write_addr);
+  store_u32(slot + 10, buffer_len);
+  uint16_t crc = crc16(slot, STATE_SLOT_SIZE - 2);
+  slot[14] = crc & 0xFF;
+  slot[15] = (crc >> 8) & 0xFF;
+
+  // alternate between copies so the previous state remains intact if the
+  // write is interrupted
+  return FRAM_FIFO_STATE_ADDR + (seq % STATE_NUM_SLOTS) * STATE_SLOT_SIZE;
+}
+
+FramStatus FramSaveBufferState(FramAddr read_addr, FramAddr write_addr,
+                               uint32_t buffer_len) {
+  uint8_t slot[STATE_SLOT_SIZE];
+
+  // an asynchronous save in progress updates the sequence number
+  FramWaitIdle();
+
+  uint8_t seq = state_seq + 1;
+  FramAddr slot_addr =
+      encode_state(slot, seq, read_addr, write_addr, buffer_len);
+
+  FramStatus status = FramWrite(slot_addr, slot, sizeof(slot));
   if (status != FRAM_OK) {
-    // APP_PRINTF("Failed to save write address. FRAM Status: %d\n", status);
     return status;
   }
 
-  // Save buffer_len
-  status =
-      FramWrite(FRAM_BUFFER_LEN_ADDR, buffer_len_bytes, sizeof(buffer_len));
+  state_seq = seq;
+
+  return FRAM_OK;
+}
+
+FramStatus FramLoadBufferState(FramAddr *read_addr, FramAddr *write_addr,
+                               uint32_t *buffer_len) {
+  uint8_t slots[STATE_NUM_SLOTS][STATE_SLOT_SIZE];
+
+  // read all copies at once
+  FramStatus status =
+      FramRead(FRAM_FIFO_STATE_ADDR, sizeof(slots), (uint8_t *)slots);
   if (status != FRAM_OK) {
-    // APP_PRINTF("Failed to save buffer length. FRAM Status: %d\n", status);
     return status;
   }
 
-  // Print a single message summarizing the saved buffer state
-  // APP_PRINTF(
-  //     "Buffer State Saved Successfully. Read Address: 0x%04X (%d), Write "
-  //     "Address: 0x%04X (%d), Buffer Length: %d\n",
-  //     read_addr, read_addr, write_addr, write_addr, buffer_len);
+  // find the valid copy with the latest sequence number
+  const uint8_t *latest = NULL;
+  for (int i = 0; i < STATE_NUM_SLOTS; i++) {
+    if (!state_slot_valid(slots[i])) {
+      continue;
+    }
 
-  return status;
-}
+    // sequence number wraps around
+    if (latest == NULL || (int8_t)(slots[i][1] - latest[1]) > 0) {
+      latest = slots[i];
+    }
+  }
+
+  if (latest == NULL) {
+    return FRAM_CORRUPT;
+  }
 
-FramStatus FramLoadBufferState(uint16_t *read_addr, uint16_t *write_addr,
-                               uint16_t *buffer_len) {
-  FramStatus status;
-
-  // Load read_addr and print each byte
-  status =
-      FramRead(FRAM_BUFFER_READ_ADDR, sizeof(*read_addr), (uint8_t *)read_addr);
-  if (status != FRAM_OK) return status;
-  // APP_PRINTF("Loaded Read Address: 0x%02X 0x%02X (%d)\n", ((uint8_t
-  // *)read_addr)[0],
-  //       ((uint8_t *)read_addr)[1], *read_addr);
-
-  // Load write_addr and print each byte
-  status = FramRead(FRAM_BUFFER_WRITE_ADDR, sizeof(*write_addr),
-                    (uint8_t *)write_addr);
-  if (status != FRAM_OK) return status;
-  // APP_PRINTF("Loaded Write Address: 0x%02X 0x%02X (%d)\n",
-  //       ((uint8_t *)write_addr)[0], ((uint8_t *)write_addr)[1], *write_addr);
-
-  // Load buffer_len and print each byte
-  status = FramRead(FRAM_BUFFER_LEN_ADDR, sizeof(*buffer_len),
-                    (uint8_t *)buffer_len);
-  if (status != FRAM_OK) return status;
-  // APP_PRINTF("Loaded Buffer Length: 0x%02X 0x%02X (%d)\n",
-  //       ((uint8_t *)buffer_len)[0], ((uint8_t *)buffer_len)[1], *buffer_len);
+  state_seq = latest[1];
+  *read_addr = load_u32(latest + 2);
+  *write_addr = load_u32(latest + 6);
+  *buffer_len = load_u32(latest + 10);
 
   return FRAM_OK;
 }
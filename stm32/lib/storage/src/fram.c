@@ -1,6 +1,8 @@
 #include "fram.h"
 
 #include "fram_def.h"
+#include "stm32_lpm.h"
+#include "utilities_def.h"
 
 // #define FRAM_FM24CL16B
 // #define FRAM_MB85RC1MT
@@ -11,22 +13,34 @@
 #include "fm24cl16b.h"
 const FramInterfaceType FramInterface = {.WritePtr = Fm24cl16bWrite,
                                          .ReadPtr = Fm24cl16bRead,
+                                         .WriteAsyncPtr = NULL,
+                                         .ReadAsyncPtr = NULL,
                                          .size = fm24cl16b_size};
 #elif defined(FRAM_MB85RC1MT)
 #include "mb85rc1mt.h"
 const FramInterfaceType FramInterface = {.WritePtr = Mb85rc1mtWrite,
                                          .ReadPtr = Mb85rc1mtRead,
+                                         .WriteAsyncPtr = Mb85rc1mtWriteAsync,
+                                         .ReadAsyncPtr = Mb85rc1mtReadAsync,
                                          .size = mb85rc1mt_size};
 #else
 #error No FRAM chip enabled
 #endif
 
+/** Flag for an asynchronous transfer in progress */
+static volatile bool async_busy = false;
+
+/** Callback of the asynchronous transfer in progress */
+static FramCallback async_callback = NULL;
+
 FramStatus FramWrite(FramAddr addr, const uint8_t *data, size_t len) {
   // check size
   if (addr + len > FramSize()) {
     return FRAM_OUT_OF_RANGE;
   }
 
+  FramWaitIdle();
+
   return FramInterface.WritePtr(addr, data, len);
 }
 
@@ -36,9 +50,122 @@ FramStatus FramRead(FramAddr addr, size_t len, uint8_t *data) {
     return FRAM_OUT_OF_RANGE;
   }
 
+  FramWaitIdle();
+
   return FramInterface.ReadPtr(addr, len, data);
 }
 
+/**
+ * @brief Marks the start of an asynchronous transfer
+ *
+ * @param callback Callback of the transfer
+ * @return FRAM_BUSY if a transfer is already in progress
+ */
+static FramStatus AsyncBegin(FramCallback callback) {
+  if (async_busy) {
+    return FRAM_BUSY;
+  }
+
+  async_busy = true;
+  async_callback = callback;
+
+  // I2C is not clocked in STOP mode
+  UTIL_LPM_SetStopMode((1 << CFG_LPM_FRAM_Id), UTIL_LPM_DISABLE);
+
+  return FRAM_OK;
+}
+
+/**
+ * @brief Marks the end of an asynchronous transfer
+ *
+ * Passed to the driver as the completion callback.
+ *
+ * @param status Status of the transfer
+ */
+static void AsyncEnd(FramStatus status) {
+  FramCallback callback = async_callback;
+  async_callback = NULL;
+  async_busy = false;
+
+  UTIL_LPM_SetStopMode((1 << CFG_LPM_FRAM_Id), UTIL_LPM_ENABLE);
+
+  // called last, the callback can start the next transfer
+  if (callback != NULL) {
+    callback(status);
+  }
+}
+
+FramStatus FramWriteAsync(FramAddr addr, const uint8_t *data, size_t len,
+                          FramCallback callback) {
+  // check size
+  if (addr + len > FramSize()) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  FramStatus status = AsyncBegin(callback);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  if (FramInterface.WriteAsyncPtr == NULL) {
+    // chip does not support asynchronous transfers
+    status = FramInterface.WritePtr(addr, data, len);
+    if (status == FRAM_OK) {
+      AsyncEnd(status);
+    }
+  } else {
+    status = FramInterface.WriteAsyncPtr(addr, data, len, AsyncEnd);
+  }
+
+  // transfer did not start
+  if (status != FRAM_OK) {
+    async_callback = NULL;
+    AsyncEnd(status);
+  }
+
+  return status;
+}
+
+FramStatus FramReadAsync(FramAddr addr, size_t len, uint8_t *data,
+                         FramCallback callback) {
+  // check size
+  if (addr + len > FramSize()) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  FramStatus status = AsyncBegin(callback);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  if (FramInterface.ReadAsyncPtr == NULL) {
+    // chip does not support asynchronous transfers
+    status = FramInterface.ReadPtr(addr, len, data);
+    if (status == FRAM_OK) {
+      AsyncEnd(status);
+    }
+  } else {
+    status = FramInterface.ReadAsyncPtr(addr, len, data, AsyncEnd);
+  }
+
+  // transfer did not start
+  if (status != FRAM_OK) {
+    async_callback = NULL;
+    AsyncEnd(status);
+  }
+
+  return status;
+}
+
+bool FramBusy(void) { return async_busy; }
+
+void FramWaitIdle(void) {
+  while (async_busy) {
+    // woken up by the transfer complete interrupt
+    __WFI();
+  }
+}
+
 FramAddr FramSize(void) { return FramInterface.size; }
 
 HAL_StatusTypeDef ConfigureSettings(configuration c) {
@@ -58,13 +185,13 @@ configuration ReadSettings(void) {
 }
 
 FramStatus FramDump(uint16_t linesize, uint8_t displayformat, uint8_t omitjunk,
-                    uint8_t printdelay_ms, uint16_t startaddress,
-                    uint16_t endaddress) {
+                    uint8_t printdelay_ms, FramAddr startaddress,
+                    FramAddr endaddress) {
   FramStatus returnstatus = FRAM_OK;
 
-  const uint16_t startaddress_aligned =
+  const FramAddr startaddress_aligned =
       startaddress - (startaddress % linesize);
-  const uint16_t endaddress_aligned =
+  const FramAddr endaddress_aligned =
       endaddress + (linesize - (endaddress % linesize)) - 1;
 
   // DUMP FRAM
@@ -125,7 +252,7 @@ FramStatus FramDump(uint16_t linesize, uint8_t displayformat, uint8_t omitjunk,
   FramStatus framdumpstatus;
   uint8_t printcurrentline, printcurrentline_prev = 1;
   uint8_t patternmatch;
-  uint16_t omittedlinestart = 0;
+  FramAddr omittedlinestart = 0;
   for (int line = startaddress_aligned / linesize;
        line <= (endaddress_aligned / linesize); line++) {
     framdumpstatus = FramRead(line * linesize, linesize, framdumpbuffer);
@@ -36,11 +36,22 @@ typedef FramStatus (*FramWritePtrType)(FramAddr addr, const uint8_t *data,
 
 typedef FramStatus (*FramReadPtrType)(FramAddr addr, size_t len, uint8_t *data);
 
+typedef FramStatus (*FramWriteAsyncPtrType)(FramAddr addr, const uint8_t *data,
+                                            size_t len, FramCallback callback);
+
+typedef FramStatus (*FramReadAsyncPtrType)(FramAddr addr, size_t len,
+                                           uint8_t *data,
+                                           FramCallback callback);
+
 typedef struct {
   /** Pointer to write function */
   FramWritePtrType WritePtr;
   /** Pointer to read function */
   FramReadPtrType ReadPtr;
+  /** Pointer to asynchronous write function, NULL if not supported */
+  FramWriteAsyncPtrType WriteAsyncPtr;
+  /** Pointer to asynchronous read function, NULL if not supported */
+  FramReadAsyncPtrType ReadAsyncPtr;
   /** Size of FRAM */
   FramAddr size;
 } FramInterfaceType;
@@ -55,6 +66,8 @@ static inline FramStatus ConvertStatus(HAL_StatusTypeDef status) {
   switch (status) {
     case HAL_OK:
       return FRAM_OK;
+    case HAL_BUSY:
+      return FRAM_BUSY;
     default:
       return FRAM_ERROR;
   }
@@ -1,5 +1,6 @@
 #include "mb85rc1mt.h"
 
+#include <stdbool.h>
 #include <string.h>
 
 #include "fram_def.h"
@@ -12,11 +13,12 @@ static const uint8_t g_base_addr = 0b10100000;
 /** Timeout for i2c communication. Set to greater than wakeup time */
 static const uint32_t g_timeout = 1000;
 
-/** Number of pages on the chip */
-static const int mb85rc1mt_pages = 1;
+/** Size of each memory segment in bytes. The upper address bit is part of the
+ * device address, so a single transfer cannot cross a segment. */
+static const size_t mb85rc1mt_seg_size = 1 << 16;
 
-/** Size of each memory segment in bytes */
-static const int mb85rc1mt_seg_size = 1 << 17;
+/** Maximum number of bytes in a single HAL transfer */
+static const size_t mb85rc1mt_max_transfer = UINT16_MAX;
 
 /** Representation of memory address */
 typedef struct {
@@ -47,8 +49,38 @@ FramStatus Wakeup(Mb85rc1mtAddress addr);
  */
 Mb85rc1mtAddress ConvertAddress(FramAddr addr);
 
+/** State of the asynchronous transfer in progress */
+static struct {
+  /** Address of the next segment */
+  FramAddr addr;
+  /** Data of the next segment */
+  uint8_t *data;
+  /** Remaining number of bytes */
+  size_t len;
+  /** Direction of the transfer */
+  bool write;
+  /** Called on completion, NULL if no transfer is in progress */
+  FramCallback callback;
+} async_xfer = {};
+
+/**
+ * @brief Get the number of bytes that can be transferred without changing the
+ * device address
+ *
+ * @param addr Fram address
+ * @param len Number of bytes remaining
+ * @return Number of bytes in the next transfer
+ */
+static size_t TransferLen(FramAddr addr, size_t len) {
+  size_t seg_remaining = mb85rc1mt_seg_size - (addr % mb85rc1mt_seg_size);
+  size_t transfer_len = (len < seg_remaining) ? len : seg_remaining;
+  if (transfer_len > mb85rc1mt_max_transfer) {
+    transfer_len = mb85rc1mt_max_transfer;
+  }
+  return transfer_len;
+}
+
 FramStatus Mb85rc1mtWrite(FramAddr addr, const uint8_t *data, size_t len) {
-  HAL_StatusTypeDef hal_status = HAL_OK;
   FramStatus fram_status = FRAM_OK;
 
   while (len > 0) {
@@ -62,26 +94,20 @@ FramStatus Mb85rc1mtWrite(FramAddr addr, const uint8_t *data, size_t len) {
     }
 
     // number of bytes that can be written without changing address
-    size_t write_len = 0;
-    if ((size_t)addr + len > mb85rc1mt_seg_size) {
-      write_len = mb85rc1mt_seg_size - addr;
-    } else {
-      write_len = len;
-    }
+    size_t write_len = TransferLen(addr, len);
 
-    for (int i = 0; i < write_len; i++) {
-      // transmit data
-      hal_status =
-          HAL_I2C_Mem_Write(&hi2c2, i2c_addr.dev, i2c_addr.mem,
-                            I2C_MEMADD_SIZE_16BIT, data, len, g_timeout);
-      fram_status = ConvertStatus(hal_status);
-      if (fram_status != FRAM_OK) {
-        return fram_status;
-      }
+    // transmit data in a single burst
+    HAL_StatusTypeDef hal_status =
+        HAL_I2C_Mem_Write(&hi2c2, i2c_addr.dev, i2c_addr.mem,
+                          I2C_MEMADD_SIZE_16BIT, data, write_len, g_timeout);
+    fram_status = ConvertStatus(hal_status);
+    if (fram_status != FRAM_OK) {
+      return fram_status;
     }
 
-    // update address and length
+    // update address, data and length
     addr += write_len;
+    data += write_len;
     len -= write_len;
 
     // sleep device
@@ -108,26 +134,21 @@ FramStatus Mb85rc1mtRead(FramAddr addr, size_t len, uint8_t *data) {
       return fram_status;
     }
 
-    size_t read_len = 0;
-    if ((size_t)addr + len > mb85rc1mt_seg_size) {
-      read_len = mb85rc1mt_seg_size - addr;
-    } else {
-      read_len = len;
-    }
-
-    // transmit data
-    HAL_StatusTypeDef hal_status = HAL_OK;
+    // number of bytes that can be read without changing address
+    size_t read_len = TransferLen(addr, len);
 
-    // read from memory
-    hal_status = HAL_I2C_Mem_Read(&hi2c2, i2c_addr.dev | 1, i2c_addr.mem,
-                                  I2C_MEMADD_SIZE_16BIT, data, len, g_timeout);
+    // read from memory in a single burst
+    HAL_StatusTypeDef hal_status =
+        HAL_I2C_Mem_Read(&hi2c2, i2c_addr.dev | 1, i2c_addr.mem,
+                         I2C_MEMADD_SIZE_16BIT, data, read_len, g_timeout);
     fram_status = ConvertStatus(hal_status);
     if (fram_status != FRAM_OK) {
       return fram_status;
     }
 
-    // update addr and len
+    // update addr, data and len
     addr += read_len;
+    data += read_len;
     len -= read_len;
 
     // sleep device
@@ -141,41 +162,126 @@ FramStatus Mb85rc1mtRead(FramAddr addr, size_t len, uint8_t *data) {
   return fram_status;
 }
 
-FramStatus Sleep(Mb85rc1mtAddress addr) {
-  /*
-  // address to enter sleep
-  const uint8_t sleep_addr = 0xf8;
+/**
+ * @brief Starts the DMA transfer of the next segment
+ *
+ * The state is updated before starting since completion can occur before
+ * the HAL function returns.
+ *
+ * @return See FramStatus
+ */
+static FramStatus AsyncNext(void) {
+  Mb85rc1mtAddress i2c_addr = ConvertAddress(async_xfer.addr);
+  uint8_t *data = async_xfer.data;
+  size_t xfer_len = TransferLen(async_xfer.addr, async_xfer.len);
 
-  // data sent to enter sleep
-  const uint8_t sleep_cmd = 0x86;
+  async_xfer.addr += xfer_len;
+  async_xfer.data += xfer_len;
+  async_xfer.len -= xfer_len;
 
-  size_t buffer_len = 2;
-  uint8_t buffer[buffer_len];
+  HAL_StatusTypeDef hal_status = HAL_OK;
+  if (async_xfer.write) {
+    hal_status = HAL_I2C_Mem_Write_DMA(&hi2c2, i2c_addr.dev, i2c_addr.mem,
+                                       I2C_MEMADD_SIZE_16BIT, data, xfer_len);
+  } else {
+    hal_status =
+        HAL_I2C_Mem_Read_DMA(&hi2c2, i2c_addr.dev | 1, i2c_addr.mem,
+                             I2C_MEMADD_SIZE_16BIT, data, xfer_len);
+  }
 
-  buffer[0] = addr.dev;
-  buffer[1] = sleep_cmd;
+  return ConvertStatus(hal_status);
+}
 
-  HAL_StatusTypeDef status = HAL_OK;
-  status = HAL_I2C_Master_Transmit(&hi2c2, sleep_addr, buffer, buffer_len,
-                                   g_timeout);
+/**
+ * @brief Starts an asynchronous transfer
+ *
+ * @param addr Address of transfer
+ * @param data Array of data
+ * @param len Number of bytes
+ * @param write true for writes, false for reads
+ * @param callback Called on completion
+ * @return See FramStatus
+ */
+static FramStatus AsyncStart(FramAddr addr, uint8_t *data, size_t len,
+                             bool write, FramCallback callback) {
+  if (async_xfer.callback != NULL) {
+    return FRAM_BUSY;
+  }
 
-  return ConvertStatus(status);
-  */
-  return FRAM_OK;
+  if (len == 0) {
+    callback(FRAM_OK);
+    return FRAM_OK;
+  }
+
+  async_xfer.addr = addr;
+  async_xfer.data = data;
+  async_xfer.len = len;
+  async_xfer.write = write;
+  async_xfer.callback = callback;
+
+  FramStatus status = AsyncNext();
+  if (status != FRAM_OK) {
+    async_xfer.callback = NULL;
+  }
+
+  return status;
 }
 
-FramStatus Wakeup(Mb85rc1mtAddress addr) {
-  /*
-  HAL_StatusTypeDef status = HAL_OK;
-  status = HAL_I2C_Master_Transmit(&hi2c2, addr.dev, NULL, 0, 0);
-  */
-  /*
-  // expect an error
-  if (status != HAL_ERROR) {
-    return FRAM_ERROR;
+/**
+ * @brief Continues or completes the asynchronous transfer
+ *
+ * @param hi2c I2C handle of the interrupt
+ * @param status Status of the segment that completed
+ */
+static void AsyncComplete(I2C_HandleTypeDef *hi2c, FramStatus status) {
+  if (hi2c != &hi2c2 || async_xfer.callback == NULL) {
+    return;
+  }
+
+  // start next segment
+  if (status == FRAM_OK && async_xfer.len > 0) {
+    status = AsyncNext();
+    if (status == FRAM_OK) {
+      return;
+    }
   }
-  */
 
+  FramCallback callback = async_xfer.callback;
+  async_xfer.callback = NULL;
+  callback(status);
+}
+
+FramStatus Mb85rc1mtWriteAsync(FramAddr addr, const uint8_t *data, size_t len,
+                               FramCallback callback) {
+  // data is not modified for writes
+  return AsyncStart(addr, (uint8_t *)data, len, true, callback);
+}
+
+FramStatus Mb85rc1mtReadAsync(FramAddr addr, size_t len, uint8_t *data,
+                              FramCallback callback) {
+  return AsyncStart(addr, data, len, false, callback);
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+  AsyncComplete(hi2c, FRAM_OK);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+  AsyncComplete(hi2c, FRAM_OK);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+  AsyncComplete(hi2c, FRAM_ERROR);
+}
+
+FramStatus Sleep(Mb85rc1mtAddress addr) {
+  // sleep mode is not used, the chip stays in standby between transfers
+  (void)addr;
+  return FRAM_OK;
+}
+
+FramStatus Wakeup(Mb85rc1mtAddress addr) {
+  (void)addr;
   return FRAM_OK;
 }
 
@@ -60,6 +60,32 @@ FramStatus Mb85rc1mtWrite(FramAddr addr, const uint8_t *data, size_t len);
  */
 FramStatus Mb85rc1mtRead(FramAddr addr, size_t len, uint8_t *data);
 
+/**
+ * @brief Starts a DMA write to an address
+ *
+ * Transfers crossing a segment are continued from the completion interrupt.
+ *
+ * @param addr Address of write
+ * @param data An array of data bytes.
+ * @param len The number of bytes to be written.
+ * @param callback Called on completion
+ * @return See FramStatus
+ */
+FramStatus Mb85rc1mtWriteAsync(FramAddr addr, const uint8_t *data, size_t len,
+                               FramCallback callback);
+
+/**
+ * @brief Starts a DMA read from an address
+ *
+ * @param addr Address of read
+ * @param len Number of sequential bytes to read
+ * @param data Array to be read into
+ * @param callback Called on completion
+ * @return See FramStatus
+ */
+FramStatus Mb85rc1mtReadAsync(FramAddr addr, size_t len, uint8_t *data,
+                              FramCallback callback);
+
 /**
  * @}
  */
@@ -1,41 +1,160 @@
 #include "page.h"
 
+#include "fifo.h"
+#include "state_def.h"
+
+/** Version of the layout of the saved page state */
+static const uint8_t kStateVersion = 2;
+
+/** Size of the header of a copy of the page state in bytes */
+#define STATE_HEADER_SIZE 16
+
+/** Size of a page in a copy of the page state in bytes */
+#define STATE_PAGE_SIZE 16
+
+/** Size of a single copy of the page state in bytes, including the CRC */
+#define STATE_SLOT_SIZE \
+  (STATE_HEADER_SIZE + STATE_PAGE_SIZE * PAGE_POOL_SIZE + 2)
+
+/** Number of copies of the page state */
+#define STATE_NUM_SLOTS 2
+
+#if STATE_NUM_SLOTS * STATE_SLOT_SIZE > FRAM_PAGE_STATE_SIZE
+#error PAGE_POOL_SIZE is too large for FRAM_PAGE_STATE_SIZE
+#endif
+
+#if PAGE_POOL_SIZE >= PAGE_NULL
+#error PAGE_POOL_SIZE must be less than PAGE_NULL
+#endif
+
+/** Pool of pages */
+static Page pool[PAGE_POOL_SIZE];
+
+static size_t size = 0;
+
+static uint32_t file_counter = 0;
+
+/** Index of front of ll */
+static PageIdx front = PAGE_NULL;
+
+/** Index of back of ll */
+static PageIdx back = PAGE_NULL;
+
+/** Index of first page in the free list */
+static PageIdx free_head = PAGE_NULL;
+
+/** Sequence number of the last saved page state */
+static uint8_t state_seq = 0;
+
+/** Copy of the page state being saved or loaded */
+static uint8_t state_buffer[STATE_SLOT_SIZE];
+
+/** Interface to external storage */
+static const PageInterfaceType *page_interface = NULL;
+
+/** Records moved between the FIFO and pages, holds the largest record */
+static uint8_t transfer[FRAM_RECORD_MAX_SIZE];
+
 /**
- * @brief Block size of the i2c communication
+ * @brief Get a page from an index
  *
- * This can be tuned for performance but is left at 16 to accommodate small
- * hardware buffers.
+ * @param idx Index in the pool
+ * @return Reference to page, NULL for PAGE_NULL
  */
-static const size_t block_size = 16;
+static inline Page *page_at(PageIdx idx) {
+  return (idx == PAGE_NULL) ? NULL : &pool[idx];
+}
 
-static size_t size = 0;
+/**
+ * @brief Get the index of a page
+ *
+ * @param page Reference to page in the pool
+ * @return Index in the pool
+ */
+static inline PageIdx page_idx(const Page *page) {
+  return (PageIdx)(page - pool);
+}
 
-static size_t file_counter = 0;
+/**
+ * @brief Resets to an empty list with every page in the free list
+ */
+static void reset_pool(void) {
+  for (PageIdx i = 0; i < PAGE_POOL_SIZE; i++) {
+    pool[i].next = (i + 1 < PAGE_POOL_SIZE) ? i + 1 : PAGE_NULL;
+    pool[i].prev = PAGE_NULL;
+  }
 
-/** Reference to front of ll */
-static Page *front = NULL;
+  size = 0;
+  file_counter = 0;
+  front = PAGE_NULL;
+  back = PAGE_NULL;
+  free_head = 0;
+}
 
-/** Reference to back of ll */
-static Page *back = NULL;
+/**
+ * @brief Takes a page from the free list with default values
+ *
+ * @return Index of page, PAGE_NULL if the pool is exhausted
+ */
+static PageIdx AllocatePage(void) {
+  PageIdx idx = free_head;
+  if (idx == PAGE_NULL) {
+    return PAGE_NULL;
+  }
 
-Page *AllocatePage(void);
+  Page *new_page = &pool[idx];
+  free_head = new_page->next;
 
-Page *AllocatePage(void) {
-  // allocate new page
-  Page *new_page = NULL;
-  new_page = malloc(sizeof(Page));
   // initial values
-  new_page->next = NULL;
-  new_page->prev = NULL;
+  new_page->next = PAGE_NULL;
+  new_page->prev = PAGE_NULL;
+  new_page->file_idx = file_counter;
   new_page->open = false;
+  new_page->write_len = 0;
+  new_page->read_offset = 0;
+
+  return idx;
+}
+
+/**
+ * @brief Returns a page to the free list
+ *
+ * @param idx Index of page
+ */
+static void FreePage(PageIdx idx) {
+  pool[idx].prev = PAGE_NULL;
+  pool[idx].next = free_head;
+  free_head = idx;
+}
+
+/**
+ * @brief Reads from a page until an array is full or the page ends
+ *
+ * @param page Page reference
+ * @param buf Array to be read into
+ * @param buf_size Size of buf in bytes
+ * @return Number of bytes read
+ */
+static size_t read_full(Page *page, uint8_t *buf, size_t buf_size) {
+  size_t len = 0;
+  while (len < buf_size) {
+    const size_t n = PageRead(page, buf + len, buf_size - len);
+    if (n == 0) {
+      break;
+    }
+    len += n;
+  }
+  return len;
 }
 
 void PageInit(void) {
   // reset to default values, see variable definitions
-  size = 0;
-  file_counter = 0;
-  front = NULL;
-  back = NULL;
+  reset_pool();
+
+  // resume from the saved state, otherwise start empty
+  if (PageStateLoad() != FRAM_OK) {
+    reset_pool();
+  }
 }
 
 void PageDeinit(void) {
@@ -43,39 +162,50 @@ void PageDeinit(void) {
   while (PageSize() > 0) {
     PagePopFront();
   }
+
+  // start numbering files from zero again
+  reset_pool();
+  PageStateSave();
+}
+
+void PageSetInterface(const PageInterfaceType *interface) {
+  page_interface = interface;
 }
 
-Page *PageFront(void) { return front; }
+Page *PageFront(void) { return page_at(front); }
+
+Page *PageBack(void) { return page_at(back); }
+
+Page *PageNext(const Page *page) { return page_at(page->next); }
 
-Page *PageBack(void) { return back; }
+Page *PagePrev(const Page *page) { return page_at(page->prev); }
 
 Page *PagePushFront(void) {
-  // allocate new page
-  Page *new_page = AllocatePage();
+  // take page from the pool
+  PageIdx idx = AllocatePage();
 
-  // check for malloc error
-  if (new_page == NULL) {
+  // check for exhausted pool
+  if (idx == PAGE_NULL) {
     return NULL;
   }
 
-  // set file counter
-  new_page->file_idx = file_counter;
-
   // empty linked list
   if (PageEmpty()) {
-    front = new_page;
-    back = new_page;
+    front = idx;
+    back = idx;
   } else {
-    new_page->next = front;
-    front->prev = new_page;
-    front = new_page;
+    pool[idx].next = front;
+    pool[front].prev = idx;
+    front = idx;
   }
 
   // update counter
   ++size;
   ++file_counter;
 
-  return new_page;
+  PageStateSave();
+
+  return &pool[idx];
 }
 
 void PagePopFront(void) {
@@ -85,60 +215,56 @@ void PagePopFront(void) {
   }
 
   // close file if open
-  if (back->open) {
-    PageClose(back);
-  }
-
-  // NULL pointers if one element left
-  if ((front == back) && (size == 1)) {
-    // free memory
-    free(front);
-    // set null pointers
-    front = NULL;
-    back = NULL;
-    // set next to front
+  if (pool[front].open) {
+    PageClose(&pool[front]);
+  }
+
+  PageIdx front_next = pool[front].next;
+  FreePage(front);
+
+  // NULL links if one element left
+  if (front_next == PAGE_NULL) {
+    front = PAGE_NULL;
+    back = PAGE_NULL;
   } else {
-    // free memory
-    free(front);
-    // store tmp pointer to next
-    Page *front_next = front->next;
     // "remove" front from linked list
-    front_next->prev = NULL;
+    pool[front_next].prev = PAGE_NULL;
     // set next as the front
     front = front_next;
   }
 
   --size;
+
+  PageStateSave();
 }
 
 Page *PagePushBack(void) {
-  // allocate new page
-  Page *new_page = AllocatePage();
+  // take page from the pool
+  PageIdx idx = AllocatePage();
 
-  // check for malloc error
-  if (new_page == NULL) {
+  // check for exhausted pool
+  if (idx == PAGE_NULL) {
     return NULL;
   }
 
-  // set file counter
-  new_page->file_idx = file_counter;
-
   // case when list is empty
   if (PageEmpty()) {
-    front = new_page;
-    back = new_page;
+    front = idx;
+    back = idx;
     // normal case
   } else {
-    new_page->prev = back;
-    back->next = new_page;
-    back = new_page;
+    pool[idx].prev = back;
+    pool[back].next = idx;
+    back = idx;
   }
 
   // update counter
   ++size;
   ++file_counter;
 
-  return new_page;
+  PageStateSave();
+
+  return &pool[idx];
 }
 
 void PagePopBack(void) {
@@ -148,58 +274,446 @@ void PagePopBack(void) {
   }
 
   // close file if open
-  if (back->open) {
-    PageClose(back);
-  }
-
-  // NULL pointers if one element left
-  if ((front == back) && (size == 1)) {
-    // free memory
-    free(back);
-    // set null pointers
-    front = NULL;
-    back = NULL;
-    // set next to front
+  if (pool[back].open) {
+    PageClose(&pool[back]);
+  }
+
+  PageIdx back_prev = pool[back].prev;
+  FreePage(back);
+
+  // NULL links if one element left
+  if (back_prev == PAGE_NULL) {
+    front = PAGE_NULL;
+    back = PAGE_NULL;
   } else {
-    // free memory
-    free(back);
-    // store tmp pointer to prev
-    Page *back_prev = back->prev;
     // "remove" back from linked list
-    back_prev->next = NULL;
-    // set next as the back
+    pool[back_prev].next = PAGE_NULL;
+    // set prev as the back
     back = back_prev;
   }
 
   --size;
+
+  PageStateSave();
 }
 
-void PageOpen(Page *page) {
-  // TODO(jtmadden): implement
+bool PageOpen(Page *page) {
+  if (page->open) {
+    return true;
+  }
+
+  if (page_interface == NULL || !page_interface->OpenPtr(page->file_idx)) {
+    return false;
+  }
 
   page->open = true;
+  return true;
 }
 
-void PageClose(Page *page) {
-  // TODO(jtmadden): implement
+bool PageClose(Page *page) {
+  if (!page->open) {
+    return true;
+  }
 
+  // the page is considered closed even if the storage failed
   page->open = false;
+
+  if (page_interface == NULL) {
+    return false;
+  }
+
+  return page_interface->ClosePtr(page->file_idx);
 }
 
-inline size_t PageSize(void) { return size; }
+bool PageDelete(Page *page) {
+  PageClose(page);
 
-inline bool PageEmpty(void) {
-  if ((front == NULL) && (back == NULL) && (size == 0)) {
+  if (page_interface == NULL) {
+    return false;
+  }
+
+  return page_interface->DeletePtr(page->file_idx);
+}
+
+size_t PageWrite(Page *page, const uint8_t *buf, size_t len) {
+  if (page_interface == NULL || !PageOpen(page)) {
+    return 0;
+  }
+
+  size_t written = 0;
+  while (written < len) {
+    size_t block_len = len - written;
+    if (block_len > PAGE_BLOCK_SIZE) {
+      block_len = PAGE_BLOCK_SIZE;
+    }
+
+    size_t n =
+        page_interface->WritePtr(page->file_idx, buf + written, block_len);
+    written += n;
+    if (n < block_len) {
+      break;
+    }
+  }
+
+  page->write_len += written;
+
+  return written;
+}
+
+size_t PageRead(Page *page, uint8_t *buf, size_t buf_size) {
+  if (page_interface == NULL || !PageOpen(page)) {
+    return 0;
+  }
+
+  if (buf_size > PAGE_BLOCK_SIZE) {
+    buf_size = PAGE_BLOCK_SIZE;
+  }
+
+  size_t n =
+      page_interface->ReadPtr(page->file_idx, page->read_offset, buf, buf_size);
+  page->read_offset += n;
+
+  return n;
+}
+
+/**
+ * @brief Adds a page to the back of the list with an empty file
+ *
+ * Removes a stale file left with the same index if the page state was lost,
+ * so writes do not append to it.
+ *
+ * @return New page, NULL if the pool is exhausted
+ */
+static Page *push_back_empty(void) {
+  Page *page = PagePushBack();
+  if (page != NULL && page_interface != NULL) {
+    page_interface->DeletePtr(page->file_idx);
+  }
+
+  return page;
+}
+
+FramStatus PageBalance(void) {
+  const FramAddr target = (PAGE_HIGH_WATER + PAGE_LOW_WATER) / 2;
+  const FramAddr used = FramBufferUsed();
+
+  if (used > PAGE_HIGH_WATER) {
+    return PageSpill(target);
+  } else if (used < PAGE_LOW_WATER && !PageEmpty()) {
+    return PageRestore(target);
+  }
+
+  return FRAM_OK;
+}
+
+FramStatus PageSpill(FramAddr target) {
+  FramStatus status = FRAM_OK;
+
+  while (FramBufferUsed() > target) {
+    // start a new page once the back page is full
+    Page *page = PageBack();
+    if (page == NULL || page->write_len >= PAGE_MAX_BYTES) {
+      if (page != NULL) {
+        PageClose(page);
+      }
+
+      page = push_back_empty();
+      if (page == NULL) {
+        return FRAM_BUFFER_FULL;
+      }
+    }
+
+    // oldest measurements stay in the FIFO until they are written
+    uint32_t count = 0;
+    status = FramPeekBatch(transfer, sizeof(transfer), &count);
+    if (status != FRAM_OK) {
+      break;
+    }
+
+    // records are written as stored, including corrupted records
+    size_t len = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      FramRecord record;
+      FramRecordDecode(transfer + len, sizeof(transfer) - len, &record);
+      len += record.size;
+    }
+
+    const size_t written = PageWrite(page, transfer, len);
+    if (written != len) {
+      // no longer append after a partial record
+      if (written > 0) {
+        PageClose(page);
+        push_back_empty();
+      }
+      PageStateSave();
+      status = FRAM_ERROR;
+      break;
+    }
+
+    // measurements are duplicated rather than lost on a reset in between
+    status = PageStateSave();
+    if (status != FRAM_OK) {
+      break;
+    }
+
+    status = FramCommit(count);
+    if (status != FRAM_OK) {
+      break;
+    }
+  }
+
+  // close so the file is complete if the storage loses power
+  if (!PageEmpty()) {
+    PageClose(PageBack());
+  }
+
+  return status;
+}
+
+FramStatus PageRestore(FramAddr target) {
+  FramStatus status = FRAM_OK;
+
+  while (!PageEmpty() && FramBufferUsed() < target) {
+    Page *page = PageFront();
+
+    if (!PageOpen(page)) {
+      return FRAM_ERROR;
+    }
+
+    const size_t len = read_full(page, transfer, sizeof(transfer));
+    const bool end = page->read_offset >= page->write_len;
+
+    // nothing was read before the end of the written bytes
+    if (len < sizeof(transfer) && !end) {
+      page->read_offset -= len;
+      status = FRAM_ERROR;
+      break;
+    }
+
+    size_t offset = 0;
+    while (offset < len) {
+      FramRecord record;
+      FramStatus record_status =
+          FramRecordDecode(transfer + offset, len - offset, &record);
+      if (record_status == FRAM_OK) {
+        status = FramPutRecord(record.type, record.data, record.len);
+        if (status != FRAM_OK) {
+          break;
+        }
+      } else if (record_status != FRAM_CORRUPT) {
+        // incomplete, or a length that cannot be skipped
+        break;
+      }
+      // corrupted records are dropped
+      offset += record.size;
+    }
+
+    // records that were not put are read again
+    page->read_offset -= len - offset;
+
+    if (status != FRAM_OK) {
+      break;
+    }
+
+    // the transfer holds the largest record, so the rest of the page is a
+    // partial record of a failed write or cannot be decoded
+    if (offset == 0) {
+      PageDelete(page);
+      PagePopFront();
+      continue;
+    }
+
+    // measurements are duplicated rather than lost on a reset in between
+    status = FramFlush();
+    if (status != FRAM_OK) {
+      break;
+    }
+
+    status = PageStateSave();
+    if (status != FRAM_OK) {
+      break;
+    }
+  }
+
+  if (!PageEmpty()) {
+    PageClose(PageFront());
+  }
+
+  return status;
+}
+
+size_t PageSize(void) { return size; }
+
+bool PageEmpty(void) {
+  if ((front == PAGE_NULL) && (back == PAGE_NULL) && (size == 0)) {
     return true;
   } else {
     return false;
   }
 }
 
-void PageStateSave(void) {
-  // TODO(jtmadden): implement
+/**
+ * @brief Encodes a copy of the page state
+ *
+ * Layout of a copy
+ * [0] version, [1] sequence number, [2:3] front, [4:5] back, [6:7] free list,
+ * [8:9] size, [10:13] file counter, [14:15] pool size, followed by each page
+ * of the pool with [0:3] file index, [4:7] bytes written, [8:11] read offset,
+ * [12:13] next, [14:15] prev, and ending with the CRC of all previous bytes.
+ *
+ * @param slot Destination of STATE_SLOT_SIZE bytes
+ * @param seq Sequence number
+ * @return Address of the copy in FRAM
+ */
+static FramAddr encode_state(uint8_t *slot, uint8_t seq) {
+  slot[0] = kStateVersion;
+  slot[1] = seq;
+  store_u16(slot + 2, front);
+  store_u16(slot + 4, back);
+  store_u16(slot + 6, free_head);
+  store_u16(slot + 8, (uint16_t)size);
+  store_u32(slot + 10, file_counter);
+  store_u16(slot + 14, PAGE_POOL_SIZE);
+
+  uint8_t *entry = slot + STATE_HEADER_SIZE;
+  for (PageIdx i = 0; i < PAGE_POOL_SIZE; i++) {
+    store_u32(entry, pool[i].file_idx);
+    store_u32(entry + 4, pool[i].write_len);
+    store_u32(entry + 8, pool[i].read_offset);
+    store_u16(entry + 12, pool[i].next);
+    store_u16(entry + 14, pool[i].prev);
+    entry += STATE_PAGE_SIZE;
+  }
+
+  store_u16(slot + STATE_SLOT_SIZE - 2, crc16(slot, STATE_SLOT_SIZE - 2));
+
+  // alternate between copies so the previous state remains intact if the
+  // write is interrupted
+  return FRAM_PAGE_STATE_ADDR + (seq % STATE_NUM_SLOTS) * STATE_SLOT_SIZE;
+}
+
+/**
+ * @brief Checks if a copy of the saved page state is valid
+ *
+ * @param slot Copy of the page state
+ * @return true if the version, pool size and CRC match, false otherwise
+ */
+static bool state_slot_valid(const uint8_t *slot) {
+  if (slot[0] != kStateVersion || load_u16(slot + 14) != PAGE_POOL_SIZE) {
+    return false;
+  }
+
+  uint16_t crc = load_u16(slot + STATE_SLOT_SIZE - 2);
+  return crc == crc16(slot, STATE_SLOT_SIZE - 2);
+}
+
+/**
+ * @brief Checks the links of the list and the free list
+ *
+ * Every page must be reached exactly once from either the front of the list
+ * or the free list, with prev links matching the next links of the list.
+ *
+ * @return true if consistent, false otherwise
+ */
+static bool state_consistent(void) {
+  bool seen[PAGE_POOL_SIZE] = {false};
+
+  size_t count = 0;
+  PageIdx prev = PAGE_NULL;
+  for (PageIdx i = front; i != PAGE_NULL; i = pool[i].next) {
+    if (i >= PAGE_POOL_SIZE || seen[i] || pool[i].prev != prev) {
+      return false;
+    }
+    seen[i] = true;
+    prev = i;
+    ++count;
+  }
+
+  if (prev != back || count != size) {
+    return false;
+  }
+
+  for (PageIdx i = free_head; i != PAGE_NULL; i = pool[i].next) {
+    if (i >= PAGE_POOL_SIZE || seen[i]) {
+      return false;
+    }
+    seen[i] = true;
+    ++count;
+  }
+
+  return count == PAGE_POOL_SIZE;
+}
+
+FramStatus PageStateSave(void) {
+  uint8_t seq = state_seq + 1;
+  FramAddr slot_addr = encode_state(state_buffer, seq);
+
+  FramStatus status = FramWrite(slot_addr, state_buffer, STATE_SLOT_SIZE);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  state_seq = seq;
+
+  return FRAM_OK;
 }
 
-void PageStateLoad(void) {
-  // TODO(jtmadden): implement
+FramStatus PageStateLoad(void) {
+  // find the valid copy with the latest sequence number
+  FramAddr latest_addr = 0;
+  bool found = false;
+  uint8_t latest_seq = 0;
+  for (int i = 0; i < STATE_NUM_SLOTS; i++) {
+    FramAddr slot_addr = FRAM_PAGE_STATE_ADDR + i * STATE_SLOT_SIZE;
+    FramStatus status = FramRead(slot_addr, STATE_SLOT_SIZE, state_buffer);
+    if (status != FRAM_OK) {
+      return status;
+    }
+
+    if (!state_slot_valid(state_buffer)) {
+      continue;
+    }
+
+    // sequence number wraps around
+    if (!found || (int8_t)(state_buffer[1] - latest_seq) > 0) {
+      latest_addr = slot_addr;
+      latest_seq = state_buffer[1];
+      found = true;
+    }
+  }
+
+  if (!found) {
+    return FRAM_ERROR;
+  }
+
+  // the last copy read may not be the latest
+  FramStatus status = FramRead(latest_addr, STATE_SLOT_SIZE, state_buffer);
+  if (status != FRAM_OK) {
+    return status;
+  }
+
+  const uint8_t *slot = state_buffer;
+  state_seq = slot[1];
+  front = load_u16(slot + 2);
+  back = load_u16(slot + 4);
+  free_head = load_u16(slot + 6);
+  size = load_u16(slot + 8);
+  file_counter = load_u32(slot + 10);
+
+  const uint8_t *entry = slot + STATE_HEADER_SIZE;
+  for (PageIdx i = 0; i < PAGE_POOL_SIZE; i++) {
+    pool[i].file_idx = load_u32(entry);
+    pool[i].write_len = load_u32(entry + 4);
+    pool[i].read_offset = load_u32(entry + 8);
+    pool[i].next = load_u16(entry + 12);
+    pool[i].prev = load_u16(entry + 14);
+    pool[i].open = false;
+    entry += STATE_PAGE_SIZE;
+  }
+
+  if (!state_consistent()) {
+    return FRAM_OUT_OF_RANGE;
+  }
+
+  return FRAM_OK;
 }
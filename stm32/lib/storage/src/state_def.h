@@ -0,0 +1,130 @@
+/**
+ * @file state_def.h
+ * @brief Helpers for encoding library state saved to FRAM
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef LIB_STORAGE_SRC_STATE_DEF_H_
+#define LIB_STORAGE_SRC_STATE_DEF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @ingroup storage
+ * @defgroup stateDef State Definitions
+ * @brief Helpers for encoding library state saved to FRAM
+ *
+ * Values are stored in little endian order and copies of state are protected
+ * with a CRC. Records of the FIFO are protected with a CRC-8.
+ *
+ * @{
+ */
+
+/**
+ * @brief Calculates the CRC-16/CCITT-FALSE of an array of bytes
+ *
+ * @param data Array of bytes
+ * @param len Number of bytes
+ * @return CRC of the data
+ */
+static inline uint16_t crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int j = 0; j < 8; j++) {
+      if (crc & 0x8000) {
+        crc = (crc << 1) ^ 0x1021;
+      } else {
+        crc = crc << 1;
+      }
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Updates a CRC-8 (polynomial 0x07) with an array of bytes
+ *
+ * Start with a CRC of 0. Can be called repeatedly to calculate the CRC of
+ * data that is not contiguous.
+ *
+ * @param crc CRC of the preceding bytes
+ * @param data Array of bytes
+ * @param len Number of bytes
+ * @return CRC including the data
+ */
+static inline uint8_t crc8(uint8_t crc, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int j = 0; j < 8; j++) {
+      if (crc & 0x80) {
+        crc = (crc << 1) ^ 0x07;
+      } else {
+        crc = crc << 1;
+      }
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief Stores a 16-bit value in little endian order
+ *
+ * @param buf Destination of 2 bytes
+ * @param value Value to store
+ */
+static inline void store_u16(uint8_t *buf, uint16_t value) {
+  buf[0] = value & 0xFF;
+  buf[1] = (value >> 8) & 0xFF;
+}
+
+/**
+ * @brief Loads a 16-bit value stored in little endian order
+ *
+ * @param buf Source of 2 bytes
+ * @return Loaded value
+ */
+static inline uint16_t load_u16(const uint8_t *buf) {
+  return (uint16_t)buf[0] | ((uint16_t)buf[1] << 8);
+}
+
+/**
+ * @brief Stores a 32-bit value in little endian order
+ *
+ * @param buf Destination of 4 bytes
+ * @param value Value to store
+ */
+static inline void store_u32(uint8_t *buf, uint32_t value) {
+  buf[0] = value & 0xFF;
+  buf[1] = (value >> 8) & 0xFF;
+  buf[2] = (value >> 16) & 0xFF;
+  buf[3] = (value >> 24) & 0xFF;
+}
+
+/**
+ * @brief Loads a 32-bit value stored in little endian order
+ *
+ * @param buf Source of 4 bytes
+ * @return Loaded value
+ */
+static inline uint32_t load_u32(const uint8_t *buf) {
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIB_STORAGE_SRC_STATE_DEF_H_
@@ -59,9 +59,9 @@ extern "C" {
 // Maximum size of the received data buffer (from protobuf definition).
 #define RX_BUFFER_SIZE UserConfiguration_size
 // Starting address for user config data in FRAM.
-#define USER_CONFIG_START_ADDRESS 1794
+#define USER_CONFIG_START_ADDRESS FRAM_USER_CONFIG_ADDR
 // Address for storing the user config data length in FRAM.
-#define USER_CONFIG_LEN_ADDR 1792
+#define USER_CONFIG_LEN_ADDR FRAM_USER_CONFIG_LEN_ADDR
 
 typedef enum {
   USERCONFIG_OK,
@@ -153,7 +153,7 @@ UserConfigStatus UserConfig_SendCurrentUserConfig(void);
  *otherwise.
  ******************************************************************************
  */
-UserConfigStatus UserConfig_WriteToFRAM(uint16_t fram_addr, uint8_t *data,
+UserConfigStatus UserConfig_WriteToFRAM(FramAddr fram_addr, uint8_t *data,
                                         uint16_t length);
 
 /**
@@ -170,7 +170,7 @@ UserConfigStatus UserConfig_WriteToFRAM(uint16_t fram_addr, uint8_t *data,
  *otherwise.
  ******************************************************************************
  */
-UserConfigStatus UserConfig_ReadFromFRAM(uint16_t fram_addr, uint16_t length,
+UserConfigStatus UserConfig_ReadFromFRAM(FramAddr fram_addr, uint16_t length,
                                          uint8_t *data);
 
 /**
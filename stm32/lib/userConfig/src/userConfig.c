@@ -218,14 +218,14 @@ void UserConfig_ProcessDataPolling(void) {
 }
 
 // Write data to FRAM
-UserConfigStatus UserConfig_WriteToFRAM(uint16_t fram_addr, uint8_t *data,
+UserConfigStatus UserConfig_WriteToFRAM(FramAddr fram_addr, uint8_t *data,
                                         uint16_t length) {
   FramStatus status = FramWrite(fram_addr, data, length);
   return (status == FRAM_OK) ? USERCONFIG_OK : USERCONFIG_FRAM_ERROR;
 }
 
 // Read data from FRAM
-UserConfigStatus UserConfig_ReadFromFRAM(uint16_t fram_addr, uint16_t length,
+UserConfigStatus UserConfig_ReadFromFRAM(FramAddr fram_addr, uint16_t length,
                                          uint8_t *data) {
   FramStatus status = FramRead(fram_addr, length, data);
   return (status == FRAM_OK) ? USERCONFIG_OK : USERCONFIG_FRAM_ERROR;
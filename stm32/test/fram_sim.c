@@ -0,0 +1,264 @@
+/**
+ * @file fram_sim.c
+ * @brief Host-side simulator of the FRAM chips and peripheral stubs
+ *
+ * Built with the tests in the native environment only. Stub headers for the
+ * HAL are located in native/.
+ *
+ * @see fram_sim.h
+ */
+
+#ifdef NATIVE
+
+#include "fram_sim.h"
+
+#include <string.h>
+
+#include "gpio.h"
+#include "i2c.h"
+#include "main.h"
+#include "main_helper.h"
+#include "stm32wlxx_hal.h"
+#include "usart.h"
+
+#if defined(FRAM_FM24CL16B)
+/** Size of the FM24CL16B */
+#define SIM_SIZE (1 << 11)
+#elif defined(FRAM_MB85RC1MT)
+/** Size of the MB85RC1MT */
+#define SIM_SIZE (1 << 17)
+#else
+#error No FRAM chip enabled
+#endif
+
+/** Device type code in the upper nibble of the device address */
+static const uint16_t sim_dev_code = 0b10100000;
+
+/** Simulated memory */
+static uint8_t sim_mem[SIM_SIZE];
+
+/** Bus statistics */
+static FramSimStats sim_stats = {};
+
+/** Number of following reads that fail */
+static uint32_t sim_fail_reads = 0;
+
+/** DMA transfer waiting to be completed */
+static struct {
+  /** Transfer is pending */
+  bool pending;
+  /** Transfer is a write */
+  bool write;
+  I2C_HandleTypeDef *hi2c;
+  uint16_t dev;
+  uint16_t mem;
+  uint16_t mem_size;
+  uint8_t *data;
+  uint16_t size;
+} sim_dma = {};
+
+I2C_HandleTypeDef hi2c2 = {};
+
+/**
+ * @brief Decodes a device and memory address into a flat address
+ *
+ * @param dev Device address, the R/W bit is ignored
+ * @param mem Memory address
+ * @param mem_size Size of the memory address
+ * @param addr Flat address
+ * @return HAL_ERROR if the device does not acknowledge the address
+ */
+static HAL_StatusTypeDef DecodeAddress(uint16_t dev, uint16_t mem,
+                                       uint16_t mem_size, uint32_t *addr) {
+  if ((dev & 0xF0) != sim_dev_code) {
+    return HAL_ERROR;
+  }
+
+#if defined(FRAM_FM24CL16B)
+  // page select in bits 1-3, single byte memory address
+  if (mem_size != I2C_MEMADD_SIZE_8BIT || mem > 0xFF) {
+    return HAL_ERROR;
+  }
+  *addr = ((uint32_t)((dev >> 1) & 0b111) << 8) | mem;
+#else
+  // A16 in bit 1, A1 and A2 select the chip and must be zero
+  if (mem_size != I2C_MEMADD_SIZE_16BIT || (dev & 0b1100) != 0) {
+    return HAL_ERROR;
+  }
+  *addr = ((uint32_t)((dev >> 1) & 0b1) << 16) | mem;
+#endif
+
+  return HAL_OK;
+}
+
+void FramSimReset(uint8_t value) {
+  memset(sim_mem, value, sizeof(sim_mem));
+  FramSimClearStats();
+}
+
+FramSimStats FramSimGetStats(void) { return sim_stats; }
+
+void FramSimClearStats(void) { memset(&sim_stats, 0, sizeof(sim_stats)); }
+
+uint8_t *FramSimMemory(void) { return sim_mem; }
+
+size_t FramSimSize(void) { return sizeof(sim_mem); }
+
+void FramSimFailReads(uint32_t count) { sim_fail_reads = count; }
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c,
+                                    uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, const uint8_t *pData,
+                                    uint16_t Size, uint32_t Timeout) {
+  uint32_t addr = 0;
+  HAL_StatusTypeDef status =
+      DecodeAddress(DevAddress, MemAddress, MemAddSize, &addr);
+  if (status != HAL_OK) {
+    return status;
+  }
+
+  // device address, memory address, data
+  ++sim_stats.transactions;
+  sim_stats.bytes += 1 + MemAddSize + Size;
+
+  // address counter wraps around at the end of memory
+  for (uint16_t i = 0; i < Size; i++) {
+    sim_mem[(addr + i) % SIM_SIZE] = pData[i];
+  }
+
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c,
+                                   uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData,
+                                   uint16_t Size, uint32_t Timeout) {
+  if (sim_fail_reads > 0) {
+    --sim_fail_reads;
+    return HAL_ERROR;
+  }
+
+  uint32_t addr = 0;
+  HAL_StatusTypeDef status =
+      DecodeAddress(DevAddress, MemAddress, MemAddSize, &addr);
+  if (status != HAL_OK) {
+    return status;
+  }
+
+  // device address, memory address, repeated start device address, data
+  ++sim_stats.transactions;
+  sim_stats.bytes += 2 + MemAddSize + Size;
+
+  for (uint16_t i = 0; i < Size; i++) {
+    pData[i] = sim_mem[(addr + i) % SIM_SIZE];
+  }
+
+  return HAL_OK;
+}
+
+/**
+ * @brief Queues a DMA transfer
+ *
+ * @return HAL_BUSY if a transfer is already pending
+ */
+static HAL_StatusTypeDef QueueTransfer(bool write, I2C_HandleTypeDef *hi2c,
+                                       uint16_t dev, uint16_t mem,
+                                       uint16_t mem_size, uint8_t *data,
+                                       uint16_t size) {
+  if (sim_dma.pending) {
+    return HAL_BUSY;
+  }
+
+  sim_dma.pending = true;
+  sim_dma.write = write;
+  sim_dma.hi2c = hi2c;
+  sim_dma.dev = dev;
+  sim_dma.mem = mem;
+  sim_dma.mem_size = mem_size;
+  sim_dma.data = data;
+  sim_dma.size = size;
+
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c,
+                                        uint16_t DevAddress,
+                                        uint16_t MemAddress,
+                                        uint16_t MemAddSize,
+                                        const uint8_t *pData, uint16_t Size) {
+  return QueueTransfer(true, hi2c, DevAddress, MemAddress, MemAddSize,
+                       (uint8_t *)pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *hi2c,
+                                       uint16_t DevAddress,
+                                       uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData,
+                                       uint16_t Size) {
+  return QueueTransfer(false, hi2c, DevAddress, MemAddress, MemAddSize, pData,
+                       Size);
+}
+
+bool FramSimCompleteTransfer(void) {
+  if (!sim_dma.pending) {
+    return false;
+  }
+
+  // the callback may queue the next transfer
+  sim_dma.pending = false;
+
+  HAL_StatusTypeDef status = HAL_OK;
+  if (sim_dma.write) {
+    status = HAL_I2C_Mem_Write(sim_dma.hi2c, sim_dma.dev, sim_dma.mem,
+                               sim_dma.mem_size, sim_dma.data, sim_dma.size,
+                               HAL_MAX_DELAY);
+  } else {
+    status = HAL_I2C_Mem_Read(sim_dma.hi2c, sim_dma.dev, sim_dma.mem,
+                              sim_dma.mem_size, sim_dma.data, sim_dma.size,
+                              HAL_MAX_DELAY);
+  }
+
+  if (status != HAL_OK) {
+    HAL_I2C_ErrorCallback(sim_dma.hi2c);
+  } else if (sim_dma.write) {
+    HAL_I2C_MemTxCpltCallback(sim_dma.hi2c);
+  } else {
+    HAL_I2C_MemRxCpltCallback(sim_dma.hi2c);
+  }
+
+  return true;
+}
+
+bool FramSimTransferPending(void) { return sim_dma.pending; }
+
+void FramSimWaitForInterrupt(void) { FramSimCompleteTransfer(); }
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c,
+                                          uint16_t DevAddress,
+                                          uint8_t *pData, uint16_t Size,
+                                          uint32_t Timeout) {
+  ++sim_stats.transactions;
+  sim_stats.bytes += 1 + Size;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_Init(void) {
+  FramSimReset(0);
+  return HAL_OK;
+}
+
+void HAL_Delay(uint32_t Delay) {}
+
+uint32_t HAL_GetTick(void) { return 0; }
+
+void SystemClock_Config(void) {}
+
+void Error_Handler(void) {}
+
+void MX_GPIO_Init(void) {}
+
+void MX_USART1_UART_Init(void) {}
+
+void MX_I2C2_Init(void) {}
+
+#endif  // NATIVE
@@ -1,5 +1,8 @@
 #include "main_helper.h"
 
+// host tests use the stubs in native/fram_sim.c
+#ifndef NATIVE
+
 /**
  * @brief System Clock Configuration
  * @retval None
@@ -84,3 +87,5 @@ void assert_failed(uint8_t *file, uint32_t line) {
   /* USER CODE END 6 */
 }
 #endif /* USE_FULL_ASSERT */
+
+#endif  // NATIVE
@@ -0,0 +1,99 @@
+/**
+ * @file fram_sim.h
+ * @brief Host-side simulator of the FRAM chips
+ *
+ * Implements the HAL I2C memory transfers on top of an array so the storage
+ * library and its tests run without a board. Device and memory addresses are
+ * decoded the same way as the chip selected with -DFRAM_MB85RC1MT or
+ * -DFRAM_FM24CL16B, including wraparound of the address counter at the end
+ * of memory. Transfers to other device addresses are not acknowledged.
+ *
+ * The number of transactions and bytes on the bus are counted to allow tests
+ * to check the efficiency of the drivers.
+ *
+ * DMA transfers are left pending until the core waits for an interrupt with
+ * __WFI() or FramSimCompleteTransfer() is called, at which point the transfer
+ * is performed and the HAL completion callback is called. This allows tests
+ * to observe the library while a transfer is in progress.
+ */
+
+#ifndef TEST_NATIVE_FRAM_SIM_H_
+#define TEST_NATIVE_FRAM_SIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Bus statistics of the simulator
+ */
+typedef struct {
+  /** Number of I2C transactions */
+  uint32_t transactions;
+  /** Number of bytes on the bus, including device and memory addresses */
+  uint32_t bytes;
+} FramSimStats;
+
+/**
+ * @brief Sets all memory to a value and resets the bus statistics
+ *
+ * @param value Value of every byte
+ */
+void FramSimReset(uint8_t value);
+
+/**
+ * @brief Get the bus statistics since the last reset
+ *
+ * @return Bus statistics
+ */
+FramSimStats FramSimGetStats(void);
+
+/**
+ * @brief Resets the bus statistics
+ */
+void FramSimClearStats(void);
+
+/**
+ * @brief Direct access to simulated memory
+ *
+ * @return Pointer to the first byte of memory
+ */
+uint8_t *FramSimMemory(void);
+
+/**
+ * @brief Get the size of simulated memory
+ *
+ * @return Size in bytes
+ */
+size_t FramSimSize(void);
+
+/**
+ * @brief Makes the following reads fail as on a bus error
+ *
+ * @param count Number of reads that fail
+ */
+void FramSimFailReads(uint32_t count);
+
+/**
+ * @brief Completes the pending DMA transfer
+ *
+ * @return true if a transfer was pending, false otherwise
+ */
+bool FramSimCompleteTransfer(void);
+
+/**
+ * @brief Checks for a pending DMA transfer
+ *
+ * @return true if a transfer is pending, false otherwise
+ */
+bool FramSimTransferPending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_FRAM_SIM_H_
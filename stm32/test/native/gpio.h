@@ -0,0 +1,21 @@
+/**
+ * @file gpio.h
+ * @brief Host replacement for the GPIO peripheral configuration
+ */
+
+#ifndef TEST_NATIVE_GPIO_H_
+#define TEST_NATIVE_GPIO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32wlxx_hal.h"
+
+void MX_GPIO_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_GPIO_H_
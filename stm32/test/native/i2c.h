@@ -0,0 +1,23 @@
+/**
+ * @file i2c.h
+ * @brief Host replacement for the I2C peripheral configuration
+ */
+
+#ifndef TEST_NATIVE_I2C_H_
+#define TEST_NATIVE_I2C_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32wlxx_hal.h"
+
+extern I2C_HandleTypeDef hi2c2;
+
+void MX_I2C2_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_I2C_H_
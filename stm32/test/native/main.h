@@ -0,0 +1,21 @@
+/**
+ * @file main.h
+ * @brief Host replacement for the application header
+ */
+
+#ifndef TEST_NATIVE_MAIN_H_
+#define TEST_NATIVE_MAIN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32wlxx_hal.h"
+
+void Error_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_MAIN_H_
@@ -0,0 +1,31 @@
+/**
+ * @file stm32_lpm.h
+ * @brief Host replacement for the low power manager utility
+ *
+ * Low power modes have no effect on the host.
+ */
+
+#ifndef TEST_NATIVE_STM32_LPM_H_
+#define TEST_NATIVE_STM32_LPM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum {
+  UTIL_LPM_ENABLE = 0,
+  UTIL_LPM_DISABLE,
+} UTIL_LPM_State_t;
+
+typedef uint32_t UTIL_LPM_bm_t;
+
+#define UTIL_LPM_SetStopMode(lpm_id_bm, state)
+#define UTIL_LPM_SetOffMode(lpm_id_bm, state)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_STM32_LPM_H_
@@ -0,0 +1,95 @@
+/**
+ * @file stm32wlxx_hal.h
+ * @brief Minimal HAL definitions for running tests on the host
+ *
+ * Only the types and functions used by the storage library and the tests are
+ * declared. I2C memory transfers are implemented by the FRAM simulator in
+ * fram_sim.c.
+ *
+ * @see fram_sim.h
+ */
+
+#ifndef TEST_NATIVE_STM32WLXX_HAL_H_
+#define TEST_NATIVE_STM32WLXX_HAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  HAL_OK = 0x00U,
+  HAL_ERROR = 0x01U,
+  HAL_BUSY = 0x02U,
+  HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct {
+  /** Unused */
+  uint32_t Instance;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT (0x00000001U)
+#define I2C_MEMADD_SIZE_16BIT (0x00000002U)
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+#define __NOP()
+
+/** Waiting for an interrupt completes the pending DMA transfer */
+#define __WFI() FramSimWaitForInterrupt()
+
+/**
+ * @brief Completes the pending DMA transfer, if any
+ *
+ * @see fram_sim.h
+ */
+void FramSimWaitForInterrupt(void);
+
+HAL_StatusTypeDef HAL_Init(void);
+
+void HAL_Delay(uint32_t Delay);
+
+uint32_t HAL_GetTick(void);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c,
+                                    uint16_t DevAddress, uint16_t MemAddress,
+                                    uint16_t MemAddSize, const uint8_t *pData,
+                                    uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c,
+                                   uint16_t DevAddress, uint16_t MemAddress,
+                                   uint16_t MemAddSize, uint8_t *pData,
+                                   uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *hi2c,
+                                        uint16_t DevAddress,
+                                        uint16_t MemAddress,
+                                        uint16_t MemAddSize,
+                                        const uint8_t *pData, uint16_t Size);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *hi2c,
+                                       uint16_t DevAddress,
+                                       uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t *pData,
+                                       uint16_t Size);
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c);
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c);
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c,
+                                          uint16_t DevAddress,
+                                          uint8_t *pData, uint16_t Size,
+                                          uint32_t Timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_STM32WLXX_HAL_H_
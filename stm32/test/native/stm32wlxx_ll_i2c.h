@@ -0,0 +1,11 @@
+/**
+ * @file stm32wlxx_ll_i2c.h
+ * @brief Host replacement, definitions are in stm32wlxx_hal.h
+ */
+
+#ifndef TEST_NATIVE_STM32WLXX_LL_I2C_H_
+#define TEST_NATIVE_STM32WLXX_LL_I2C_H_
+
+#include "stm32wlxx_hal.h"
+
+#endif  // TEST_NATIVE_STM32WLXX_LL_I2C_H_
@@ -0,0 +1,23 @@
+/**
+ * @file sys_app.h
+ * @brief Host replacement for the logging macros, prints to stdout
+ */
+
+#ifndef TEST_NATIVE_SYS_APP_H_
+#define TEST_NATIVE_SYS_APP_H_
+
+#include <stdio.h>
+
+#define TS_OFF 0
+#define TS_ON 1
+
+#define VLEVEL_OFF 0
+#define VLEVEL_L 1
+#define VLEVEL_M 2
+#define VLEVEL_H 3
+
+#define APP_PRINTF(...) printf(__VA_ARGS__)
+
+#define APP_LOG(TS, VL, ...) printf(__VA_ARGS__)
+
+#endif  // TEST_NATIVE_SYS_APP_H_
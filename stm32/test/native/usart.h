@@ -0,0 +1,21 @@
+/**
+ * @file usart.h
+ * @brief Host replacement for the USART peripheral configuration
+ */
+
+#ifndef TEST_NATIVE_USART_H_
+#define TEST_NATIVE_USART_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32wlxx_hal.h"
+
+void MX_USART1_UART_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_USART_H_
@@ -0,0 +1,27 @@
+/**
+ * @file utilities_def.h
+ * @brief Host replacement for the utilities configuration
+ *
+ * Only the identifiers used by the libraries under test are defined.
+ */
+
+#ifndef TEST_NATIVE_UTILITIES_DEF_H_
+#define TEST_NATIVE_UTILITIES_DEF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Low power manager identifiers */
+typedef enum {
+  CFG_LPM_APPLI_Id,
+  CFG_LPM_UART_TX_Id,
+  CFG_LPM_FRAM_Id,
+  CFG_LPM_SDI12_Id,
+} CFG_LPM_Id_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TEST_NATIVE_UTILITIES_DEF_H_
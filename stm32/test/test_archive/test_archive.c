@@ -0,0 +1,232 @@
+/**
+ * @file test_archive.c
+ *
+ * @brief Tests reading archives written by the python package
+ *
+ * The archive was written by ents.proto.ArchiveWriter with a block size of 64
+ * bytes. It holds power measurements of cells 10 and 11 of logger 1 every 60
+ * seconds, with a voltage of 37 V plus the minute and a current of 185 A plus
+ * the cell id, in blocks of 3 measurements.
+ *
+ * @see archive.h
+ *
+ * @author John Madden <jmadden173@pm.me>
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "archive.h"
+#include "gpio.h"
+#include "main.h"
+#include "main_helper.h"
+#include "usart.h"
+
+/**
+ * @brief Generated from CubeMX
+ */
+void SystemClock_Config(void);
+
+/** First timestamp of the archive */
+#define TS 1436079600
+
+/** Archive written by the python package */
+static const uint8_t archive_data[] = {
+    0x45, 0x4e, 0x54, 0x53, 0x41, 0x52, 0x43, 0x01, 0x18, 0x0a, 0x0a, 0x08,
+    0x0a, 0x10, 0x01, 0x18, 0xf0, 0xab, 0xe3, 0xac, 0x05, 0x12, 0x0a, 0x25,
+    0x00, 0x00, 0x14, 0x42, 0x2d, 0x00, 0x00, 0x43, 0x43, 0x18, 0x0a, 0x0a,
+    0x08, 0x0a, 0x10, 0x01, 0x18, 0xac, 0xac, 0xe3, 0xac, 0x05, 0x12, 0x0a,
+    0x25, 0x00, 0x00, 0x18, 0x42, 0x2d, 0x00, 0x00, 0x43, 0x43, 0x18, 0x0a,
+    0x0a, 0x08, 0x0a, 0x10, 0x01, 0x18, 0xe8, 0xac, 0xe3, 0xac, 0x05, 0x12,
+    0x0a, 0x25, 0x00, 0x00, 0x1c, 0x42, 0x2d, 0x00, 0x00, 0x43, 0x43, 0x18,
+    0x0a, 0x0a, 0x08, 0x0b, 0x10, 0x01, 0x18, 0xf0, 0xab, 0xe3, 0xac, 0x05,
+    0x12, 0x0a, 0x25, 0x00, 0x00, 0x14, 0x42, 0x2d, 0x00, 0x00, 0x44, 0x43,
+    0x18, 0x0a, 0x0a, 0x08, 0x0b, 0x10, 0x01, 0x18, 0xac, 0xac, 0xe3, 0xac,
+    0x05, 0x12, 0x0a, 0x25, 0x00, 0x00, 0x18, 0x42, 0x2d, 0x00, 0x00, 0x44,
+    0x43, 0x18, 0x0a, 0x0a, 0x08, 0x0b, 0x10, 0x01, 0x18, 0xe8, 0xac, 0xe3,
+    0xac, 0x05, 0x12, 0x0a, 0x25, 0x00, 0x00, 0x1c, 0x42, 0x2d, 0x00, 0x00,
+    0x44, 0x43, 0x18, 0x0a, 0x0a, 0x08, 0x0a, 0x10, 0x01, 0x18, 0xa4, 0xad,
+    0xe3, 0xac, 0x05, 0x12, 0x0a, 0x25, 0x00, 0x00, 0x20, 0x42, 0x2d, 0x00,
+    0x00, 0x43, 0x43, 0x18, 0x0a, 0x0a, 0x08, 0x0a, 0x10, 0x01, 0x18, 0xe0,
+    0xad, 0xe3, 0xac, 0x05, 0x12, 0x0a, 0x25, 0x00, 0x00, 0x24, 0x42, 0x2d,
+    0x00, 0x00, 0x43, 0x43, 0x18, 0x0a, 0x0a, 0x08, 0x0a, 0x10, 0x01, 0x18,
+    0x9c, 0xae, 0xe3, 0xac, 0x05, 0x12, 0x0a, 0x25, 0x00, 0x00, 0x28, 0x42,
+    0x2d, 0x00, 0x00, 0x43, 0x43, 0x18, 0x0a, 0x0a, 0x08, 0x0b, 0x10, 0x01,
+    0x18, 0xa4, 0xad, 0xe3, 0xac, 0x05, 0x12, 0x0a, 0x25, 0x00, 0x00, 0x20,
+    0x42, 0x2d, 0x00, 0x00, 0x44, 0x43, 0x18, 0x0a, 0x0a, 0x08, 0x0b, 0x10,
+    0x01, 0x18, 0xe0, 0xad, 0xe3, 0xac, 0x05, 0x12, 0x0a, 0x25, 0x00, 0x00,
+    0x24, 0x42, 0x2d, 0x00, 0x00, 0x44, 0x43, 0x18, 0x0a, 0x0a, 0x08, 0x0b,
+    0x10, 0x01, 0x18, 0x9c, 0xae, 0xe3, 0xac, 0x05, 0x12, 0x0a, 0x25, 0x00,
+    0x00, 0x28, 0x42, 0x2d, 0x00, 0x00, 0x44, 0x43, 0x01, 0x00, 0x00, 0x00,
+    0x0a, 0x00, 0x00, 0x00, 0xf0, 0xd5, 0x98, 0x55, 0x68, 0xd6, 0x98, 0x55,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4b, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00,
+    0xf0, 0xd5, 0x98, 0x55, 0x68, 0xd6, 0x98, 0x55, 0x53, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x4b, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0xa4, 0xd6, 0x98, 0x55,
+    0x1c, 0xd7, 0x98, 0x55, 0x9e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4b, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x0b, 0x00, 0x00, 0x00, 0xa4, 0xd6, 0x98, 0x55, 0x1c, 0xd7, 0x98, 0x55,
+    0xe9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4b, 0x00, 0x00, 0x00,
+    0x03, 0x00, 0x00, 0x00, 0x34, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x45, 0x49, 0x44, 0x58,
+};
+
+/** Buffer for blocks */
+static uint8_t block_buffer[128];
+
+/**
+ * @brief Matching measurements of a query
+ */
+typedef struct {
+  /** Measurements */
+  Measurement meas[12];
+  /** Number of measurements */
+  int count;
+  /** Number of measurements before stopping the query */
+  int limit;
+} Matches;
+
+/**
+ * @brief Setup code that runs at the start of every test
+ */
+void setUp(void) {}
+
+/**
+ * @brief Tear down code that runs at the end of every test
+ */
+void tearDown(void) {}
+
+/**
+ * @brief Reads bytes of archive_data
+ */
+static bool ReadArchive(void *ctx, uint64_t offset, uint8_t *data,
+                        size_t len) {
+  const size_t *size = ctx;
+  if (offset > *size || len > *size - offset) {
+    return false;
+  }
+  memcpy(data, archive_data + offset, len);
+  return true;
+}
+
+/**
+ * @brief Stores matching measurements in a Matches
+ */
+static bool StoreMatch(const Measurement *meas, void *arg) {
+  Matches *matches = arg;
+  matches->meas[matches->count++] = *meas;
+  return matches->count != matches->limit;
+}
+
+void TestArchiveOpen(void) {
+  size_t size = sizeof(archive_data);
+  Archive archive;
+  TEST_ASSERT_EQUAL(0, ArchiveOpen(&archive, ReadArchive, &size, size));
+  TEST_ASSERT_EQUAL(4, archive.num_blocks);
+
+  ArchiveBlock block;
+  TEST_ASSERT_EQUAL(0, ArchiveGetBlock(&archive, 3, &block));
+  TEST_ASSERT_EQUAL(1, block.logger_id);
+  TEST_ASSERT_EQUAL(11, block.cell_id);
+  TEST_ASSERT_EQUAL(TS + 180, block.ts_min);
+  TEST_ASSERT_EQUAL(TS + 300, block.ts_max);
+  TEST_ASSERT_EQUAL(3, block.count);
+  TEST_ASSERT_EQUAL(-1, ArchiveGetBlock(&archive, 4, &block));
+}
+
+void TestArchiveOpenInvalid(void) {
+  Archive archive;
+
+  // missing trailer
+  size_t size = sizeof(archive_data) - 1;
+  TEST_ASSERT_EQUAL(-1, ArchiveOpen(&archive, ReadArchive, &size, size));
+
+  // too short for a header and trailer
+  size = 8;
+  TEST_ASSERT_EQUAL(-1, ArchiveOpen(&archive, ReadArchive, &size, size));
+}
+
+void TestArchiveRead(void) {
+  size_t size = sizeof(archive_data);
+  Archive archive;
+  TEST_ASSERT_EQUAL(0, ArchiveOpen(&archive, ReadArchive, &size, size));
+
+  // second to fifth minute of cell 11
+  ArchiveQuery query = {
+      .has_cell_id = true, .cell_id = 11, .start = TS + 60, .end = TS + 240};
+  Matches matches = {.count = 0, .limit = -1};
+  TEST_ASSERT_EQUAL(4, ArchiveRead(&archive, &query, block_buffer,
+                                   sizeof(block_buffer), StoreMatch,
+                                   &matches));
+  TEST_ASSERT_EQUAL(4, matches.count);
+
+  for (int i = 0; i < 4; i++) {
+    const Measurement *meas = &matches.meas[i];
+    TEST_ASSERT_EQUAL(Measurement_power_tag, meas->which_measurement);
+    TEST_ASSERT_EQUAL(1, meas->meta.logger_id);
+    TEST_ASSERT_EQUAL(11, meas->meta.cell_id);
+    TEST_ASSERT_EQUAL(TS + 60 * (i + 1), meas->meta.ts);
+    TEST_ASSERT_EQUAL_FLOAT(38 + i, meas->measurement.power.voltage);
+    TEST_ASSERT_EQUAL_FLOAT(196, meas->measurement.power.current);
+  }
+
+  // all measurements of logger 1
+  query = (ArchiveQuery){
+      .has_logger_id = true, .logger_id = 1, .start = 0, .end = UINT32_MAX};
+  matches.count = 0;
+  TEST_ASSERT_EQUAL(12, ArchiveRead(&archive, &query, block_buffer,
+                                    sizeof(block_buffer), StoreMatch,
+                                    &matches));
+
+  // stopped by the callback
+  matches.count = 0;
+  matches.limit = 2;
+  TEST_ASSERT_EQUAL(2, ArchiveRead(&archive, &query, block_buffer,
+                                   sizeof(block_buffer), StoreMatch,
+                                   &matches));
+
+  // no matching block
+  query.logger_id = 2;
+  TEST_ASSERT_EQUAL(0, ArchiveRead(&archive, &query, block_buffer,
+                                   sizeof(block_buffer), StoreMatch,
+                                   &matches));
+
+  // blocks do not fit the buffer
+  query.logger_id = 1;
+  TEST_ASSERT_EQUAL(-1, ArchiveRead(&archive, &query, block_buffer, 64,
+                                    StoreMatch, &matches));
+}
+
+/**
+ * @brief Entry point for archive test
+ * @retval int
+ */
+int main(void) {
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick.
+   */
+  HAL_Init();
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+
+  // wait for UART
+  for (int i = 0; i < 1000000; i++) {
+    __NOP();
+  }
+
+  // Unit testing
+  UNITY_BEGIN();
+
+  RUN_TEST(TestArchiveOpen);
+  RUN_TEST(TestArchiveOpenInvalid);
+  RUN_TEST(TestArchiveRead);
+
+  UNITY_END();
+}
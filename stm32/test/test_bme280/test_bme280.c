@@ -19,6 +19,7 @@
 #include "i2c.h"
 #include "main.h"
 #include "main_helper.h"
+#include "soil_power_sensor.pb.h"
 #include "sys_app.h"
 #include "usart.h"
 
@@ -70,12 +71,13 @@ void test_measure_humidity(void) {
 }
 
 void test_measure(void) {
-  uint8_t buffer[256];
-  size_t buffer_len = 0;
+  uint8_t buffer[Measurement_size];
+  pb_ostream_t ostream = pb_ostream_from_buffer(buffer, sizeof(buffer));
 
-  buffer_len = BME280Measure(buffer);
+  bool status = BME280Measure(&ostream);
 
-  TEST_ASSERT_GREATER_THAN(0, buffer_len);
+  TEST_ASSERT_TRUE(status);
+  TEST_ASSERT_GREATER_THAN(0, ostream.bytes_written);
 }
 
 /**
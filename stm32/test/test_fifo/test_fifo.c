@@ -5,6 +5,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <unity.h>
 
 #include "fifo.h"
@@ -12,9 +13,21 @@
 #include "i2c.h"
 #include "main.h"
 #include "main_helper.h"
+#include "transcoder.h"
 #include "usart.h"
 
-void setUp(void) { FramBufferClear(); }
+#ifdef NATIVE
+#include "fram_sim.h"
+#endif  // NATIVE
+
+/** Stored size of a measurement of fewer than 128 bytes */
+#define RECORD_SIZE(len) ((len) + 3)
+
+void setUp(void) {
+  FramBufferClear();
+  FramSetPolicy(FIFO_POLICY_DROP_NEW);
+  FramResetDiscards();
+}
 
 void tearDown(void) {}
 
@@ -27,16 +40,6 @@ void test_FramPut_ValidData(void) {
   TEST_ASSERT_EQUAL(1, FramBufferLen());
 }
 
-void test_FramPut_BufferFull(void) {
-  // Data size is larger than the buffer size
-  const uint16_t kFullBufferSize = kFramBufferSize + 1;
-  uint8_t data[kFullBufferSize];
-
-  FramStatus status = FramPut(data, sizeof(data));
-
-  TEST_ASSERT_EQUAL(FRAM_BUFFER_FULL, status);
-}
-
 void test_FramPut_Sequential(void) {
   const int niters = 20;
 
@@ -59,7 +62,7 @@ void test_FramPut_Sequential_BufferFull(void) {
   // starting values
   uint8_t data[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
 
-  const int niters = kFramBufferSize / (sizeof(data) + 1);
+  const int niters = FramBufferSize() / RECORD_SIZE(sizeof(data));
 
   // write 100 times, therefore 1100 bytes (data + len)
   for (int i = 0; i < niters; i++) {
@@ -71,11 +74,168 @@ void test_FramPut_Sequential_BufferFull(void) {
   TEST_ASSERT_EQUAL(FRAM_BUFFER_FULL, status_full);
 }
 
+/**
+ * @brief Fills the buffer with numbered measurements of 9 bytes
+ *
+ * The first 4 bytes of each measurement are its number.
+ *
+ * @return Number of records in the buffer
+ */
+static uint32_t fill_numbered(void) {
+  uint8_t data[9] = {0};
+  uint32_t n = 0;
+  while (true) {
+    memcpy(data, &n, sizeof(n));
+    if (FramPut(data, sizeof(data)) != FRAM_OK) {
+      break;
+    }
+    ++n;
+  }
+
+  TEST_ASSERT_EQUAL(n, FramBufferLen());
+  return n;
+}
+
+/**
+ * @brief Gets the next record and returns its number
+ */
+static uint32_t get_numbered(void) {
+  uint8_t data[256];
+  size_t len = 0;
+  TEST_ASSERT_EQUAL(FRAM_OK, FramGet(data, sizeof(data), &len));
+  TEST_ASSERT_EQUAL(9, len);
+
+  uint32_t n = 0;
+  memcpy(&n, data, sizeof(n));
+  return n;
+}
+
+void test_FramPut_BufferFull(void) {
+  fill_numbered();
+
+  // Data size is larger than the free space. Space is checked before any
+  // data is read so the array does not need to be the full size.
+  uint8_t data[16] = {0};
+
+  FramStatus status = FramPut(data, FRAM_RECORD_MAX_LEN);
+
+  TEST_ASSERT_EQUAL(FRAM_BUFFER_FULL, status);
+}
+
+void test_FramPut_DropNew(void) {
+  const uint32_t n = fill_numbered();
+
+  uint8_t data[9] = {0};
+  TEST_ASSERT_EQUAL(FRAM_BUFFER_FULL, FramPut(data, sizeof(data)));
+  TEST_ASSERT_EQUAL(n, FramBufferLen());
+
+  // one refused while filling, one refused above
+  FifoDiscards discards;
+  FramGetDiscards(&discards);
+  TEST_ASSERT_EQUAL(2, discards.drop_new);
+  TEST_ASSERT_EQUAL(0, discards.drop_old);
+  TEST_ASSERT_EQUAL(0, discards.decimate);
+
+  // oldest record is kept
+  TEST_ASSERT_EQUAL(0, get_numbered());
+}
+
+void test_FramPut_DropOld(void) {
+  const uint32_t n = fill_numbered();
+  FramResetDiscards();
+  FramSetPolicy(FIFO_POLICY_DROP_OLD);
+
+  uint8_t data[9] = {0};
+  for (uint32_t i = n; i < n + 3; i++) {
+    memcpy(data, &i, sizeof(i));
+    TEST_ASSERT_EQUAL(FRAM_OK, FramPut(data, sizeof(data)));
+  }
+  TEST_ASSERT_EQUAL(n, FramBufferLen());
+
+  FifoDiscards discards;
+  FramGetDiscards(&discards);
+  TEST_ASSERT_EQUAL(0, discards.drop_new);
+  TEST_ASSERT_EQUAL(3, discards.drop_old);
+
+  // the oldest records were evicted
+  TEST_ASSERT_EQUAL(3, get_numbered());
+  FramCommit(FramBufferLen() - 1);
+  TEST_ASSERT_EQUAL(n + 2, get_numbered());
+}
+
+void test_FramPut_DropOld_LargerRecord(void) {
+  fill_numbered();
+  FramSetPolicy(FIFO_POLICY_DROP_OLD);
+
+  // evicts as many small records as needed
+  uint8_t data[25] = {0};
+  TEST_ASSERT_EQUAL(FRAM_OK, FramPut(data, sizeof(data)));
+
+  FifoDiscards discards;
+  FramGetDiscards(&discards);
+  TEST_ASSERT_GREATER_OR_EQUAL(2, discards.drop_old);
+  TEST_ASSERT_EQUAL(discards.drop_old, get_numbered());
+}
+
+void test_FramPut_DropOld_TooLarge(void) {
+  const uint32_t n = fill_numbered();
+  FramResetDiscards();
+  FramSetPolicy(FIFO_POLICY_DROP_OLD);
+
+  // refused before any record is evicted
+  static uint8_t data[FRAM_RECORD_MAX_LEN + 1];
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, FramPut(data, sizeof(data)));
+  TEST_ASSERT_EQUAL(n, FramBufferLen());
+
+  FifoDiscards discards;
+  FramGetDiscards(&discards);
+  TEST_ASSERT_EQUAL(0, discards.drop_old);
+  TEST_ASSERT_EQUAL(0, get_numbered());
+}
+
+void test_FramPut_DropOld_Peek(void) {
+  fill_numbered();
+  FramSetPolicy(FIFO_POLICY_DROP_OLD);
+
+  uint8_t batch[3 * RECORD_SIZE(9)];
+  uint32_t count = 0;
+  TEST_ASSERT_EQUAL(FRAM_OK, FramPeekBatch(batch, sizeof(batch), &count));
+  TEST_ASSERT_EQUAL(3, count);
+
+  // evict the first record of the batch while it is uploaded
+  uint8_t data[9] = {0};
+  TEST_ASSERT_EQUAL(FRAM_OK, FramPut(data, sizeof(data)));
+
+  // only the rest of the batch is removed
+  TEST_ASSERT_EQUAL(FRAM_OK, FramCommit(count));
+  TEST_ASSERT_EQUAL(3, get_numbered());
+}
+
+void test_FramPut_Decimate(void) {
+  const uint32_t n = fill_numbered();
+  FramResetDiscards();
+  FramSetPolicy(FIFO_POLICY_DECIMATE);
+
+  // every other record is stored
+  uint8_t data[9] = {0};
+  for (int i = 0; i < 4; i++) {
+    FramStatus status = FramPut(data, sizeof(data));
+    TEST_ASSERT_EQUAL((i % 2 == 0) ? FRAM_BUFFER_FULL : FRAM_OK, status);
+  }
+  TEST_ASSERT_EQUAL(n, FramBufferLen());
+
+  // two refused and two evicted
+  FifoDiscards discards;
+  FramGetDiscards(&discards);
+  TEST_ASSERT_EQUAL(4, discards.decimate);
+  TEST_ASSERT_EQUAL(2, get_numbered());
+}
+
 void test_FramGet_BufferEmpty(void) {
-  uint8_t data[kFramBufferSize];
-  uint8_t data_len;
+  uint8_t data[256];
+  size_t data_len;
 
-  FramStatus status = FramGet(data, &data_len);
+  FramStatus status = FramGet(data, sizeof(data), &data_len);
 
   TEST_ASSERT_EQUAL(FRAM_BUFFER_EMPTY, status);
 }
@@ -85,8 +245,8 @@ void test_FramGet_ValidData(void) {
   FramPut(put_data, sizeof(put_data));
 
   uint8_t get_data[sizeof(put_data)];
-  uint8_t get_data_len;
-  FramStatus status = FramGet(get_data, &get_data_len);
+  size_t get_data_len;
+  FramStatus status = FramGet(get_data, sizeof(get_data), &get_data_len);
 
   TEST_ASSERT_EQUAL(FRAM_OK, status);
   TEST_ASSERT_EQUAL_UINT8_ARRAY(put_data, get_data, sizeof(put_data));
@@ -118,8 +278,8 @@ void test_FramGet_Sequential(void) {
 
   // read back all the data
   for (int i = 0; i < niters; i++) {
-    uint8_t get_data_len = 0;
-    FramStatus status_get = FramGet(get_data, &get_data_len);
+    size_t get_data_len = 0;
+    FramStatus status_get = FramGet(get_data, sizeof(get_data), &get_data_len);
 
     TEST_ASSERT_EQUAL(FRAM_OK, status_get);
     TEST_ASSERT_EQUAL_INT(10, get_data_len);
@@ -138,7 +298,7 @@ void test_FramGet_Sequential_BufferFull(void) {
   // starting values
   uint8_t data[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
 
-  const int niters = (kFramBufferSize / (sizeof(data) + 1));
+  const int niters = (FramBufferSize() / RECORD_SIZE(sizeof(data)));
 
   // write 100 times, therefore 1100 bytes (data + len)
   for (int i = 0; i < niters; i++) {
@@ -162,8 +322,8 @@ void test_FramGet_Sequential_BufferFull(void) {
   uint8_t get_data[sizeof(data)] = {0};
 
   for (int i = 0; i < niters; i++) {
-    uint8_t get_data_len = 0;
-    status = FramGet(get_data, &get_data_len);
+    size_t get_data_len = 0;
+    status = FramGet(get_data, sizeof(get_data), &get_data_len);
 
     TEST_ASSERT_EQUAL(FRAM_OK, status);
     TEST_ASSERT_EQUAL_INT(sizeof(data), get_data_len);
@@ -176,6 +336,108 @@ void test_FramGet_Sequential_BufferFull(void) {
   }
 }
 
+void test_FramPut_LargeRecord(void) {
+  static uint8_t put_data[FRAM_RECORD_MAX_LEN + 1];
+  for (int i = 0; i < sizeof(put_data); i++) {
+    put_data[i] = i;
+  }
+
+  // records are not limited to 255 bytes
+  FramStatus status = FramPut(put_data, FRAM_RECORD_MAX_LEN);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(FRAM_RECORD_MAX_SIZE, FramBufferUsed());
+
+  static uint8_t get_data[FRAM_RECORD_MAX_LEN];
+  size_t get_data_len = 0;
+  status = FramGet(get_data, sizeof(get_data), &get_data_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(FRAM_RECORD_MAX_LEN, get_data_len);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(put_data, get_data, FRAM_RECORD_MAX_LEN);
+
+  status = FramPut(put_data, sizeof(put_data));
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, status);
+}
+
+void test_FramPutRecord_Type(void) {
+  const uint8_t put_data[] = {1, 2, 3};
+  FramStatus status = FramPutRecord(0x42, put_data, sizeof(put_data));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  uint8_t type = 0;
+  uint8_t get_data[sizeof(put_data)];
+  size_t get_data_len = 0;
+  status = FramGetRecord(&type, get_data, sizeof(get_data), &get_data_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(0x42, type);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(put_data, get_data, sizeof(put_data));
+}
+
+void test_FramGet_TooSmall(void) {
+  const uint8_t put_data[] = {1, 2, 3, 4};
+  FramPut(put_data, sizeof(put_data));
+
+  // the record stays in the buffer
+  uint8_t get_data[sizeof(put_data) - 1];
+  size_t get_data_len = 0;
+  FramStatus status = FramGet(get_data, sizeof(get_data), &get_data_len);
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, status);
+  TEST_ASSERT_EQUAL(1, FramBufferLen());
+}
+
+void test_FramGet_CorruptRecord(void) {
+  uint8_t put_data[5] = {0};
+  for (int i = 0; i < 3; i++) {
+    put_data[0] = i;
+    FramPut(put_data, sizeof(put_data));
+  }
+  FramFlush();
+
+  // flip a bit in the data of the second record
+  const FramAddr addr = FRAM_BUFFER_START + RECORD_SIZE(sizeof(put_data)) + 3;
+  uint8_t byte = 0;
+  FramRead(addr, 1, &byte);
+  byte ^= 0x01;
+  FramWrite(addr, &byte, 1);
+
+  // the corrupted record is skipped
+  uint8_t get_data[sizeof(put_data)];
+  size_t get_data_len = 0;
+  FramStatus status = FramGet(get_data, sizeof(get_data), &get_data_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(0, get_data[0]);
+  status = FramGet(get_data, sizeof(get_data), &get_data_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(2, get_data[0]);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+
+  FifoDiscards discards;
+  FramGetDiscards(&discards);
+  TEST_ASSERT_EQUAL(1, discards.corrupt);
+}
+
+void test_FramGet_InvalidLength(void) {
+  const uint8_t put_data[5] = {0};
+  for (int i = 0; i < 3; i++) {
+    FramPut(put_data, sizeof(put_data));
+  }
+  FramFlush();
+
+  // a length longer than a varint of 2 bytes
+  const uint8_t header[] = {0xFF, 0xFF};
+  FramWrite(FRAM_BUFFER_START, header, sizeof(header));
+
+  // records can not be found so the buffer is cleared
+  uint8_t get_data[sizeof(put_data)];
+  size_t get_data_len = 0;
+  FramStatus status = FramGet(get_data, sizeof(get_data), &get_data_len);
+  TEST_ASSERT_EQUAL(FRAM_ERROR, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+
+  FifoDiscards discards;
+  FramGetDiscards(&discards);
+  TEST_ASSERT_EQUAL(3, discards.corrupt);
+}
+
 void test_FramBufferLen(void) {
   // Assuming that the buffer length is initially 0
   TEST_ASSERT_EQUAL(0, FramBufferLen());
@@ -207,21 +469,23 @@ void test_FramBuffer_Wraparound(void) {
   // checks for errors when read addr > write addr
   FramStatus status;
 
-  // Set the memory after the FIFO buffer to a unique character to check OOB
-  // memory write
+  // Set the memory next to the FIFO buffer to a unique character to check OOB
+  // memory write. The buffer can extend to the end of the chip so use the
+  // address before the start when there is one.
+  const FramAddr oob_addr =
+      (FRAM_BUFFER_START > 0) ? FRAM_BUFFER_START - 1 : FRAM_BUFFER_END + 1;
   uint8_t oob_before = 0;
   uint8_t oob_after = 0;
   const uint8_t oob_check = 0xFF;
-  status = FramRead(FRAM_BUFFER_END + 1, 1,
-                    &oob_before);  // to be restored afterwards
+  status = FramRead(oob_addr, 1, &oob_before);  // to be restored afterwards
   TEST_ASSERT_EQUAL(FRAM_OK, status);
-  status = FramWrite(FRAM_BUFFER_END + 1, &oob_check, 1);
+  status = FramWrite(oob_addr, &oob_check, 1);
   TEST_ASSERT_EQUAL(FRAM_OK, status);
 
   // write block size to handle length
-  // block_size+1 must not be a factor of the FIFO's space
+  // the record size must not be a factor of the FIFO's space
   uint8_t block_size = 70;
-  while (kFramBufferSize % (block_size + 1) == 0) {
+  while (FramBufferSize() % RECORD_SIZE(block_size) == 0) {
     block_size += 1;
   }
 
@@ -236,9 +500,9 @@ void test_FramBuffer_Wraparound(void) {
   }
 
   uint8_t buffer[256];
-  uint8_t buffer_length;
+  size_t buffer_length;
 
-  // move write to before the end of physical memory in FRAM
+  // move write to before the end of the buffer in FRAM
   // if the assigned FRAM memory is [0, 1769], then a block_size of 16 (+1
   // length byte) means that the 104th block starts at 1768 and must wrap
   // around. read 0, write 1768
@@ -251,7 +515,7 @@ void test_FramBuffer_Wraparound(void) {
   // advance read all the way to the end to make room for the wraparound
   // read 1768, write 1768
   while (FramBufferLen() != 0) {
-    status = FramGet(buffer, &buffer_length);
+    status = FramGet(buffer, sizeof(buffer), &buffer_length);
     TEST_ASSERT_EQUAL(FRAM_OK, status);
   }
 
@@ -263,17 +527,17 @@ void test_FramBuffer_Wraparound(void) {
 
   // observe the wraparound
   // read 14, write 14
-  status = FramGet(buffer, &buffer_length);
+  status = FramGet(buffer, sizeof(buffer), &buffer_length);
   TEST_ASSERT_EQUAL(FRAM_OK, status);
 
   // test that the data was successfully retrieved across the wraparound
   TEST_ASSERT_EQUAL_UINT8_ARRAY(buffer, junk_data, block_size);
 
   // test that no data was written out of bounds
-  status = FramRead(FRAM_BUFFER_END + 1, 1, &oob_after);
+  status = FramRead(oob_addr, 1, &oob_after);
   TEST_ASSERT_EQUAL(FRAM_OK, status);
   TEST_ASSERT_EQUAL(oob_after, oob_check);
-  status = FramWrite(FRAM_BUFFER_END + 1, &oob_before, 1);  // restore
+  status = FramWrite(oob_addr, &oob_before, 1);  // restore
   TEST_ASSERT_EQUAL(FRAM_OK, status);
 
   // status = FramPut(zeros, block_size);
@@ -288,13 +552,17 @@ void test_LoadSaveBufferState(void) {
   // Add some data
   const uint8_t test_data[] = {0x11, 0x22, 0x33};
   for (int i = 0; i < 10; i++) {
-    // note that FramPut() calls FramSaveBufferState()
     status = FramPut(test_data, sizeof(test_data));
     TEST_ASSERT_EQUAL(FRAM_OK, status);
   }
 
+  // note that FramFlush() calls FramSaveBufferState()
+  status = FramFlush();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
   // Load the new buffer state
-  uint16_t saved_read_addr, saved_write_addr, saved_buffer_len;
+  FramAddr saved_read_addr, saved_write_addr;
+  uint32_t saved_buffer_len;
   status = FramLoadBufferState(&saved_read_addr, &saved_write_addr,
                                &saved_buffer_len);
   TEST_ASSERT_EQUAL(FRAM_OK, status);
@@ -305,14 +573,568 @@ void test_LoadSaveBufferState(void) {
   TEST_ASSERT_EQUAL(FRAM_BUFFER_START, saved_read_addr);
 
   uint8_t retrieved_data[sizeof(test_data)];
-  uint8_t retrieved_len;
+  size_t retrieved_len;
   for (int i = 0; i < 10; i++) {
-    status = FramGet(retrieved_data, &retrieved_len);
+    status = FramGet(retrieved_data, sizeof(retrieved_data), &retrieved_len);
     TEST_ASSERT_EQUAL(FRAM_OK, status);
     TEST_ASSERT_EQUAL_UINT8_ARRAY(test_data, retrieved_data, sizeof(test_data));
   }
 }
 
+void test_FramPeekBatch_BufferEmpty(void) {
+  uint8_t data[64];
+  uint32_t count = 1;
+
+  FramStatus status = FramPeekBatch(data, sizeof(data), &count);
+
+  TEST_ASSERT_EQUAL(FRAM_BUFFER_EMPTY, status);
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+void test_FramPeekBatch_Commit(void) {
+  uint8_t put_data[5] = {0, 1, 2, 3, 4};
+  for (int i = 0; i < 10; i++) {
+    FramStatus status = FramPut(put_data, sizeof(put_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    put_data[0]++;
+  }
+
+  // room for 4 full records and part of a fifth
+  uint8_t data[4 * RECORD_SIZE(sizeof(put_data)) + 3];
+  uint32_t count = 0;
+  FramStatus status = FramPeekBatch(data, sizeof(data), &count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(4, count);
+
+  size_t offset = 0;
+  for (int i = 0; i < count; i++) {
+    FramRecord record;
+    status = FramRecordDecode(data + offset, sizeof(data) - offset, &record);
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    TEST_ASSERT_EQUAL(sizeof(put_data), record.len);
+    TEST_ASSERT_EQUAL(i, record.data[0]);
+    offset += record.size;
+  }
+
+  // the partial record is not complete
+  FramRecord partial;
+  status = FramRecordDecode(data + offset, sizeof(data) - offset, &partial);
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, status);
+
+  // peeking does not remove records
+  TEST_ASSERT_EQUAL(10, FramBufferLen());
+  status = FramPeekBatch(data, sizeof(data), &count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(4, count);
+  TEST_ASSERT_EQUAL(0, data[2]);
+
+  status = FramCommit(count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(6, FramBufferLen());
+
+  // commit without a matching peek
+  status = FramCommit(2);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(4, FramBufferLen());
+
+  uint8_t get_data[sizeof(put_data)];
+  size_t get_data_len;
+  status = FramGet(get_data, sizeof(get_data), &get_data_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(6, get_data[0]);
+
+  status = FramCommit(4);
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, status);
+}
+
+void test_FramPeekBatch_CorruptRecord(void) {
+  uint8_t put_data[5] = {0};
+  for (int i = 0; i < 2; i++) {
+    put_data[0] = i;
+    FramPut(put_data, sizeof(put_data));
+  }
+  FramFlush();
+
+  // flip a bit in the CRC of the first record
+  const FramAddr addr = FRAM_BUFFER_START + RECORD_SIZE(sizeof(put_data)) - 1;
+  uint8_t byte = 0;
+  FramRead(addr, 1, &byte);
+  byte ^= 0x01;
+  FramWrite(addr, &byte, 1);
+
+  // corrupted records are returned so they are committed with the batch
+  uint8_t data[64];
+  uint32_t count = 0;
+  FramStatus status = FramPeekBatch(data, sizeof(data), &count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(2, count);
+
+  FramRecord record;
+  status = FramRecordDecode(data, sizeof(data), &record);
+  TEST_ASSERT_EQUAL(FRAM_CORRUPT, status);
+  TEST_ASSERT_EQUAL(RECORD_SIZE(sizeof(put_data)), record.size);
+  status = FramRecordDecode(data + record.size, sizeof(data) - record.size,
+                            &record);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(1, record.data[0]);
+
+  status = FramCommit(count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+}
+
+void test_FramPackBatch(void) {
+  uint8_t put_data[25] = {0};
+  for (int i = 0; i < 10; i++) {
+    put_data[0] = i;
+    FramPut(put_data, sizeof(put_data));
+  }
+
+  uint8_t batch[256];
+  uint32_t count = 0;
+  FramStatus status = FramPeekBatch(batch, sizeof(batch), &count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(9, count);
+
+  // as many measurements as fit, each preceded by its length
+  uint8_t packed[4 * (sizeof(put_data) + 1) + 10];
+  size_t len = FramPackBatch(batch, sizeof(batch), &count, packed,
+                             sizeof(packed));
+  TEST_ASSERT_EQUAL(4, count);
+  TEST_ASSERT_EQUAL(4 * (sizeof(put_data) + 1), len);
+  for (int i = 0; i < count; i++) {
+    const uint8_t *record = packed + i * (sizeof(put_data) + 1);
+    TEST_ASSERT_EQUAL(sizeof(put_data), record[0]);
+    TEST_ASSERT_EQUAL(i, record[1]);
+  }
+
+  // packing in place gives the same result
+  uint8_t expected[sizeof(packed)];
+  memcpy(expected, packed, len);
+  count = 9;
+  len = FramPackBatch(batch, sizeof(batch), &count, batch, sizeof(packed));
+  TEST_ASSERT_EQUAL(4, count);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, batch, len);
+
+  status = FramCommit(count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(6, FramBufferLen());
+}
+
+void test_FramPackBatch_CorruptRecord(void) {
+  uint8_t put_data[5] = {0};
+  for (int i = 0; i < 2; i++) {
+    put_data[0] = i;
+    FramPut(put_data, sizeof(put_data));
+  }
+
+  uint8_t batch[64];
+  uint32_t count = 0;
+  FramPeekBatch(batch, sizeof(batch), &count);
+  TEST_ASSERT_EQUAL(2, count);
+
+  // corrupted records are skipped but consumed
+  batch[RECORD_SIZE(sizeof(put_data)) - 1] ^= 0x01;
+  uint8_t packed[64];
+  size_t len = FramPackBatch(batch, sizeof(batch), &count, packed,
+                             sizeof(packed));
+  TEST_ASSERT_EQUAL(2, count);
+  TEST_ASSERT_EQUAL(sizeof(put_data) + 1, len);
+  TEST_ASSERT_EQUAL(1, packed[1]);
+}
+
+void test_FramPackBatch_DeltaRecord(void) {
+  // power summaries are always stored as keyframes
+  MeasurementDelta delta;
+  MeasurementDeltaInit(&delta);
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta.ts = 1436079600;
+  meas.which_measurement = Measurement_power_summary_tag;
+  meas.measurement.power_summary.count = 16;
+  meas.measurement.power_summary.voltage_mean = 37.13;
+
+  uint8_t keyframe[TRANSCODER_DELTA_MAX_SIZE];
+  const size_t keyframe_len =
+      EncodeMeasurementDelta(&delta, &meas, keyframe, sizeof(keyframe));
+  TEST_ASSERT_EQUAL(0x80 | Measurement_power_summary_tag, keyframe[0]);
+  TEST_ASSERT_EQUAL(FRAM_OK, FramPutRecord(FRAM_RECORD_DELTA, keyframe,
+                                           keyframe_len));
+  uint8_t put_data[5] = {0};
+  FramPut(put_data, sizeof(put_data));
+
+  uint8_t batch[128];
+  uint32_t count = 0;
+  TEST_ASSERT_EQUAL(FRAM_OK, FramPeekBatch(batch, sizeof(batch), &count));
+  TEST_ASSERT_EQUAL(2, count);
+
+  // compressed records are not measurements, nothing is packed or consumed
+  uint8_t packed[128];
+  size_t len = FramPackBatch(batch, sizeof(batch), &count, packed,
+                             sizeof(packed));
+  TEST_ASSERT_EQUAL(0, count);
+  TEST_ASSERT_EQUAL(0, len);
+}
+
+void test_FramPeekBatch_TooSmall(void) {
+  uint8_t put_data[16] = {0};
+  FramStatus status = FramPut(put_data, sizeof(put_data));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  uint8_t data[sizeof(put_data)];
+  uint32_t count = 0;
+  status = FramPeekBatch(data, sizeof(data), &count);
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, status);
+  TEST_ASSERT_EQUAL(0, count);
+}
+
+void test_FramPeekBatch_Wraparound(void) {
+  uint8_t junk_data[100];
+  for (int i = 0; i < sizeof(junk_data); i++) {
+    junk_data[i] = i;
+  }
+
+  // fill the buffer and drain it so the next records wrap around
+  FramStatus status = FRAM_OK;
+  while (status == FRAM_OK) {
+    status = FramPut(junk_data, sizeof(junk_data));
+  }
+  TEST_ASSERT_EQUAL(FRAM_BUFFER_FULL, status);
+  status = FramCommit(FramBufferLen());
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  for (int i = 0; i < 3; i++) {
+    status = FramPut(junk_data, sizeof(junk_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+  }
+
+  uint8_t data[3 * RECORD_SIZE(sizeof(junk_data))];
+  uint32_t count = 0;
+  status = FramPeekBatch(data, sizeof(data), &count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(3, count);
+  for (int i = 0; i < count; i++) {
+    FramRecord record;
+    const uint8_t *stored = data + i * RECORD_SIZE(sizeof(junk_data));
+    status = FramRecordDecode(stored, RECORD_SIZE(sizeof(junk_data)), &record);
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    TEST_ASSERT_EQUAL(sizeof(junk_data), record.len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(junk_data, record.data, sizeof(junk_data));
+  }
+
+  status = FramCommit(count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+}
+
+/** Status passed to flush_callback() */
+static volatile FramStatus flush_status = FRAM_ERROR;
+
+/** Number of calls to flush_callback() */
+static volatile int flush_calls = 0;
+
+static void flush_callback(FramStatus status) {
+  flush_status = status;
+  ++flush_calls;
+}
+
+void test_FramFlush_Callback(void) {
+  uint8_t test_data[] = {0x0A, 0x0B, 0x0C, 0x0D};
+  const uint8_t expected[] = {0x0A, 0x0B, 0x0C, 0x0D};
+
+  flush_calls = 0;
+  flush_status = FRAM_ERROR;
+  FramSetFlushCallback(flush_callback);
+
+  FramStatus status = FramPut(test_data, sizeof(test_data));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(RECORD_SIZE(sizeof(test_data)), FramStagedLen());
+  TEST_ASSERT_TRUE(FramFlushPending());
+  TEST_ASSERT_EQUAL(1, FramBufferLen());
+
+  // data is copied so it can be reused before the write
+  memset(test_data, 0, sizeof(test_data));
+
+  status = FramFlush();
+  FramSetFlushCallback(NULL);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(1, flush_calls);
+  TEST_ASSERT_EQUAL(FRAM_OK, flush_status);
+  TEST_ASSERT_EQUAL(0, FramStagedLen());
+  TEST_ASSERT_FALSE(FramFlushPending());
+
+  // state is saved by the flush
+  status = FIFO_Init();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(1, FramBufferLen());
+
+  uint8_t retrieved_data[sizeof(expected)];
+  size_t retrieved_len;
+  status = FramGet(retrieved_data, sizeof(retrieved_data), &retrieved_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(sizeof(expected), retrieved_len);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, retrieved_data, sizeof(expected));
+}
+
+void test_FramFlush_HighWater(void) {
+  uint8_t test_data[100] = {0};
+
+  // stage until the high-water mark is reached
+  size_t staged = 0;
+  while (staged + RECORD_SIZE(sizeof(test_data)) < FRAM_STAGING_HIGH_WATER) {
+    FramStatus status = FramPut(test_data, sizeof(test_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    staged += RECORD_SIZE(sizeof(test_data));
+  }
+  TEST_ASSERT_EQUAL(staged, FramStagedLen());
+
+  FramStatus status = FramPut(test_data, sizeof(test_data));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // flush runs in the background
+  FramWaitIdle();
+  TEST_ASSERT_EQUAL(0, FramStagedLen());
+}
+
+void test_FramFlush_StagingWraparound(void) {
+  uint8_t test_data[200];
+
+  // records wrap around the end of the staging ring, each read flushes so
+  // the records fit in the smaller buffers
+  const int n = FRAM_STAGING_SIZE / RECORD_SIZE(sizeof(test_data)) + 2;
+  for (int i = 0; i < n; i++) {
+    memset(test_data, i, sizeof(test_data));
+    FramStatus status = FramPut(test_data, sizeof(test_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    TEST_ASSERT_EQUAL(1, FramBufferLen());
+
+    uint8_t expected[sizeof(test_data)];
+    memset(expected, i, sizeof(expected));
+
+    size_t retrieved_len;
+    status = FramGet(test_data, sizeof(test_data), &retrieved_len);
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    TEST_ASSERT_EQUAL(sizeof(test_data), retrieved_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, test_data, sizeof(expected));
+  }
+}
+
+/** Data written by WriteStream() */
+typedef struct {
+  const uint8_t *data;
+  size_t len;
+} StreamData;
+
+/**
+ * @brief Writes StreamData to a stream of FramPutStream()
+ */
+static bool WriteStream(pb_ostream_t *stream, void *arg) {
+  const StreamData *sd = (const StreamData *)arg;
+  return pb_write(stream, sd->data, sd->len);
+}
+
+/**
+ * @brief Fails without writing
+ */
+static bool FailStream(pb_ostream_t *stream, void *arg) { return false; }
+
+void test_FramPutStream_ValidData(void) {
+  const uint8_t test_data[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+  StreamData sd = {test_data, sizeof(test_data)};
+
+  FramStatus status =
+      FramPutStream(FRAM_RECORD_MEASUREMENT, 16, WriteStream, &sd);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(1, FramBufferLen());
+  TEST_ASSERT_EQUAL(RECORD_SIZE(sizeof(test_data)), FramBufferUsed());
+
+  uint8_t retrieved_data[16];
+  size_t retrieved_len;
+  status = FramGet(retrieved_data, sizeof(retrieved_data), &retrieved_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(sizeof(test_data), retrieved_len);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(test_data, retrieved_data, sizeof(test_data));
+}
+
+void test_FramPutStream_PaddedLength(void) {
+  const uint8_t test_data[] = {0x01, 0x02, 0x03};
+  StreamData sd = {test_data, sizeof(test_data)};
+
+  // the length takes the 2 bytes reserved for 200 bytes
+  FramStatus status =
+      FramPutStream(FRAM_RECORD_MEASUREMENT, 200, WriteStream, &sd);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(RECORD_SIZE(sizeof(test_data)) + 1, FramBufferUsed());
+
+  uint8_t batch[32];
+  uint32_t count = 0;
+  status = FramPeekBatch(batch, sizeof(batch), &count);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(1, count);
+
+  FramRecord record;
+  status = FramRecordDecode(batch, sizeof(batch), &record);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(FRAM_RECORD_MEASUREMENT, record.type);
+  TEST_ASSERT_EQUAL(sizeof(test_data), record.len);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(test_data, record.data, sizeof(test_data));
+
+  // packed with the shortest length
+  uint8_t packed[32];
+  size_t packed_len = FramPackBatch(batch, sizeof(batch), &count, packed,
+                                    sizeof(packed));
+  TEST_ASSERT_EQUAL(1 + sizeof(test_data), packed_len);
+  TEST_ASSERT_EQUAL(sizeof(test_data), packed[0]);
+
+  TEST_ASSERT_EQUAL(FRAM_OK, FramCommit(count));
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+}
+
+void test_FramPutStream_EncoderFails(void) {
+  FramStatus status =
+      FramPutStream(FRAM_RECORD_MEASUREMENT, 16, FailStream, NULL);
+  TEST_ASSERT_EQUAL(FRAM_ERROR, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+  TEST_ASSERT_EQUAL(0, FramStagedLen());
+
+  // writes past the reserved space fail
+  const uint8_t test_data[17] = {0};
+  StreamData sd = {test_data, sizeof(test_data)};
+  status = FramPutStream(FRAM_RECORD_MEASUREMENT, 16, WriteStream, &sd);
+  TEST_ASSERT_EQUAL(FRAM_ERROR, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+
+  status = FramPutStream(FRAM_RECORD_MEASUREMENT, FRAM_RECORD_MAX_LEN + 1,
+                         WriteStream, &sd);
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, status);
+}
+
+void test_FramPutStream_StagingWraparound(void) {
+  uint8_t test_data[200];
+  StreamData sd = {test_data, sizeof(test_data)};
+
+  // records are encoded across the end of the staging ring
+  const int n = FRAM_STAGING_SIZE / RECORD_SIZE(sizeof(test_data)) + 2;
+  for (int i = 0; i < n; i++) {
+    memset(test_data, i, sizeof(test_data));
+    FramStatus status = FramPutStream(FRAM_RECORD_MEASUREMENT,
+                                      sizeof(test_data), WriteStream, &sd);
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    TEST_ASSERT_EQUAL(1, FramBufferLen());
+
+    uint8_t expected[sizeof(test_data)];
+    memset(expected, i, sizeof(expected));
+
+    uint8_t retrieved_data[sizeof(test_data)];
+    size_t retrieved_len;
+    status = FramGet(retrieved_data, sizeof(retrieved_data), &retrieved_len);
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    TEST_ASSERT_EQUAL(sizeof(test_data), retrieved_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, retrieved_data, sizeof(expected));
+  }
+}
+
+#if defined(NATIVE) && defined(FRAM_MB85RC1MT)
+void test_FramFlush_SingleBurst(void) {
+  const uint8_t test_data[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+  for (int i = 0; i < 3; i++) {
+    FramStatus status = FramPut(test_data, sizeof(test_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+  }
+
+  // nothing is written until the flush
+  FramSimClearStats();
+  FramStatus status = FramFlush();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // one write of all records and one of the buffer state
+  FramSimStats stats = FramSimGetStats();
+  TEST_ASSERT_EQUAL(2, stats.transactions);
+}
+#endif  // defined(NATIVE) && defined(FRAM_MB85RC1MT)
+
+void test_FIFO_Init_Resume(void) {
+  const uint8_t test_data[] = {0x11, 0x22, 0x33};
+  for (int i = 0; i < 5; i++) {
+    FramStatus status = FramPut(test_data, sizeof(test_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+  }
+
+  // reload the state as on boot
+  FramStatus status = FIFO_Init();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(5, FramBufferLen());
+
+  uint8_t retrieved_data[sizeof(test_data)];
+  size_t retrieved_len;
+  status = FramGet(retrieved_data, sizeof(retrieved_data), &retrieved_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(test_data, retrieved_data, sizeof(test_data));
+}
+
+void test_FIFO_Init_CorruptState(void) {
+  const uint8_t test_data[] = {0x11, 0x22, 0x33};
+  // each flush saves a copy of the state
+  for (int i = 0; i < 2; i++) {
+    FramStatus status = FramPut(test_data, sizeof(test_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    status = FramFlush();
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+  }
+  FramStatus status;
+
+  // corrupt both copies of the state
+  uint8_t state[FRAM_FIFO_STATE_SIZE];
+  status = FramRead(FRAM_FIFO_STATE_ADDR, sizeof(state), state);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // corrupting one copy falls back to the other
+  uint8_t corrupt[FRAM_FIFO_STATE_SIZE];
+  memcpy(corrupt, state, sizeof(state));
+  for (int i = 0; i < sizeof(corrupt) / 2; i++) {
+    corrupt[i] ^= 0xFF;
+  }
+  status = FramWrite(FRAM_FIFO_STATE_ADDR, corrupt, sizeof(corrupt));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  status = FIFO_Init();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_NOT_EQUAL(0, FramBufferLen());
+
+  // corrupting both copies clears the buffer
+  for (int i = 0; i < sizeof(corrupt); i++) {
+    corrupt[i] = state[i] ^ 0xFF;
+  }
+  status = FramWrite(FRAM_FIFO_STATE_ADDR, corrupt, sizeof(corrupt));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  status = FIFO_Init();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+}
+
+#ifdef NATIVE
+void test_FIFO_Init_ReadError(void) {
+  const uint8_t test_data[] = {0x11, 0x22, 0x33};
+  for (int i = 0; i < 3; i++) {
+    FramStatus status = FramPut(test_data, sizeof(test_data));
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+  }
+  TEST_ASSERT_EQUAL(FRAM_OK, FramFlush());
+
+  // a bus error is reported without clearing the saved state
+  FramSimFailReads(1);
+  FramStatus status = FIFO_Init();
+  FramSimFailReads(0);
+  TEST_ASSERT_EQUAL(FRAM_ERROR, status);
+
+  // retrying resumes the backlog
+  status = FIFO_Init();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(3, FramBufferLen());
+}
+#endif  // NATIVE
+
 /**
  * @brief  The application entry point.
  * @retval int
@@ -354,12 +1176,46 @@ int main(void) {
   RUN_TEST(test_FramPut_BufferFull);
   RUN_TEST(test_FramPut_Sequential);
   RUN_TEST(test_FramPut_Sequential_BufferFull);
+  RUN_TEST(test_FramPut_DropNew);
+  RUN_TEST(test_FramPut_DropOld);
+  RUN_TEST(test_FramPut_DropOld_LargerRecord);
+  RUN_TEST(test_FramPut_DropOld_TooLarge);
+  RUN_TEST(test_FramPut_DropOld_Peek);
+  RUN_TEST(test_FramPut_Decimate);
   RUN_TEST(test_FramGet_ValidData);
   RUN_TEST(test_FramGet_BufferEmpty);
   RUN_TEST(test_FramGet_Sequential);
   RUN_TEST(test_FramGet_Sequential_BufferFull);
+  RUN_TEST(test_FramPut_LargeRecord);
+  RUN_TEST(test_FramPutRecord_Type);
+  RUN_TEST(test_FramGet_TooSmall);
+  RUN_TEST(test_FramGet_CorruptRecord);
+  RUN_TEST(test_FramGet_InvalidLength);
   RUN_TEST(test_FramBuffer_Wraparound);
   RUN_TEST(test_LoadSaveBufferState);
+  RUN_TEST(test_FramPeekBatch_BufferEmpty);
+  RUN_TEST(test_FramPeekBatch_Commit);
+  RUN_TEST(test_FramPeekBatch_CorruptRecord);
+  RUN_TEST(test_FramPeekBatch_TooSmall);
+  RUN_TEST(test_FramPackBatch);
+  RUN_TEST(test_FramPackBatch_CorruptRecord);
+  RUN_TEST(test_FramPackBatch_DeltaRecord);
+  RUN_TEST(test_FramPeekBatch_Wraparound);
+  RUN_TEST(test_FramFlush_Callback);
+  RUN_TEST(test_FramFlush_HighWater);
+  RUN_TEST(test_FramFlush_StagingWraparound);
+  RUN_TEST(test_FramPutStream_ValidData);
+  RUN_TEST(test_FramPutStream_PaddedLength);
+  RUN_TEST(test_FramPutStream_EncoderFails);
+  RUN_TEST(test_FramPutStream_StagingWraparound);
+#if defined(NATIVE) && defined(FRAM_MB85RC1MT)
+  RUN_TEST(test_FramFlush_SingleBurst);
+#endif  // defined(NATIVE) && defined(FRAM_MB85RC1MT)
+  RUN_TEST(test_FIFO_Init_Resume);
+  RUN_TEST(test_FIFO_Init_CorruptState);
+#ifdef NATIVE
+  RUN_TEST(test_FIFO_Init_ReadError);
+#endif  // NATIVE
   UNITY_END();
   /* USER CODE END 3 */
 }
@@ -7,6 +7,9 @@
  * Test code exists but not enabled to run tests across multiple pages. The
  * newest hardware version of the board (MB85RC1MT) only has a single page,
  * therefore testing is not possible.
+ *
+ * Runs on the board or on the host against the FRAM simulator with the native
+ * environment.
  */
 
 #include <stdio.h>
@@ -19,6 +22,10 @@
 #include "main_helper.h"
 #include "usart.h"
 
+#ifdef NATIVE
+#include "fram_sim.h"
+#endif  // NATIVE
+
 void setUp(void) {}
 
 /**
@@ -123,6 +130,154 @@ void test_FramRead_All(void) {
   }
 }
 
+void test_FramWriteRead_SegmentBoundary(void) {
+  // boundary of device address bits on chips larger than 64 KiB
+  const FramAddr boundary = 1 << 16;
+  if (FramSize() <= boundary) {
+    TEST_IGNORE_MESSAGE("FRAM chip has a single segment");
+  }
+
+  uint8_t write_data[10];
+  for (int i = 0; i < sizeof(write_data); i++) {
+    write_data[i] = 0xA0 + i;
+  }
+
+  FramAddr addr = boundary - 4;
+  FramStatus status = FramWrite(addr, write_data, sizeof(write_data));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  uint8_t read_data[sizeof(write_data)] = {0};
+  status = FramRead(addr, sizeof(read_data), read_data);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(write_data, read_data, sizeof(write_data));
+
+  // data at the start of each segment is unique
+  uint8_t first = 0;
+  status = FramRead(0, 1, &first);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_NOT_EQUAL(write_data[4], first);
+}
+
+/** Status passed to async_callback() */
+static volatile FramStatus async_status = FRAM_ERROR;
+
+/** Number of calls to async_callback() */
+static volatile int async_calls = 0;
+
+static void async_callback(FramStatus status) {
+  async_status = status;
+  ++async_calls;
+}
+
+void test_FramWriteReadAsync_ValidData(void) {
+  uint8_t write_data[200];
+  for (int i = 0; i < sizeof(write_data); i++) {
+    write_data[i] = 0xFF - i;
+  }
+
+  async_calls = 0;
+  async_status = FRAM_ERROR;
+  FramStatus status =
+      FramWriteAsync(0x40, write_data, sizeof(write_data), async_callback);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  FramWaitIdle();
+  TEST_ASSERT_FALSE(FramBusy());
+  TEST_ASSERT_EQUAL(1, async_calls);
+  TEST_ASSERT_EQUAL(FRAM_OK, async_status);
+
+  uint8_t read_data[sizeof(write_data)] = {0};
+  async_status = FRAM_ERROR;
+  status = FramReadAsync(0x40, sizeof(read_data), read_data, async_callback);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  FramWaitIdle();
+  TEST_ASSERT_EQUAL(2, async_calls);
+  TEST_ASSERT_EQUAL(FRAM_OK, async_status);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(write_data, read_data, sizeof(write_data));
+}
+
+void test_FramWriteAsync_OutOfRange(void) {
+  uint8_t data[] = {1, 2, 3};
+
+  async_calls = 0;
+  FramStatus status =
+      FramWriteAsync(FramSize() - 1, data, sizeof(data), async_callback);
+  TEST_ASSERT_EQUAL(FRAM_OUT_OF_RANGE, status);
+  TEST_ASSERT_FALSE(FramBusy());
+  TEST_ASSERT_EQUAL(0, async_calls);
+}
+
+#ifdef FRAM_MB85RC1MT
+void test_FramWriteAsync_Busy(void) {
+  uint8_t data[200] = {0};
+
+  async_calls = 0;
+  FramStatus status = FramWriteAsync(0x40, data, sizeof(data), async_callback);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_TRUE(FramBusy());
+
+  // only a single transfer at a time
+  status = FramWriteAsync(0x400, data, sizeof(data), NULL);
+  TEST_ASSERT_EQUAL(FRAM_BUSY, status);
+
+  // blocking calls wait for the transfer
+  uint8_t read_data[sizeof(data)] = {0xFF};
+  status = FramRead(0x40, sizeof(read_data), read_data);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(1, async_calls);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, read_data, sizeof(data));
+}
+#endif  // FRAM_MB85RC1MT
+
+#if defined(NATIVE) && defined(FRAM_MB85RC1MT)
+void test_FramWrite_SingleBurst(void) {
+  uint8_t data[25];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+
+  FramSimClearStats();
+  FramStatus status = FramWrite(0x100, data, sizeof(data));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // device address, two memory address bytes and data
+  FramSimStats stats = FramSimGetStats();
+  TEST_ASSERT_EQUAL(1, stats.transactions);
+  TEST_ASSERT_EQUAL(sizeof(data) + 3, stats.bytes);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, FramSimMemory() + 0x100, sizeof(data));
+}
+
+void test_FramRead_SingleBurst(void) {
+  uint8_t data[25];
+
+  FramSimClearStats();
+  FramStatus status = FramRead(0x100, sizeof(data), data);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // device address, memory address, repeated start and data
+  FramSimStats stats = FramSimGetStats();
+  TEST_ASSERT_EQUAL(1, stats.transactions);
+  TEST_ASSERT_EQUAL(sizeof(data) + 4, stats.bytes);
+}
+
+void test_FramWrite_SegmentBoundaryBursts(void) {
+  const FramAddr boundary = 1 << 16;
+  uint8_t data[10];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = 0x50 + i;
+  }
+
+  FramSimClearStats();
+  FramStatus status = FramWrite(boundary - 4, data, sizeof(data));
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // one burst on each side of the boundary
+  FramSimStats stats = FramSimGetStats();
+  TEST_ASSERT_EQUAL(2, stats.transactions);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, FramSimMemory() + boundary - 4,
+                                sizeof(data));
+}
+#endif  // defined(NATIVE) && defined(FRAM_MB85RC1MT)
+
 /**
  * @brief  The application entry point.
  * @retval int
@@ -150,5 +305,16 @@ int main(void) {
   RUN_TEST(test_FramRead_ZeroLength);
   RUN_TEST(test_FramRead_OutOfRange);
   RUN_TEST(test_FramRead_All);
+  RUN_TEST(test_FramWriteRead_SegmentBoundary);
+  RUN_TEST(test_FramWriteReadAsync_ValidData);
+  RUN_TEST(test_FramWriteAsync_OutOfRange);
+#ifdef FRAM_MB85RC1MT
+  RUN_TEST(test_FramWriteAsync_Busy);
+#endif  // FRAM_MB85RC1MT
+#if defined(NATIVE) && defined(FRAM_MB85RC1MT)
+  RUN_TEST(test_FramWrite_SingleBurst);
+  RUN_TEST(test_FramRead_SingleBurst);
+  RUN_TEST(test_FramWrite_SegmentBoundaryBursts);
+#endif  // defined(NATIVE) && defined(FRAM_MB85RC1MT)
   UNITY_END();
 }
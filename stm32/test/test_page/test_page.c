@@ -2,28 +2,147 @@
  * @file test_page.c
  * @brief Test from non-volatile memory paging to sd card
  *
- * This test requires the esp32 to have the correct firmware loaded.
+ * Pages are stored in RAM through a test implementation of the storage
+ * interface, so the tests do not require the esp32.
  *
  * @author John Madden <jmadden173@pm.me>
  * @date 2024-08-06
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <unity.h>
 
+#include "fifo.h"
 #include "gpio.h"
+#include "i2c.h"
 #include "main.h"
+#include "main_helper.h"
 #include "page.h"
 #include "usart.h"
 
-void SystemClock_Config(void);
+/** Number of files in the test storage */
+#define TEST_NUM_FILES 8
+
+/** Size of each file in the test storage */
+#define TEST_FILE_SIZE 4096
+
+/** File in the test storage */
+typedef struct {
+  bool exists;
+  bool open;
+  uint8_t data[TEST_FILE_SIZE];
+  size_t len;
+} TestFile;
+
+/** Test storage */
+static TestFile files[TEST_NUM_FILES];
+
+/** Number of bytes accepted by writes before failing */
+static size_t write_limit = SIZE_MAX;
+
+static bool TestOpen(uint32_t file_idx) {
+  if (file_idx >= TEST_NUM_FILES) {
+    return false;
+  }
+
+  files[file_idx].exists = true;
+  files[file_idx].open = true;
+  return true;
+}
+
+static bool TestClose(uint32_t file_idx) {
+  files[file_idx].open = false;
+  return true;
+}
+
+static size_t TestWrite(uint32_t file_idx, const uint8_t *buf, size_t len) {
+  TestFile *file = &files[file_idx];
+  if (!file->open) {
+    return 0;
+  }
+
+  if (len > write_limit) {
+    len = write_limit;
+  }
+  if (len > TEST_FILE_SIZE - file->len) {
+    len = TEST_FILE_SIZE - file->len;
+  }
+
+  memcpy(file->data + file->len, buf, len);
+  file->len += len;
+  write_limit -= len;
+
+  return len;
+}
+
+static size_t TestRead(uint32_t file_idx, uint32_t offset, uint8_t *buf,
+                       size_t len) {
+  TestFile *file = &files[file_idx];
+  if (!file->exists || offset >= file->len) {
+    return 0;
+  }
+
+  if (len > file->len - offset) {
+    len = file->len - offset;
+  }
+
+  memcpy(buf, file->data + offset, len);
+
+  return len;
+}
+
+static bool TestDelete(uint32_t file_idx) {
+  if (file_idx >= TEST_NUM_FILES || !files[file_idx].exists) {
+    return false;
+  }
+
+  memset(&files[file_idx], 0, sizeof(TestFile));
+  return true;
+}
+
+/** Stored size of a measurement of fewer than 128 bytes */
+#define RECORD_SIZE(len) ((len) + 3)
+
+static const PageInterfaceType test_interface = {
+    .OpenPtr = TestOpen,
+    .ClosePtr = TestClose,
+    .WritePtr = TestWrite,
+    .ReadPtr = TestRead,
+    .DeletePtr = TestDelete,
+};
+
+/**
+ * @brief Puts numbered measurements into the FIFO
+ *
+ * The first byte of each measurement is its number.
+ *
+ * @param first Number of the first measurement
+ * @param count Number of measurements
+ * @param len Length of each measurement
+ */
+static void put_measurements(uint8_t first, int count, size_t len) {
+  uint8_t data[255];
+  memset(data, 0xAA, sizeof(data));
+
+  for (int i = 0; i < count; i++) {
+    data[0] = first + i;
+    TEST_ASSERT_EQUAL(FRAM_OK, FramPut(data, len));
+  }
+}
 
 /**
  * @brief Setup code that runs at the start of every test
  *
  * Initialises library to know state
  */
-void setUp(void) { PageInit(); }
+void setUp(void) {
+  memset(files, 0, sizeof(files));
+  write_limit = SIZE_MAX;
+  FramBufferClear();
+  PageInit();
+  PageSetInterface(&test_interface);
+}
 
 /**
  * @brief Tear down code that runs at the end of every test
@@ -35,11 +154,11 @@ void tearDown(void) { PageDeinit(); }
 void test_PageInit(void) {
   // check front
   Page *front = PageFront();
-  TEST_ASSERT_EQUAL(NULL, back);
+  TEST_ASSERT_NULL(front);
 
   // check back
   Page *back = PageBack();
-  TEST_ASSERT_EQUAL(NULL, back);
+  TEST_ASSERT_NULL(back);
 
   // check size
   size_t size = PageSize();
@@ -50,11 +169,6 @@ void test_PageInit(void) {
   TEST_ASSERT_EQUAL(true, empty);
 }
 
-void test_PageEmpty(void) {
-  bool empty = PageEmpty();
-  TEST_ASSERT_TRUE(empty);
-}
-
 void test_PageSize(void) {
   size_t size = PageSize();
   TEST_ASSERT_EQUAL(0, size);
@@ -70,6 +184,8 @@ void test_PageSize(void) {
   PagePushFront();
   size = PageSize();
   TEST_ASSERT_EQUAL(3, size);
+
+  TEST_ASSERT_FALSE(PageEmpty());
 }
 
 void test_PagePushFront_single(void) {
@@ -84,10 +200,10 @@ void test_PagePushFront_single(void) {
   TEST_ASSERT_NOT_NULL(page);
 
   // check front and back are equal
-  TEST_ASSERT_EQUAL(page, front);
-  TEST_ASSERT_EQUAL(page, back);
-  TEST_ASSERT_EQUAL(NULL, page->next);
-  TEST_ASSERT_EQUAL(NULL, page->prev);
+  TEST_ASSERT_EQUAL_PTR(page, front);
+  TEST_ASSERT_EQUAL_PTR(page, back);
+  TEST_ASSERT_NULL(PageNext(page));
+  TEST_ASSERT_NULL(PagePrev(page));
   TEST_ASSERT_FALSE(page->open);
 
   // check size
@@ -105,28 +221,29 @@ void test_PagePushFront_multiple(void) {
   size_t size = PageSize();
   TEST_ASSERT_EQUAL(3, size);
 
-  // check first element
+  // check first element, which was pushed last
   Page *page = PageFront();
   TEST_ASSERT_NOT_NULL(page);
-  TEST_ASSERT_NULL(page->prev);
-  TEST_ASSERT_NOT_NULL(page->next);
+  TEST_ASSERT_NULL(PagePrev(page));
+  TEST_ASSERT_NOT_NULL(PageNext(page));
   TEST_ASSERT_EQUAL(false, page->open);
-  TEST_ASSERT_EQUAL(0, file_counter);
+  TEST_ASSERT_EQUAL(2, page->file_idx);
 
   // check second element
-  Page *page_next = page->next;
-  TEST_ASSERT_EQUAL(page, page_next->prev)
-  TEST_ASSERT_NOT_NULL(page_next->next);
+  Page *page_next = PageNext(page);
+  TEST_ASSERT_EQUAL_PTR(page, PagePrev(page_next));
+  TEST_ASSERT_NOT_NULL(PageNext(page_next));
   TEST_ASSERT_EQUAL(false, page_next->open);
-  TEST_ASSERT_EQUAL(1, file_counter);
+  TEST_ASSERT_EQUAL(1, page_next->file_idx);
 
   // check third element
   page = page_next;
-  page_next = page->next;
-  TEST_ASSERT_EQUAL(page, page_next->prev)
-  TEST_ASSERT_NULL(page_next->next);
+  page_next = PageNext(page);
+  TEST_ASSERT_EQUAL_PTR(page, PagePrev(page_next));
+  TEST_ASSERT_NULL(PageNext(page_next));
   TEST_ASSERT_EQUAL(false, page_next->open);
-  TEST_ASSERT_EQUAL(2, file_counter);
+  TEST_ASSERT_EQUAL(0, page_next->file_idx);
+  TEST_ASSERT_EQUAL_PTR(page_next, PageBack());
 }
 
 void test_PagePushBack_single(void) {
@@ -141,15 +258,15 @@ void test_PagePushBack_single(void) {
   TEST_ASSERT_NOT_NULL(page);
 
   // check front and back are equal
-  TEST_ASSERT_EQUAL(page, front);
-  TEST_ASSERT_EQUAL(page, back);
-  TEST_ASSERT_EQUAL(NULL, page->next);
-  TEST_ASSERT_EQUAL(NULL, page->prev);
+  TEST_ASSERT_EQUAL_PTR(page, front);
+  TEST_ASSERT_EQUAL_PTR(page, back);
+  TEST_ASSERT_NULL(PageNext(page));
+  TEST_ASSERT_NULL(PagePrev(page));
   TEST_ASSERT_FALSE(page->open);
 
   // check size
   size_t size = PageSize();
-  TEST_ASSERT_EQUAL(size, 1);
+  TEST_ASSERT_EQUAL(1, size);
 }
 
 void test_PagePushBack_multiple(void) {
@@ -165,25 +282,26 @@ void test_PagePushBack_multiple(void) {
   // check first element
   Page *page = PageFront();
   TEST_ASSERT_NOT_NULL(page);
-  TEST_ASSERT_NULL(page->prev);
-  TEST_ASSERT_NOT_NULL(page->next);
+  TEST_ASSERT_NULL(PagePrev(page));
+  TEST_ASSERT_NOT_NULL(PageNext(page));
   TEST_ASSERT_EQUAL(false, page->open);
-  TEST_ASSERT_EQUAL(0, file_counter);
+  TEST_ASSERT_EQUAL(0, page->file_idx);
 
   // check second element
-  Page *page_next = page->next;
-  TEST_ASSERT_EQUAL(page, page_next->prev)
-  TEST_ASSERT_NOT_NULL(page_next->next);
+  Page *page_next = PageNext(page);
+  TEST_ASSERT_EQUAL_PTR(page, PagePrev(page_next));
+  TEST_ASSERT_NOT_NULL(PageNext(page_next));
   TEST_ASSERT_EQUAL(false, page_next->open);
-  TEST_ASSERT_EQUAL(1, file_counter);
+  TEST_ASSERT_EQUAL(1, page_next->file_idx);
 
   // check third element
   page = page_next;
-  page_next = page->next;
-  TEST_ASSERT_EQUAL(page, page_next->prev)
-  TEST_ASSERT_NULL(page_next->next);
+  page_next = PageNext(page);
+  TEST_ASSERT_EQUAL_PTR(page, PagePrev(page_next));
+  TEST_ASSERT_NULL(PageNext(page_next));
   TEST_ASSERT_EQUAL(false, page_next->open);
-  TEST_ASSERT_EQUAL(2, file_counter);
+  TEST_ASSERT_EQUAL(2, page_next->file_idx);
+  TEST_ASSERT_EQUAL_PTR(page_next, PageBack());
 }
 
 void test_PagePopFront_single(void) {
@@ -205,10 +323,10 @@ void test_PagePopFront_single(void) {
 void test_PagePopFront_multiple(void) {
   // add 3 items to list
   for (int i = 0; i < 3; i++) {
-    PagePushFront();
+    PagePushBack();
   }
 
-  Page *front_pop = PageFront();
+  Page *front_next = PageNext(PageFront());
 
   PagePopFront();
 
@@ -217,12 +335,26 @@ void test_PagePopFront_multiple(void) {
   TEST_ASSERT_EQUAL(2, size);
 
   // check pointers for first element
-  Page *front = PageFront() TEST_ASSERT_NOT_EQUAL(front_pop, front);
-  TEST_ASSERT_NULL(front->prev);
-  TEST_ASSERT_NOT_NULL(front->next);
+  Page *front = PageFront();
+  TEST_ASSERT_EQUAL_PTR(front_next, front);
+  TEST_ASSERT_EQUAL(1, front->file_idx);
+  TEST_ASSERT_NULL(PagePrev(front));
+  TEST_ASSERT_NOT_NULL(PageNext(front));
 }
 
-void test_pagePopBack_single(void) {
+void test_PagePopFront_open(void) {
+  Page *page = PagePushBack();
+  TEST_ASSERT_TRUE(PageOpen(page));
+  TEST_ASSERT_TRUE(files[page->file_idx].open);
+
+  PagePopFront();
+
+  // closed but not deleted
+  TEST_ASSERT_FALSE(files[0].open);
+  TEST_ASSERT_TRUE(files[0].exists);
+}
+
+void test_PagePopBack_single(void) {
   PagePushFront();
 
   size_t size = PageSize();
@@ -241,10 +373,10 @@ void test_pagePopBack_single(void) {
 void test_PagePopBack_multiple(void) {
   // add 3 items to list
   for (int i = 0; i < 3; i++) {
-    PagePushFront();
+    PagePushBack();
   }
 
-  Page *back_pop = PageBack();
+  Page *back_prev = PagePrev(PageBack());
 
   PagePopBack();
 
@@ -253,19 +385,112 @@ void test_PagePopBack_multiple(void) {
   TEST_ASSERT_EQUAL(2, size);
 
   // check pointers for last element
-  Page *back = PageBack() TEST_ASSERT_NOT_EQUAL(back_pop, back);
-  TEST_ASSERT_NULL(back->next);
-  TEST_ASSERT_NOT_NULL(back->prev);
+  Page *back = PageBack();
+  TEST_ASSERT_EQUAL_PTR(back_prev, back);
+  TEST_ASSERT_EQUAL(1, back->file_idx);
+  TEST_ASSERT_NULL(PageNext(back));
+  TEST_ASSERT_NOT_NULL(PagePrev(back));
+}
+
+void test_PagePush_PoolExhausted(void) {
+  for (int i = 0; i < PAGE_POOL_SIZE; i++) {
+    TEST_ASSERT_NOT_NULL(PagePushBack());
+  }
+
+  TEST_ASSERT_NULL(PagePushBack());
+  TEST_ASSERT_NULL(PagePushFront());
+  TEST_ASSERT_EQUAL(PAGE_POOL_SIZE, PageSize());
+
+  // popped pages are reused
+  PagePopFront();
+  Page *page = PagePushBack();
+  TEST_ASSERT_NOT_NULL(page);
+  TEST_ASSERT_EQUAL_PTR(page, PageBack());
+  TEST_ASSERT_EQUAL(PAGE_POOL_SIZE, page->file_idx);
+}
+
+void test_PageStateLoad_Resume(void) {
+  for (int i = 0; i < 3; i++) {
+    PagePushBack();
+  }
+  PagePopFront();
+
+  Page *page = PageBack();
+  uint8_t data[] = {1, 2, 3, 4};
+  PageWrite(page, data, sizeof(data));
+  uint8_t read[2];
+  PageRead(page, read, sizeof(read));
+  TEST_ASSERT_EQUAL(FRAM_OK, PageStateSave());
+
+  // simulate a reset
+  PageInit();
+
+  TEST_ASSERT_EQUAL(2, PageSize());
+  Page *front = PageFront();
+  TEST_ASSERT_EQUAL(1, front->file_idx);
+  TEST_ASSERT_NULL(PagePrev(front));
+  Page *back = PageNext(front);
+  TEST_ASSERT_EQUAL_PTR(back, PageBack());
+  TEST_ASSERT_EQUAL_PTR(front, PagePrev(back));
+  TEST_ASSERT_EQUAL(2, back->file_idx);
+  TEST_ASSERT_EQUAL(sizeof(data), back->write_len);
+  TEST_ASSERT_EQUAL(sizeof(read), back->read_offset);
+  TEST_ASSERT_FALSE(back->open);
+
+  // file indices are not reused
+  page = PagePushBack();
+  TEST_ASSERT_EQUAL(3, page->file_idx);
+}
+
+void test_PageStateLoad_Corrupt(void) {
+  PagePushBack();
+  PagePushBack();
+
+  // corrupt both copies of the state
+  uint8_t junk[FRAM_PAGE_STATE_SIZE];
+  memset(junk, 0x5A, sizeof(junk));
+  FramWrite(FRAM_PAGE_STATE_ADDR, junk, sizeof(junk));
+
+  TEST_ASSERT_NOT_EQUAL(FRAM_OK, PageStateLoad());
+
+  // starts empty
+  PageInit();
+  TEST_ASSERT_TRUE(PageEmpty());
+  TEST_ASSERT_NULL(PageFront());
+  TEST_ASSERT_NOT_NULL(PagePushBack());
+}
+
+void test_PageStateSave_Alternates(void) {
+  PagePushBack();
+
+  // an interrupted save leaves the previous copy intact
+  uint8_t before[FRAM_PAGE_STATE_SIZE];
+  FramRead(FRAM_PAGE_STATE_ADDR, sizeof(before), before);
+  PagePushBack();
+  FramWrite(FRAM_PAGE_STATE_ADDR, before, sizeof(before));
+
+  PageInit();
+  TEST_ASSERT_EQUAL(1, PageSize());
 }
 
 void test_PageOpen(void) {
   Page *page = PagePushFront();
 
-  TEST_ASSERT_EQUAL(false, page);
+  TEST_ASSERT_EQUAL(false, page->open);
 
-  PageOpen(page);
+  TEST_ASSERT_TRUE(PageOpen(page));
 
-  TEST_ASSERT_EQUAL(true, page);
+  TEST_ASSERT_EQUAL(true, page->open);
+  TEST_ASSERT_TRUE(files[page->file_idx].open);
+}
+
+void test_PageOpen_NoInterface(void) {
+  PageSetInterface(NULL);
+
+  Page *page = PagePushFront();
+
+  TEST_ASSERT_FALSE(PageOpen(page));
+  TEST_ASSERT_FALSE(page->open);
 }
 
 void test_PageClose(void) {
@@ -275,13 +500,172 @@ void test_PageClose(void) {
 
   TEST_ASSERT_EQUAL(true, page->open);
 
-  PageClose(page);
+  TEST_ASSERT_TRUE(PageClose(page));
 
   TEST_ASSERT_EQUAL(false, page->open);
+  TEST_ASSERT_FALSE(files[page->file_idx].open);
+}
+
+void test_PageWriteRead(void) {
+  Page *page = PagePushBack();
+
+  // larger than a block to check writes are split
+  uint8_t data[PAGE_BLOCK_SIZE + 100];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+
+  size_t written = PageWrite(page, data, sizeof(data));
+  TEST_ASSERT_EQUAL(sizeof(data), written);
+  TEST_ASSERT_EQUAL(sizeof(data), page->write_len);
+
+  // reads continue from the previous read
+  uint8_t read[sizeof(data)];
+  size_t n = PageRead(page, read, sizeof(read));
+  TEST_ASSERT_EQUAL(PAGE_BLOCK_SIZE, n);
+  n = PageRead(page, read + PAGE_BLOCK_SIZE, sizeof(read) - PAGE_BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(100, n);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, read, sizeof(data));
+
+  // end of page
+  n = PageRead(page, read, sizeof(read));
+  TEST_ASSERT_EQUAL(0, n);
+}
+
+void test_PageDelete(void) {
+  Page *page = PagePushBack();
+  uint8_t data[] = {1, 2, 3};
+  PageWrite(page, data, sizeof(data));
+
+  TEST_ASSERT_TRUE(PageDelete(page));
+
+  TEST_ASSERT_FALSE(page->open);
+  TEST_ASSERT_FALSE(files[page->file_idx].exists);
+}
+
+void test_PageSpill(void) {
+  put_measurements(0, 20, 50);
+  const uint32_t len = FramBufferLen();
+  const FramAddr target = FramBufferUsed() / 2;
+
+  FramStatus status = PageSpill(target);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // oldest measurements are moved to a closed page
+  TEST_ASSERT_LESS_OR_EQUAL(target, FramBufferUsed());
+  TEST_ASSERT_EQUAL(1, PageSize());
+  TEST_ASSERT_FALSE(files[0].open);
+  TEST_ASSERT_EQUAL(0, files[0].len % RECORD_SIZE(50));
+  TEST_ASSERT_EQUAL(len, FramBufferLen() + files[0].len / RECORD_SIZE(50));
+
+  // measurements are stored as records
+  FramRecord record;
+  TEST_ASSERT_EQUAL(FRAM_OK,
+                    FramRecordDecode(files[0].data, files[0].len, &record));
+  TEST_ASSERT_EQUAL(FRAM_RECORD_MEASUREMENT, record.type);
+  TEST_ASSERT_EQUAL(50, record.len);
+  TEST_ASSERT_EQUAL(0, record.data[0]);
+
+  // remaining measurements are the newest
+  uint8_t data[256];
+  size_t data_len = 0;
+  status = FramGet(data, sizeof(data), &data_len);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(files[0].len / RECORD_SIZE(50), data[0]);
+}
+
+void test_PageSpill_StorageFailure(void) {
+  put_measurements(0, 20, 50);
+  const uint32_t len = FramBufferLen();
+
+  // stale file with the index of the second page from a lost page state
+  files[1].exists = true;
+  files[1].len = 10;
+
+  // fails part way through the first block
+  write_limit = 60;
+
+  FramStatus status = PageSpill(0);
+  TEST_ASSERT_EQUAL(FRAM_ERROR, status);
+
+  // nothing is removed from the FIFO
+  TEST_ASSERT_EQUAL(len, FramBufferLen());
+
+  // spilling again starts a new page after the partial measurement
+  write_limit = SIZE_MAX;
+  status = PageSpill(0);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+  TEST_ASSERT_EQUAL(2, PageSize());
+  TEST_ASSERT_EQUAL(20 * RECORD_SIZE(50), files[1].len);
+}
+
+void test_PageRestore(void) {
+  put_measurements(0, 20, 50);
+
+  FramStatus status = PageSpill(0);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+
+  status = PageRestore(FramBufferSize());
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+
+  // page is deleted once read in full
+  TEST_ASSERT_TRUE(PageEmpty());
+  TEST_ASSERT_FALSE(files[0].exists);
+
+  // measurements are restored in order
+  TEST_ASSERT_EQUAL(20, FramBufferLen());
+  for (int i = 0; i < 20; i++) {
+    uint8_t data[256];
+    size_t data_len = 0;
+    status = FramGet(data, sizeof(data), &data_len);
+    TEST_ASSERT_EQUAL(FRAM_OK, status);
+    TEST_ASSERT_EQUAL(50, data_len);
+    TEST_ASSERT_EQUAL(i, data[0]);
+  }
+}
+
+void test_PageRestore_Target(void) {
+  put_measurements(0, 20, 50);
+  PageSpill(0);
+
+  // stops once the target is reached, the rest stays in the page
+  FramStatus status = PageRestore(RECORD_SIZE(50) * 5);
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_GREATER_OR_EQUAL(RECORD_SIZE(50) * 5, FramBufferUsed());
+  TEST_ASSERT_LESS_THAN(20, FramBufferLen());
+  TEST_ASSERT_EQUAL(1, PageSize());
+
+  const uint32_t restored = FramBufferLen();
+  TEST_ASSERT_EQUAL(restored * RECORD_SIZE(50), PageFront()->read_offset);
+
+  // continues from the first measurement that was not restored
+  status = PageRestore(FramBufferSize());
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_TRUE(PageEmpty());
+  TEST_ASSERT_EQUAL(20, FramBufferLen());
+}
+
+void test_PageBalance(void) {
+  // nothing to do when empty
+  FramStatus status = PageBalance();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_TRUE(PageEmpty());
+
+  // restores when the FIFO is below the low watermark
+  put_measurements(0, 10, 50);
+  PageSpill(0);
+  TEST_ASSERT_EQUAL(0, FramBufferLen());
+
+  status = PageBalance();
+  TEST_ASSERT_EQUAL(FRAM_OK, status);
+  TEST_ASSERT_EQUAL(10, FramBufferLen());
+  TEST_ASSERT_TRUE(PageEmpty());
 }
 
 /**
- * @brief Entry point for protobuf test
+ * @brief Entry point for page test
  * @retval int
  */
 int main(void) {
@@ -295,101 +679,47 @@ int main(void) {
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
   MX_USART1_UART_Init();
+  MX_I2C2_Init();
 
   // wait for UART
   for (int i = 0; i < 1000000; i++) {
     __NOP();
   }
 
+  FIFO_Init();
+
   // Unit testing
   UNITY_BEGIN();
 
-  // Tests for timestamp
+  // linked list
   RUN_TEST(test_PageInit);
+  RUN_TEST(test_PageSize);
+  RUN_TEST(test_PagePushFront_single);
+  RUN_TEST(test_PagePushFront_multiple);
+  RUN_TEST(test_PagePushBack_single);
+  RUN_TEST(test_PagePushBack_multiple);
+  RUN_TEST(test_PagePopFront_single);
+  RUN_TEST(test_PagePopFront_multiple);
+  RUN_TEST(test_PagePopFront_open);
+  RUN_TEST(test_PagePopBack_single);
+  RUN_TEST(test_PagePopBack_multiple);
+  RUN_TEST(test_PagePush_PoolExhausted);
+  // persistence
+  RUN_TEST(test_PageStateLoad_Resume);
+  RUN_TEST(test_PageStateLoad_Corrupt);
+  RUN_TEST(test_PageStateSave_Alternates);
+  // storage
+  RUN_TEST(test_PageOpen);
+  RUN_TEST(test_PageOpen_NoInterface);
+  RUN_TEST(test_PageClose);
+  RUN_TEST(test_PageWriteRead);
+  RUN_TEST(test_PageDelete);
+  // spill tier
+  RUN_TEST(test_PageSpill);
+  RUN_TEST(test_PageSpill_StorageFailure);
+  RUN_TEST(test_PageRestore);
+  RUN_TEST(test_PageRestore_Target);
+  RUN_TEST(test_PageBalance);
 
   UNITY_END();
 }
-
-/**
- * @brief System Clock Configuration
- * @retval None
- */
-void SystemClock_Config(void) {
-  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
-  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
-
-  /** Configure the main internal regulator output voltage
-   */
-  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE2);
-
-  /** Initializes the CPU, AHB and APB buses clocks
-   */
-  RCC_OscInitStruct.OscillatorType =
-      RCC_OSCILLATORTYPE_HSI | RCC_OSCILLATORTYPE_MSI;
-  RCC_OscInitStruct.HSIState = RCC_HSI_ON;
-  RCC_OscInitStruct.MSIState = RCC_MSI_ON;
-  RCC_OscInitStruct.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
-  RCC_OscInitStruct.MSICalibrationValue = RCC_MSICALIBRATION_DEFAULT;
-  RCC_OscInitStruct.MSIClockRange = RCC_MSIRANGE_6;
-  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
-  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
-    Error_Handler();
-  }
-
-  /** Configure the SYSCLKSource, HCLK, PCLK1 and PCLK2 clocks dividers
-   */
-  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK3 | RCC_CLOCKTYPE_HCLK |
-                                RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 |
-                                RCC_CLOCKTYPE_PCLK2;
-  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_MSI;
-  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
-  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
-  RCC_ClkInitStruct.AHBCLK3Divider = RCC_SYSCLK_DIV1;
-
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK) {
-    Error_Handler();
-  }
-  HAL_RCC_MCOConfig(RCC_MCO1, RCC_MCO1SOURCE_SYSCLK, RCC_MCODIV_1);
-}
-
-/* USER CODE BEGIN 4 */
-
-/* USER CODE END 4 */
-
-/**
- * @brief  This function is executed in case of error occurrence.
- * @retval None
- */
-void Error_Handler(void) {
-  HAL_GPIO_WritePin(GPIOB, GPIO_PIN_5, GPIO_PIN_RESET);
-
-  /* USER CODE BEGIN Error_Handler_Debug */
-  char error[30];
-  int error_len =
-      snprintf(error, sizeof(error), "Error!  HAL Status: %d\n", rc);
-  HAL_UART_Transmit(&huart1, error, error_len, 1000);
-
-  /* User can add his own implementation to report the HAL error return state */
-  __disable_irq();
-  while (1) {
-  }
-  /* USER CODE END Error_Handler_Debug */
-}
-
-#ifdef USE_FULL_ASSERT
-/**
- * @brief  Reports the name of the source file and the source line number
- *         where the assert_param error has occurred.
- * @param  file: pointer to the source file name
- * @param  line: assert_param error line source number
- * @retval None
- */
-void assert_failed(uint8_t *file, uint32_t line) {
-  /* USER CODE BEGIN 6 */
-  /* User can add his own implementation to report the file name and line
-     number, ex: printf("Wrong parameters value: file %s on line %d\r\n", file,
-     line) */
-  /* USER CODE END 6 */
-}
-#endif /* USE_FULL_ASSERT */
@@ -10,6 +10,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <unity.h>
 
 #include "gpio.h"
@@ -17,6 +18,7 @@
 #include "main_helper.h"
 #include "pb_decode.h"
 #include "pb_encode.h"
+#include "soil_power_sensor.fast.h"
 #include "soil_power_sensor.pb.h"
 #include "usart.h"
 
@@ -279,6 +281,208 @@ void test_esp32_wifi() {
   TEST_ASSERT_EQUAL(443, decode.command.wifi_command.port);
 }
 
+/**
+ * @brief Checks the fast encoder output matches pb_encode
+ *
+ * @param meas Measurement to encode
+ */
+void assert_fast_encode(const Measurement *meas) {
+  ostream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+  status = pb_encode(&ostream, Measurement_fields, meas);
+  msg_len = ostream.bytes_written;
+  TEST_ASSERT_TRUE(status);
+
+  uint8_t fast_buffer[Measurement_size];
+  size_t fast_len = 0;
+  status = Measurement_fast_encode(meas, fast_buffer, sizeof(fast_buffer),
+                                   &fast_len);
+  TEST_ASSERT_TRUE(status);
+
+  TEST_ASSERT_EQUAL(msg_len, Measurement_fast_encoded_size(meas));
+  TEST_ASSERT_EQUAL(msg_len, fast_len);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(buffer, fast_buffer, msg_len);
+
+  // stream writer produces the same bytes
+  uint8_t stream_buffer[Measurement_size];
+  pb_ostream_t fast_stream =
+      pb_ostream_from_buffer(stream_buffer, sizeof(stream_buffer));
+  status = Measurement_fast_encode_stream(meas, &fast_stream);
+  TEST_ASSERT_TRUE(status);
+  TEST_ASSERT_EQUAL(msg_len, fast_stream.bytes_written);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(buffer, stream_buffer, msg_len);
+
+  // stream errors are reported
+  if (msg_len > 0) {
+    fast_stream = pb_ostream_from_buffer(stream_buffer, msg_len - 1);
+    TEST_ASSERT_FALSE(Measurement_fast_encode_stream(meas, &fast_stream));
+  }
+}
+
+void test_fast_power(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.meta.logger_id = 7;
+  meas.which_measurement = Measurement_power_tag;
+  meas.measurement.power.voltage = 1.2;
+  meas.measurement.power.current = -0.0;
+  assert_fast_encode(&meas);
+
+  // deprecated double fields
+  meas.measurement.power.voltage_double = 1.2;
+  meas.measurement.power.current_double = 120.1;
+  assert_fast_encode(&meas);
+}
+
+void test_fast_teros12(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_teros12_tag;
+  meas.measurement.teros12.vwc_raw = 2070.0;
+  meas.measurement.teros12.vwc_adj = 0.34;
+  meas.measurement.teros12.temp = 21.3;
+  meas.measurement.teros12.ec = 0xFFFFFFFF;
+  assert_fast_encode(&meas);
+}
+
+void test_fast_phytos31(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_phytos31_tag;
+  meas.measurement.phytos31.voltage = 1425.1;
+  meas.measurement.phytos31.leaf_wetness = 0.0;
+  assert_fast_encode(&meas);
+}
+
+void test_fast_bme280(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_bme280_tag;
+  meas.measurement.bme280.pressure = 98473;
+  meas.measurement.bme280.temperature = -1250;
+  meas.measurement.bme280.humidity = 43600;
+  assert_fast_encode(&meas);
+}
+
+void test_fast_teros21(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_teros21_tag;
+  meas.measurement.teros21.matric_pot = -1234.5;
+  meas.measurement.teros21.temp = 22.5;
+  assert_fast_encode(&meas);
+}
+
+void test_fast_power_summary(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_power_summary_tag;
+  meas.measurement.power_summary.count = 300;
+  meas.measurement.power_summary.voltage_mean = 37.13;
+  meas.measurement.power_summary.voltage_min = -0.5;
+  meas.measurement.power_summary.voltage_stddev = 0.12;
+  meas.measurement.power_summary.current_max = 190.25;
+  assert_fast_encode(&meas);
+}
+
+void test_fast_power_burst(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_power_burst_tag;
+  meas.measurement.power_burst.burst_id = 2;
+  meas.measurement.power_burst.current = true;
+  meas.measurement.power_burst.rate = 1000;
+  meas.measurement.power_burst.total = 4096;
+  assert_fast_encode(&meas);
+
+  // bytes are only encoded when not empty
+  meas.measurement.power_burst.samples.size = 64;
+  memset(meas.measurement.power_burst.samples.bytes, 0xAB, 64);
+  assert_fast_encode(&meas);
+}
+
+void test_fast_empty(void) {
+  Measurement meas = Measurement_init_zero;
+  assert_fast_encode(&meas);
+  TEST_ASSERT_EQUAL(0, msg_len);
+
+  // empty submessages are still encoded
+  meas.has_meta = true;
+  meas.which_measurement = Measurement_power_tag;
+  assert_fast_encode(&meas);
+}
+
+void test_fast_size(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_power_tag;
+  meas.measurement.power.voltage = 1.2;
+
+  size_t len = Measurement_fast_encoded_size(&meas);
+  size_t fast_len = 0;
+
+  status = Measurement_fast_encode(&meas, buffer, len - 1, &fast_len);
+  TEST_ASSERT_FALSE(status);
+  TEST_ASSERT_EQUAL(0, fast_len);
+
+  status = Measurement_fast_encode(&meas, buffer, len, &fast_len);
+  TEST_ASSERT_TRUE(status);
+  TEST_ASSERT_EQUAL(len, fast_len);
+}
+
+#ifdef DWT
+/** Number of encodes averaged in the benchmark */
+#define BENCHMARK_ITERATIONS 1000
+
+/**
+ * @brief Compares the cycle count of pb_encode and the fast encoder
+ *
+ * Cycles are counted with the DWT cycle counter and printed for each encoder.
+ */
+void test_fast_benchmark(void) {
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta = meta_default;
+  meas.which_measurement = Measurement_teros12_tag;
+  meas.measurement.teros12.vwc_raw = 2070.0;
+  meas.measurement.teros12.vwc_adj = 0.34;
+  meas.measurement.teros12.temp = 21.3;
+  meas.measurement.teros12.ec = 12;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  uint32_t start = DWT->CYCCNT;
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+    ostream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+    pb_encode(&ostream, Measurement_fields, &meas);
+  }
+  uint32_t nanopb_cycles = (DWT->CYCCNT - start) / BENCHMARK_ITERATIONS;
+
+  size_t len = 0;
+  start = DWT->CYCCNT;
+  for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+    Measurement_fast_encode(&meas, buffer, sizeof(buffer), &len);
+  }
+  uint32_t fast_cycles = (DWT->CYCCNT - start) / BENCHMARK_ITERATIONS;
+
+  char msg[64];
+  snprintf(msg, sizeof(msg), "pb_encode: %lu cycles, fast: %lu cycles",
+           (unsigned long)nanopb_cycles, (unsigned long)fast_cycles);
+  TEST_MESSAGE(msg);
+
+  TEST_ASSERT_LESS_THAN(nanopb_cycles, fast_cycles);
+}
+#endif /* DWT */
+
 /**
  * @brief Entry point for protobuf test
  * @retval int
@@ -313,6 +517,19 @@ int main(void) {
   RUN_TEST(test_response);
   // Tests Esp32Command WiFI
   RUN_TEST(test_esp32_wifi);
+  // Tests for fast encoders
+  RUN_TEST(test_fast_power);
+  RUN_TEST(test_fast_teros12);
+  RUN_TEST(test_fast_phytos31);
+  RUN_TEST(test_fast_bme280);
+  RUN_TEST(test_fast_teros21);
+  RUN_TEST(test_fast_power_summary);
+  RUN_TEST(test_fast_power_burst);
+  RUN_TEST(test_fast_empty);
+  RUN_TEST(test_fast_size);
+#ifdef DWT
+  RUN_TEST(test_fast_benchmark);
+#endif /* DWT */
 
   UNITY_END();
 }
@@ -0,0 +1,225 @@
+/**
+ * @file test_schedule.c
+ * @brief Tests the deadline ordered schedule of sensors
+ *
+ * @see schedule.h
+ *
+ * @author John Madden <jmadden173@pm.me>
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <unity.h>
+
+#include "gpio.h"
+#include "main.h"
+#include "main_helper.h"
+#include "schedule.h"
+#include "usart.h"
+
+/**
+ * @brief Generated from CubeMX
+ */
+void SystemClock_Config(void);
+
+/** Schedule under test */
+static Schedule schedule;
+
+/**
+ * @brief Setup code that runs at the start of every test
+ */
+void setUp(void) { ScheduleInit(&schedule); }
+
+/**
+ * @brief Tear down code that runs at the end of every test
+ */
+void tearDown(void) {}
+
+void test_ScheduleNext_Empty(void) {
+  uint32_t deadline = 0;
+  TEST_ASSERT_FALSE(ScheduleNext(&schedule, &deadline));
+
+  uint8_t due[4];
+  TEST_ASSERT_EQUAL(0, SchedulePopDue(&schedule, 1000, due, 4));
+}
+
+void test_ScheduleAdd_Invalid(void) {
+  // zero period would never advance
+  TEST_ASSERT_EQUAL(-1, ScheduleAdd(&schedule, 0, 100, 0));
+
+  for (int i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+    TEST_ASSERT_EQUAL(0, ScheduleAdd(&schedule, i, 100, 100));
+  }
+  TEST_ASSERT_EQUAL(-1, ScheduleAdd(&schedule, 0, 100, 100));
+}
+
+void test_ScheduleNext_Earliest(void) {
+  ScheduleAdd(&schedule, 0, 300, 1000);
+  ScheduleAdd(&schedule, 1, 100, 1000);
+  ScheduleAdd(&schedule, 2, 200, 1000);
+
+  uint32_t deadline = 0;
+  TEST_ASSERT_TRUE(ScheduleNext(&schedule, &deadline));
+  TEST_ASSERT_EQUAL_UINT32(100, deadline);
+}
+
+void test_SchedulePopDue_NotDue(void) {
+  ScheduleAdd(&schedule, 0, 100, 1000);
+
+  uint8_t due[4];
+  TEST_ASSERT_EQUAL(0, SchedulePopDue(&schedule, 99, due, 4));
+
+  uint32_t deadline = 0;
+  ScheduleNext(&schedule, &deadline);
+  TEST_ASSERT_EQUAL_UINT32(100, deadline);
+}
+
+void test_SchedulePopDue_Order(void) {
+  ScheduleAdd(&schedule, 0, 300, 1000);
+  ScheduleAdd(&schedule, 1, 100, 1000);
+  ScheduleAdd(&schedule, 2, 200, 1000);
+
+  uint8_t due[4];
+  TEST_ASSERT_EQUAL(3, SchedulePopDue(&schedule, 300, due, 4));
+  TEST_ASSERT_EQUAL(1, due[0]);
+  TEST_ASSERT_EQUAL(2, due[1]);
+  TEST_ASSERT_EQUAL(0, due[2]);
+
+  uint32_t deadline = 0;
+  ScheduleNext(&schedule, &deadline);
+  TEST_ASSERT_EQUAL_UINT32(1100, deadline);
+}
+
+void test_SchedulePopDue_Coalesce(void) {
+  // same deadline is one wake-up, ordered by id
+  ScheduleAdd(&schedule, 2, 1000, 1000);
+  ScheduleAdd(&schedule, 0, 1000, 1000);
+  ScheduleAdd(&schedule, 1, 1000, 1000);
+
+  uint8_t due[4];
+  TEST_ASSERT_EQUAL(3, SchedulePopDue(&schedule, 1000, due, 4));
+  TEST_ASSERT_EQUAL(0, due[0]);
+  TEST_ASSERT_EQUAL(1, due[1]);
+  TEST_ASSERT_EQUAL(2, due[2]);
+}
+
+void test_SchedulePopDue_Periods(void) {
+  // fast sensor every 250 ms, slow sensor every 1000 ms
+  ScheduleAdd(&schedule, 0, 250, 250);
+  ScheduleAdd(&schedule, 1, 1000, 1000);
+
+  uint8_t due[4];
+  int counts[2] = {0, 0};
+  int wakeups = 0;
+  uint32_t now = 0;
+  while (ScheduleNext(&schedule, &now) && now <= 4000) {
+    size_t len = SchedulePopDue(&schedule, now, due, 4);
+    TEST_ASSERT_GREATER_THAN(0, len);
+    for (size_t i = 0; i < len; i++) {
+      ++counts[due[i]];
+    }
+    ++wakeups;
+  }
+
+  TEST_ASSERT_EQUAL(16, counts[0]);
+  TEST_ASSERT_EQUAL(4, counts[1]);
+  // slow sensor shares the wake-ups of the fast sensor
+  TEST_ASSERT_EQUAL(16, wakeups);
+}
+
+void test_SchedulePopDue_Phase(void) {
+  ScheduleAdd(&schedule, 0, 1000, 1000);
+  ScheduleAdd(&schedule, 1, 1500, 1000);
+
+  uint8_t due[4];
+  TEST_ASSERT_EQUAL(1, SchedulePopDue(&schedule, 1000, due, 4));
+  TEST_ASSERT_EQUAL(0, due[0]);
+  TEST_ASSERT_EQUAL(1, SchedulePopDue(&schedule, 1500, due, 4));
+  TEST_ASSERT_EQUAL(1, due[0]);
+  TEST_ASSERT_EQUAL(1, SchedulePopDue(&schedule, 2000, due, 4));
+  TEST_ASSERT_EQUAL(0, due[0]);
+}
+
+void test_SchedulePopDue_SkipMissed(void) {
+  ScheduleAdd(&schedule, 0, 100, 100);
+
+  // returned once even though several periods were missed
+  uint8_t due[4];
+  TEST_ASSERT_EQUAL(1, SchedulePopDue(&schedule, 450, due, 4));
+
+  uint32_t deadline = 0;
+  ScheduleNext(&schedule, &deadline);
+  TEST_ASSERT_EQUAL_UINT32(500, deadline);
+}
+
+void test_SchedulePopDue_Max(void) {
+  ScheduleAdd(&schedule, 0, 100, 1000);
+  ScheduleAdd(&schedule, 1, 100, 1000);
+  ScheduleAdd(&schedule, 2, 100, 1000);
+
+  // remaining due tasks are returned by the next call
+  uint8_t due[2];
+  TEST_ASSERT_EQUAL(2, SchedulePopDue(&schedule, 100, due, 2));
+  TEST_ASSERT_EQUAL(0, due[0]);
+  TEST_ASSERT_EQUAL(1, due[1]);
+  TEST_ASSERT_EQUAL(1, SchedulePopDue(&schedule, 100, due, 2));
+  TEST_ASSERT_EQUAL(2, due[0]);
+}
+
+void test_SchedulePopDue_Wrap(void) {
+  // deadline after the clock wraps runs after one before it
+  ScheduleAdd(&schedule, 0, 0x10, 1000);
+  ScheduleAdd(&schedule, 1, 0xFFFFFF00, 1000);
+
+  uint32_t deadline = 0;
+  ScheduleNext(&schedule, &deadline);
+  TEST_ASSERT_EQUAL_HEX32(0xFFFFFF00, deadline);
+
+  uint8_t due[4];
+  TEST_ASSERT_EQUAL(1, SchedulePopDue(&schedule, 0xFFFFFFF0, due, 4));
+  TEST_ASSERT_EQUAL(1, due[0]);
+  TEST_ASSERT_EQUAL(1, SchedulePopDue(&schedule, 0x20, due, 4));
+  TEST_ASSERT_EQUAL(0, due[0]);
+
+  ScheduleNext(&schedule, &deadline);
+  TEST_ASSERT_EQUAL_HEX32(0xFFFFFF00 + 1000, deadline);
+}
+
+/**
+ * @brief Entry point for schedule test
+ * @retval int
+ */
+int main(void) {
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick.
+   */
+  HAL_Init();
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+
+  // wait for UART
+  for (int i = 0; i < 1000000; i++) {
+    __NOP();
+  }
+
+  // Unit testing
+  UNITY_BEGIN();
+
+  RUN_TEST(test_ScheduleNext_Empty);
+  RUN_TEST(test_ScheduleAdd_Invalid);
+  RUN_TEST(test_ScheduleNext_Earliest);
+  RUN_TEST(test_SchedulePopDue_NotDue);
+  RUN_TEST(test_SchedulePopDue_Order);
+  RUN_TEST(test_SchedulePopDue_Coalesce);
+  RUN_TEST(test_SchedulePopDue_Periods);
+  RUN_TEST(test_SchedulePopDue_Phase);
+  RUN_TEST(test_SchedulePopDue_SkipMissed);
+  RUN_TEST(test_SchedulePopDue_Max);
+  RUN_TEST(test_SchedulePopDue_Wrap);
+
+  UNITY_END();
+}
@@ -0,0 +1,158 @@
+/**
+ * @file test_stats.c
+ * @brief Tests the fixed point running statistics
+ *
+ * Results are compared against the statistics of the same samples computed
+ * in double precision.
+ *
+ * @see stats.h
+ *
+ * @author John Madden <jmadden173@pm.me>
+ * @date 2026-10-16
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include "gpio.h"
+#include "main.h"
+#include "main_helper.h"
+#include "stats.h"
+#include "usart.h"
+
+/**
+ * @brief Generated from CubeMX
+ */
+void SystemClock_Config(void);
+
+/** Statistics under test */
+static Stats stats;
+
+/**
+ * @brief Setup code that runs at the start of every test
+ */
+void setUp(void) { StatsInit(&stats); }
+
+/**
+ * @brief Tear down code that runs at the end of every test
+ */
+void tearDown(void) {}
+
+/**
+ * @brief Adds samples and checks against a two-pass computation
+ *
+ * @param samples Samples
+ * @param len Number of samples
+ */
+static void assert_stats(const int32_t *samples, size_t len) {
+  double sum = 0.0;
+  int32_t min = samples[0];
+  int32_t max = samples[0];
+  for (size_t i = 0; i < len; i++) {
+    TEST_ASSERT_EQUAL(0, StatsAdd(&stats, samples[i]));
+    sum += samples[i];
+    min = (samples[i] < min) ? samples[i] : min;
+    max = (samples[i] > max) ? samples[i] : max;
+  }
+
+  const double mean = sum / len;
+  double m2 = 0.0;
+  for (size_t i = 0; i < len; i++) {
+    m2 += (samples[i] - mean) * (samples[i] - mean);
+  }
+  const double variance = (len > 1) ? m2 / (len - 1) : 0.0;
+
+  TEST_ASSERT_EQUAL(len, stats.count);
+  TEST_ASSERT_EQUAL_INT32(min, stats.min);
+  TEST_ASSERT_EQUAL_INT32(max, stats.max);
+  // within a few fixed point steps
+  TEST_ASSERT_DOUBLE_WITHIN(0.05, mean, StatsMean(&stats));
+  TEST_ASSERT_DOUBLE_WITHIN(0.05 + variance * 1e-6, variance,
+                            StatsVariance(&stats));
+}
+
+void test_Stats_Empty(void) {
+  TEST_ASSERT_EQUAL(0, stats.count);
+  TEST_ASSERT_EQUAL_DOUBLE(0.0, StatsMean(&stats));
+  TEST_ASSERT_EQUAL_DOUBLE(0.0, StatsVariance(&stats));
+}
+
+void test_Stats_Single(void) {
+  TEST_ASSERT_EQUAL(0, StatsAdd(&stats, -1234));
+  TEST_ASSERT_EQUAL_DOUBLE(-1234.0, StatsMean(&stats));
+  TEST_ASSERT_EQUAL_DOUBLE(0.0, StatsVariance(&stats));
+  TEST_ASSERT_EQUAL_INT32(-1234, stats.min);
+  TEST_ASSERT_EQUAL_INT32(-1234, stats.max);
+}
+
+void test_Stats_Sequence(void) {
+  const int32_t samples[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  assert_stats(samples, sizeof(samples) / sizeof(samples[0]));
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, 5.5, StatsMean(&stats));
+  TEST_ASSERT_DOUBLE_WITHIN(0.01, 3.0277, StatsStddev(&stats));
+}
+
+void test_Stats_Offset(void) {
+  // small noise on a large offset, where a sum of squares loses precision
+  int32_t samples[64];
+  for (size_t i = 0; i < 64; i++) {
+    samples[i] = 8000000 + (int32_t)(i % 7) - 3;
+  }
+  assert_stats(samples, 64);
+}
+
+void test_Stats_FullScale(void) {
+  // largest differences between samples must not overflow
+  int32_t samples[STATS_MAX_COUNT];
+  for (size_t i = 0; i < STATS_MAX_COUNT; i++) {
+    samples[i] = (i % 2) ? STATS_SAMPLE_MAX : STATS_SAMPLE_MIN;
+  }
+  assert_stats(samples, STATS_MAX_COUNT);
+}
+
+void test_Stats_Limits(void) {
+  TEST_ASSERT_EQUAL(-1, StatsAdd(&stats, STATS_SAMPLE_MAX + 1));
+  TEST_ASSERT_EQUAL(-1, StatsAdd(&stats, STATS_SAMPLE_MIN - 1));
+  TEST_ASSERT_EQUAL(0, stats.count);
+
+  for (int i = 0; i < STATS_MAX_COUNT; i++) {
+    TEST_ASSERT_EQUAL(0, StatsAdd(&stats, i));
+  }
+  TEST_ASSERT_EQUAL(-1, StatsAdd(&stats, 0));
+  TEST_ASSERT_EQUAL(STATS_MAX_COUNT, stats.count);
+}
+
+/**
+ * @brief Entry point for stats test
+ * @retval int
+ */
+int main(void) {
+  /* Reset of all peripherals, Initializes the Flash interface and the Systick.
+   */
+  HAL_Init();
+
+  /* Configure the system clock */
+  SystemClock_Config();
+
+  /* Initialize all configured peripherals */
+  MX_GPIO_Init();
+  MX_USART1_UART_Init();
+
+  // wait for UART
+  for (int i = 0; i < 1000000; i++) {
+    __NOP();
+  }
+
+  // Unit testing
+  UNITY_BEGIN();
+
+  RUN_TEST(test_Stats_Empty);
+  RUN_TEST(test_Stats_Single);
+  RUN_TEST(test_Stats_Sequence);
+  RUN_TEST(test_Stats_Offset);
+  RUN_TEST(test_Stats_FullScale);
+  RUN_TEST(test_Stats_Limits);
+
+  UNITY_END();
+}
@@ -52,10 +52,9 @@ void TestEncodePower(void) {
   buffer_len = EncodePowerMeasurement(1436079600, 7, 4, 37.13, 185.29, buffer);
 
   uint8_t data[] = {0xa,  0xa,  0x8,  0x4,  0x10, 0x7,  0x18, 0xf0,
-                    0xab, 0xe3, 0xac, 0x5,  0x12, 0x12, 0x11, 0x71,
-                    0x3d, 0xa,  0xd7, 0xa3, 0x90, 0x42, 0x40, 0x19,
-                    0xe1, 0x7a, 0x14, 0xae, 0x47, 0x29, 0x67, 0x40};
-  size_t data_len = 32;
+                    0xab, 0xe3, 0xac, 0x5,  0x12, 0xa,  0x25, 0x1f,
+                    0x85, 0x14, 0x42, 0x2d, 0x3d, 0x4a, 0x39, 0x43};
+  size_t data_len = 24;
 
   TEST_ASSERT_EQUAL_HEX8_ARRAY(data, buffer, buffer_len);
   TEST_ASSERT_EQUAL_INT(data_len, buffer_len);
@@ -68,12 +67,11 @@ void TestEncodeTeros12(void) {
   buffer_len = EncodeTeros12Measurement(1436079600, 7, 4, 2124.62, 0.43, 24.8,
                                         123, buffer);
 
-  uint8_t data[] = {0xa,  0xa,  0x8,  0x4,  0x10, 0x7,  0x18, 0xf0, 0xab,
-                    0xe3, 0xac, 0x5,  0x1a, 0x1d, 0x11, 0xa,  0xd7, 0xa3,
-                    0x70, 0x3d, 0x99, 0xa0, 0x40, 0x19, 0x85, 0xeb, 0x51,
-                    0xb8, 0x1e, 0x85, 0xdb, 0x3f, 0x21, 0xcd, 0xcc, 0xcc,
-                    0xcc, 0xcc, 0xcc, 0x38, 0x40, 0x28, 0x7b};
-  size_t data_len = 43;
+  uint8_t data[] = {0xa,  0xa,  0x8,  0x4,  0x10, 0x7,  0x18, 0xf0,
+                    0xab, 0xe3, 0xac, 0x5,  0x1a, 0x11, 0x28, 0x7b,
+                    0x35, 0xec, 0xc9, 0x4,  0x45, 0x3d, 0xf6, 0x28,
+                    0xdc, 0x3e, 0x45, 0x66, 0x66, 0xc6, 0x41};
+  size_t data_len = 31;
 
   TEST_ASSERT_EQUAL_HEX8_ARRAY(data, buffer, buffer_len);
   TEST_ASSERT_EQUAL_INT(data_len, buffer_len);
@@ -87,10 +85,9 @@ void TestEncodePhytos31(void) {
       EncodePhytos31Measurement(1436079600, 7, 4, 1425.12, 1962.2, buffer);
 
   uint8_t data[] = {0xa,  0xa,  0x8,  0x4,  0x10, 0x7,  0x18, 0xf0,
-                    0xab, 0xe3, 0xac, 0x5,  0x22, 0x12, 0x9,  0x14,
-                    0xae, 0x47, 0xe1, 0x7a, 0x44, 0x96, 0x40, 0x11,
-                    0xcd, 0xcc, 0xcc, 0xcc, 0xcc, 0xa8, 0x9e, 0x40};
-  size_t data_len = 32;
+                    0xab, 0xe3, 0xac, 0x5,  0x22, 0xa,  0x1d, 0xd7,
+                    0x23, 0xb2, 0x44, 0x25, 0x66, 0x46, 0xf5, 0x44};
+  size_t data_len = 24;
 
   TEST_ASSERT_EQUAL_HEX8_ARRAY(data, buffer, buffer_len);
   TEST_ASSERT_EQUAL_INT(data_len, buffer_len);
@@ -120,13 +117,511 @@ void TestEncodeTeros21(void) {
       EncodeTeros21Measurement(1737671549, 51, 12, 134.5, 22.4, buffer);
 
   uint8_t data[] = {0xa,  0xa,  0x8,  0xc,  0x10, 0x33, 0x18, 0xfd,
-                    0x86, 0xcb, 0xbc, 0x6,  0x32, 0x12, 0x9,  0x0,
-                    0x0,  0x0,  0x0,  0x0,  0xd0, 0x60, 0x40, 0x11,
-                    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x36, 0x40};
+                    0x86, 0xcb, 0xbc, 0x6,  0x32, 0xa,  0x1d, 0x0,
+                    0x80, 0x6,  0x43, 0x25, 0x33, 0x33, 0xb3, 0x41};
+  size_t data_len = 24;
+
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(data, buffer, buffer_len);
+  TEST_ASSERT_EQUAL_INT(data_len, buffer_len);
+}
+
+void TestEncodePowerSummary(void) {
+  uint8_t buffer[256];
+  size_t buffer_len;
+
+  PowerSummary summary = PowerSummary_init_zero;
+  summary.count = 16;
+  summary.voltage_mean = 37.13;
+  summary.voltage_min = 36.9;
+  summary.voltage_max = 37.4;
+  summary.voltage_stddev = 0.12;
+  summary.current_mean = 185.29;
+  summary.current_min = 180.5;
+  summary.current_max = 190.25;
+  summary.current_stddev = 2.5;
+
+  buffer_len = EncodePowerSummary(1436079600, 7, 4, &summary, buffer);
+
+  uint8_t data[] = {0xa,  0xa,  0x8,  0x4,  0x10, 0x7,  0x18, 0xf0,
+                    0xab, 0xe3, 0xac, 0x5,  0x3a, 0x2a, 0x8,  0x10,
+                    0x15, 0x1f, 0x85, 0x14, 0x42, 0x1d, 0x9a, 0x99,
+                    0x13, 0x42, 0x25, 0x9a, 0x99, 0x15, 0x42, 0x2d,
+                    0x8f, 0xc2, 0xf5, 0x3d, 0x35, 0x3d, 0x4a, 0x39,
+                    0x43, 0x3d, 0x0,  0x80, 0x34, 0x43, 0x45, 0x0,
+                    0x40, 0x3e, 0x43, 0x4d, 0x0,  0x0,  0x20, 0x40};
+  size_t data_len = 56;
+
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(data, buffer, buffer_len);
+  TEST_ASSERT_EQUAL_INT(data_len, buffer_len);
+
+  Measurement meas = Measurement_init_zero;
+  TEST_ASSERT_EQUAL(0, DecodeMeasurement(buffer, buffer_len, &meas));
+  TEST_ASSERT_EQUAL(Measurement_power_summary_tag, meas.which_measurement);
+  TEST_ASSERT_EQUAL(16, meas.measurement.power_summary.count);
+  TEST_ASSERT_EQUAL_FLOAT(2.5, meas.measurement.power_summary.current_stddev);
+
+  // summaries can not be batched
+  MeasurementBatch batch = MeasurementBatch_init_zero;
+  TEST_ASSERT_EQUAL(-1,
+                    MeasurementBatchAdd(&batch, &meas, MeasurementBatch_size));
+}
+
+void TestEncodeStream(void) {
+  uint8_t buffer[Measurement_size];
+  size_t buffer_len;
+
+  buffer_len = EncodeTeros12Measurement(1436079600, 7, 4, 2124.62, 0.43, 24.8,
+                                        123, buffer);
+
+  // same bytes as encoding into a buffer
+  uint8_t stream_buffer[Measurement_size];
+  pb_ostream_t ostream =
+      pb_ostream_from_buffer(stream_buffer, sizeof(stream_buffer));
+  bool status = EncodeTeros12MeasurementStream(1436079600, 7, 4, 2124.62, 0.43,
+                                               24.8, 123, &ostream);
+
+  TEST_ASSERT_TRUE(status);
+  TEST_ASSERT_EQUAL_INT(buffer_len, ostream.bytes_written);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(buffer, stream_buffer, buffer_len);
+
+  // stream too small for the measurement
+  ostream = pb_ostream_from_buffer(stream_buffer, buffer_len - 1);
+  status = EncodeTeros12MeasurementStream(1436079600, 7, 4, 2124.62, 0.43,
+                                          24.8, 123, &ostream);
+  TEST_ASSERT_FALSE(status);
+}
+
+void TestDecodeMeasurementDouble(void) {
+  // power measurement encoded with the deprecated double fields
+  uint8_t data[] = {0xa,  0xa,  0x8,  0x4,  0x10, 0x7,  0x18, 0xf0,
+                    0xab, 0xe3, 0xac, 0x5,  0x12, 0x12, 0x11, 0x71,
+                    0x3d, 0xa,  0xd7, 0xa3, 0x90, 0x42, 0x40, 0x19,
+                    0xe1, 0x7a, 0x14, 0xae, 0x47, 0x29, 0x67, 0x40};
   size_t data_len = 32;
 
+  Measurement meas = Measurement_init_zero;
+  int status = DecodeMeasurement(data, data_len, &meas);
+
+  TEST_ASSERT_EQUAL(0, status);
+  TEST_ASSERT_EQUAL(Measurement_power_tag, meas.which_measurement);
+  TEST_ASSERT_EQUAL(4, meas.meta.cell_id);
+  TEST_ASSERT_EQUAL(7, meas.meta.logger_id);
+  TEST_ASSERT_EQUAL(1436079600, meas.meta.ts);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4, 37.13, meas.measurement.power.voltage);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4, 185.29, meas.measurement.power.current);
+}
+
+void TestMeasurementBatchPower(void) {
+  MeasurementBatch batch = MeasurementBatch_init_zero;
+
+  // build batch from individually encoded measurements
+  for (int i = 0; i < 10; i++) {
+    uint8_t buffer[Measurement_size];
+    size_t buffer_len = EncodePowerMeasurement(
+        1436079600 + 60 * i, 7, 4, 37.13 + i, 185.29 - i, buffer);
+
+    Measurement meas = Measurement_init_zero;
+    TEST_ASSERT_EQUAL(0, DecodeMeasurement(buffer, buffer_len, &meas));
+    TEST_ASSERT_EQUAL(0, MeasurementBatchAdd(&batch, &meas,
+                                             MeasurementBatch_size));
+  }
+
+  uint8_t buffer[MeasurementBatch_size];
+  size_t buffer_len = EncodeMeasurementBatch(&batch, buffer, sizeof(buffer));
+  TEST_ASSERT_NOT_EQUAL(-1, buffer_len);
+
+  // less than half the size of 10 power measurements
+  TEST_ASSERT_LESS_THAN(10 * 32 / 2, buffer_len);
+
+  MeasurementBatch decoded = MeasurementBatch_init_zero;
+  TEST_ASSERT_EQUAL(0, DecodeMeasurementBatch(buffer, buffer_len, &decoded));
+  TEST_ASSERT_EQUAL(MeasurementBatch_power_tag, decoded.which_batch);
+  TEST_ASSERT_EQUAL(10, decoded.ts_delta_count);
+
+  for (int i = 0; i < 10; i++) {
+    Measurement meas = Measurement_init_zero;
+    TEST_ASSERT_EQUAL(0, MeasurementBatchGet(&decoded, i, &meas));
+    TEST_ASSERT_EQUAL(Measurement_power_tag, meas.which_measurement);
+    TEST_ASSERT_EQUAL(1436079600 + 60 * i, meas.meta.ts);
+    TEST_ASSERT_EQUAL(7, meas.meta.logger_id);
+    TEST_ASSERT_EQUAL(4, meas.meta.cell_id);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 37.13 + i, meas.measurement.power.voltage);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, 185.29 - i, meas.measurement.power.current);
+  }
+
+  Measurement meas = Measurement_init_zero;
+  TEST_ASSERT_EQUAL(-1, MeasurementBatchGet(&decoded, 10, &meas));
+}
+
+void TestMeasurementBatchBME280(void) {
+  MeasurementBatch batch = MeasurementBatch_init_zero;
+
+  // timestamps are not required to be increasing
+  const uint32_t ts[] = {1436079600, 1436079660, 1436079630};
+  for (int i = 0; i < 3; i++) {
+    Measurement meas = Measurement_init_zero;
+    meas.has_meta = true;
+    meas.meta.ts = ts[i];
+    meas.meta.logger_id = 7;
+    meas.meta.cell_id = 4;
+    meas.which_measurement = Measurement_bme280_tag;
+    meas.measurement.bme280.pressure = 98473 + i;
+    meas.measurement.bme280.temperature = -2275 + i;
+    meas.measurement.bme280.humidity = 43600 + i;
+    TEST_ASSERT_EQUAL(0, MeasurementBatchAdd(&batch, &meas,
+                                             MeasurementBatch_size));
+  }
+
+  uint8_t buffer[MeasurementBatch_size];
+  size_t buffer_len = EncodeMeasurementBatch(&batch, buffer, sizeof(buffer));
+
+  MeasurementBatch decoded = MeasurementBatch_init_zero;
+  TEST_ASSERT_EQUAL(0, DecodeMeasurementBatch(buffer, buffer_len, &decoded));
+
+  for (int i = 0; i < 3; i++) {
+    Measurement meas = Measurement_init_zero;
+    TEST_ASSERT_EQUAL(0, MeasurementBatchGet(&decoded, i, &meas));
+    TEST_ASSERT_EQUAL(Measurement_bme280_tag, meas.which_measurement);
+    TEST_ASSERT_EQUAL(ts[i], meas.meta.ts);
+    TEST_ASSERT_EQUAL(98473 + i, meas.measurement.bme280.pressure);
+    TEST_ASSERT_EQUAL(-2275 + i, meas.measurement.bme280.temperature);
+    TEST_ASSERT_EQUAL(43600 + i, meas.measurement.bme280.humidity);
+  }
+}
+
+void TestMeasurementBatchAddMismatch(void) {
+  MeasurementBatch batch = MeasurementBatch_init_zero;
+
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta.ts = 1436079600;
+  meas.meta.logger_id = 7;
+  meas.meta.cell_id = 4;
+  meas.which_measurement = Measurement_power_tag;
+  TEST_ASSERT_EQUAL(0, MeasurementBatchAdd(&batch, &meas,
+                                           MeasurementBatch_size));
+
+  // other cell
+  meas.meta.cell_id = 5;
+  TEST_ASSERT_EQUAL(-1, MeasurementBatchAdd(&batch, &meas,
+                                            MeasurementBatch_size));
+
+  // other type
+  meas.meta.cell_id = 4;
+  meas.which_measurement = Measurement_teros21_tag;
+  TEST_ASSERT_EQUAL(-1, MeasurementBatchAdd(&batch, &meas,
+                                            MeasurementBatch_size));
+
+  TEST_ASSERT_EQUAL(1, batch.ts_delta_count);
+  TEST_ASSERT_EQUAL(1, batch.batch.power.voltage_count);
+}
+
+void TestMeasurementBatchAddMaxSize(void) {
+  MeasurementBatch batch = MeasurementBatch_init_zero;
+
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta.ts = 1436079600;
+  meas.meta.logger_id = 7;
+  meas.meta.cell_id = 4;
+  meas.which_measurement = Measurement_power_tag;
+  meas.measurement.power.voltage = 37.13;
+  meas.measurement.power.current = 185.29;
+
+  // add until the batch is full
+  const size_t max_size = 51;
+  int count = 0;
+  while (MeasurementBatchAdd(&batch, &meas, max_size) == 0) {
+    meas.meta.ts += 60;
+    count++;
+  }
+  TEST_ASSERT_GREATER_THAN(1, count);
+  TEST_ASSERT_EQUAL(count, batch.ts_delta_count);
+  TEST_ASSERT_EQUAL(count, batch.batch.power.current_count);
+
+  uint8_t buffer[MeasurementBatch_size];
+  size_t buffer_len = EncodeMeasurementBatch(&batch, buffer, sizeof(buffer));
+  TEST_ASSERT_LESS_OR_EQUAL(max_size, buffer_len);
+
+  // a batch that can not fit a single measurement stays empty
+  MeasurementBatch empty = MeasurementBatch_init_zero;
+  TEST_ASSERT_EQUAL(-1, MeasurementBatchAdd(&empty, &meas, 4));
+  TEST_ASSERT_EQUAL(0, empty.ts_delta_count);
+  TEST_ASSERT_FALSE(empty.has_meta);
+}
+
+void TestMeasurementDeltaPower(void) {
+  MeasurementDelta enc;
+  MeasurementDelta dec;
+  MeasurementDeltaInit(&enc);
+  MeasurementDeltaInit(&dec);
+
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta.ts = 1436079600;
+  meas.meta.logger_id = 7;
+  meas.meta.cell_id = 4;
+  meas.which_measurement = Measurement_power_tag;
+
+  size_t total = 0;
+  for (int i = 0; i < 10; i++) {
+    // slowly changing voltage with a constant current
+    meas.meta.ts = 1436079600 + 60 * i;
+    meas.measurement.power.voltage = 37.13 + 0.01 * i;
+    meas.measurement.power.current = 185.29;
+
+    uint8_t buffer[TRANSCODER_DELTA_MAX_SIZE];
+    size_t buffer_len =
+        EncodeMeasurementDelta(&enc, &meas, buffer, sizeof(buffer));
+    TEST_ASSERT_NOT_EQUAL(-1, buffer_len);
+    TEST_ASSERT_EQUAL(i == 0, (buffer[0] & 0x80) != 0);
+    MeasurementDeltaAdvance(&enc, buffer, &meas);
+    total += buffer_len;
+
+    Measurement decoded = Measurement_init_zero;
+    TEST_ASSERT_EQUAL(
+        0, DecodeMeasurementDelta(&dec, buffer, buffer_len, &decoded));
+    MeasurementDeltaAdvance(&dec, buffer, &decoded);
+
+    TEST_ASSERT_EQUAL(Measurement_power_tag, decoded.which_measurement);
+    TEST_ASSERT_EQUAL(meas.meta.ts, decoded.meta.ts);
+    TEST_ASSERT_EQUAL(7, decoded.meta.logger_id);
+    TEST_ASSERT_EQUAL(4, decoded.meta.cell_id);
+    TEST_ASSERT_EQUAL_FLOAT(meas.measurement.power.voltage,
+                            decoded.measurement.power.voltage);
+    TEST_ASSERT_EQUAL_FLOAT(meas.measurement.power.current,
+                            decoded.measurement.power.current);
+  }
+
+  // less than half the size of 10 power measurements
+  TEST_ASSERT_LESS_THAN(10 * 24 / 2, total);
+}
+
+void TestMeasurementDeltaBME280(void) {
+  MeasurementDelta enc;
+  MeasurementDelta dec;
+  MeasurementDeltaInit(&enc);
+  MeasurementDeltaInit(&dec);
+
+  // temperature crosses zero and timestamps are irregular
+  const uint32_t ts[] = {1436079600, 1436079660, 1436079630, 1436079690};
+  const int32_t temperature[] = {-5, 3, -2275, 2};
+  for (int i = 0; i < 4; i++) {
+    Measurement meas = Measurement_init_zero;
+    meas.has_meta = true;
+    meas.meta.ts = ts[i];
+    meas.meta.logger_id = 7;
+    meas.meta.cell_id = 4;
+    meas.which_measurement = Measurement_bme280_tag;
+    meas.measurement.bme280.pressure = 98473 - i;
+    meas.measurement.bme280.temperature = temperature[i];
+    meas.measurement.bme280.humidity = 43600;
+
+    uint8_t buffer[TRANSCODER_DELTA_MAX_SIZE];
+    size_t buffer_len =
+        EncodeMeasurementDelta(&enc, &meas, buffer, sizeof(buffer));
+    TEST_ASSERT_NOT_EQUAL(-1, buffer_len);
+    MeasurementDeltaAdvance(&enc, buffer, &meas);
+
+    Measurement decoded = Measurement_init_zero;
+    TEST_ASSERT_EQUAL(
+        0, DecodeMeasurementDelta(&dec, buffer, buffer_len, &decoded));
+    MeasurementDeltaAdvance(&dec, buffer, &decoded);
+
+    TEST_ASSERT_EQUAL(ts[i], decoded.meta.ts);
+    TEST_ASSERT_EQUAL(98473 - i, decoded.measurement.bme280.pressure);
+    TEST_ASSERT_EQUAL(temperature[i], decoded.measurement.bme280.temperature);
+    TEST_ASSERT_EQUAL(43600, decoded.measurement.bme280.humidity);
+  }
+}
+
+void TestMeasurementDeltaMissingReference(void) {
+  MeasurementDelta enc;
+  MeasurementDelta dec;
+  MeasurementDeltaInit(&enc);
+  MeasurementDeltaInit(&dec);
+
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta.ts = 1436079600;
+  meas.which_measurement = Measurement_teros21_tag;
+  meas.measurement.teros21.matric_pot = 101.5;
+  meas.measurement.teros21.temp = 22.5;
+
+  uint8_t keyframe[TRANSCODER_DELTA_MAX_SIZE];
+  size_t keyframe_len =
+      EncodeMeasurementDelta(&enc, &meas, keyframe, sizeof(keyframe));
+  MeasurementDeltaAdvance(&enc, keyframe, &meas);
+
+  meas.meta.ts += 60;
+  meas.measurement.teros21.temp = 22.75;
+  uint8_t delta[TRANSCODER_DELTA_MAX_SIZE];
+  size_t delta_len = EncodeMeasurementDelta(&enc, &meas, delta, sizeof(delta));
+  TEST_ASSERT_EQUAL(Measurement_teros21_tag, delta[0]);
+
+  // delta without its keyframe is refused
+  Measurement decoded = Measurement_init_zero;
+  TEST_ASSERT_EQUAL(-1, DecodeMeasurementDelta(&dec, delta, delta_len,
+                                               &decoded));
+
+  TEST_ASSERT_EQUAL(0, DecodeMeasurementDelta(&dec, keyframe, keyframe_len,
+                                              &decoded));
+  MeasurementDeltaAdvance(&dec, keyframe, &decoded);
+  TEST_ASSERT_EQUAL(0, DecodeMeasurementDelta(&dec, delta, delta_len,
+                                              &decoded));
+  MeasurementDeltaAdvance(&dec, delta, &decoded);
+  TEST_ASSERT_EQUAL_FLOAT(22.75, decoded.measurement.teros21.temp);
+
+  // the same delta again is out of sequence
+  TEST_ASSERT_EQUAL(-1, DecodeMeasurementDelta(&dec, delta, delta_len,
+                                               &decoded));
+
+  // truncated delta
+  TEST_ASSERT_EQUAL(-1, DecodeMeasurementDelta(&enc, delta, 2, &decoded));
+}
+
+void TestMeasurementDeltaKeyframe(void) {
+  MeasurementDelta enc;
+  MeasurementDeltaInit(&enc);
+
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta.ts = 1436079600;
+  meas.meta.cell_id = 4;
+  meas.which_measurement = Measurement_phytos31_tag;
+
+  // keyframes are repeated after the interval
+  for (int i = 0; i < 2 * TRANSCODER_DELTA_KEYFRAME_INTERVAL; i++) {
+    uint8_t buffer[TRANSCODER_DELTA_MAX_SIZE];
+    TEST_ASSERT_NOT_EQUAL(
+        -1, EncodeMeasurementDelta(&enc, &meas, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(i % TRANSCODER_DELTA_KEYFRAME_INTERVAL == 0,
+                      (buffer[0] & 0x80) != 0);
+    MeasurementDeltaAdvance(&enc, buffer, &meas);
+    meas.meta.ts += 60;
+  }
+
+  // other cell
+  meas.meta.cell_id = 5;
+  uint8_t buffer[TRANSCODER_DELTA_MAX_SIZE];
+  EncodeMeasurementDelta(&enc, &meas, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL(0x80 | Measurement_phytos31_tag, buffer[0]);
+
+  // buffer too small
+  TEST_ASSERT_EQUAL(-1, EncodeMeasurementDelta(&enc, &meas, buffer, 4));
+
+  // unsupported type
+  meas.which_measurement = 0;
+  TEST_ASSERT_EQUAL(
+      -1, EncodeMeasurementDelta(&enc, &meas, buffer, sizeof(buffer)));
+}
+
+void TestEncodePowerBurst(void) {
+  uint8_t buffer[256];
+  size_t buffer_len;
+
+  const int32_t samples[] = {8000000, 8000003, 7999990, 8000100, -5};
+
+  PowerBurst burst = PowerBurst_init_zero;
+  burst.burst_id = 3;
+  burst.rate = 1000;
+  burst.offset = 64;
+  burst.total = 1024;
+  size_t samples_len = 0;
+  TEST_ASSERT_EQUAL(5, EncodeBurstSamples(samples, 5, burst.samples.bytes,
+                                          sizeof(burst.samples.bytes),
+                                          &samples_len));
+  burst.samples.size = samples_len;
+
+  buffer_len = EncodePowerBurst(1436079600, 7, 4, &burst, buffer);
+
+  uint8_t data[] = {0xa,  0xa,  0x8,  0x4,  0x10, 0x7,  0x18, 0xf0,
+                    0xab, 0xe3, 0xac, 0x5,  0x42, 0x18, 0x8,  0x3,
+                    0x18, 0xe8, 0x7,  0x20, 0x40, 0x28, 0x80, 0x8,
+                    0x3a, 0xc,  0x80, 0xc8, 0xd0, 0x7,  0x6,  0x19,
+                    0xdc, 0x1,  0xd1, 0xc9, 0xd0, 0x7};
+  size_t data_len = 38;
+
   TEST_ASSERT_EQUAL_HEX8_ARRAY(data, buffer, buffer_len);
   TEST_ASSERT_EQUAL_INT(data_len, buffer_len);
+
+  Measurement meas = Measurement_init_zero;
+  TEST_ASSERT_EQUAL(0, DecodeMeasurement(buffer, buffer_len, &meas));
+  TEST_ASSERT_EQUAL(Measurement_power_burst_tag, meas.which_measurement);
+
+  const PowerBurst_samples_t *decoded_samples =
+      &meas.measurement.power_burst.samples;
+  int32_t decoded[8];
+  TEST_ASSERT_EQUAL(5, DecodeBurstSamples(decoded_samples->bytes,
+                                          decoded_samples->size, decoded, 8));
+  TEST_ASSERT_EQUAL_INT32_ARRAY(samples, decoded, 5);
+
+  // bursts can not be batched
+  MeasurementBatch batch = MeasurementBatch_init_zero;
+  TEST_ASSERT_EQUAL(-1,
+                    MeasurementBatchAdd(&batch, &meas, MeasurementBatch_size));
+}
+
+void TestBurstSamplesLimits(void) {
+  const int32_t samples[] = {-8388608, 8388607, 0, 1};
+  uint8_t buffer[16];
+  size_t len = 0;
+
+  // full scale swing takes four bytes, stops before a sample that does not fit
+  TEST_ASSERT_EQUAL(1, EncodeBurstSamples(samples, 4, buffer, 6, &len));
+  TEST_ASSERT_EQUAL(4, len);
+  TEST_ASSERT_EQUAL(2, EncodeBurstSamples(samples, 4, buffer, 8, &len));
+  TEST_ASSERT_EQUAL(8, len);
+  TEST_ASSERT_EQUAL(4, EncodeBurstSamples(samples, 4, buffer, sizeof(buffer),
+                                          &len));
+
+  int32_t decoded[4];
+  TEST_ASSERT_EQUAL(4, DecodeBurstSamples(buffer, len, decoded, 4));
+  TEST_ASSERT_EQUAL_INT32_ARRAY(samples, decoded, 4);
+
+  // more samples than room
+  TEST_ASSERT_EQUAL(-1, DecodeBurstSamples(buffer, len, decoded, 3));
+  // truncated varint
+  TEST_ASSERT_EQUAL(-1, DecodeBurstSamples(buffer, 3, decoded, 4));
+  TEST_ASSERT_EQUAL(0, DecodeBurstSamples(buffer, 0, decoded, 4));
+}
+
+void TestMeasurementDeltaPowerSummary(void) {
+  MeasurementDelta enc;
+  MeasurementDelta dec;
+  MeasurementDeltaInit(&enc);
+  MeasurementDeltaInit(&dec);
+
+  Measurement meas = Measurement_init_zero;
+  meas.has_meta = true;
+  meas.meta.ts = 1436079600;
+  meas.which_measurement = Measurement_power_summary_tag;
+  meas.measurement.power_summary.count = 16;
+
+  // summaries have too many values for the bitmap of a delta
+  for (int i = 0; i < 3; i++) {
+    meas.measurement.power_summary.voltage_mean = 37.13 + i;
+
+    uint8_t buffer[TRANSCODER_DELTA_MAX_SIZE];
+    size_t buffer_len =
+        EncodeMeasurementDelta(&enc, &meas, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL(0x80 | Measurement_power_summary_tag, buffer[0]);
+    MeasurementDeltaAdvance(&enc, buffer, &meas);
+
+    Measurement decoded = Measurement_init_zero;
+    TEST_ASSERT_EQUAL(
+        0, DecodeMeasurementDelta(&dec, buffer, buffer_len, &decoded));
+    MeasurementDeltaAdvance(&dec, buffer, &decoded);
+    TEST_ASSERT_EQUAL_FLOAT(37.13 + i,
+                            decoded.measurement.power_summary.voltage_mean);
+    meas.meta.ts += 60;
+  }
+
+  // deltas of summaries are refused
+  const uint8_t delta[] = {Measurement_power_summary_tag, 4, 0x00, 0x00};
+  Measurement decoded = Measurement_init_zero;
+  TEST_ASSERT_EQUAL(-1, DecodeMeasurementDelta(&dec, delta, sizeof(delta),
+                                               &decoded));
 }
 
 void TestDecodeResponseSuccess(void) {
@@ -198,7 +693,9 @@ void TestDecodeWiFi() {
                     0x1,  0x30, 0x80, 0xd4, 0x61, 0x40, 0xbb, 0x3};
   size_t data_len = 48;
 
-  Esp32Command cmd = DecodeEsp32Command(data, data_len);
+  Esp32Command cmd = Esp32Command_init_zero;
+  int status = DecodeEsp32Command(data, data_len, &cmd);
+  TEST_ASSERT_EQUAL(0, status);
 
   char ssid[] = "Hello";
   char passwd[] = "World";
@@ -215,6 +712,78 @@ void TestDecodeWiFi() {
   TEST_ASSERT_EQUAL(0, cmd.command.wifi_command.resp.size);
 }
 
+void TestDecodeWiFiCommand(void) {
+  uint8_t data[] = {0x1a, 0x2e, 0x12, 0x5,  0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x1a,
+                    0x5,  0x57, 0x6f, 0x72, 0x6c, 0x64, 0x22, 0x14, 0x68, 0x74,
+                    0x74, 0x70, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x74,
+                    0x65, 0x73, 0x74, 0x2e, 0x63, 0x6f, 0x6d, 0x2f, 0x28, 0xc8,
+                    0x1,  0x30, 0x80, 0xd4, 0x61, 0x40, 0xbb, 0x3};
+  size_t data_len = 48;
+
+  WiFiCommand wifi_cmd;
+  int status = DecodeWiFiCommand(data, data_len, &wifi_cmd);
+  TEST_ASSERT_EQUAL(0, status);
+
+  TEST_ASSERT_EQUAL(WiFiCommand_Type_CONNECT, wifi_cmd.type);
+  TEST_ASSERT_EQUAL_STRING("Hello", wifi_cmd.ssid);
+  TEST_ASSERT_EQUAL_STRING("World", wifi_cmd.passwd);
+  TEST_ASSERT_EQUAL_STRING("http://www.test.com/", wifi_cmd.url);
+  TEST_ASSERT_EQUAL(443, wifi_cmd.port);
+  TEST_ASSERT_EQUAL(200, wifi_cmd.rc);
+  TEST_ASSERT_EQUAL(1600000, wifi_cmd.ts);
+  TEST_ASSERT_EQUAL(0, wifi_cmd.resp.size);
+}
+
+void TestDecodeWiFiCommandWrongType(void) {
+  uint8_t buffer[Esp32Command_size];
+  size_t buffer_len = EncodeTestCommand(TestCommand_ChangeState_RECEIVE, 42,
+                                        buffer, sizeof(buffer));
+
+  WiFiCommand wifi_cmd;
+  int status = DecodeWiFiCommand(buffer, buffer_len, &wifi_cmd);
+  TEST_ASSERT_EQUAL(-1, status);
+
+  // empty message contains no command
+  status = DecodeWiFiCommand(buffer, 0, &wifi_cmd);
+  TEST_ASSERT_EQUAL(-1, status);
+}
+
+void TestPageCommandRoundTrip(void) {
+  PageCommand page_cmd = PageCommand_init_zero;
+  page_cmd.file_request = PageCommand_RequestType_WRITE;
+  page_cmd.file_descriptor = 3;
+  page_cmd.num_bytes = 4;
+  page_cmd.data.size = 4;
+  memcpy(page_cmd.data.bytes, "\x01\x02\x03\x04", 4);
+
+  uint8_t buffer[Esp32Command_size];
+  size_t buffer_len = EncodePageCommandMsg(&page_cmd, buffer, sizeof(buffer));
+
+  // same output as encoding the full esp32command
+  Esp32Command cmd = Esp32Command_init_zero;
+  cmd.which_command = Esp32Command_page_command_tag;
+  cmd.command.page_command = page_cmd;
+  uint8_t expected[Esp32Command_size];
+  pb_ostream_t ostream = pb_ostream_from_buffer(expected, sizeof(expected));
+  TEST_ASSERT_TRUE(pb_encode(&ostream, Esp32Command_fields, &cmd));
+  TEST_ASSERT_EQUAL(ostream.bytes_written, buffer_len);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, buffer_len);
+
+  PageCommand decoded;
+  int status = DecodePageCommand(buffer, buffer_len, &decoded);
+  TEST_ASSERT_EQUAL(0, status);
+  TEST_ASSERT_EQUAL(PageCommand_RequestType_WRITE, decoded.file_request);
+  TEST_ASSERT_EQUAL(3, decoded.file_descriptor);
+  TEST_ASSERT_EQUAL(4, decoded.num_bytes);
+  TEST_ASSERT_EQUAL(4, decoded.data.size);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(page_cmd.data.bytes, decoded.data.bytes, 4);
+
+  // not a wifi command
+  WiFiCommand wifi_cmd;
+  status = DecodeWiFiCommand(buffer, buffer_len, &wifi_cmd);
+  TEST_ASSERT_EQUAL(-1, status);
+}
+
 /**
  * @brief Entry point for protobuf test
  * @retval int
@@ -244,10 +813,27 @@ int main(void) {
   RUN_TEST(TestEncodePhytos31);
   RUN_TEST(TestEncodeBME280);
   RUN_TEST(TestEncodeTeros21);
+  RUN_TEST(TestEncodePowerSummary);
+  RUN_TEST(TestEncodeStream);
+  RUN_TEST(TestDecodeMeasurementDouble);
+  RUN_TEST(TestMeasurementBatchPower);
+  RUN_TEST(TestMeasurementBatchBME280);
+  RUN_TEST(TestMeasurementBatchAddMismatch);
+  RUN_TEST(TestMeasurementBatchAddMaxSize);
+  RUN_TEST(TestMeasurementDeltaPower);
+  RUN_TEST(TestMeasurementDeltaBME280);
+  RUN_TEST(TestMeasurementDeltaMissingReference);
+  RUN_TEST(TestMeasurementDeltaKeyframe);
+  RUN_TEST(TestMeasurementDeltaPowerSummary);
+  RUN_TEST(TestEncodePowerBurst);
+  RUN_TEST(TestBurstSamplesLimits);
   RUN_TEST(TestDecodeResponseSuccess);
   RUN_TEST(TestDecodeResponseError);
   RUN_TEST(TestEncodeWiFi);
   RUN_TEST(TestDecodeWiFi);
+  RUN_TEST(TestDecodeWiFiCommand);
+  RUN_TEST(TestDecodeWiFiCommandWrongType);
+  RUN_TEST(TestPageCommandRoundTrip);
 
   UNITY_END();
 }
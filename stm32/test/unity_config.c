@@ -1,7 +1,12 @@
 #include "unity_config.h"
 
+// host tests use the default output to stdout
+#ifndef NATIVE
+
 void UnityOutputChar(char c) {
   HAL_StatusTypeDef status;
   status = HAL_UART_Transmit(&huart1, (const uint8_t *)&c, 1, UART_TIMEOUT);
   if (status != HAL_OK) Error_Handler();
 }
+
+#endif  // NATIVE
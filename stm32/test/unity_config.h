@@ -10,7 +10,9 @@
 #ifndef TEST_UNITY_CONFIG_H_
 #define TEST_UNITY_CONFIG_H_
 
+#ifndef NATIVE
 #include "usart.h"
+#endif  // NATIVE
 
 #ifndef NULL
 #ifndef __cplusplus
@@ -28,6 +30,8 @@
 /** Timeout for UART transmission */
 #define UART_TIMEOUT 1000
 
+#ifndef NATIVE
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -48,4 +52,6 @@ void UnityOutputChar(char c);
 }
 #endif  // extern "C"
 
+#endif  // NATIVE
+
 #endif  // TEST_UNITY_CONFIG_H_